@@ -48,6 +48,10 @@
  * me because I have the emacs taint.  In practice few if any users use key
  * bindings so I'm calling it a day.
  *
+ * Once all the bindings are added, each bucket is compiled into a contiguous
+ * run of KeyEntry in one array with the press and release actions already
+ * decided, so the search is over a few adjacent integers.
+ *
  * MIDI Notes
  *
  * MIDI has a more predictable and constrained message structure.
@@ -62,6 +66,12 @@
  * The table contains a TableEntry array like keyboard bindings, but the "qualifier"
  * value is different.  For MIDI the only qualifier we need is the channel number.
  *
+ * The lists are then compiled into one flat table indexed by message type,
+ * channel, first data byte, and press or release.  Bindings on the "any"
+ * channel are spread over all 16 channels.  Each slot holds the index of
+ * the action, a short, so the whole table is 24K and dispatch is one load.
+ * The result of compilation is the same action the old list search would
+ * have found for that message.
  */
 
 #include <JuceHeader.h>
@@ -83,17 +93,6 @@
 
 #include "Binderator.h"
 
-/**
- * Maximum index into a binding array.
- * One byte (256) is enough for MIDI and basic ASCII keys.
- * Don't need to mess it extended Unicode.
- *
- * OSC bindings will handle this in a different way.
- * Host parameter bindings are unclear, but I think we
- * can limit this to 256.
- */
-const int BinderatorMaxIndex = 256;
-
 //////////////////////////////////////////////////////////////////////
 //
 // Binderator
@@ -102,6 +101,8 @@ const int BinderatorMaxIndex = 256;
 
 Binderator::Binderator()
 {
+    memset(midiTable, 0, sizeof(midiTable));
+    memset(keyBuckets, 0, sizeof(keyBuckets));
 }
 
 Binderator::~Binderator()
@@ -132,8 +133,15 @@ void Binderator::configureMidi(SystemConfig* sconfig, UIConfig* uconfig, SymbolT
     installMidiActions(sconfig, uconfig, symbols);
 }
 
+void Binderator::configureMidi(SymbolTable* symbols, BindingSet* set)
+{
+    prepareMidi();
+    installMidiActions(symbols, set);
+    compileMidi();
+}
+
 /**
- * Prepare a Juce::OwnedArray for use as a binding dispatch table.
+ * Prepare a Juce::OwnedArray for use as a binding build table.
  * Maximum number of events for each type is 256.
  *
  * This is annoying because even if you call ensureStorageAllocated
@@ -148,11 +156,19 @@ void Binderator::configureMidi(SystemConfig* sconfig, UIConfig* uconfig, SymbolT
 void Binderator::prepareArray(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table)
 {
     table->clear();
-    for (int i = 0 ; i < BinderatorMaxIndex ; i++) {
+    for (int i = 0 ; i < MaxIndex ; i++) {
         table->set(i, nullptr);
     }
 }
 
+void Binderator::prepareMidi()
+{
+    prepareArray(&noteActions);
+    prepareArray(&programActions);
+    prepareArray(&controlActions);
+    midiTemplates.clear();
+}
+
 /**
  * Add a table entry.
  * Be sure to call prepareArray on the table first.
@@ -162,11 +178,14 @@ void Binderator::prepareArray(juce::OwnedArray<juce::OwnedArray<TableEntry>>* ta
  * they can come in in any order.
  */
 void Binderator::addEntry(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
+                          juce::OwnedArray<UIAction>* templates,
                           int hashKey,
                           unsigned int qualifier,
                           bool release,
                           UIAction* action)
 {
+    templates->add(action);
+
     juce::OwnedArray<TableEntry>* entries = (*table)[hashKey];
     if (entries == nullptr) {
         entries = new juce::OwnedArray<TableEntry>();
@@ -177,6 +196,7 @@ void Binderator::addEntry(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
     neu->qualifier = qualifier;
     neu->release = release;
     neu->action = action;
+    neu->index = templates->size();
     // kludge to allow this to be processed now that sustain is false
     if (release) neu->action->release = true;
     
@@ -208,7 +228,7 @@ void Binderator::addEntry(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
 }
 
 /**
- * Look up an action in a table.
+ * Look up an entry in a build table.  Used only when compiling.
  * 
  * The optional wildZero argument is used only for MIDI bindings in
  * order to support the "any" binding channel.
@@ -224,10 +244,11 @@ void Binderator::addEntry(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
  * the order of evaluation.  If necessary this could be accomplished with
  * scripts, but reconsider someday.
  */
-UIAction* Binderator::getAction(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
-                                int hashKey, unsigned int qualifier, bool release, bool wildZero)
+Binderator::TableEntry* Binderator::findEntry(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
+                                              int hashKey, unsigned int qualifier,
+                                              bool release, bool wildZero)
 {
-    UIAction* action = nullptr;
+    TableEntry* found = nullptr;
     
     juce::OwnedArray<TableEntry>* entries = (*table)[hashKey];
     if (entries != nullptr) {
@@ -247,13 +268,77 @@ UIAction* Binderator::getAction(juce::OwnedArray<juce::OwnedArray<TableEntry>>*
                     (entry->hasRelease && !release) ||
                     (entry->release && release)) {
                 
-                    action = entry->action;
+                    found = entry;
                     break;
                 }
             }
         }
     }
-    return action;
+    return found;
+}
+
+int Binderator::getIndex(TableEntry* entry)
+{
+    return (entry != nullptr) ? entry->index : 0;
+}
+
+/**
+ * Compile the key build table into buckets of KeyEntry.
+ */
+void Binderator::compileKeys()
+{
+    keyTable.clearQuick();
+    for (int i = 0 ; i < MaxIndex ; i++) {
+        int start = keyTable.size();
+        keyBuckets[i] = (juce::uint16)start;
+        juce::OwnedArray<TableEntry>* entries = keyActions[i];
+        if (entries != nullptr) {
+            for (auto entry : *entries) {
+                bool compiled = false;
+                for (int k = start ; k < keyTable.size() ; k++) {
+                    if (keyTable.getReference(k).qualifier == entry->qualifier) {
+                        compiled = true;
+                        break;
+                    }
+                }
+                if (!compiled) {
+                    KeyEntry key;
+                    key.qualifier = entry->qualifier;
+                    key.press = (juce::uint16)getIndex(findEntry(&keyActions, i, entry->qualifier, false, false));
+                    key.release = (juce::uint16)getIndex(findEntry(&keyActions, i, entry->qualifier, true, false));
+                    keyTable.add(key);
+                }
+            }
+        }
+    }
+    keyBuckets[MaxIndex] = (juce::uint16)keyTable.size();
+    keyActions.clear();
+}
+
+/**
+ * Compile the three MIDI build tables into the dispatch table.
+ */
+void Binderator::compileMidi()
+{
+    compileMidi(&noteActions, MidiNote);
+    compileMidi(&programActions, MidiProgram);
+    compileMidi(&controlActions, MidiControl);
+    noteActions.clear();
+    programActions.clear();
+    controlActions.clear();
+}
+
+void Binderator::compileMidi(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table, int type)
+{
+    for (int channel = 0 ; channel < MidiChannels ; channel++) {
+        for (int value = 0 ; value < MidiValues ; value++) {
+            // binding channels start from 1 with 0 meaning any
+            midiTable[type][channel][value][0] =
+                (juce::uint16)getIndex(findEntry(table, value, channel + 1, false, true));
+            midiTable[type][channel][value][1] =
+                (juce::uint16)getIndex(findEntry(table, value, channel + 1, true, true));
+        }
+    }
 }
 
 /**
@@ -354,6 +439,7 @@ void Binderator::installKeyboardActions(SystemConfig* sconfig, UIConfig* uconfig
 {
     (void)uconfig;
     prepareArray(&keyActions);
+    keyTemplates.clear();
 
     BindingSets* container = sconfig->getBindings();
     if (container != nullptr) {
@@ -375,13 +461,15 @@ void Binderator::installKeyboardActions(SystemConfig* sconfig, UIConfig* uconfig
                         UIAction* action = buildAction(symbols, binding);
                         if (action != nullptr) {
                             int index = code & 0xFF;
-                            addEntry(&keyActions, index, code, binding->release, action);
+                            addEntry(&keyActions, &keyTemplates, index, code,
+                                     binding->release, action);
                         }
                     }
                 }
             }
         }
     }
+    compileKeys();
 }
 
 /**
@@ -401,9 +489,7 @@ void Binderator::installKeyboardActions(SystemConfig* sconfig, UIConfig* uconfig
  */
 void Binderator::installMidiActions(SystemConfig* sconfig, UIConfig* uconfig, SymbolTable* symbols)
 {
-    prepareArray(&noteActions);
-    prepareArray(&programActions);
-    prepareArray(&controlActions);
+    prepareMidi();
     
     BindingSets* container = sconfig->getBindings();
     if (container != nullptr) {
@@ -420,6 +506,7 @@ void Binderator::installMidiActions(SystemConfig* sconfig, UIConfig* uconfig, Sy
             }
         }
     }
+    compileMidi();
 }
 
 void Binderator::installMidiActions(SymbolTable* symbols, BindingSet* set)
@@ -438,7 +525,7 @@ void Binderator::installMidiActions(SymbolTable* symbols, BindingSet* set)
         if (dest != nullptr) {
 
             int index = binding->triggerValue;
-            if (index < 0 ||  index >= BinderatorMaxIndex) {
+            if (index < 0 ||  index >= MidiValues) {
                 Trace(1, "Binderator: Invalid MIDI note %s\n", binding->symbol.toUTF8());
             }
             else {
@@ -451,7 +538,7 @@ void Binderator::installMidiActions(SymbolTable* symbols, BindingSet* set)
                     // "any" and specific channels are numbered from 1
                     // this needs to be understood when matching incomming events
                     int qualifier = binding->midiChannel;
-                    addEntry(dest, index, qualifier, binding->release, action);
+                    addEntry(dest, &midiTemplates, index, qualifier, binding->release, action);
                 }
             }
         }
@@ -463,43 +550,65 @@ void Binderator::installMidiActions(SymbolTable* symbols, BindingSet* set)
  */
 UIAction* Binderator::getKeyAction(int code, int modifiers, bool release)
 {
-    int index = code & 0xFF;
-    int qualifier = getKeyQualifier(code, modifiers);
-    
-    return getAction(&keyActions, index, qualifier, release, false);
+    UIAction* action = nullptr;
+    int bucket = code & 0xFF;
+    unsigned int qualifier = getKeyQualifier(code, modifiers);
+
+    for (int i = keyBuckets[bucket] ; i < keyBuckets[bucket + 1] ; i++) {
+        const KeyEntry& key = keyTable.getReference(i);
+        if (key.qualifier == qualifier) {
+            int index = (release) ? key.release : key.press;
+            if (index > 0)
+              action = keyTemplates.getUnchecked(index - 1);
+            break;
+        }
+    }
+    return action;
 }
 
 /**
  * Given a MIDI message, look up the corresponding action.
- * MidiMessage channels start at 1 with zero reserved for sysex.
- * This matches channel numbers in the Binding model.
- * A binding channel of zero means "any" so we use the
- * "wild zero" option to getAction.
+ * This works from the raw bytes rather than asking MidiMessage
+ * so the table indexes fall out of the status byte.
+ *
+ * Note on with velocity zero is a note off, and a controller with
+ * value zero is a release, both of which use the release slot.
  */
 UIAction* Binderator::getMidiAction(const juce::MidiMessage& message)
 {
     UIAction* action = nullptr;
+    const juce::uint8* raw = message.getRawData();
+    int size = message.getRawDataSize();
     
-    int qualifier = message.getChannel();
-    
-    if (message.isNoteOn()) {
-        int index = message.getNoteNumber();
-        action = getAction(&noteActions, index, qualifier, false, true);
-    }
-    else if (message.isNoteOff()) {
-        int index = message.getNoteNumber();
-        action = getAction(&noteActions, index, qualifier, true, true);
-    }
-    else if (message.isProgramChange()) {
-        int index = message.getProgramChangeNumber();
-        action = getAction(&programActions, index, qualifier, false, true);
-    }
-    else if (message.isController()) {
-        int index = message.getControllerNumber();
-        bool release = (message.getControllerValue() == 0);
-        action = getAction(&controlActions, index, qualifier, release, true);
-    }
+    if (size >= 2) {
+        int status = raw[0] & 0xF0;
+        int channel = raw[0] & 0x0F;
+        int value = raw[1] & 0x7F;
+        int type = -1;
+        int release = 0;
+
+        if (status == 0x90 && size >= 3) {
+            type = MidiNote;
+            release = (raw[2] == 0) ? 1 : 0;
+        }
+        else if (status == 0x80) {
+            type = MidiNote;
+            release = 1;
+        }
+        else if (status == 0xC0) {
+            type = MidiProgram;
+        }
+        else if (status == 0xB0 && size >= 3) {
+            type = MidiControl;
+            release = (raw[2] == 0) ? 1 : 0;
+        }
 
+        if (type >= 0) {
+            int index = midiTable[type][channel][value][release];
+            if (index > 0)
+              action = midiTemplates.getUnchecked(index - 1);
+        }
+    }
     return action;
 }
 
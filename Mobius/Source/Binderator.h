@@ -17,11 +17,32 @@
  * Core class that consumes a MobiusConfig and builds out dispatch
  * tables to quickly map between an external event and a UIAction to send
  * to the UI or the engine.
+ *
+ * Bindings are first collected into hashed lists of TableEntry, then
+ * compiled into flat arrays that can be indexed directly by the MIDI
+ * message bytes or the key code.  Dispatch does no allocation and for
+ * MIDI no searching.  The lists are discarded after compilation.
  */
 class Binderator
 {
   public:
 
+    /**
+     * Maximum index into the build tables and the number of
+     * key dispatch buckets.
+     */
+    static const int MaxIndex = 256;
+
+    /**
+     * Dimensions of the compiled MIDI table.
+     */
+    static const int MidiNote = 0;
+    static const int MidiProgram = 1;
+    static const int MidiControl = 2;
+    static const int MidiTypes = 3;
+    static const int MidiChannels = 16;
+    static const int MidiValues = 128;
+
     // convert key codes and modifier bits to a compressed format
     // for storing in the Binding model, and in the Binderator jump table
     static unsigned int getKeyQualifier(const juce::KeyPress& kp);
@@ -31,14 +52,18 @@ class Binderator
     static unsigned int getMidiQualifier(const juce::MidiMessage& msg);
 
     /**
-     * Internal structure maintained in the action hash table to represent
+     * Internal structure maintained in the build tables to represent
      * collisions on the same table index.
      */
     struct TableEntry {
 
-        // the action to perform
+        // the action to perform, owned by one of the template arrays
         class UIAction* action = nullptr;
 
+        // position of the action in the template array plus one,
+        // this is what the compiled tables store
+        int index = 0;
+
         // for MIDI events, the qualifier is the channel number
         // for keyboard events, it is a combination of the full juce key code
         // and the modifier bits
@@ -50,12 +75,16 @@ class Binderator
         // true if this is associated with a release binding which means
         // that sustain/long abilities are not relevant
         bool hasRelease = false;
+    };
 
-        // could use a smart pointer here, but it's really obvious what to do
-        ~TableEntry() {
-            delete action;
-        }
-        
+    /**
+     * Compiled key binding, one for each distinct key qualifier
+     * in a bucket.  Press and release are template indexes plus one.
+     */
+    struct KeyEntry {
+        unsigned int qualifier = 0;
+        juce::uint16 press = 0;
+        juce::uint16 release = 0;
     };
 
     Binderator();
@@ -71,6 +100,12 @@ class Binderator
      */
     void configureMidi(class SystemConfig* mc, class UIConfig* uc, class SymbolTable* st);
 
+    /**
+     * Construct MIDI tables from a single binding set.
+     * Used by TestDriver to install bindings of its own.
+     */
+    void configureMidi(class SymbolTable* st, class BindingSet* set);
+
     /**
      * Construct mapping tables for only keyboard events.
      */
@@ -86,19 +121,47 @@ class Binderator
      */
     class UIAction* handleKeyEvent(int code, int modifiers, bool up);
 
+    /**
+     * The number of bindings compiled, for the benchmark.
+     */
+    int getMidiBindingCount() {
+        return midiTemplates.size();
+    }
+    
   private:
 
     int controllerThreshold = 0;
+
+    // the actions built from bindings, referenced by the compiled tables
+    juce::OwnedArray<UIAction> keyTemplates;
+    juce::OwnedArray<UIAction> midiTemplates;
+
+    // compiled MIDI dispatch, indexed by message type, channel, the first
+    // data byte, and one for release
+    juce::uint16 midiTable[MidiTypes][MidiChannels][MidiValues][2];
+
+    // compiled key dispatch, bucket i has the entries from keyBuckets[i]
+    // up to keyBuckets[i+1]
+    juce::uint16 keyBuckets[MaxIndex + 1];
+    juce::Array<KeyEntry> keyTable;
+
+    // build tables, empty after compilation
     juce::OwnedArray<juce::OwnedArray<TableEntry>> keyActions;
     juce::OwnedArray<juce::OwnedArray<TableEntry>> noteActions;
     juce::OwnedArray<juce::OwnedArray<TableEntry>> programActions;
     juce::OwnedArray<juce::OwnedArray<TableEntry>> controlActions;
 
     void prepareArray(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table);
+    void prepareMidi();
     void addEntry(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
+                  juce::OwnedArray<UIAction>* templates,
                   int hashKey, unsigned int qualifier, bool release, UIAction* action);
-    UIAction* getAction(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
-                        int hashKey, unsigned int qualifier, bool release, bool wildZero);
+    TableEntry* findEntry(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table,
+                          int hashKey, unsigned int qualifier, bool release, bool wildZero);
+    int getIndex(TableEntry* entry);
+    void compileKeys();
+    void compileMidi();
+    void compileMidi(juce::OwnedArray<juce::OwnedArray<TableEntry>>* table, int type);
 
     void installKeyboardActions(class SystemConfig* sconfig, class UIConfig* uconfig,
                                 class SymbolTable* symbols);
@@ -0,0 +1,490 @@
+/**
+ * Offline rendering of the engine to audio files.
+ *
+ * The engine doesn't care where audio blocks come from as long as they
+ * arrive through a MobiusAudioStream.  TestDriver already uses that to
+ * pump blocks in "bypass" mode from the maintenance thread.  This does
+ * the same thing from a dedicated thread with no pacing at all, so a session
+ * renders as fast as the engine can process it.
+ *
+ * Each port has a pair of interleaved buffers like PortAuthority.  Input
+ * ports may be fed from audio files, and output ports are converted back
+ * to planar buffers and handed to a ThreadedWriter so file I/O happens
+ * on a separate thread.  If the writer falls behind we simply wait for it,
+ * there is no deadline to miss.
+ *
+ * Track stems use MobiusAudioStream::getTrackOutputBuffer.  Tracks that
+ * find a buffer there play into it and then mix it into their port.
+ *
+ * Completion is detected in two ways.  A frame count stops the render
+ * exactly on that frame.  A script stops it when the shell receives the
+ * EventScriptFinished notification which happens in the maintenance thread,
+ * so the render can run a short distance past the end of the script.
+ */
+
+#include <JuceHeader.h>
+
+#include "util/Trace.h"
+#include "model/Session.h"
+#include "model/Symbol.h"
+#include "model/ScriptProperties.h"
+#include "model/UIAction.h"
+
+#include "Supervisor.h"
+#include "Freewheeler.h"
+
+/**
+ * Request ids for script completion, kept well away from the ones
+ * TestDriver generates.
+ */
+static int FreewheelRequestId = 10000;
+
+/**
+ * The port buffers no longer limit the block size but the core streams
+ * are still sized for AUDIO_MAX_FRAMES_PER_BUFFER.
+ */
+static const int FreewheelMaxBlockSize = 4096;
+
+Freewheeler::Freewheeler(Supervisor* s) :
+    juce::Thread(juce::String("Mobius Render"))
+{
+    supervisor = s;
+    formatManager.registerBasicFormats();
+}
+
+Freewheeler::~Freewheeler()
+{
+    if (active) {
+        stopThread(2000);
+        closeFiles();
+        supervisor->cancelListenerOverrides();
+    }
+}
+
+int Freewheeler::getBlockSize()
+{
+    return request.blockSize;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Start/Stop
+//
+//////////////////////////////////////////////////////////////////////
+
+juce::String Freewheeler::start(Request& r)
+{
+    if (active)
+      return juce::String("Render already in progress");
+
+    if (supervisor->isTestMode())
+      return juce::String("Render is not available in test mode");
+
+    if (r.maxFrames <= 0 && r.script.length() == 0)
+      return juce::String("Render needs a script or a frame count");
+
+    if (r.blockSize <= 0 || r.ports <= 0)
+      return juce::String("Invalid render block size or port count");
+
+    if (r.blockSize > FreewheelMaxBlockSize)
+      return juce::String("Render block size may not exceed ") + juce::String(FreewheelMaxBlockSize);
+
+    Symbol* scriptSymbol = nullptr;
+    if (r.script.length() > 0) {
+        scriptSymbol = supervisor->getSymbols()->find(r.script);
+        if (scriptSymbol == nullptr)
+          return juce::String("Unknown script ") + r.script;
+
+        // completion is only reported by the MOS ScriptRuntime, MSL scripts
+        // and ordinary functions would render forever
+        if (scriptSymbol->script == nullptr || scriptSymbol->script->coreScript == nullptr)
+          return r.script + juce::String(" is not a MOS script, use a frame count");
+    }
+
+    if (!r.folder.isDirectory()) {
+        juce::Result result = r.folder.createDirectory();
+        if (result.failed())
+          return juce::String("Unable to create folder ") + r.folder.getFullPathName();
+    }
+
+    request = r;
+    sampleRate = supervisor->getSampleRate();
+    juce::String error;
+
+    int samples = request.blockSize * 2;
+    ports.clear();
+    for (int i = 0 ; i < request.ports && error.length() == 0 ; i++) {
+        Channel* c = new Channel();
+        ports.add(c);
+        c->input.calloc(samples);
+        c->output.calloc(samples);
+        if (i < request.inputs.size())
+          (void)openInput(c, request.inputs[i], error);
+        if (error.length() == 0)
+          (void)openOutput(c, request.name + "-port" + juce::String(i + 1), error);
+    }
+
+    tracks.clear();
+    if (request.tracks) {
+        int trackCount = supervisor->getSession()->getTrackCount();
+        for (int i = 0 ; i < trackCount && error.length() == 0 ; i++) {
+            Channel* c = new Channel();
+            tracks.add(c);
+            c->output.calloc(samples);
+            (void)openOutput(c, request.name + "-track" + juce::String(i + 1), error);
+        }
+    }
+
+    if (error.length() > 0) {
+        closeFiles();
+        return error;
+    }
+
+    voidInput.calloc(samples);
+    voidOutput.calloc(samples);
+    planar.setSize(2, request.blockSize);
+    midiBuffer.ensureSize(1024);
+
+    framesRendered = 0;
+    blocksRendered = 0;
+    elapsed = 0;
+    scriptEnded = false;
+    finished = false;
+
+    writerThread.startThread();
+
+    defaultAudioListener = supervisor->overrideAudioListener(this);
+    waitForDevice();
+    active = true;
+
+    if (scriptSymbol != nullptr) {
+        UIAction action;
+        action.symbol = scriptSymbol;
+        action.requestId = FreewheelRequestId++;
+        requestId = action.requestId;
+        // this is queued and will be consumed on the first render block
+        supervisor->getMobius()->doAction(&action);
+    }
+    else {
+        requestId = 0;
+    }
+
+    Trace(2, "Freewheeler: Starting render to %s block size %d",
+          request.folder.getFullPathName().toUTF8(), request.blockSize);
+
+    startThread();
+    return error;
+}
+
+/**
+ * After redirecting the device stream, give the audio thread a moment to
+ * finish any block it was in the middle of so we don't call the kernel
+ * from two threads at once.  If no device is running we'll never see a
+ * block and just time out.
+ */
+void Freewheeler::waitForDevice()
+{
+    deviceBlocks = 0;
+    for (int i = 0 ; i < 20 && deviceBlocks.load() == 0 ; i++)
+      juce::Thread::sleep(5);
+}
+
+bool Freewheeler::openInput(Channel* c, juce::String path, juce::String& error)
+{
+    juce::File file = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+    juce::AudioFormatReader* reader = formatManager.createReaderFor(file);
+    if (reader == nullptr) {
+        error = juce::String("Unable to read input file ") + file.getFullPathName();
+    }
+    else {
+        c->reader.reset(reader);
+        if ((int)(reader->sampleRate) != sampleRate)
+          Trace(1, "Freewheeler: Input file sample rate %d does not match %d",
+                (int)(reader->sampleRate), sampleRate);
+    }
+    return (reader != nullptr);
+}
+
+bool Freewheeler::openOutput(Channel* c, juce::String leaf, juce::String& error)
+{
+    juce::File file = request.folder.getChildFile(leaf + ".wav");
+    if (file.existsAsFile())
+      file.deleteFile();
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::FileOutputStream> stream = file.createOutputStream();
+    juce::AudioFormatWriter* writer = nullptr;
+    if (stream != nullptr) {
+        writer = wav.createWriterFor(stream.get(), (double)sampleRate, 2, 24, {}, 0);
+        // writer owns the stream if it was created
+        if (writer != nullptr)
+          (void)stream.release();
+    }
+
+    if (writer == nullptr) {
+        error = juce::String("Unable to write output file ") + file.getFullPathName();
+    }
+    else {
+        // give the writer a generous FIFO so the render thread rarely waits
+        c->writer.reset(new juce::AudioFormatWriter::ThreadedWriter(writer, writerThread,
+                                                                    request.blockSize * 64));
+    }
+    return (writer != nullptr);
+}
+
+void Freewheeler::cancel()
+{
+    if (active) {
+        Trace(2, "Freewheeler: Canceling render");
+        signalThreadShouldExit();
+    }
+}
+
+void Freewheeler::scriptFinished(int id)
+{
+    if (active && requestId > 0 && id == requestId)
+      scriptEnded = true;
+}
+
+/**
+ * Called in the maintenance thread.
+ */
+void Freewheeler::advance()
+{
+    if (active && finished.load())
+      finish();
+}
+
+void Freewheeler::finish()
+{
+    stopThread(2000);
+    closeFiles();
+
+    supervisor->cancelListenerOverrides();
+    defaultAudioListener = nullptr;
+    active = false;
+
+    double seconds = (double)framesRendered / (double)sampleRate;
+    double speed = (elapsed > 0) ? ((seconds * 1000.0f) / (double)elapsed) : 0.0f;
+    juce::String msg = juce::String("Render finished: ") +
+        juce::String(framesRendered) + " frames in " +
+        juce::String(blocksRendered) + " blocks, " +
+        juce::String(elapsed) + " msec, " +
+        juce::String(speed, 1) + "x realtime";
+    Trace(2, "Freewheeler: %s", msg.toUTF8());
+    supervisor->message(msg);
+    supervisor->mslPrint(msg.toUTF8());
+}
+
+/**
+ * Deleting a ThreadedWriter flushes whatever remains in the FIFO and
+ * closes the file.  Track files that were never touched belong to
+ * MIDI tracks and are removed.
+ */
+void Freewheeler::closeFiles()
+{
+    for (auto c : ports) {
+        c->writer = nullptr;
+        c->reader = nullptr;
+    }
+
+    for (int i = 0 ; i < tracks.size() ; i++) {
+        Channel* c = tracks[i];
+        c->writer = nullptr;
+        if (!c->touched) {
+            juce::File file = request.folder.getChildFile(request.name + "-track" +
+                                                          juce::String(i + 1) + ".wav");
+            file.deleteFile();
+        }
+    }
+
+    writerThread.stopThread(2000);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Render Thread
+//
+//////////////////////////////////////////////////////////////////////
+
+void Freewheeler::run()
+{
+    startTime = juce::Time::getMillisecondCounter();
+
+    while (!threadShouldExit() && !scriptEnded.load()) {
+
+        int frames = request.blockSize;
+        if (request.maxFrames > 0) {
+            juce::int64 remaining = request.maxFrames - framesRendered;
+            if (remaining <= 0)
+              break;
+            else if (remaining < frames)
+              frames = (int)remaining;
+        }
+        blockFrames = frames;
+
+        prepareBlock();
+        defaultAudioListener->processAudioStream(this);
+        commitBlock();
+
+        framesRendered += frames;
+        blocksRendered++;
+    }
+
+    elapsed = juce::Time::getMillisecondCounter() - startTime;
+    finished = true;
+}
+
+void Freewheeler::prepareBlock()
+{
+    int samples = blockFrames * 2;
+
+    for (auto c : ports) {
+        readInput(c);
+        memset(c->output.get(), 0, sizeof(float) * samples);
+    }
+
+    for (auto c : tracks)
+      memset(c->output.get(), 0, sizeof(float) * samples);
+
+    memset(voidInput.get(), 0, sizeof(float) * samples);
+    memset(voidOutput.get(), 0, sizeof(float) * samples);
+
+    midiBuffer.clear();
+}
+
+void Freewheeler::readInput(Channel* c)
+{
+    float* dest = c->input.get();
+    if (c->reader == nullptr) {
+        memset(dest, 0, sizeof(float) * blockFrames * 2);
+    }
+    else {
+        planar.clear();
+        juce::int64 available = c->reader->lengthInSamples - c->readPosition;
+        int frames = (int)juce::jmin((juce::int64)blockFrames, available);
+        if (frames > 0) {
+            c->reader->read(&planar, 0, frames, c->readPosition, true, true);
+            c->readPosition += frames;
+        }
+        const float* left = planar.getReadPointer(0);
+        const float* right = planar.getReadPointer(1);
+        for (int i = 0 ; i < blockFrames ; i++) {
+            *dest++ = left[i];
+            *dest++ = right[i];
+        }
+    }
+}
+
+void Freewheeler::commitBlock()
+{
+    for (auto c : ports)
+      writeOutput(c);
+
+    for (auto c : tracks) {
+        if (c->touched)
+          writeOutput(c);
+    }
+}
+
+void Freewheeler::writeOutput(Channel* c)
+{
+    if (c->writer != nullptr) {
+        const float* src = c->output.get();
+        float* left = planar.getWritePointer(0);
+        float* right = planar.getWritePointer(1);
+        for (int i = 0 ; i < blockFrames ; i++) {
+            left[i] = *src++;
+            right[i] = *src++;
+        }
+
+        // if the writer FIFO is full, wait for it to drain
+        while (!c->writer->write(planar.getArrayOfReadPointers(), blockFrames)) {
+            if (threadShouldExit())
+              break;
+            wait(1);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// MobiusAudioListener
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * The device keeps calling us while we render, let it play silence.
+ * JuceAudioStream clears the port buffers before each block so there
+ * is nothing to do but count them.
+ */
+void Freewheeler::processAudioStream(MobiusAudioStream* stream)
+{
+    (void)stream;
+    deviceBlocks++;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// MobiusAudioStream
+//
+//////////////////////////////////////////////////////////////////////
+
+int Freewheeler::getSampleRate()
+{
+    return sampleRate;
+}
+
+int Freewheeler::getInterruptFrames()
+{
+    return blockFrames;
+}
+
+void Freewheeler::getInterruptBuffers(int inport, float** input,
+                                      int outport, float** output)
+{
+    if (input != nullptr) {
+        if (inport >= 0 && inport < ports.size())
+          *input = ports[inport]->input.get();
+        else
+          *input = voidInput.get();
+    }
+
+    if (output != nullptr) {
+        if (outport >= 0 && outport < ports.size())
+          *output = ports[outport]->output.get();
+        else
+          *output = voidOutput.get();
+    }
+}
+
+float* Freewheeler::getTrackOutputBuffer(int number)
+{
+    float* buffer = nullptr;
+    int index = number - 1;
+    if (index >= 0 && index < tracks.size()) {
+        Channel* c = tracks[index];
+        c->touched = true;
+        buffer = c->output.get();
+    }
+    return buffer;
+}
+
+juce::MidiBuffer* Freewheeler::getMidiMessages()
+{
+    return &midiBuffer;
+}
+
+double Freewheeler::getStreamTime()
+{
+    return (double)framesRendered / (double)sampleRate;
+}
+
+double Freewheeler::getLastInterruptStreamTime()
+{
+    return getStreamTime();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,175 @@
+/**
+ * Offline rendering of the engine to audio files.
+ *
+ * Freewheeler splices itself into the audio listener chain the same way
+ * TestDriver does, then drives the kernel from its own thread rather than
+ * the audio device.  Blocks are processed back to back as fast as the
+ * engine can consume them, optionally larger than the device block size.
+ * Input may be read from files, and the output of each port, and optionally
+ * each track, is streamed to WAV files through a background writer.
+ *
+ * Rendering stops when a script launched at the start finishes, when
+ * a frame count is reached, or when canceled.
+ *
+ * Live device blocks that arrive while rendering are ignored and the
+ * device outputs silence.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "mobius/MobiusInterface.h"
+
+class Freewheeler : public juce::Thread, public MobiusAudioListener, public MobiusAudioStream
+{
+  public:
+
+    /**
+     * Options for one render.
+     */
+    class Request
+    {
+      public:
+
+        // folder where the output files are written, created if necessary
+        juce::File folder;
+
+        // prefix for the output file names
+        juce::String name = "render";
+
+        // frames in each block, may be larger than the device block size
+        int blockSize = 1024;
+
+        // stop after this many frames, zero to run until the script finishes
+        int maxFrames = 0;
+
+        // name of a MOS script Symbol to run when rendering starts
+        juce::String script;
+
+        // files that feed the input ports, the first is port 1
+        juce::StringArray inputs;
+
+        // number of output ports to capture
+        int ports = 1;
+
+        // true to write a file for each audio track in addition to the ports
+        bool tracks = false;
+    };
+
+    Freewheeler(class Supervisor* s);
+    ~Freewheeler();
+
+    /**
+     * Begin rendering.  Returns an error message if the request could
+     * not be started.
+     */
+    juce::String start(Request& r);
+
+    /**
+     * Stop rendering early.  Files written so far are kept.
+     */
+    void cancel();
+
+    bool isActive() {
+        return active;
+    }
+
+    /**
+     * Called by Supervisor in the maintenance thread to detect completion
+     * and close the output files.
+     */
+    void advance();
+
+    /**
+     * Forwarded from the MobiusListener to detect the end of the script.
+     */
+    void scriptFinished(int requestId);
+
+    /**
+     * The block size the kernel should assume while rendering.
+     */
+    int getBlockSize();
+
+    // Thread
+    void run() override;
+
+    // MobiusAudioListener, receives the device blocks we ignore
+    void processAudioStream(class MobiusAudioStream* stream) override;
+
+    // MobiusAudioStream
+    int getSampleRate() override;
+	int getInterruptFrames() override;
+	void getInterruptBuffers(int inport, float** input,
+                             int outport, float** output) override;
+    float* getTrackOutputBuffer(int number) override;
+    juce::MidiBuffer* getMidiMessages() override;
+    double getStreamTime() override;
+    double getLastInterruptStreamTime() override;
+
+  private:
+
+    /**
+     * Buffers and files for one port or track.
+     */
+    class Channel
+    {
+      public:
+        juce::HeapBlock<float> input;
+        juce::HeapBlock<float> output;
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> writer;
+        juce::int64 readPosition = 0;
+        // set the first time the track asks for its buffer and never
+        // cleared, tracks that never ask are MIDI tracks
+        bool touched = false;
+    };
+
+    class Supervisor* supervisor = nullptr;
+    class MobiusAudioListener* defaultAudioListener = nullptr;
+
+    Request request;
+    bool active = false;
+    int sampleRate = 44100;
+    int requestId = 0;
+
+    juce::AudioFormatManager formatManager;
+    juce::TimeSliceThread writerThread {"Mobius Render Writer"};
+
+    juce::OwnedArray<Channel> ports;
+    juce::OwnedArray<Channel> tracks;
+
+    // planar buffer used to convert between files and interleaved ports
+    juce::AudioBuffer<float> planar;
+
+    // empty buffers for ports beyond what was requested
+    juce::HeapBlock<float> voidInput;
+    juce::HeapBlock<float> voidOutput;
+
+    juce::MidiBuffer midiBuffer;
+
+    int blockFrames = 0;
+    juce::int64 framesRendered = 0;
+    int blocksRendered = 0;
+    juce::uint32 startTime = 0;
+    juce::uint32 elapsed = 0;
+
+    std::atomic<bool> scriptEnded {false};
+    std::atomic<bool> finished {false};
+    std::atomic<int> deviceBlocks {0};
+
+    void waitForDevice();
+    bool openInput(Channel* c, juce::String path, juce::String& error);
+    bool openOutput(Channel* c, juce::String leaf, juce::String& error);
+    void prepareBlock();
+    void commitBlock();
+    void readInput(Channel* c);
+    void writeOutput(Channel* c);
+    void finish();
+    void closeFiles();
+
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
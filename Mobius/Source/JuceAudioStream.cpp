@@ -78,6 +78,7 @@ void JuceAudioStream::traceFinalStatistics()
     Tracej("  releaseResources " + juce::String(releaseResourcesCalls));
     if (audioPrepared) 
       Tracej("  Ending with audio still prepared!");
+    portAuthority.traceStatistics();
 }
 
 /**
@@ -187,6 +188,15 @@ void JuceAudioStream::getInterruptBuffers(int inport, float** input,
     if (output != nullptr) *output = portAuthority.getOutput(outport);
 }
 
+/**
+ * Tracks that can consume non-interleaved input read the host
+ * channels directly, which avoids interleaving the port.
+ */
+bool JuceAudioStream::getPlanarInput(int port, const float** left, const float** right)
+{
+    return portAuthority.getPlanarInput(port, left, right);
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // Standalone AudioAppComponent Interface
@@ -221,6 +231,7 @@ void JuceAudioStream::prepareToPlay (int samplesPerBlockExpected, double sampleR
     prepareToPlayCalls++;
     preparedSamplesPerBlock = samplesPerBlockExpected;
     preparedSampleRate = sampleRate;
+    portAuthority.allocate(samplesPerBlockExpected);
     
     audioPrepared = true;
 
@@ -430,6 +441,7 @@ void JuceAudioStream::prepareToPlayPlugin(double sampleRate, int samplesPerBlock
 
     prepareToPlayCalls++;
     preparedSamplesPerBlock = samplesPerBlock;
+    portAuthority.allocate(samplesPerBlock);
     preparedSampleRate = sampleRate;
     
     Tracej("AudioStream: prepareToPlayPlugin samplesPerBlock " + juce::String(samplesPerBlock) +
@@ -44,6 +44,7 @@ class JuceAudioStream : public MobiusAudioStream
 	int getInterruptFrames() override;
 	void getInterruptBuffers(int inport, float** input, 
                              int outport, float** output) override;
+    bool getPlanarInput(int port, const float** left, const float** right) override;
 
     juce::MidiBuffer* getMidiMessages() override;
     
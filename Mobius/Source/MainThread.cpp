@@ -40,8 +40,8 @@ void MainThread::start()
     // of a plugin host
     // most comments indicate that this only works for Mac or Posix
     // so start with just priority
-    (void)options.withPriority(10);
-    (void)options.withPeriodMs(1);
+    // these return a modified copy rather than changing options
+    options = options.withPriority(10).withPeriodMs(1);
 
     if (!startRealtimeThread(options)) {
         Trace(1, "MainThread: Unable to start thread\n");
@@ -57,9 +57,15 @@ void MainThread::stop()
 }
 
 /**
- * Looks like this is similar to Java threads, in that run() is
- * called once and if you have any timing to do you have to handle
- * that yourself.   
+ * Signals from the kernel and trace set flags that are polled every
+ * PollInterval so work is handled soon after it is queued.  Signals can
+ * come from the audio thread so they don't notify the thread, waking it
+ * can take a lock.  The other deadlines are things driven by time: the
+ * high resolution refresh while someone is listening for it, and a slower
+ * periodic shell advance for script waits, tests, and tasks.
+ *
+ * The MessageManagerLock is only taken when one of those has something
+ * to do.  When the engine is idle a poll just looks at the flags.
  */
 void MainThread::run()
 {
@@ -68,18 +74,33 @@ void MainThread::run()
     // trace buffering for some reason
     
     GlobalTraceFlusher = this;
-    int ticks = 0;
+
+    double now = juce::Time::getMillisecondCounterHiRes();
+    startTime = now;
+    nextShell = now + ShellInterval;
+    nextHigh = now;
+    nextTrace = now;
     
     // threadShouldExit returns true when the stopThread method is called
     while (!threadShouldExit()) {
 
-        wait(10);
-        ticks++;
+        wait(getTimeout(now));
+        wakeups++;
+        now = juce::Time::getMillisecondCounterHiRes();
+
+        bool shellSignaled = shellPending.exchange(false);
+        bool doShell = shellSignaled || now >= nextShell;
+        bool doDisplay = displayPending.exchange(false) || doShell;
+        bool doTrace = tracePending.load() && now >= nextTrace;
+        
+        bool doHigh = false;
+        bool highSignaled = highPending.exchange(false);
+        if (supervisor->hasHighListeners())
+          doHigh = highSignaled || now >= nextHigh;
 
-        bool doCoarse = false;
-        if (ticks >= 10) {
-            doCoarse = true;
-            ticks = 0;
+        if (!doShell && !doDisplay && !doTrace && !doHigh) {
+            idleWakeups++;
+            continue;
         }
 
         // from the Juce example
@@ -91,47 +112,145 @@ void MainThread::run()
             // in which case we better return
             return;
         }
+        locks++;
 
-        supervisor->advanceHigh();
-
-        if (doCoarse) {
-
+        if (doHigh) {
+            supervisor->advanceHigh();
+            nextHigh = now + highInterval.load();
+            highAdvances++;
+        }
+        
+        if (doTrace || doShell) {
             // flush any accumulated trace messages
             // had to move this under MessageManagerLock once UnitTestPanel started
             // intercepting messages
-            if (GlobalTraceFlusher == this)
-              FlushTrace();
+            if (doTrace) {
+                tracePending = false;
+                if (GlobalTraceFlusher == this)
+                  FlushTrace();
+                nextTrace = now + TraceInterval;
+                traceFlushes++;
+            }
 
             // hmm, not liking the double buffering
             // Should FlushTrace do this or are they independent?
             // gak, what a mess
             TraceFile.flush();
+        }
 
-            // thread is locked, we can mess with components
-            // I don't think we're going to need events to process, just
-            // notify Supervisor
+        if (doShell) {
+            if (shellSignaled) {
+                double latency = now - shellSignalTime.load();
+                totalLatency += latency;
+                if (latency > maxLatency)
+                  maxLatency = latency;
+                shellSignals++;
+            }
             supervisor->advance();
+            nextShell = now + ShellInterval;
+            shellAdvances++;
+        }
+
+        if (doDisplay) {
+            supervisor->advanceDisplay();
+            displayAdvances++;
         }
     }
 
     FlushTrace();
     GlobalTraceFlusher = nullptr;
+
+    traceStatistics();
 }
 
 /**
- * TraceFlusher callback indicating  a trace record
- * has been added.  The old MobiusThread used this to call signal() to
- * break the thread out of the wait state so it could call FlushTrace
- * immediately rather than waiting the full 1/10th second timeout so
- * that messages would have less lag.
- *
- * Unclear what the Juce equivalent of that is, but I'm sure there's something.
- * This doesn't really matter as long as the thread calls FlushTrace
- * regularly, it just might have lag.
+ * Calculate how long to wait for the next thing that runs on time,
+ * or the next look at the signal flags.
+ */
+int MainThread::getTimeout(double now)
+{
+    double deadline = now + PollInterval;
+    if (nextShell < deadline)
+      deadline = nextShell;
+    if (supervisor->hasHighListeners() && nextHigh < deadline)
+      deadline = nextHigh;
+    if (tracePending.load() && nextTrace < deadline)
+      deadline = nextTrace;
+
+    int timeout = (int)(deadline - now);
+    if (timeout < 1)
+      timeout = 1;
+    return timeout;
+}
+
+void MainThread::setHighInterval(int msec)
+{
+    if (msec < 1)
+      msec = DefaultHighInterval;
+    highInterval = msec;
+}
+
+/**
+ * Called by the kernel at the end of a block when it sent
+ * messages to the shell.  This is called from the audio thread.
+ * Only the first signal is timestamped so the latency measures
+ * how long the oldest message waited.
+ */
+void MainThread::signalShell()
+{
+    if (!shellPending.load()) {
+        shellSignalTime = juce::Time::getMillisecondCounterHiRes();
+        shellPending = true;
+    }
+}
+
+/**
+ * Called by the kernel when it publishes a new SystemState.
+ */
+void MainThread::signalDisplay()
+{
+    displayPending = true;
+}
+
+/**
+ * Called when the engine crosses a time boundary and the
+ * high resolution elements would like to see it early.
+ */
+void MainThread::signalHigh()
+{
+    highPending = true;
+}
+
+/**
+ * TraceFlusher callback indicating a trace record has been added.
+ * This can happen in the audio thread so it only sets the flag.
+ * Flushes are throttled to TraceInterval so a burst of trace doesn't
+ * take the MessageManagerLock for each one.
  */
 void MainThread::traceEvent()
 {
-    // signal();
+    tracePending = true;
+}
+
+/**
+ * Trace what the thread did over its lifetime, mostly to see how
+ * often it wakes up when idle and how long the shell waited
+ * for kernel messages.
+ */
+void MainThread::traceStatistics()
+{
+    double seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    if (seconds > 0.0) {
+        Trace(2, "MainThread: %d wakeups %d idle %d locks in %d seconds",
+              wakeups, idleWakeups, locks, (int)seconds);
+        Trace(2, "MainThread: %d shell %d display %d high %d trace advances",
+              shellAdvances, displayAdvances, highAdvances, traceFlushes);
+        if (shellSignals > 0) {
+            Trace(2, "MainThread: Kernel signals %d average latency %d us maximum %d us",
+                  shellSignals, (int)((totalLatency * 1000.0) / shellSignals),
+                  (int)(maxLatency * 1000.0));
+        }
+    }
 }
 
 /****************************************************************************/
@@ -1,4 +1,3 @@
-
 #pragma once
 
 #include <JuceHeader.h>
@@ -7,7 +6,29 @@
 class MainThread : public juce::Thread, public TraceFlusher
 {
   public:
-    
+
+    /**
+     * Default rate in milliseconds for high resolution refresh.
+     */
+    static const int DefaultHighInterval = 10;
+
+    /**
+     * Time in milliseconds between shell advances when nothing
+     * has signaled.  Scripts waiting on time, TestDriver, and
+     * the TaskMaster depend on this.
+     */
+    static const int ShellInterval = 100;
+
+    /**
+     * Minimum time between trace flushes.
+     */
+    static const int TraceInterval = 10;
+
+    /**
+     * Time in milliseconds between looks at the signal flags.
+     */
+    static const int PollInterval = 5;
+
     MainThread(class Supervisor* super);
     ~MainThread();
 
@@ -19,11 +40,44 @@ class MainThread : public juce::Thread, public TraceFlusher
     // TraceListener
     void traceEvent() override;
 
+    // signals, these may be called from any thread including audio
+    void signalShell();
+    void signalDisplay();
+    void signalHigh();
+
+    void setHighInterval(int msec);
+
   private:
 
     class Supervisor* supervisor;
 
-    int counter = 0;
-    
-};
+    std::atomic<bool> shellPending {false};
+    std::atomic<bool> displayPending {false};
+    std::atomic<bool> highPending {false};
+    std::atomic<bool> tracePending {false};
+    std::atomic<int> highInterval {DefaultHighInterval};
+
+    // time the first unprocessed shell signal was sent
+    std::atomic<double> shellSignalTime {0.0};
+
+    double nextShell = 0.0;
+    double nextHigh = 0.0;
+    double nextTrace = 0.0;
 
+    // statistics
+    double startTime = 0.0;
+    int wakeups = 0;
+    int idleWakeups = 0;
+    int locks = 0;
+    int shellSignals = 0;
+    int shellAdvances = 0;
+    int displayAdvances = 0;
+    int highAdvances = 0;
+    int traceFlushes = 0;
+    double totalLatency = 0.0;
+    double maxLatency = 0.0;
+
+    int getTimeout(double now);
+    void traceStatistics();
+
+};
@@ -359,6 +359,7 @@ MidiSequence* MidiClerk::toSequence(juce::File file)
               Trace(2, "MidiClerk: Warning: More than one track in file, merging");
                 
             sequence = new MidiSequence();
+            sequence->reserveIndex();
             
             for (int i = 0 ; i < ntracks ; i++) {
                 const juce::MidiMessageSequence* mms = mfile.getTrack(i);
@@ -89,6 +89,8 @@ MidiManager::MidiManager(Supervisor* super)
     // done to MidiMessage::getTimeStamp when created by MidiInput
     // " The message's timestamp is set to a value equivalent to (Time::getMillisecondCounter() / 1000.0) to specify the time when the message arrived"
     startTime = (juce::Time::getMillisecondCounterHiRes() * 0.001);
+
+    outputQueue.initialize(this);
 }
 
 MidiManager::~MidiManager()
@@ -140,9 +142,12 @@ void MidiManager::resume()
 void MidiManager::shutdown()
 {
     closeAllInputs();
+    outputQueue.stopThread();
     closeAllOutputs();
     listeners.clear();
     realtimeListeners.clear();
+    inputQueue.traceStatistics();
+    outputQueue.traceStatistics();
 }
 
 void MidiManager::addListener(Listener* l)
@@ -171,11 +176,31 @@ void MidiManager::addMonitor(Monitor* l)
 {
     if (!monitors.contains(l))
       monitors.add(l);
+    refreshMonitors();
 }
 
 void MidiManager::removeMonitor(Monitor* l)
 {
     monitors.removeAllInstancesOf(l);
+    refreshMonitors();
+}
+
+/**
+ * The device threads can't walk the monitor list while the UI is
+ * changing it, so summarize what they need to know.  Whether a monitor
+ * is exclusive doesn't change once it has been added.
+ */
+void MidiManager::refreshMonitors()
+{
+    bool exclusive = false;
+    for (auto monitor : monitors) {
+        if (monitor->midiMonitorExclusive()) {
+            exclusive = true;
+            break;
+        }
+    }
+    exclusiveMonitor = exclusive;
+    monitorCount = monitors.size();
 }
 
 /**
@@ -222,9 +247,14 @@ void MidiManager::openDevices()
     // keep a list of device errors for display at an appropriate time later
     errors.clear();
 
+    // the output thread must not be sending while devices are closed
+    outputQueue.stopThread();
+    
     reconcileInputs(mconfig);
     reconcileOutputs(mconfig);
 
+    outputQueue.startThread();
+
 }
 
 /**
@@ -398,6 +428,7 @@ juce::MidiInput* MidiManager::findOrOpenInput(juce::String name)
             else {
                 found = dev.release();
                 inputDevices.add(found);
+                inputQueue.attach(found, inputDevices.size() - 1);
                 // presumably this is what starts it pumping events to the callback
                 found->start();
             }
@@ -463,9 +494,21 @@ void MidiManager::closeUnusedInputs()
             dev->stop();
             if (dev == inputSyncDevice)
               inputSyncDevice = nullptr;
+            inputQueue.detach(dev);
             inputDevices.removeObject(dev, true);
         }
     }
+    attachInputs();
+}
+
+/**
+ * Device ids are positions in the input list, after removing some
+ * the ones that are left may have moved.  They keep their rings.
+ */
+void MidiManager::attachInputs()
+{
+    for (int i = 0 ; i < inputDevices.size() ; i++)
+      inputQueue.attach(inputDevices[i], i);
 }
 
 /**
@@ -495,6 +538,9 @@ void MidiManager::closeAllInputs()
         
     // stop them first?
     stopInputs();
+
+    for (auto dev : inputDevices)
+      inputQueue.detach(dev);
     
     // this deletes them
     inputDevices.clear();
@@ -1051,8 +1097,13 @@ void MidiManager::handleIncomingMidiMessage (juce::MidiInput* source,
             listener->midiRealtime(message, sourceName);
         }
     }
+    else if (queueInput(source, message)) {
+        // the kernel has it, the monitors may still want to see it
+        if (monitorCount > 0)
+          postListenerMessage(message, sourceName, true);
+    }
     else {
-        postListenerMessage(message, sourceName);
+        postListenerMessage(message, sourceName, false);
     }
 
     // unclear whether sending MIDI is considered dangerous to do in the receiver thread,
@@ -1069,6 +1120,23 @@ void MidiManager::handleIncomingMidiMessage (juce::MidiInput* source,
     }
 }
 
+/**
+ * Try to give a message directly to the kernel.
+ * This doesn't happen while an exclusive monitor like binding capture
+ * is open since those don't want anything processed.
+ *
+ * This runs in the device thread so it must not look at inputDevices,
+ * which the message thread changes.  The queue finds the ring the device
+ * was attached to and the same device id record() would use.
+ */
+bool MidiManager::queueInput(juce::MidiInput* source, const juce::MidiMessage& message)
+{
+    bool queued = false;
+    if (!exclusiveMonitor)
+      queued = inputQueue.add(source, message);
+    return queued;
+}
+
 /**
  * This one is optional, I don't need Sysex yet but I'm curious.
  *
@@ -1132,8 +1200,9 @@ class ListenerMessageCallback : public juce::CallbackMessage
 {
   public:
     
-    ListenerMessageCallback (MidiManager* o, const juce::MidiMessage& m, const juce::String& s)
-        : owner (o), message (m), source (s)
+    ListenerMessageCallback (MidiManager* o, const juce::MidiMessage& m, const juce::String& s,
+                             bool mo)
+        : owner (o), message (m), source (s), monitorOnly (mo)
     {}
 
     // this appears to be what Juce will call when it handles this
@@ -1142,7 +1211,10 @@ class ListenerMessageCallback : public juce::CallbackMessage
     {
         if (owner != nullptr) {
             // and we can call any method on the owner
-            owner->notifyListeners (message, source);
+            if (monitorOnly)
+              owner->notifyMonitors (message, source);
+            else
+              owner->notifyListeners (message, source);
         }
     }
 
@@ -1151,6 +1223,8 @@ class ListenerMessageCallback : public juce::CallbackMessage
     // these are copied by value so safe
     juce::MidiMessage message;
     juce::String source;
+    // true if the kernel already processed it
+    bool monitorOnly = false;
 };
 
 /**
@@ -1159,10 +1233,11 @@ class ListenerMessageCallback : public juce::CallbackMessage
  * It is allocated with new and will be magically freed when it gets processed
  * on the message thread.
  */
-void MidiManager::postListenerMessage(const juce::MidiMessage& message, juce::String& source)
+void MidiManager::postListenerMessage(const juce::MidiMessage& message, juce::String& source,
+                                      bool monitorOnly)
 {
-    if (listeners.size() > 0 || monitors.size() > 0) {
-        (new ListenerMessageCallback (this, message, source))->post();
+    if (monitorOnly || listeners.size() > 0 || monitors.size() > 0) {
+        (new ListenerMessageCallback (this, message, source, monitorOnly))->post();
     }
 }
 
@@ -1215,6 +1290,15 @@ void MidiManager::notifyListeners(const juce::MidiMessage& message, juce::String
     }
 }
 
+/**
+ * Side tap for messages the kernel received directly.
+ */
+void MidiManager::notifyMonitors(const juce::MidiMessage& message, juce::String& source)
+{
+    for (auto monitor : monitors)
+      monitor->midiMonitor(message, source);
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // MIDI Recording
@@ -24,6 +24,11 @@
  *
  * Monitoring listeners can receive events both from directly opened devices,
  * and indirectly from the kernel when it receives events through the plugin host.
+ *
+ * Short messages from input devices normally go straight from the device
+ * thread to the kernel through MidiInputQueue where they are bound to actions
+ * and given to the tracks.  Processing listeners only see them when the
+ * queue can't be used.  Monitors still see them on the message thread.
  * 
  */
 
@@ -34,6 +39,8 @@
 #include "model/DeviceConfig.h"
 #include "mobius/MobiusInterface.h"
 #include "midi/MidiEvent.h"
+#include "midi/MidiInputQueue.h"
+#include "midi/MidiOutputQueue.h"
 
 class MidiManager : public juce::MidiInputCallback, public MobiusMidiListener
 {
@@ -170,6 +177,21 @@ class MidiManager : public juce::MidiInputCallback, public MobiusMidiListener
 
     // needs to be public so it can be called from a CallbackMessage
     void notifyListeners(const juce::MidiMessage& message, juce::String& source);
+    void notifyMonitors(const juce::MidiMessage& message, juce::String& source);
+
+    /**
+     * The queue the kernel reads device input from.
+     */
+    MidiInputQueue* getInputQueue() {
+        return &inputQueue;
+    }
+
+    /**
+     * The queue the kernel sends timed device output through.
+     */
+    MidiOutputQueue* getOutputQueue() {
+        return &outputQueue;
+    }
 
     // called in the audio thread as events are received by the plugin
     bool mobiusMidiReceived(juce::MidiMessage& msg) override;
@@ -184,6 +206,13 @@ class MidiManager : public juce::MidiInputCallback, public MobiusMidiListener
     class juce::Array<RealtimeListener*> realtimeListeners;
     class juce::Array<Monitor*> monitors;
 
+    // device threads look at these rather than the monitor list
+    std::atomic<int> monitorCount {0};
+    std::atomic<bool> exclusiveMonitor {false};
+
+    MidiInputQueue inputQueue;
+    MidiOutputQueue outputQueue;
+
     // error messages from the last time openDevices was called
     juce::StringArray errors;
 
@@ -239,7 +268,11 @@ class MidiManager : public juce::MidiInputCallback, public MobiusMidiListener
     void closeAllOutputs();
     bool removeOutputSyncDevice(juce::String name);
 
-    void postListenerMessage (const juce::MidiMessage& message, juce::String& source);
+    void postListenerMessage (const juce::MidiMessage& message, juce::String& source,
+                              bool monitorOnly);
+    bool queueInput(juce::MidiInput* source, const juce::MidiMessage& message);
+    void attachInputs();
+    void refreshMonitors();
     void record(const juce::MidiMessage& message, juce::String& source);
 
     // experiments
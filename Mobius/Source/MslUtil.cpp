@@ -111,8 +111,11 @@ void MslUtil::mutateReturn(Provider* p, Symbol* s, int value, MslValue* retval)
         UIParameterType ptype = props->type;
         if (ptype == TypeEnum) {
             // don't use labels since I want scripters to get used to the names
-            const char* ename = props->getEnumName(value);
-            retval->setEnum(ename, value);
+            int eid = props->getEnumId(value);
+            if (eid > 0)
+              retval->setEnumId(eid, value);
+            else
+              retval->setEnum(props->getEnumName(value), value);
         }
         else if (ptype == TypeBool) {
             retval->setBool(value == 1);
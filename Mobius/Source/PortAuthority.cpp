@@ -6,6 +6,7 @@
 
 #include <JuceHeader.h>
 
+#include "util/Trace.h"
 #include "model/DeviceConfig.h"
 #include "Supervisor.h"
 #include "PortAuthority.h"
@@ -93,8 +94,29 @@ void PortAuthority::configure(Supervisor* super)
     
     for (int i = 0 ; i < maxPorts ; i++) {
         PortBuffer* pb = new PortBuffer();
+        // prepareToPlay may have been called before we got here
+        pb->allocate(capacity);
         ports.add(pb);
     }
+
+    allocate(PortDefaultFramesPerBuffer);
+}
+
+/**
+ * Grow the port buffers if they are smaller than the block size.
+ * They never shrink, a device that once used a large block size
+ * is likely to do it again.
+ */
+void PortAuthority::allocate(int frames)
+{
+    if (frames > capacity) {
+        for (auto port : ports)
+          port->allocate(frames);
+        voidPort.allocate(frames);
+        // the void input is cleared once and must stay clean
+        voidPort.inputPrepared = false;
+        capacity = frames;
+    }
 }
 
 /**
@@ -147,9 +169,21 @@ void PortAuthority::prepare(juce::AudioBuffer<float>& buffer)
 
 void PortAuthority::resetPorts()
 {
+    if (blockSize > capacity) {
+        // the host didn't tell prepareToPlay the truth, this allocates
+        // in the audio thread but it's better than the alternatives
+        // blocks beyond what the core can handle are split by MobiusKernel
+        if (reallocations == 0)
+          Trace(1, "PortAuthority: Growing port buffers in the audio thread to %d\n", blockSize);
+        reallocations++;
+        allocate(blockSize);
+    }
+    blocks++;
+
     for (auto port : ports) {
         port->inputPrepared = false;
         port->outputPrepared = false;
+        port->planarRead = false;
     }
 
     // void output needs to be cleared whenever it is used
@@ -179,7 +213,7 @@ float* PortAuthority::getInput(int port)
         // in theory things like SamplePlayer could be injecting things into
         // the input buffers but that doesn't happen right now
         if (!voidPort.inputPrepared) {
-            clearInterleavedBuffer(voidPort.input);
+            clearInterleavedBuffer(voidPort.input, capacity);
             voidPort.inputPrepared = true;
         }
         result = voidPort.input;
@@ -189,6 +223,7 @@ float* PortAuthority::getInput(int port)
         if (!pb->inputPrepared) {
             interleaveInput(port, pb->input);
             pb->inputPrepared = true;
+            interleavedInputs++;
         }
         result = pb->input;
     }
@@ -196,6 +231,34 @@ float* PortAuthority::getInput(int port)
     return result;
 }
 
+/**
+ * Return pointers to the host channels for one input port.
+ *
+ * This is only allowed until something asks for the interleaved input
+ * for this port.  After that the interleaved buffer is the authority since
+ * SampleManager and the test scripts may inject content into it, and
+ * MobiusKernel can clear it to suppress external input.
+ *
+ * Since AudioBuffer may be used in place, the host channels will be
+ * overwritten by commit, but that doesn't happen until every track
+ * has finished with the input.
+ */
+bool PortAuthority::getPlanarInput(int port, const float** left, const float** right)
+{
+    bool available = false;
+    if (port >= 0 && port < ports.size()) {
+        PortBuffer* pb = ports[port];
+        if (!pb->inputPrepared) {
+            available = getHostChannels(port, left, right);
+            if (available) {
+                pb->planarRead = true;
+                planarInputs++;
+            }
+        }
+    }
+    return available;
+}
+
 /**
  * Get the interleaved output buffer for one port.
  * If the port number is out of rante, return a scratch buffer so the
@@ -218,6 +281,7 @@ float* PortAuthority::getOutput(int port)
         if (!pb->outputPrepared) {
             // needs to start clean
             clearInterleavedBuffer(pb->output, blockSize);
+            samplesCleared += blockSize * PortMaxChannels;
             pb->outputPrepared = true;
         }
         result = pb->output;
@@ -228,15 +292,10 @@ float* PortAuthority::getOutput(int port)
 
 /**
  * Zero one of our interleaved buffers.
- * Is it still fashionable to use memset?
- *
- * If frames is zero we'll clear the entire buffer.
- * Otherwise we'll do a rather anal optimization and only
- * clear the frames necessary for the current block size.
+ * Only the frames necessary for the current block size are cleared.
  */
 void PortAuthority::clearInterleavedBuffer(float* buffer, int frames)
 {
-    if (frames == 0) frames = PortMaxFramesPerBuffer;
     int totalSamples = frames * PortMaxChannels;
       
     // is it still fashionable to use memset?
@@ -268,6 +327,31 @@ void PortAuthority::clearInterleavedBuffer(float* buffer, int frames)
  */
 void PortAuthority::interleaveInput(int port, float* result)
 {
+    const float* leftChannel = nullptr;
+    const float* rightChannel = nullptr;
+
+    if (!getHostChannels(port, &leftChannel, &rightChannel)) {
+        clearInterleavedBuffer(result, blockSize);
+    }
+    else {
+        int sampleIndex = 0;
+        for (int i = 0 ; i < blockSize ; i++) {
+            result[sampleIndex] = leftChannel[i];
+            result[sampleIndex+1] = rightChannel[i];
+            sampleIndex += 2;
+        }
+        samplesInterleaved += blockSize * PortMaxChannels;
+    }
+}
+
+/**
+ * Locate the pair of AudioBuffer channels for a port, used both
+ * to build the interleaved buffer and for planar access.
+ * Returns false if the host can't provide that port.
+ */
+bool PortAuthority::getHostChannels(int port, const float** left, const float** right)
+{
+    bool found = false;
     int channelOffset = port * 2;
     int maxChannels = juceBuffer->getNumChannels();
 
@@ -281,7 +365,6 @@ void PortAuthority::interleaveInput(int port, float* result)
         if (inputPortHostRangeErrors == 0)
           Trace(1, "PortAuthority: Input port out of range %d\n", port);
         inputPortHostRangeErrors++;
-        clearInterleavedBuffer(result, blockSize);
     }
     else {
         auto* leftChannel = juceBuffer->getReadPointer(channelOffset, startSample);
@@ -290,7 +373,6 @@ void PortAuthority::interleaveInput(int port, float* result)
             // might happen with those goofy active channel flags and the AudioBuffer
             // channels were not compressed
             Trace(1, "PortAuthority: Input buffer not available for port %d\n", port);
-            clearInterleavedBuffer(result, blockSize);
         }
         else {
             // should have 2 but if there is only one go mono
@@ -303,15 +385,12 @@ void PortAuthority::interleaveInput(int port, float* result)
                     rightChannel = leftChannel;
                 }
             }
-            
-            int sampleIndex = 0;
-            for (int i = 0 ; i < blockSize ; i++) {
-                result[sampleIndex] = leftChannel[i];
-                result[sampleIndex+1] = rightChannel[i];
-                sampleIndex += 2;
-            }
+            *left = leftChannel;
+            *right = rightChannel;
+            found = true;
         }
     }
+    return found;
 }
 
 /**
@@ -331,6 +410,13 @@ void PortAuthority::interleaveInput(int port, float* result)
  */
 void PortAuthority::commit()
 {
+    // every port that was only read through the host channels
+    // saved one interleaving pass
+    for (auto pb : ports) {
+        if (pb->planarRead && !pb->inputPrepared)
+          samplesAvoided += blockSize * PortMaxChannels;
+    }
+
     int maxChannels = juceBuffer->getNumChannels();
 
     int portNumber = 0;
@@ -356,11 +442,7 @@ void PortAuthority::commit()
             if (srcSamples == nullptr) {
                 // we either don't have a port for this output channel or
                 // the engine decided not to put anything into it
-                // hmm, I'd use memset here but the "auto" shit makes it unclear
-                // how large this is, can you do sizeof(*destSamples) ?
-                for (int i = 0 ; i < blockSize ; i++) {
-                    destSamples[i] = 0.0f;
-                }
+                juce::FloatVectorOperations::clear(destSamples, blockSize);
             }
             else {
                 int srcOffset = 0;
@@ -368,6 +450,7 @@ void PortAuthority::commit()
                     destSamples[i] = srcSamples[srcOffset];
                     srcOffset += PortMaxChannels;
                 }
+                samplesDeinterleaved += blockSize;
             }
 
             // advance to the next source channel or port
@@ -391,6 +474,40 @@ void PortAuthority::commit()
     }
 }
 
+/**
+ * Called at shutdown by JuceAudioStream to show how much copying the
+ * planar input path saved.
+ */
+void PortAuthority::traceStatistics()
+{
+    Tracej("PortAuthority: Ending port statistics:");
+    Tracej("  blocks " + juce::String(blocks));
+    Tracej("  buffer frames " + juce::String(capacity));
+    if (reallocations > 0)
+      Tracej("  audio thread reallocations " + juce::String(reallocations));
+    Tracej("  interleaved inputs " + juce::String(interleavedInputs));
+    Tracej("  planar inputs " + juce::String(planarInputs));
+    Tracej("  samples interleaved " + juce::String(samplesInterleaved));
+    Tracej("  samples deinterleaved " + juce::String(samplesDeinterleaved));
+    Tracej("  samples cleared " + juce::String(samplesCleared));
+    Tracej("  samples not copied " + juce::String(samplesAvoided));
+    if (blocks > 0) {
+        Tracej("  copied per block " +
+               juce::String((samplesInterleaved + samplesDeinterleaved) / blocks));
+        Tracej("  saved per block " + juce::String(samplesAvoided / blocks));
+    }
+}
+
+juce::int64 PortAuthority::getSamplesCopied()
+{
+    return samplesInterleaved + samplesDeinterleaved;
+}
+
+juce::int64 PortAuthority::getSamplesAvoided()
+{
+    return samplesAvoided;
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // PortBuffer
@@ -405,6 +522,16 @@ PortBuffer::~PortBuffer()
 {
 }
 
+void PortBuffer::allocate(int frames)
+{
+    if (frames > capacity) {
+        int samples = frames * PortMaxChannels;
+        input.calloc(samples);
+        output.calloc(samples);
+        capacity = frames;
+    }
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
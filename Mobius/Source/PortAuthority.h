@@ -9,22 +9,16 @@
 #include <JuceHeader.h>
 
 /**
- * The maximum number of frames we'll allow in the interleaved buffers.  
- * These have been of fixed size so they could be stack allocated but
- * they're relatively large and some users have enormous numbers of ports
- * so stack allocation may not be a good idea.  It needs to be as large
- * as the largest normal ASIO buffer size.
+ * The number of frames the interleaved buffers are initially allocated for.
+ * These used to be fixed arrays of this size, they are now heap buffers
+ * that grow to the block size given to prepareToPlay, or if a host sends
+ * an unexpectedly large block, to the size of that block.
  *
  * Old comments indicate that auval used up to 4096 buffers, so old code
- * assumed that.  Non ASIO devices can also have extremely large buffer sizes
- * which would not normally be used, but we have to behave if they are.
- *
- * Rather than dynamically resizing these as host block size changes, consider
- * adding a layer that splits large host buffers into a sequence of smaller ones
- * and pretending the host is using a smaller buffer.
- * comes in bigger than this just bail.
+ * assumed that and it remains a good default that avoids growing
+ * in the audio thread for almost all devices.
  */
-const int PortMaxFramesPerBuffer = 4096;
+const int PortDefaultFramesPerBuffer = 4096;
 
 /**
  * Number of samples per frame.
@@ -32,20 +26,13 @@ const int PortMaxFramesPerBuffer = 4096;
  */
 const int PortMaxChannels = 2;
 
-/**
- * This then is the size of one interleaved input or output buffer we
- * need to allocate.  Under all circumstances the Juce buffer processing
- * will use the same size for both the input and output buffers.
- *
- * This will result in two buffers of 8k being allocated on the stack
- * if you do stack allocation.  Shouldn't be a problem these days but might
- * want to move these to the heap.
- */
-const int PortMaxSamplesPerBuffer = PortMaxFramesPerBuffer * PortMaxChannels;
-
 /**
  * A PortBuffer maintains a pair of interleaved input and output buffers
  * for each configured Mobius port.  PortAuthority has an array of these.
+ *
+ * The interleaved input is only built if something asks for it.  Tracks
+ * that can read the host channels directly through getPlanarInput
+ * leave the input unprepared.
  */
 class PortBuffer
 {
@@ -54,15 +41,26 @@ class PortBuffer
     PortBuffer();
     ~PortBuffer();
 
+    /**
+     * Make sure both buffers can hold the given number of frames.
+     */
+    void allocate(int frames);
+
     // The input buffer to be initialized with content from the host
     // at the beginning of each audio interrupt
-    float input[PortMaxSamplesPerBuffer];
+    juce::HeapBlock<float> input;
     bool inputPrepared = false;
 
     // The output buffer filled by the engine, then de-interlevaed and
     // sent back to the host
-    float output[PortMaxSamplesPerBuffer];
+    juce::HeapBlock<float> output;
     bool outputPrepared = false;
+
+    // set when a track read the host channels directly during this block
+    bool planarRead = false;
+
+    // number of frames the buffers can hold
+    int capacity = 0;
 };
 
 /**
@@ -78,6 +76,12 @@ class PortAuthority
 
     void configure(class Supervisor* super);
 
+    /**
+     * Size the port buffers for the block size the device expects.
+     * Called outside the audio thread from prepareToPlay.
+     */
+    void allocate(int blockSize);
+
     /**
      * Prepare the input and output buffers for each port at the
      * beginning of an audio interrupt.  This is the model used
@@ -94,6 +98,26 @@ class PortAuthority
     // port buffer accessors called by the engine during the audio interrupt
     float* getInput(int port);
     float* getOutput(int port);
+
+    /**
+     * Return the host channels for an input port without interleaving
+     * them.  Returns false if the port has already been interleaved
+     * during this block.
+     */
+    bool getPlanarInput(int port, const float** left, const float** right);
+
+    /**
+     * Trace how many samples were copied to and from the interleaved
+     * buffers and how many copies were avoided by the planar path.
+     */
+    void traceStatistics();
+
+    /**
+     * Samples copied to and from the interleaved buffers so far,
+     * and samples the planar path didn't have to copy.
+     */
+    juce::int64 getSamplesCopied();
+    juce::int64 getSamplesAvoided();
     
     /**
      * At the end of an audio interrupt, copy the interleaved output buffers
@@ -119,15 +143,29 @@ class PortAuthority
     int blockSize = 0;
     juce::AudioBuffer<float>* juceBuffer;
 
+    // frames the port buffers are currently allocated for
+    int capacity = 0;
+
     // various disturbances we notice along the way
     int inputPortRangeErrors = 0;
     int outputPortRangeErrors = 0;
     int inputPortHostRangeErrors = 0;
     int outputPortHostRangeErrors = 0;
-    
+    int reallocations = 0;
+
+    // copy statistics, in samples
+    juce::int64 blocks = 0;
+    juce::int64 interleavedInputs = 0;
+    juce::int64 planarInputs = 0;
+    juce::int64 samplesInterleaved = 0;
+    juce::int64 samplesDeinterleaved = 0;
+    juce::int64 samplesCleared = 0;
+    juce::int64 samplesAvoided = 0;
+
     void resetPorts();
-    void clearInterleavedBuffer(float* buffer, int frames = 0);
+    void clearInterleavedBuffer(float* buffer, int frames);
     void interleaveInput(int port, float* result);
+    bool getHostChannels(int port, const float** left, const float** right);
 
 };
 
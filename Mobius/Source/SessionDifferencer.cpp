@@ -20,6 +20,10 @@
  * track ids like TrackManager does when it reorganizes the track array.  It could, but
  * rearranging tracks is a pretty massive change, and it seems enough just to try to catch
  * the common case where the tracks all still line up.    Tackle that another day.
+ *
+ * This is used by MobiusShell to tell the kernel which tracks need to be
+ * refreshed after a session edit, so it must not miss anything.  A key that
+ * is only in the modified session, or only in a track, is still a difference.
  */
 
 #include <JuceHeader.h>
@@ -32,13 +36,11 @@
 #include "model/SessionDiff.h"
 #include "model/Symbol.h"
 
-#include "Provider.h"
-
 #include "SessionDifferencer.h"
 
-SessionDifferencer::SessionDifferencer(Provider* p)
+SessionDifferencer::SessionDifferencer(SymbolTable* s)
 {
-    provider = p;
+    symbols = s;
 }
 
 SessionDiffs* SessionDifferencer::diff(Session* s1, Session* s2)
@@ -65,13 +67,17 @@ SessionDiffs* SessionDifferencer::diff(Session* s1, Session* s2)
 
 void SessionDifferencer::diff(ValueSet* v1, ValueSet* v2, int track)
 {
-    SymbolTable* symbols = provider->getSymbols();
     ValueSet* originalDefaults = original->ensureGlobals();
     ValueSet* newDefaults = modified->ensureGlobals();
     
-    // use the original default parameter set as the key guide
+    // the original default parameter set has most of the keys, but
+    // parameters can be added to the defaults or exist only in the tracks
     juce::StringArray keys;
-    original->ensureGlobals()->getKeys(keys);
+    originalDefaults->getKeys(keys);
+    newDefaults->getKeys(keys);
+    v1->getKeys(keys);
+    v2->getKeys(keys);
+    keys.removeDuplicates(false);
 
     for (auto key : keys) {
         Symbol* s = symbols->find(key);
@@ -93,13 +99,14 @@ void SessionDifferencer::diff(ValueSet* v1, ValueSet* v2, int track)
             if (!isEqual(srcv, neuv)) {
                 SessionDiff diff;
                 diff.track = track;
+                diff.symbol = s;
                 result->diffs.add(diff);
             }
         }
     }
 
-    // todo: pick up the noDefaults
-    // that will only exist in the track value sets
+    // the noDefaults that only exist in the track value sets are picked up
+    // by including the track keys above
     // these are trackName, trackType, trackGroup, focus, trackNoReset, trackNoModify
     // none of these has any impact on behavioral parameters since they are all also
     // noBinding and could not be changed anyway
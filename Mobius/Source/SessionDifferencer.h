@@ -8,14 +8,14 @@ class SessionDifferencer
 {
   public:
 
-    SessionDifferencer(Provider* p);
+    SessionDifferencer(class SymbolTable* s);
     
     // differences are allocated dynamically and must be deleted
     class SessionDiffs* diff(class Session* original, class Session* modified);
 
   private:
 
-    Provider* provider = nullptr;
+    class SymbolTable* symbols = nullptr;
     Session* original = nullptr;
     Session* modified = nullptr;
     std::unique_ptr<SessionDiffs> result = nullptr;
@@ -0,0 +1,186 @@
+/**
+ * Implementation of the startup task graph.
+ */
+
+#include <JuceHeader.h>
+
+#include "util/Trace.h"
+
+#include "StartupGraph.h"
+
+/**
+ * Startup is mostly file reading, a few threads are plenty.
+ */
+const int StartupMaxThreads = 4;
+
+StartupGraph::StartupGraph() :
+    pool(juce::jlimit(1, StartupMaxThreads, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+StartupGraph::~StartupGraph()
+{
+    pool.removeAllJobs(false, 10000);
+}
+
+void StartupGraph::addMain(juce::String name, juce::StringArray after, Work work)
+{
+    add(name, after, work, true);
+}
+
+void StartupGraph::addBackground(juce::String name, juce::StringArray after, Work work)
+{
+    add(name, after, work, false);
+}
+
+void StartupGraph::add(juce::String name, juce::StringArray after, Work work, bool main)
+{
+    // a typo here would leave a task waiting forever
+    for (auto dep : after) {
+        if (find(dep) == nullptr)
+          Trace(1, "StartupGraph: Task %s depends on unknown task %s",
+                name.toUTF8(), dep.toUTF8());
+    }
+
+    Task* t = new Task();
+    t->name = name;
+    t->after = after;
+    t->work = work;
+    t->main = main;
+    tasks.add(t);
+}
+
+StartupGraph::Task* StartupGraph::find(juce::String name)
+{
+    Task* found = nullptr;
+    for (auto t : tasks) {
+        if (t->name == name) {
+            found = t;
+            break;
+        }
+    }
+    return found;
+}
+
+/**
+ * Dependencies can only be on tasks added earlier, so unknown
+ * names were traced in add() and are ignored here.
+ */
+bool StartupGraph::isReady(Task* t)
+{
+    bool ready = true;
+    for (auto dep : t->after) {
+        Task* other = find(dep);
+        if (other != nullptr && !other->finished.load()) {
+            ready = false;
+            break;
+        }
+    }
+    return ready;
+}
+
+void StartupGraph::runTask(Task* t)
+{
+    t->start = juce::Time::getMillisecondCounterHiRes();
+    if (t->work)
+      t->work();
+    t->end = juce::Time::getMillisecondCounterHiRes();
+    t->finished.store(true);
+}
+
+juce::ThreadPoolJob::JobStatus StartupGraph::Job::runJob()
+{
+    graph->runTask(task);
+    graph->taskFinished.signal();
+    return jobHasFinished;
+}
+
+void StartupGraph::run()
+{
+    startTime = juce::Time::getMillisecondCounterHiRes();
+
+    int remaining = tasks.size();
+    while (remaining > 0) {
+
+        // start everything in the background that can go
+        for (auto t : tasks) {
+            if (!t->main && !t->started && isReady(t)) {
+                t->started = true;
+                pool.addJob(new Job(this, t), true);
+            }
+        }
+
+        // then the first main task that can go, going back to look
+        // for background tasks after each one
+        Task* next = nullptr;
+        for (auto t : tasks) {
+            if (t->main && !t->started && isReady(t)) {
+                next = t;
+                break;
+            }
+        }
+
+        if (next != nullptr) {
+            next->started = true;
+            runTask(next);
+        }
+        else {
+            // waiting on the pool
+            bool pending = false;
+            for (auto t : tasks) {
+                if (t->started && !t->finished) {
+                    pending = true;
+                    break;
+                }
+            }
+            if (pending) {
+                taskFinished.wait(100);
+            }
+            else {
+                // nothing running and nothing can start, must be a cycle
+                bool stuck = false;
+                for (auto t : tasks) {
+                    if (!t->started) {
+                        Trace(1, "StartupGraph: Task %s could not start", t->name.toUTF8());
+                        t->started = true;
+                        runTask(t);
+                        stuck = true;
+                        break;
+                    }
+                }
+                if (!stuck)
+                  Trace(1, "StartupGraph: Lost track of the remaining tasks");
+            }
+        }
+
+        remaining = 0;
+        for (auto t : tasks) {
+            if (!t->finished)
+              remaining++;
+        }
+    }
+
+    endTime = juce::Time::getMillisecondCounterHiRes();
+}
+
+void StartupGraph::report(juce::StringArray& lines)
+{
+    juce::Array<Task*> ordered;
+    for (auto t : tasks) {
+        int index = 0;
+        while (index < ordered.size() && ordered[index]->start <= t->start)
+          index++;
+        ordered.insert(index, t);
+    }
+
+    for (auto t : ordered) {
+        juce::String line = juce::String((int)(t->start - startTime)).paddedLeft(' ', 6) + " " +
+            juce::String((int)(t->end - t->start)).paddedLeft(' ', 6) + " " +
+            (t->main ? "main " : "pool ") + t->name;
+        lines.add(line);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
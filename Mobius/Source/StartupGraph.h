@@ -0,0 +1,91 @@
+/**
+ * A small dependency graph used by Supervisor::start to overlap the
+ * parts of startup that don't depend on each other.
+ *
+ * Each task has a name, the names of the tasks that must finish before it
+ * can start, and says whether it must run on the thread that called run(),
+ * which for Supervisor is the message thread.  Anything that builds UI
+ * components, touches the symbol table, or talks to the engine must be a
+ * main task.  Background tasks go to a thread pool and should only do
+ * things like reading and parsing files into objects nobody else can see
+ * yet, with a main task after them to put the results where they belong.
+ *
+ * Main tasks run in the order they were added as soon as their
+ * dependencies are satisfied, so a graph with only main tasks behaves
+ * exactly like the code it replaced.
+ *
+ * The start and end time of every task is recorded for the timeline
+ * report.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class StartupGraph
+{
+  public:
+
+    typedef std::function<void()> Work;
+
+    StartupGraph();
+    ~StartupGraph();
+
+    void addMain(juce::String name, juce::StringArray after, Work work);
+    void addBackground(juce::String name, juce::StringArray after, Work work);
+
+    /**
+     * Run every task and return when they have all finished.
+     */
+    void run();
+
+    /**
+     * Lines for the timeline, in order of start time, with the offset
+     * from the start of run(), the elapsed time, and the thread.
+     */
+    void report(juce::StringArray& lines);
+
+    double getElapsed() {
+        return endTime - startTime;
+    }
+
+  private:
+
+    class Task
+    {
+      public:
+        juce::String name;
+        juce::StringArray after;
+        Work work;
+        bool main = false;
+        std::atomic<bool> started {false};
+        std::atomic<bool> finished {false};
+        double start = 0.0;
+        double end = 0.0;
+    };
+
+    class Job : public juce::ThreadPoolJob
+    {
+      public:
+        Job(StartupGraph* g, Task* t) : juce::ThreadPoolJob(t->name), graph(g), task(t) {}
+        JobStatus runJob() override;
+      private:
+        StartupGraph* graph;
+        Task* task;
+    };
+
+    juce::OwnedArray<Task> tasks;
+    juce::ThreadPool pool;
+    juce::WaitableEvent taskFinished;
+    double startTime = 0.0;
+    double endTime = 0.0;
+
+    void add(juce::String name, juce::StringArray after, Work work, bool main);
+    Task* find(juce::String name);
+    bool isReady(Task* t);
+    void runTask(Task* t);
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
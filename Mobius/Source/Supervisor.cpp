@@ -37,6 +37,7 @@
 #include "model/ScriptProperties.h"
 
 #include "ui/MainWindow.h"
+#include "ui/display/PaintMeter.h"
 
 #include "mobius/MobiusInterface.h"
 #include "mobius/SampleReader.h"
@@ -56,6 +57,7 @@
 #include "task/TaskMaster.h"
 #include "ProjectFiler.h"
 #include "MidiClerk.h"
+#include "Freewheeler.h"
 #include "ModelTransformer.h"
 #include "MslUtil.h"
 
@@ -68,6 +70,7 @@
 #include "script/ScriptExternals.h"
 #include "script/MslResult.h"
 
+#include "StartupGraph.h"
 #include "Supervisor.h"
 
 /**
@@ -265,212 +268,287 @@ bool Supervisor::start()
           Trace(1, "  %s", rootErrors[i].toUTF8());
     }
 
-    meter("Initialize symbols");
-
-    // initialize symbol table
-    // this MUST be done before Upgrader
-    symbolizer.initialize();
-
-    // install variables
-    variableManager.install();
-
-    // load the initial session and prepare internal objects
-    producer.reset(new Producer(this));
-    (void)initializeSession();
-    
-    // now that Sessions and MobiusConfig are sanitized, can
-    // install activation symbols
-    symbolizer.installActivationSymbols();
-
-    meter("MainWindow");
-
-    // this hasn't been static initialized, don't remember why
-    // it may have some dependencies
-    MainWindow* win = new MainWindow(this);
-    // save it in a smart pointer for deletion
-    mainWindow.reset(win);
-
-    // tell the test driver where it can put the control panel
-    testDriver.initialize(win);
-    
-    // if we're standalone add to the MainComponent now
-    // if plugin have to do this later when the editor is created
-
-    if (mainComponent != nullptr) {
-        mainComponent->addKeyListener(&keyTracker);
-        // didn't do this originally does it help with focus loss after changing buttons?
-        // yes, unclear why this works because focus is hella complicated, but when changing
-        // action ButtonSets, MainComponent was losing focus, possibly this is because
-        // an ActionButton is a juce::TextButton and it either wants focus, or doing anything
-        // to the child component list after construction grabs focus?  whatever, setting
-        // this seems to allow MainComponent to retain focus and keep pumping events
-        // through KeyTracker
-        mainComponent->setWantsKeyboardFocus(true);
-        mainComponent->addAndMakeVisible(win);
-
-        // get the size previoiusly used
-        UIConfig* uconfig = getUIConfig();
-        int width = mainComponent->getWidth();
-        int height = mainComponent->getHeight();
-        if (uconfig->windowWidth > 0) width = uconfig->windowWidth;
-        if (uconfig->windowHeight > 0) height = uconfig->windowHeight;
-        mainComponent->setSize(width, height);
-
-        // grab focus next ping
-        wantsFocus = true;
-    }
-    else {
-        // plugins don't have the wrapper yet, so size the MainWindow
-        // can't we just do this consistently in MainWindow for both?
-        UIConfig* uconfig = getUIConfig();
-        int width = mainWindow->getWidth();
-        int height = mainWindow->getHeight();
-        if (uconfig->windowWidth > 0) width = uconfig->windowWidth;
-        if (uconfig->windowHeight > 0) height = uconfig->windowHeight;
-        mainWindow->setSize(width, height);
-    }
-    
-    meter("Mobius");
-
-    // let this initialize before we start the audio device
-    // and blocks start comming in
-    // also before Mobius so it registers the block listener with
-    // the right one
-    // !! revisit this, for plugins we don't control when blocks start
-    // so it needs to be in a quiet state immediately
-    audioStream.configure();
-
-    // load the script registry to do ScriptConfig conversion first
-    scriptClerk.initialize();
-
-    scriptUtil.initialize(this);
-    // supreme hate for how this is working
-    SystemConfig* scon = getSystemConfig();
-    scriptUtil.configure(session.get(), scon->getGroups());
-
-    // open MIDI devices before Mobius so MidiTracks can resolve device
-    // names in the session to device ids
-    midiManager.configure();
-    midiManager.openDevices();
-    // go ahead and add MM errors to the startup alert so it doesn't have to
-    addStartupErrors(midiManager.getErrors());
-    
-    // now bring up the bad boy
-    // here is where we may want to defer this for host plugin scanning
-    // this used to be a Singleton that was released with
-    // MobiusInterface::shutdown, but now it's just an ordinary pointer
-    // that has to be deleted
-    // should be a unique_ptr, but it's also better if this
-    // is deleted earler to control ordering
-    mobius = MobiusInterface::getMobius(this);
-    
-    // this is where the bulk of the engine initialization happens
-    // it will call MobiusContainer to register callbacks for
-    // audio and midi streams
-    sendInitialConfiguration();
-
-    // force a synchronous refresh of SystemState to reflect up the
-    // state after initialization, don't need to use the normal async state
-    // refresh protocol yet
-    mobius->initializeState(&systemState);
-    mobiusViewer.refresh(&systemState, &mobiusView);
-    // nothing has been displayed set so turn on all the flags
-    mobiusViewer.forceRefresh(&mobiusView);
-
-    // ScriptConfig no longer goes in through MobiusConfig
-    // extract one from the new ScriptRegistry and send it down
-    ScriptConfig* oldScripts = scriptClerk.getMobiusScriptConfig();
-    mobius->installScripts(oldScripts);
-    scriptClerk.saveErrors(oldScripts);
-    delete oldScripts;
-    
-    // listen for timing and config changes we didn't initiate
-    // !! continuing to dislike the distinction between MobiusContainer and
-    // MobiusListener, we're the same thing but in the engine everything has
-    // access to Container and few get the Listener
-    mobius->setListener(this);
-
-    // let internal UI components interested in configuration adjust themselves
-    // move this after scrript installation so the new display elements can see
-    // MSL symbols
-    //propagateConfiguration();
-
-    meter("Maintenance Thread");
-
-    // let the maintenance thread go
-    uiThread.start();
-
-    meter("Devices");
+    // Startup is a graph of tasks so file reading can overlap with
+    // the things that have to happen on the message thread.  Task names
+    // are what show up in the timeline report.
+    StartupGraph graph;
+
+    // the configuration files that are needed during startup are
+    // read in the background and adopted by a main task
+    // help.xml and static.xml are left until something asks for them
+    std::unique_ptr<SystemConfig> newSystemConfig;
+    std::unique_ptr<UIConfig> newUIConfig;
+    std::unique_ptr<DeviceConfig> newDeviceConfig;
+
+    graph.addBackground("Read system.xml", {}, [this, &newSystemConfig]() {
+        newSystemConfig.reset(fileManager.readSystemConfig());
+    });
+
+    graph.addBackground("Read ui.xml", {}, [this, &newUIConfig]() {
+        newUIConfig.reset(fileManager.readUIConfig());
+    });
+
+    graph.addBackground("Read devices.xml", {}, [this, &newDeviceConfig]() {
+        newDeviceConfig.reset(fileManager.readDeviceConfig());
+    });
+
+    graph.addMain("Initialize symbols", {}, [this]() {
+        // initialize symbol table
+        // this MUST be done before Upgrader
+        symbolizer.initialize();
+
+        // install variables
+        variableManager.install();
+    });
+
+    graph.addMain("Adopt configuration",
+                  {"Read system.xml", "Read ui.xml", "Read devices.xml"},
+                  [this, &newSystemConfig, &newUIConfig, &newDeviceConfig]() {
+        // don't replace anything that was already loaded, the getters
+        // bootstrap anything that didn't read
+        if (!systemConfig) systemConfig = std::move(newSystemConfig);
+        if (!uiConfig) uiConfig = std::move(newUIConfig);
+        if (!deviceConfig) deviceConfig = std::move(newDeviceConfig);
+    });
+
+    graph.addMain("Session", {"Initialize symbols", "Adopt configuration"}, [this]() {
+        // load the initial session and prepare internal objects
+        producer.reset(new Producer(this));
+        (void)initializeSession();
+
+        // now that Sessions and MobiusConfig are sanitized, can
+        // install activation symbols
+        symbolizer.installActivationSymbols();
+
+        // make sure mobius.xml is loaded here, before the script
+        // registry converts the old ScriptConfig in it
+        (void)getOldMobiusConfig();
+    });
+
+    // the script registry is built in phases so reading scripts.xml
+    // and looking for files can overlap with building the UI, the
+    // registry isn't visible until the last one
+    std::unique_ptr<ScriptRegistry> newRegistry;
+
+    graph.addBackground("Read scripts.xml", {}, [this, &newRegistry]() {
+        newRegistry.reset(scriptClerk.readRegistry());
+    });
+
+    graph.addMain("Convert ScriptConfig", {"Session", "Read scripts.xml"}, [this, &newRegistry]() {
+        // this modifies mobius.xml so it stays on the message thread
+        scriptClerk.convertRegistry(newRegistry.get());
+    });
+
+    graph.addBackground("Scan scripts", {"Convert ScriptConfig"}, [this, &newRegistry]() {
+        scriptClerk.scanRegistry(newRegistry.get());
+    });
+
+    graph.addMain("Script registry", {"Scan scripts"}, [this, &newRegistry]() {
+        scriptClerk.adoptRegistry(newRegistry.release());
+    });
+
+    graph.addMain("MainWindow", {"Session"}, [this]() {
+        // this hasn't been static initialized, don't remember why
+        // it may have some dependencies
+        MainWindow* win = new MainWindow(this);
+        // save it in a smart pointer for deletion
+        mainWindow.reset(win);
+
+        // tell the test driver where it can put the control panel
+        testDriver.initialize(win);
+
+        // if we're standalone add to the MainComponent now
+        // if plugin have to do this later when the editor is created
+
+        if (mainComponent != nullptr) {
+            mainComponent->addKeyListener(&keyTracker);
+            // didn't do this originally does it help with focus loss after changing buttons?
+            // yes, unclear why this works because focus is hella complicated, but when changing
+            // action ButtonSets, MainComponent was losing focus, possibly this is because
+            // an ActionButton is a juce::TextButton and it either wants focus, or doing anything
+            // to the child component list after construction grabs focus?  whatever, setting
+            // this seems to allow MainComponent to retain focus and keep pumping events
+            // through KeyTracker
+            mainComponent->setWantsKeyboardFocus(true);
+            mainComponent->addAndMakeVisible(win);
+
+            // get the size previoiusly used
+            UIConfig* uconfig = getUIConfig();
+            int width = mainComponent->getWidth();
+            int height = mainComponent->getHeight();
+            if (uconfig->windowWidth > 0) width = uconfig->windowWidth;
+            if (uconfig->windowHeight > 0) height = uconfig->windowHeight;
+            mainComponent->setSize(width, height);
+
+            // grab focus next ping
+            wantsFocus = true;
+        }
+        else {
+            // plugins don't have the wrapper yet, so size the MainWindow
+            // can't we just do this consistently in MainWindow for both?
+            UIConfig* uconfig = getUIConfig();
+            int width = mainWindow->getWidth();
+            int height = mainWindow->getHeight();
+            if (uconfig->windowWidth > 0) width = uconfig->windowWidth;
+            if (uconfig->windowHeight > 0) height = uconfig->windowHeight;
+            mainWindow->setSize(width, height);
+        }
+    });
+
+    graph.addMain("Mobius", {"MainWindow", "Script registry"}, [this]() {
+        // let this initialize before we start the audio device
+        // and blocks start comming in
+        // also before Mobius so it registers the block listener with
+        // the right one
+        // !! revisit this, for plugins we don't control when blocks start
+        // so it needs to be in a quiet state immediately
+        audioStream.configure();
+
+        scriptUtil.initialize(this);
+        // supreme hate for how this is working
+        SystemConfig* scon = getSystemConfig();
+        scriptUtil.configure(session.get(), scon->getGroups());
+
+        // open MIDI devices before Mobius so MidiTracks can resolve device
+        // names in the session to device ids
+        midiManager.configure();
+        midiManager.openDevices();
+        // go ahead and add MM errors to the startup alert so it doesn't have to
+        addStartupErrors(midiManager.getErrors());
+
+        // now bring up the bad boy
+        // here is where we may want to defer this for host plugin scanning
+        // this used to be a Singleton that was released with
+        // MobiusInterface::shutdown, but now it's just an ordinary pointer
+        // that has to be deleted
+        // should be a unique_ptr, but it's also better if this
+        // is deleted earler to control ordering
+        mobius = MobiusInterface::getMobius(this);
+
+        // this is where the bulk of the engine initialization happens
+        // it will call MobiusContainer to register callbacks for
+        // audio and midi streams
+        sendInitialConfiguration();
+
+        // force a synchronous refresh of SystemState to reflect up the
+        // state after initialization, don't need to use the normal async state
+        // refresh protocol yet
+        mobius->initializeState(&stateBuffer);
+        SystemState* initialState = stateBuffer.acquire();
+        if (initialState != nullptr)
+          mobiusViewer.refresh(initialState, &mobiusView);
+        // nothing has been displayed set so turn on all the flags
+        mobiusViewer.forceRefresh(&mobiusView);
+
+        // ScriptConfig no longer goes in through MobiusConfig
+        // extract one from the new ScriptRegistry and send it down
+        ScriptConfig* oldScripts = scriptClerk.getMobiusScriptConfig();
+        mobius->installScripts(oldScripts);
+        scriptClerk.saveErrors(oldScripts);
+        delete oldScripts;
+
+        // listen for timing and config changes we didn't initiate
+        // !! continuing to dislike the distinction between MobiusContainer and
+        // MobiusListener, we're the same thing but in the engine everything has
+        // access to Container and few get the Listener
+        mobius->setListener(this);
+
+        // let internal UI components interested in configuration adjust themselves
+        // move this after scrript installation so the new display elements can see
+        // MSL symbols
+        //propagateConfiguration();
+    });
+
+    graph.addMain("Maintenance Thread", {"Mobius"}, [this]() {
+        // let the maintenance thread go
+        uiThread.start();
+    });
+
+    graph.addMain("Devices", {"Maintenance Thread"}, [this]() {
+        // formerly did MIDI devices here, but that has to be done before Mobius
+        //midiManager.configure();
+        //midiManager.openDevices();
+
+        // install the MidiManager as the MobiusMidiListener when running
+        // as a plugin, this only needs to be done once
+        if (isPlugin())
+          mobius->setMidiListener(&midiManager);
+
+        // initialize the audio device last if we're standalone after
+        // everything is wired together and events can come in safely
+        if (mainComponent != nullptr) {
+            audioManager.openDevices();
+        }
+    });
+
+    graph.addMain("Display Update", {"Devices"}, [this]() {
+        // initial display update if we're standalone
+
+        // new: having some timing problems in GP with MIDI commands to
+        // initialize things needing to have a refreshed view before the
+        // editor window is open, should have fixed this with the synchronous
+        // view refresh done earlier
+        for (auto track : mobiusView.tracks) {
+            if (track->loopCount == 0)
+              Trace(1, "Supervisor: Initial loop count zero in track %d", track->index + 1);
+        }
 
-    // formerly did MIDI devices here, but that has to be done before Mobius
-    //midiManager.configure();
-    //midiManager.openDevices();
-    
-    // install the MidiManager as the MobiusMidiListener when running
-    // as a plugin, this only needs to be done once
-    if (isPlugin())
-      mobius->setMidiListener(&midiManager);
-    
-    // initialize the audio device last if we're standalone after
-    // everything is wired together and events can come in safely
-    if (mainComponent != nullptr) {
-        audioManager.openDevices();
-    }
+        // not sure why I thought it was desireable to defer this for
+        // the plugin, seems harmless even though the editor window
+        // may not be open
+        if (mainComponent != nullptr) {
+            mainWindow->update(&mobiusView);
+        }
+    });
+
+    graph.addMain("Parameters", {"Display Update"}, [this]() {
+        // install parameters
+        // initialize first so we can test standalone
+        parametizer.initialize();
+        if (audioProcessor != nullptr) {
+            // then install them if we're a plugin
+            parametizer.install();
+        }
+    });
+
+    graph.addMain("MSL", {"Parameters"}, [this]() {
+        // load the MSL files in the library
+        // this is where scripts with init blocks may run
+        // so it needs to be toward the end of most of the initialization
+        scriptClerk.installMsl();
+        // restore persistent variables
+        scriptClerk.restoreState();
+    });
+
+    graph.addMain("Bindings", {"MSL"}, [this]() {
+        // now update the UI after script loading so it can see symbols
+        propagateConfiguration();
 
-    meter("Display Update");
-    
-    // initial display update if we're standalone
+        // prepare action bindings
+        // important to do this AFTER all the symbols are
+        // intstalled, including scripts
+        configureBindings();
 
-    // new: having some timing problems in GP with MIDI commands to
-    // initialize things needing to have a refreshed view before the
-    // editor window is open, should have fixed this with the synchronous
-    // view refresh done earlier
-    for (auto track : mobiusView.tracks) {
-        if (track->loopCount == 0)
-          Trace(1, "Supervisor: Initial loop count zero in track %d", track->index + 1);
-    }
+        // random internal utility objects
+        midiClerk.reset(new MidiClerk(this));
+        freewheeler.reset(new Freewheeler(this));
 
-    // not sure why I thought it was desireable to defer this for
-    // the plugin, seems harmless even though the editor window
-    // may not be open
-    if (mainComponent != nullptr) {
-        win->update(&mobiusView);
-    }
+        // unclear where in the startup process this needs to be brought up,
+        // not necessary until we have auto-start tasks
+        taskMaster.reset(new TaskMaster(this));
+    });
 
-    meter("Parameters");
-    
-    // install parameters
-    // initialize first so we can test standalone
-    parametizer.initialize();
-    if (audioProcessor != nullptr) {
-        // then install them if we're a plugin
-        parametizer.install();
-    }
-
-    // load the MSL files in the library
-    // this is where scripts with init blocks may run
-    // so it needs to be toward the end of most of the initialization
-    scriptClerk.installMsl();
-    // restore persistent variables
-    scriptClerk.restoreState();
-
-    // now update the UI after script loading so it can see symbols
-    propagateConfiguration();
-        
-    // prepare action bindings
-    // important to do this AFTER all the symbols are
-    // intstalled, including scripts
-    configureBindings();
+    graph.run();
 
-    // random internal utility objects
-    midiClerk.reset(new MidiClerk(this));
+    startupTimeline.clear();
+    graph.report(startupTimeline);
+    startupTimeline.add("Total " + juce::String((int)graph.getElapsed()) + " msec");
+    Trace(2, "Supervisor: Startup timeline\n");
+    for (auto line : startupTimeline)
+      Trace(2, "  %s\n", line.toUTF8());
 
-    // unclear where in the startup process this needs to be brought up,
-    // not necessary until we have auto-start tasks
-    taskMaster.reset(new TaskMaster(this));
-                       
     alert(startupErrors);
-    
+
     meter(nullptr);
 
     // argument is intervalInMilliseconds
@@ -549,6 +627,9 @@ void Supervisor::shutdown()
     Trace(2, "Supervisor: Stopping maintenance thread\n");
     uiThread.stop();
 
+    // stop any offline render before the kernel goes away
+    freewheeler.reset();
+
     // audio devices should have been stopped by now, but
     // to be safer, disconnect the linkage between the app/plugin and the engine
     // still not sure how we can be sure that we aren't still
@@ -556,6 +637,9 @@ void Supervisor::shutdown()
     // if you see crashes on shutdown look here
     audioStream.setAudioListener(nullptr);
     audioStream.traceFinalStatistics();
+    Trace(2, "Supervisor: %d state publications with %d track changes",
+          stateBuffer.getPublications(), stateBuffer.getTracksChanged());
+    PaintMeter::traceStatistics();
     
     binderator.stop();
     scriptenv.shutdown();
@@ -729,14 +813,15 @@ void Supervisor::configureBindings()
     binderator.start();
 
     // also build one and send it down to the kernel
-    if (isPlugin()) {
-        Binderator* coreBinderator = new Binderator();
-        // this now requires UIConfig and pulls it from Supervisor
-        // so we don't need to be passing in config objects any more
-        coreBinderator->configureMidi(getSystemConfig(), getUIConfig(), &symbols);
+    // this used to be only for the plugin, but MIDI from the input devices
+    // now goes directly to the kernel in both, the one here only sees
+    // what MidiManager couldn't queue
+    Binderator* coreBinderator = new Binderator();
+    // this now requires UIConfig and pulls it from Supervisor
+    // so we don't need to be passing in config objects any more
+    coreBinderator->configureMidi(getSystemConfig(), getUIConfig(), &symbols);
 
-        mobius->installBindings(coreBinderator);
-    }
+    mobius->installBindings(coreBinderator);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -866,6 +951,11 @@ MidiClerk* Supervisor::getMidiClerk()
     return midiClerk.get();
 }
 
+Freewheeler* Supervisor::getFreewheeler()
+{
+    return freewheeler.get();
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // Projects and Files
@@ -978,8 +1068,9 @@ TaskMaster* Supervisor::getTaskMaster()
 //////////////////////////////////////////////////////////////////////
 
 /**
- * Called by the MobiusThread to process events outside the audio thread.
- * The expected cycle time is 10ms or 1/10 second.
+ * Called by the MainThread to process events outside the audio thread.
+ * This happens when the kernel signals that it sent something to the shell,
+ * and at least every MainThread::ShellInterval for things that wait on time.
  */
 void Supervisor::advance()
 {
@@ -991,37 +1082,6 @@ void Supervisor::advance()
         
         // tell the engine to do housekeeping before we refresh the UI
         mobius->performMaintenance();
-
-        if (stateRefreshReturned) {
-            // always refresh the view, even if the UI is not visible
-            // LoadMidi and possibly other places look at things in the view to
-            // do request validation and these need fresh state
-            mobiusViewer.refresh(&systemState, &mobiusView);
-            
-            // the actual UI refresh doesn't need to happen unless the window is open
-            if (mainComponent != nullptr || pluginEditorOpen)
-              mainWindow->update(&mobiusView);
-            
-            stateRefreshReturned = false;
-        }
-
-        // request another state refresh
-        if (!stateRefreshRequested) {
-            stateRefreshRequested = true;
-
-            // set this to get details for the focused track
-            systemState.focusedTrackNumber = mobiusView.focusedTrack + 1;
-            
-            mobius->requestState(&systemState);
-        }
-        else {
-            // unusual, the engine should be keeping up with this but it can happen
-            // in rare cases if you hit it just right
-            // should keep track of the number of advances that happen while this is waiting
-            // and if we get more than a few then the engine must be hung
-            Trace(2, "Supervisor: Mobius is late on a refresh request");
-        }
-        
     }
 
     // let TestDriver advance wait states, and process completed tests
@@ -1029,6 +1089,10 @@ void Supervisor::advance()
     // and will have it's own mechanism for periodic advance
     testDriver.advance();
 
+    // let an offline render notice when it is finished
+    if (freewheeler != nullptr)
+      freewheeler->advance();
+
     // let MidiMonitors display things queued from the plugin
     midiManager.performMaintenance();
 
@@ -1036,20 +1100,31 @@ void Supervisor::advance()
 }
 
 /**
- * Engine callback when the state has finished a refresh.
+ * Called by the MainThread when the kernel publishes a new state,
+ * and after every shell advance.  The rate is controlled by the
+ * publication interval which is set from the refreshRate in UIConfig.
  */
-void Supervisor::mobiusStateRefreshed(class SystemState* state)
+void Supervisor::advanceDisplay()
 {
-    (void)state;
-    
-    if (!stateRefreshRequested)
-      Trace(1, "Supervisor: Mobius refreshed a SystemState without asking");
+    if (mobius != nullptr) {
 
-    if (stateRefreshReturned)
-      Trace(1, "Supervisor: Mobius returned an extra SystemState");
-      
-    stateRefreshReturned = true;
-    stateRefreshRequested = false;
+        // pick up the latest state the kernel published, if the engine is
+        // running behind there may not be one and we'll catch it next time
+        SystemState* state = stateBuffer.acquire();
+        if (state != nullptr) {
+            // always refresh the view, even if the UI is not visible
+            // LoadMidi and possibly other places look at things in the view to
+            // do request validation and these need fresh state
+            mobiusViewer.refresh(state, &mobiusView);
+            
+            // the actual UI refresh doesn't need to happen unless the window is open
+            if (mainComponent != nullptr || pluginEditorOpen)
+              mainWindow->update(&mobiusView);
+        }
+
+        // set this to get details for the focused track in the next one
+        stateBuffer.setFocusedTrack(mobiusView.focusedTrack + 1);
+    }
 }
 
 /**
@@ -1424,9 +1499,31 @@ void Supervisor::updateDeviceConfig()
  */
 void Supervisor::propagateConfiguration()
 {
+    configureRefresh();
     mainWindow->configure();
 }
 
+/**
+ * Adjust the display refresh rates.  These are in cycles per second
+ * and are independent of how often the shell does maintenance.
+ * The normal display rate controls how often the kernel publishes state,
+ * the high rate is for the few elements that want to look snappy.
+ */
+void Supervisor::configureRefresh()
+{
+    UIConfig* config = getUIConfig();
+    
+    int rate = config->getInt("refreshRate");
+    if (rate <= 0)
+      rate = 1000 / SystemStateBuffer::DefaultInterval;
+    stateBuffer.setInterval(1000 / rate);
+
+    int highRate = config->getInt("highRefreshRate");
+    if (highRate <= 0)
+      highRate = 1000 / MainThread::DefaultHighInterval;
+    uiThread.setHighInterval(1000 / highRate);
+}
+
 ParameterSets* Supervisor::getParameterSets()
 {
     if (!parameterSets) {
@@ -1515,8 +1612,8 @@ Session* Supervisor::initializeSession()
     // this is now accessible to the reset of the system
     session.reset(neu);
 
-    // make the SystemState match the session
-    resizeSystemState(neu);
+    // warn if the session has more tracks than we can show
+    checkStateCapacity(neu);
 
     // initialize the view for the known track counts
     mobiusViewer.initialize(session.get(), &mobiusView);
@@ -1547,8 +1644,8 @@ void Supervisor::loadSession(Session* neu)
     // this is now accessible to the reset of the system
     session.reset(neu);
 
-    // make the SystemState match the session
-    resizeSystemState(neu);
+    // warn if the session has more tracks than we can show
+    checkStateCapacity(neu);
 
     // bump the session version to trigger a full refresh
     neu->setVersion(++sessionVersion);
@@ -1581,61 +1678,16 @@ Session* Supervisor::getSession()
 }
 
 /**
- * Configure the SystemState object so that it has enough TrackStates
- * to match the tracks defined in the session.  This doesn't need to
- * make it smaller, but it always needs to be larger than necessary
- * so the engine has enough space to deposit things.
- *
- * todo: If you reorder tracks in the session, then the existing state
- * will contain stale data that may not match what the track actually is.
- * May want to reset everything to some clean initial values.
+ * The SystemStates are allocated once by SystemStateBuffer with room
+ * for a fixed number of tracks so the kernel never sees them change size.
+ * If a session has more than that, the extra tracks will not be displayed.
  */
-void Supervisor::resizeSystemState(Session* s)
+void Supervisor::checkStateCapacity(Session* s)
 {
     int maxTracks = s->getTrackCount();
-    
-    // in theory should whip through the config model and calculate
-    // the maximum
-    int maxLoops = TrackState::MaxLoops;
-    
-    for (int i = systemState.tracks.size() ; i < maxTracks ; i++) {
-        TrackState* ts = new TrackState();
-        for (int l = 0 ; l < maxLoops ; l++) {
-            TrackState::Loop loop;
-            ts->loops.add(loop);
-        }
-        ts->loopCount = 0;
-        systemState.tracks.add(ts);
-    }
-
-    FocusedTrackState* focused = &(systemState.focusedState);
-    
-    // not crucial, the number of events is typically less than 4 but with
-    // stacking can be higher, it's okay to miss a few since if there are that many
-    // it's hard to read anyway
-    int maxEvents = FocusedTrackState::MaxEvents;
-    for (int i = focused->events.size() ; i < maxEvents ; i++) {
-        // todo: look at that fill() method, that's probably a better way to do this
-        // what about ensureStorageAllocated?
-        TrackState::Event e;
-        focused->events.add(e);
-    }
-    
-    // this it leaves numAllocated with the right number but numUsed is zero
-    // so size() returns zero
-    //focused->regions.ensureStorageAllocated(FocusedTrackState::MaxRegions);
-    //focused->layers.ensureStorageAllocated(FocusedTrackState::MaxLayers);
-
-    focused->regions.resize(FocusedTrackState::MaxRegions);
-    focused->layers.resize(FocusedTrackState::MaxLayers);
-
-    // not necessary if the default constructor initializes it the way you want
-    //focused->regions.fill(TrackState::Region());
-    //focused->layers.fill(TrackState::Layer());
-
-    focused->eventCount = 0;
-    focused->regionCount = 0;
-    focused->layerCount = 0;
+    if (maxTracks > SystemStateBuffer::MaxTracks)
+      Trace(1, "Supervisor: Session has %d tracks, only %d can be displayed",
+            maxTracks, SystemStateBuffer::MaxTracks);
 }
 
 /**
@@ -1652,7 +1704,7 @@ void Supervisor::sessionEditorSave()
     
     producer->saveSession(s);
 
-    resizeSystemState(s);
+    checkStateCapacity(s);
         
     mobiusViewer.configure(s, &mobiusView);
 
@@ -1678,11 +1730,13 @@ void Supervisor::addHighListener(HighRefreshListener* l)
 {
     if (!highListeners.contains(l))
       highListeners.add(l);
+    highListenerCount = highListeners.size();
 }
 
 void Supervisor::removeHighListener(HighRefreshListener* l)
 {
     highListeners.removeFirstMatchingValue(l);
+    highListenerCount = highListeners.size();
 }
 
 void Supervisor::addAlertListener(AlertListener* l)
@@ -1806,6 +1860,10 @@ int Supervisor::getSampleRate()
  */
 int Supervisor::getBlockSize()
 {
+    // while rendering offline the kernel is driven with a different block size
+    if (freewheeler != nullptr && freewheeler->isActive())
+      return freewheeler->getBlockSize();
+
     int blockSize = audioStream.getBlockSize();
     if (blockSize == 0)
       blockSize = 256;
@@ -1897,7 +1955,20 @@ int Supervisor::getFocusedTrackIndex()
  */
 void Supervisor::mobiusTimeBoundary()
 {
-    uiThread.notify();
+    uiThread.signalHigh();
+}
+
+/**
+ * MobiusContainer signals from the audio thread at the end of a block.
+ */
+void Supervisor::notifyKernelMessages()
+{
+    uiThread.signalShell();
+}
+
+void Supervisor::notifyStatePublished()
+{
+    uiThread.signalDisplay();
 }
 
 /**
@@ -2010,6 +2081,16 @@ void Supervisor::mobiusSaveCapture(Audio* content, juce::String fileName)
     AudioFile::write(file, content, getSampleRate());
 }
 
+/**
+ * Only Freewheeler cares about this, TestDriver intercepts it
+ * when it overrides the listener.
+ */
+void Supervisor::mobiusScriptFinished(int requestId)
+{
+    if (freewheeler != nullptr)
+      freewheeler->scriptFinished(requestId);
+}
+
 /**
  * Called down in TrackManager after handling a NextTrack/PrevTrack/SelectTrack
  */
@@ -2665,8 +2746,11 @@ void Supervisor::mutateMslReturn(Symbol* s, int value, MslValue* retval)
         UIParameterType ptype = props->type;
         if (ptype == TypeEnum) {
             // don't use labels since I want scripters to get used to the names
-            const char* ename = props->getEnumName(value);
-            retval->setEnum(ename, value);
+            int eid = props->getEnumId(value);
+            if (eid > 0)
+              retval->setEnumId(eid, value);
+            else
+              retval->setEnum(props->getEnumName(value), value);
         }
         else if (ptype == TypeBool) {
             retval->setBool(value == 1);
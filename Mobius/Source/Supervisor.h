@@ -20,6 +20,7 @@
 #include "mobius/MobiusInterface.h"
 #include "model/Symbol.h"
 #include "model/SystemState.h"
+#include "model/SystemStateBuffer.h"
 #include "model/PriorityState.h"
 
 #include "JuceAudioStream.h"
@@ -153,6 +154,14 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
         return &midiManager;
     }
 
+    class MidiInputQueue* getMidiInputQueue() override {
+        return midiManager.getInputQueue();
+    }
+
+    class MidiOutputQueue* getMidiOutputQueue() override {
+        return midiManager.getOutputQueue();
+    }
+
     class FileManager* getFileManager() override {
         return &fileManager;
     }
@@ -182,6 +191,7 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     }
     
     class MidiClerk* getMidiClerk();
+    class Freewheeler* getFreewheeler();
 
     class SystemConfig* getSystemConfig() override;
     void updateSystemConfig() override;
@@ -215,6 +225,9 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     class Session* getSession() override;
     void sessionEditorSave();
     void loadSession(class Session* neu);
+    // send the Session down without saving it, MobiusConsole uses this
+    // to benchmark session edits
+    void sendModifiedSession(bool globalReset);
 
     class ParameterSets* getParameterSets() override;
     void updateParameterSets() override;
@@ -244,7 +257,11 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     
     // entry point for the "maintenance thread" only to be called by MainThread
     void advance();
+    void advanceDisplay();
     void advanceHigh();
+    bool hasHighListeners() {
+        return (highListenerCount.load() > 0);
+    }
     
     // Provider interface for file transfer
     void loadAudio(int trackNumber, int loopNumber) override;
@@ -284,6 +301,8 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     class MslEnvironment* getMslEnvironment() override;
     void writeDump(juce::String file, juce::String content) override;
     int getFocusedTrackIndex() override;
+    void notifyKernelMessages() override;
+    void notifyStatePublished() override;
     
     // MobiusListener
 	void mobiusTimeBoundary() override;
@@ -295,8 +314,8 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     void mobiusMidiReceived(juce::MidiMessage& msg) override;
     void mobiusDynamicConfigChanged() override;
     void mobiusSaveCapture(Audio* content, juce::String fileName) override;
+    void mobiusScriptFinished(int requestId) override;
     void mobiusActivateBindings(juce::String name) override;
-    void mobiusStateRefreshed(class SystemState* state) override;
     void mobiusSetFocusedTrack(int index) override;
     void mobiusGlobalReset() override;
     
@@ -343,6 +362,7 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     // toggle status element borders and labels, other display commands
     // send UIActions to Supervisor, should this too?
     void propagateConfiguration();
+    void configureRefresh();
 
     // kludge for "identify mode" which is transient state held by StatusArea
     // and needed by MainMenu which is too isolated to have options that
@@ -364,6 +384,11 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
         return commandLine;
     }
 
+    // when each startup task ran, for the console
+    juce::StringArray& getStartupTimeline() {
+        return startupTimeline;
+    }
+
     // stupid utility to generate unique identififers for bindings
     int newUid() override;
 
@@ -388,6 +413,9 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     // in an alert window when the UI is up
     juce::StringArray startupErrors;
 
+    // timeline of the StartupGraph from the last start()
+    juce::StringArray startupTimeline;
+
     // put this first since it contains object pools that the things below may
     // need to use during the destruction sequence
     MslEnvironment scriptenv;
@@ -398,11 +426,9 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     // symbol table for this application/plugin instance
     SymbolTable symbols;
 
-    // system state capture, used to drive the view
-    SystemState systemState;
+    // system state published by the kernel, used to drive the view
+    SystemStateBuffer stateBuffer;
     PriorityState priorityState;
-    bool stateRefreshRequested = false;
-    bool stateRefreshReturned = false;
     
     // use a custom AudioDeviceManager so we don't have to mess with that XML initializer
     juce::AudioDeviceManager customAudioDeviceManager;
@@ -467,10 +493,15 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     // full link every time you touch the header file
     std::unique_ptr<class MidiClerk> midiClerk;
 
+    // offline rendering
+    std::unique_ptr<class Freewheeler> freewheeler;
+
     // internal component listeners
     juce::Array<ActionListener*> actionListeners;
     juce::Array<AlertListener*> alertListeners;
     juce::Array<HighRefreshListener*> highListeners;
+    // maintenance thread looks at this without the MessageManagerLock
+    std::atomic<int> highListenerCount {0};
     class MobiusConsole* mobiusConsole = nullptr;
 
     // master copies of the configuration files
@@ -524,10 +555,9 @@ class Supervisor : public Provider, public MobiusContainer, public MobiusListene
     void configureBindings();
 
     class Session* initializeSession();
-    void resizeSystemState(class Session* s);
+    void checkStateCapacity(class Session* s);
 
     void sendInitialConfiguration();
-    void sendModifiedSession(bool globalReset);
     
     // Listener notification
     void notifyAlertListeners(juce::String msg);
@@ -16,6 +16,7 @@
 #include "model/ParameterProperties.h"
 #include "model/Session.h"
 #include "model/ParameterSets.h"
+#include "script/MslStringArena.h"
 
 #include "Provider.h"
 #include "Producer.h"
@@ -344,6 +345,8 @@ void Symbolizer::parseParameter(SymbolTable* symbols, juce::XmlElement* el,
         props->multi = el->getBoolAttribute("multi");
         props->values = parseStringList(el->getStringAttribute("values"));
         props->valueLabels = parseLabels(el->getStringAttribute("valueLabels"), props->values);
+        for (auto value : props->values)
+          props->valueIds.add(MslStringArena::getArena()->intern(value.toUTF8()));
         props->low = el->getIntAttribute("low");
         props->high = el->getIntAttribute("high");
         props->defaultValue = el->getIntAttribute("defaultValue");
@@ -0,0 +1,167 @@
+/**
+ * Device thread to kernel MIDI queues.
+ *
+ * AbstractFifo gives us the wait-free single producer single consumer
+ * index handling, the entries themselves are preallocated in each Ring.
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/Trace.h"
+
+#include "MidiInputQueue.h"
+
+MidiInputQueue::MidiInputQueue()
+{
+}
+
+MidiInputQueue::~MidiInputQueue()
+{
+}
+
+/**
+ * Called by MidiManager in the message thread after opening a device
+ * or changing the device list.  If there are more devices than rings
+ * the extras go through the message thread.
+ */
+void MidiInputQueue::attach(juce::MidiInput* device, int id)
+{
+    Ring* found = nullptr;
+    Ring* available = nullptr;
+    for (int i = 0 ; i < MaxDevices ; i++) {
+        juce::MidiInput* owner = rings[i].owner.load();
+        if (owner == device) {
+            found = &(rings[i]);
+            break;
+        }
+        else if (owner == nullptr && available == nullptr) {
+            available = &(rings[i]);
+        }
+    }
+
+    if (found == nullptr && available != nullptr) {
+        found = available;
+        found->id.store(id);
+        found->owner.store(device);
+    }
+    else if (found != nullptr) {
+        found->id.store(id);
+    }
+}
+
+/**
+ * Anything the device left in the ring is still delivered.
+ */
+void MidiInputQueue::detach(juce::MidiInput* device)
+{
+    for (int i = 0 ; i < MaxDevices ; i++) {
+        if (rings[i].owner.load() == device)
+          rings[i].owner.store(nullptr);
+    }
+}
+
+/**
+ * Called by MidiManager in the device thread.
+ */
+bool MidiInputQueue::add(juce::MidiInput* device, const juce::MidiMessage& msg)
+{
+    bool added = false;
+    juce::int64 now = juce::Time::getHighResolutionTicks();
+    int size = msg.getRawDataSize();
+
+    // if the kernel isn't taking things, don't let them pile up
+    // where they would all fire when the audio stream starts
+    juce::int64 last = consumerTicks.load(std::memory_order_relaxed);
+    juce::int64 stale = juce::Time::getHighResolutionTicksPerSecond() * StaleMillis / 1000;
+
+    Ring* ring = nullptr;
+    for (int i = 0 ; i < MaxDevices ; i++) {
+        if (rings[i].owner.load() == device) {
+            ring = &(rings[i]);
+            break;
+        }
+    }
+
+    if (ring != nullptr && size <= 3 && last > 0 && (now - last) < stale) {
+        const auto scope = ring->fifo.write(1);
+        if (scope.blockSize1 > 0) {
+            Entry& e = ring->entries[scope.startIndex1];
+            const juce::uint8* raw = msg.getRawData();
+            for (int i = 0 ; i < size ; i++)
+              e.data[i] = raw[i];
+            e.size = size;
+            e.device = ring->id.load();
+            e.ticks = now;
+            added = true;
+            queued++;
+        }
+    }
+
+    if (!added)
+      rejected++;
+
+    return added;
+}
+
+/**
+ * Called by the kernel in the audio thread.
+ */
+bool MidiInputQueue::next(int index, Entry& e)
+{
+    bool found = false;
+    if (index >= 0 && index < MaxDevices) {
+        Ring& ring = rings[index];
+        const auto scope = ring.fifo.read(1);
+        if (scope.blockSize1 > 0) {
+            e = ring.entries[scope.startIndex1];
+            found = true;
+        }
+    }
+    return found;
+}
+
+void MidiInputQueue::consumed(juce::int64 now)
+{
+    consumerTicks.store(now, std::memory_order_relaxed);
+}
+
+/**
+ * Scheduling delay for one message.  Only the kernel calls this
+ * so the totals don't need to be atomic.
+ *
+ * This is calculated from the block offset the kernel chose, it is not
+ * a measurement of when the action was heard, which also depends on the
+ * audio device.  Since messages are placed in the next block at the
+ * offset they arrived within the previous one, it should hover around
+ * one block.  A maximum well above the average means messages arrived
+ * late enough to be clamped to the end of a block.
+ */
+void MidiInputQueue::addDelay(Entry& e, juce::int64 actionTicks)
+{
+    juce::int64 delay = actionTicks - e.ticks;
+    delivered++;
+    totalDelay += delay;
+    if (delay > maxDelay)
+      maxDelay = delay;
+}
+
+/**
+ * Called at shutdown after the audio stream has stopped.
+ */
+void MidiInputQueue::traceStatistics()
+{
+    double ticksPerMicro = (double)juce::Time::getHighResolutionTicksPerSecond() / 1000000.0;
+    int average = 0;
+    if (delivered > 0)
+      average = (int)(((double)totalDelay / (double)delivered) / ticksPerMicro);
+    int maximum = (int)((double)maxDelay / ticksPerMicro);
+
+    Trace(2, "MidiInputQueue: %d queued %d rejected %d delivered",
+          queued.load(), rejected.load(), delivered);
+    Trace(2, "MidiInputQueue: Scheduling delay %d us average %d us maximum",
+          average, maximum);
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,139 @@
+/**
+ * Queues for passing short MIDI messages from the MidiInput device
+ * threads directly to the kernel in the audio thread.
+ *
+ * Each open input device has its own ring so there is only ever one
+ * producer, the Juce callback thread for that device, and one consumer,
+ * the kernel.  Rings are fixed size and neither side waits or allocates.
+ *
+ * MidiManager attaches a device to a ring when it is opened and detaches
+ * it before it is deleted.  The device keeps the same ring for as long
+ * as it is open, so when other devices come and go it can't end up
+ * writing into a ring that belongs to another device.  The device id
+ * given to the kernel is kept with the ring and can change, it is only
+ * a label.
+ *
+ * Messages are stamped with the high resolution tick counter when they
+ * arrive.  The kernel converts that to an offset within the next block
+ * so timing between messages is preserved regardless of when the
+ * device thread happened to run relative to the audio thread.
+ *
+ * Only messages that fit in three bytes go through here.  Realtime
+ * messages have their own path to MidiAnalyzer and sysex still goes
+ * through the message thread.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class MidiInputQueue
+{
+  public:
+
+    /**
+     * Maximum number of devices that can use a queue.  Others
+     * go through the message thread.
+     */
+    static const int MaxDevices = 16;
+
+    /**
+     * Messages in each device ring.
+     */
+    static const int RingSize = 256;
+
+    /**
+     * If the kernel hasn't taken anything for this long assume the audio
+     * stream isn't running and let the message thread handle it.
+     */
+    static const int StaleMillis = 200;
+
+    class Entry
+    {
+      public:
+        juce::uint8 data[3] = {0, 0, 0};
+        int size = 0;
+        int device = 0;
+        juce::int64 ticks = 0;
+    };
+
+    MidiInputQueue();
+    ~MidiInputQueue();
+
+    //
+    // Message thread
+    //
+
+    /**
+     * Give a device a ring if it doesn't have one, and set the id
+     * the kernel will see for its messages.
+     */
+    void attach(juce::MidiInput* device, int id);
+
+    /**
+     * Release the ring of a device that is about to be deleted.
+     */
+    void detach(juce::MidiInput* device);
+
+    //
+    // Device threads
+    //
+
+    /**
+     * Add a message received from a device.  Returns false if the
+     * message could not be queued and should be handled the old way.
+     */
+    bool add(juce::MidiInput* device, const juce::MidiMessage& msg);
+
+    //
+    // Kernel
+    //
+
+    /**
+     * Return the next message from a ring, false if empty.
+     */
+    bool next(int ring, Entry& e);
+
+    /**
+     * Remember when the kernel last looked.
+     */
+    void consumed(juce::int64 now);
+
+    /**
+     * Accumulate the delay between arrival and the position the message
+     * was given in the audio stream, expressed in ticks.
+     */
+    void addDelay(Entry& e, juce::int64 actionTicks);
+
+    void traceStatistics();
+
+  private:
+
+    class Ring
+    {
+      public:
+        juce::AbstractFifo fifo {RingSize};
+        Entry entries[RingSize];
+        // the device writing to this ring and the id it goes by
+        std::atomic<juce::MidiInput*> owner {nullptr};
+        std::atomic<int> id {0};
+    };
+
+    Ring rings[MaxDevices];
+
+    // last time the kernel drained the rings
+    std::atomic<juce::int64> consumerTicks {0};
+
+    // statistics, the kernel writes these, the others are written by
+    // the device threads
+    std::atomic<int> queued {0};
+    std::atomic<int> rejected {0};
+    int delivered = 0;
+    juce::int64 totalDelay = 0;
+    juce::int64 maxDelay = 0;
+
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,237 @@
+/**
+ * Kernel to device MIDI queues and the thread that empties them.
+ *
+ * Same AbstractFifo arrangement as MidiInputQueue with the roles
+ * reversed.  Messages within a ring are in time order since the kernel
+ * adds them in block order, so the thread only needs to look at the head
+ * of each ring.
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/Trace.h"
+#include "../MidiManager.h"
+
+#include "MidiOutputQueue.h"
+
+MidiOutputQueue::MidiOutputQueue()
+{
+}
+
+MidiOutputQueue::~MidiOutputQueue()
+{
+    stopThread();
+}
+
+void MidiOutputQueue::initialize(MidiManager* mm)
+{
+    midiManager = mm;
+}
+
+/**
+ * Called by MidiManager after devices were opened.  Anything queued
+ * before now was for the old device list.
+ */
+void MidiOutputQueue::startThread()
+{
+    if (thread == nullptr) {
+        Trace(2, "MidiOutputQueue: Starting output thread\n");
+        generation++;
+        thread = new MidiOutputThread(this);
+        if (thread->start()) {
+            running.store(true);
+        }
+        else {
+            delete thread;
+            thread = nullptr;
+        }
+    }
+}
+
+/**
+ * The kernel stops queueing before the thread goes away.  It may have
+ * just added something, that stays in the ring until the next
+ * generation discards it.
+ */
+void MidiOutputQueue::stopThread()
+{
+    running.store(false);
+    if (thread != nullptr) {
+        Trace(2, "MidiOutputQueue: Stopping output thread\n");
+        thread->stop();
+        delete thread;
+        thread = nullptr;
+    }
+}
+
+bool MidiOutputQueue::isRunning()
+{
+    return running.load();
+}
+
+/**
+ * Called by the kernel in the audio thread.
+ */
+bool MidiOutputQueue::add(int device, const juce::MidiMessage& msg, juce::int64 ticks)
+{
+    bool added = false;
+    int size = msg.getRawDataSize();
+    
+    if (running.load() && device >= 0 && device < MaxDevices && size <= 3) {
+        Ring& ring = rings[device];
+        const auto scope = ring.fifo.write(1);
+        if (scope.blockSize1 > 0) {
+            Entry& e = ring.entries[scope.startIndex1];
+            const juce::uint8* raw = msg.getRawData();
+            for (int i = 0 ; i < size ; i++)
+              e.data[i] = raw[i];
+            e.size = size;
+            e.generation = generation.load();
+            e.ticks = ticks;
+            added = true;
+            queued++;
+        }
+    }
+
+    if (!added)
+      rejected++;
+
+    return added;
+}
+
+void MidiOutputQueue::blockSent(int count)
+{
+    blocks++;
+    if (count > maxBlock)
+      maxBlock = count;
+}
+
+/**
+ * Called by the thread.
+ */
+juce::int64 MidiOutputQueue::send()
+{
+    juce::int64 remaining = -1;
+    juce::int64 now = juce::Time::getHighResolutionTicks();
+    int current = generation.load();
+
+    for (int device = 0 ; device < MaxDevices ; device++) {
+        Ring& ring = rings[device];
+        bool more = true;
+        while (more) {
+            more = false;
+            int start1, size1, start2, size2;
+            ring.fifo.prepareToRead(1, start1, size1, start2, size2);
+            if (size1 > 0) {
+                Entry& e = ring.entries[start1];
+                if (e.generation != current) {
+                    // queued for a device that may not be there any more
+                    discarded++;
+                    ring.fifo.finishedRead(1);
+                    more = true;
+                }
+                else if (e.ticks <= now) {
+                    if (midiManager != nullptr)
+                      midiManager->send(juce::MidiMessage(e.data, e.size), device);
+                    juce::int64 late = now - e.ticks;
+                    totalLateness += late;
+                    if (late > maxLateness)
+                      maxLateness = late;
+                    sent++;
+                    ring.fifo.finishedRead(1);
+                    more = true;
+                }
+                else {
+                    juce::int64 wait = e.ticks - now;
+                    if (remaining < 0 || wait < remaining)
+                      remaining = wait;
+                }
+            }
+        }
+    }
+    return remaining;
+}
+
+/**
+ * Called at shutdown after the audio stream and the thread have stopped.
+ */
+void MidiOutputQueue::traceStatistics()
+{
+    double ticksPerMicro = (double)juce::Time::getHighResolutionTicksPerSecond() / 1000000.0;
+    int average = 0;
+    if (sent > 0)
+      average = (int)(((double)totalLateness / (double)sent) / ticksPerMicro);
+    int maximum = (int)((double)maxLateness / ticksPerMicro);
+
+    int perBlock = 0;
+    if (blocks > 0)
+      perBlock = queued / blocks;
+    
+    Trace(2, "MidiOutputQueue: %d queued %d rejected %d sent %d discarded",
+          queued, rejected, sent, discarded);
+    Trace(2, "MidiOutputQueue: %d blocks with output %d average %d maximum per block",
+          blocks, perBlock, maxBlock);
+    Trace(2, "MidiOutputQueue: Send lateness %d us average %d us maximum",
+          average, maximum);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Thread
+//
+//////////////////////////////////////////////////////////////////////
+
+MidiOutputThread::MidiOutputThread(MidiOutputQueue* q) :
+    juce::Thread(juce::String("MobiusMidiOutput"))
+{
+    queue = q;
+    ticksPerMillisecond = juce::Time::getHighResolutionTicksPerSecond() / 1000;
+}
+
+MidiOutputThread::~MidiOutputThread()
+{
+}
+
+/**
+ * Like MidiClockThread this asks to be realtime since the whole
+ * point is to send on time.
+ */
+bool MidiOutputThread::start()
+{
+    juce::Thread::RealtimeOptions options;
+    options = options.withPriority(10).withPeriodMs(1);
+
+    bool started = startRealtimeThread(options);
+    if (!started)
+      Trace(1, "MidiOutputThread: Unable to start thread\n");
+    return started;
+}
+
+void MidiOutputThread::stop()
+{
+    if (!stopThread(2000))
+      Trace(1, "MidiOutputThread: Unable to stop thread\n");
+    queue = nullptr;
+}
+
+/**
+ * wait(1) is too coarse once something is due soon, so yield until
+ * it is.
+ */
+void MidiOutputThread::run()
+{
+    while (!threadShouldExit()) {
+        juce::int64 remaining = -1;
+        if (queue != nullptr)
+          remaining = queue->send();
+        
+        if (remaining >= 0 && remaining < ticksPerMillisecond)
+          yield();
+        else
+          wait(1);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,145 @@
+/**
+ * Queues for passing short MIDI messages from the kernel to the output
+ * devices with the time they should be sent.
+ *
+ * This is the other direction of MidiInputQueue.  The kernel gathers
+ * what the tracks played during a block with sample offsets and adds them
+ * here stamped with the high resolution tick counter.  A thread owned by
+ * MidiManager sends each one when its time comes so messages are spaced
+ * the way they were in the audio stream rather than all going out at once
+ * wherever the block happened to be processed.
+ *
+ * There is one ring per device, the kernel is the only producer and the
+ * sender thread is the only consumer.  Rings are fixed size and neither
+ * side waits or allocates.
+ *
+ * Only messages that fit in three bytes go through here, anything else
+ * is sent immediately the old way.
+ *
+ * The kernel never looks at the thread itself, only an atomic flag that
+ * is cleared before the thread is stopped and set after it starts.  Device
+ * numbers may mean something else after MidiManager reconciles devices, so
+ * each entry carries the generation it was queued in and the thread drops
+ * anything left over from an earlier one.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class MidiOutputThread : public juce::Thread
+{
+  public:
+    
+    MidiOutputThread(class MidiOutputQueue* q);
+    ~MidiOutputThread();
+
+    bool start();
+    void stop();
+
+    void run() override;
+
+  private:
+
+    class MidiOutputQueue* queue = nullptr;
+    juce::int64 ticksPerMillisecond = 0;
+    
+};
+
+class MidiOutputQueue
+{
+    friend class MidiOutputThread;
+    
+  public:
+
+    /**
+     * Maximum number of devices that can use a queue.
+     */
+    static const int MaxDevices = 16;
+
+    /**
+     * Messages in each device ring.  Dense controller streams can put
+     * a lot in a block so this is larger than the input rings.
+     */
+    static const int RingSize = 1024;
+
+    class Entry
+    {
+      public:
+        juce::uint8 data[3] = {0, 0, 0};
+        int size = 0;
+        int generation = 0;
+        juce::int64 ticks = 0;
+    };
+
+    MidiOutputQueue();
+    ~MidiOutputQueue();
+
+    void initialize(class MidiManager* mm);
+    void startThread();
+    void stopThread();
+
+    /**
+     * True if the sender thread is running and messages can be queued.
+     */
+    bool isRunning();
+
+    //
+    // Kernel
+    //
+
+    /**
+     * Add a message to be sent to a device at a time.  Returns false
+     * if the message could not be queued and should be sent the old way.
+     */
+    bool add(int device, const juce::MidiMessage& msg, juce::int64 ticks);
+
+    /**
+     * Called after each block that sent something.
+     */
+    void blockSent(int count);
+
+    void traceStatistics();
+
+  private:
+
+    class Ring
+    {
+      public:
+        juce::AbstractFifo fifo {RingSize};
+        Entry entries[RingSize];
+    };
+
+    class MidiManager* midiManager = nullptr;
+    MidiOutputThread* thread = nullptr;
+
+    // what the kernel looks at instead of the thread
+    std::atomic<bool> running {false};
+    std::atomic<int> generation {0};
+    
+    Ring rings[MaxDevices];
+
+    /**
+     * Send everything that is due, called by the thread.
+     * Returns the ticks until the next message or -1 if
+     * nothing is waiting.
+     */
+    juce::int64 send();
+
+    // statistics, the kernel writes these
+    int queued = 0;
+    int rejected = 0;
+    int blocks = 0;
+    int maxBlock = 0;
+
+    // the thread writes these
+    int sent = 0;
+    int discarded = 0;
+    juce::int64 totalLateness = 0;
+    juce::int64 maxLateness = 0;
+
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,203 @@
+/**
+ * Implementation of MidiPackedSequence
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/StructureDumper.h"
+
+#include "MidiEvent.h"
+#include "MidiSequence.h"
+#include "MidiPackedSequence.h"
+
+MidiPackedSequence::MidiPackedSequence()
+{
+}
+
+/**
+ * Chunks should have gone back to the pool by now, if not
+ * they were checked out so they can simply be deleted.
+ */
+MidiPackedSequence::~MidiPackedSequence()
+{
+    for (int i = 0 ; i < chunkCount ; i++)
+      delete chunks[i];
+}
+
+void MidiPackedSequence::clear(MidiPackedChunkPool* pool)
+{
+    for (int i = 0 ; i < chunkCount ; i++)
+      pool->checkin(chunks[i]);
+    reset();
+}
+
+void MidiPackedSequence::reset()
+{
+    chunkCount = 0;
+    count = 0;
+}
+
+void MidiPackedSequence::dump(StructureDumper& d)
+{
+    d.start("PackedSequence:");
+    d.add("count", count);
+    d.add("chunks", chunkCount);
+    d.newline();
+}
+
+int& MidiPackedSequence::getReach(int stretch)
+{
+    return chunks[stretch / MidiPackedChunk::Stretches]->reach[stretch % MidiPackedChunk::Stretches];
+}
+
+/**
+ * Everything is checked before taking any chunks so a sequence
+ * that can't be packed costs one pass over the list.
+ */
+bool MidiPackedSequence::pack(MidiPackedChunkPool* pool, MidiSequence* src)
+{
+    clear(pool);
+
+    bool packable = (src != nullptr && src->size() <= (MaxChunks * ChunkEvents));
+    if (packable) {
+        for (MidiEvent* e = src->getFirst() ; e != nullptr ; e = e->next) {
+            if (e->juceMessage.getRawDataSize() > 3) {
+                packable = false;
+                break;
+            }
+        }
+    }
+
+    if (packable) {
+        for (MidiEvent* e = src->getFirst() ; e != nullptr ; e = e->next) {
+            if ((count % ChunkEvents) == 0)
+              chunks[chunkCount++] = pool->newChunk();
+
+            Event& packed = get(count);
+            packed.frame = e->frame;
+            packed.duration = e->duration;
+            packed.releaseVelocity = (juce::uint8)e->releaseVelocity;
+            packed.device = (juce::int16)e->device;
+
+            int msgsize = e->juceMessage.getRawDataSize();
+            const juce::uint8* raw = e->juceMessage.getRawData();
+            packed.size = (juce::uint8)msgsize;
+            for (int i = 0 ; i < msgsize ; i++)
+              packed.data[i] = raw[i];
+
+            int last = (e->duration > 0) ? (e->frame + e->duration - 1) : e->frame;
+            int& reach = getReach(count / ReachStride);
+            if ((count % ReachStride) == 0 || last > reach)
+              reach = last;
+
+            count++;
+        }
+    }
+    return packable;
+}
+
+int MidiPackedSequence::seek(int frame)
+{
+    int low = 0;
+    int high = count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (get(mid).frame < frame)
+          low = mid + 1;
+        else
+          high = mid;
+    }
+    return low;
+}
+
+/**
+ * Like MidiSequence::seekHeld this stops at the first stretch that reaches
+ * the frame or starts after it.
+ */
+int MidiPackedSequence::seekHeld(int frame)
+{
+    int found = count;
+    int stretches = (count + ReachStride - 1) / ReachStride;
+    for (int i = 0 ; i < stretches ; i++) {
+        int first = i * ReachStride;
+        if (getReach(i) >= frame || get(first).frame > frame) {
+            found = first;
+            break;
+        }
+    }
+    return found;
+}
+
+/**
+ * Same as juce::MidiMessage, a NoteOn with zero velocity is a NoteOff.
+ */
+bool MidiPackedSequence::isNoteOn(int index)
+{
+    Event& e = get(index);
+    return (e.size == 3 && (e.data[0] & 0xF0) == 0x90 && e.data[2] != 0);
+}
+
+bool MidiPackedSequence::isNoteOff(int index)
+{
+    Event& e = get(index);
+    int status = e.data[0] & 0xF0;
+    return (e.size == 3 && (status == 0x80 || (status == 0x90 && e.data[2] == 0)));
+}
+
+juce::MidiMessage MidiPackedSequence::getMessage(int index)
+{
+    Event& e = get(index);
+    return juce::MidiMessage(e.data, (int)e.size);
+}
+
+/**
+ * Inverse of what pack() does.  Held note state and the peer are
+ * left clean.
+ */
+void MidiPackedSequence::toEvent(int index, MidiEvent* e)
+{
+    Event& packed = get(index);
+    e->next = nullptr;
+    e->device = packed.device;
+    e->juceMessage = getMessage(index);
+    e->frame = packed.frame;
+    e->duration = packed.duration;
+    e->releaseVelocity = packed.releaseVelocity;
+    e->remaining = 0;
+    e->peer = nullptr;
+    e->channelOverride = 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Pool
+//
+//////////////////////////////////////////////////////////////////////
+
+MidiPackedChunkPool::MidiPackedChunkPool()
+{
+    setName("MidiPackedChunk");
+    setObjectSize(sizeof(MidiPackedChunk));
+    fluff();
+}
+
+MidiPackedChunkPool::~MidiPackedChunkPool()
+{
+}
+
+/**
+ * ObjectPool overload to create a new pooled object.
+ */
+PooledObject* MidiPackedChunkPool::alloc()
+{
+    return new MidiPackedChunk();
+}
+
+MidiPackedChunk* MidiPackedChunkPool::newChunk()
+{
+    return (MidiPackedChunk*)checkout();
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,152 @@
+/**
+ * A compact read-only form of MidiSequence for layers that are no
+ * longer being edited.
+ *
+ * A MidiSequence is a linked list of pooled MidiEvents, each carrying a
+ * full juce::MidiMessage and several pointers.  That is convenient while
+ * recording and editing, but once a layer is finished it only needs to be
+ * played, and long loops with controller streams spend a lot of memory and
+ * pointer chasing on it.  Here events are packed into fixed size arrays
+ * ordered by frame.
+ *
+ * Packing happens in the audio thread so the arrays come from a pool of
+ * chunks rather than being allocated to fit.  A sequence that needs more
+ * than MaxChunks, or that has messages longer than three bytes, which is
+ * pretty much only sysex, is left unpacked.
+ *
+ * Since the events are in order, seeking is a binary search on the frame.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "../model/ObjectPool.h"
+
+class MidiPackedSequence
+{
+  public:
+
+    class Event
+    {
+      public:
+        int frame = 0;
+        int duration = 0;
+        juce::uint8 size = 0;
+        juce::uint8 data[3] = {0, 0, 0};
+        juce::uint8 releaseVelocity = 0;
+        juce::int16 device = 0;
+    };
+
+    /**
+     * Events in each pooled chunk.
+     */
+    static const int ChunkEvents = 2048;
+
+    /**
+     * Chunks one sequence can use, about 130K events.
+     */
+    static const int MaxChunks = 64;
+
+    /**
+     * Events between entries in the held note reach table.
+     */
+    static const int ReachStride = 32;
+
+    MidiPackedSequence();
+    ~MidiPackedSequence();
+
+    /**
+     * Return the chunks to the pool.
+     */
+    void clear(class MidiPackedChunkPool* pool);
+
+    /**
+     * Forget the chunks without returning them, for poolInit.
+     */
+    void reset();
+
+    void dump(class StructureDumper& d);
+
+    /**
+     * Replace the contents with a copy of a sequence.
+     * Returns false and leaves this empty if it can't be packed.
+     */
+    bool pack(class MidiPackedChunkPool* pool, class MidiSequence* src);
+
+    int size() {
+        return count;
+    }
+
+    inline Event& get(int index);
+
+    /**
+     * The index of the first event at or after a frame, size() if none.
+     */
+    int seek(int frame);
+
+    /**
+     * The index of the first event that may still be sounding at a frame.
+     */
+    int seekHeld(int frame);
+
+    bool isNoteOn(int index);
+    bool isNoteOff(int index);
+
+    /**
+     * Fill in a pooled event from a packed one.
+     */
+    void toEvent(int index, class MidiEvent* e);
+
+    juce::MidiMessage getMessage(int index);
+
+  private:
+
+    class MidiPackedChunk* chunks[MaxChunks];
+    int chunkCount = 0;
+    int count = 0;
+
+    int& getReach(int stretch);
+
+};
+
+/**
+ * A block of packed events and the reach table that covers them.
+ */
+class MidiPackedChunk : public PooledObject
+{
+  public:
+
+    static const int Stretches = MidiPackedSequence::ChunkEvents / MidiPackedSequence::ReachStride;
+
+    void poolInit() override {}
+
+    MidiPackedSequence::Event events[MidiPackedSequence::ChunkEvents];
+
+    // the last frame sounded by anything in each stretch of ReachStride events
+    int reach[Stretches];
+};
+
+class MidiPackedChunkPool : public ObjectPool
+{
+  public:
+
+    MidiPackedChunkPool();
+    virtual ~MidiPackedChunkPool();
+
+    class MidiPackedChunk* newChunk();
+
+  protected:
+
+    virtual PooledObject* alloc() override;
+
+};
+
+inline MidiPackedSequence::Event& MidiPackedSequence::get(int index)
+{
+    return chunks[index / ChunkEvents]->events[index % ChunkEvents];
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
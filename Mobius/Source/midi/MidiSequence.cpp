@@ -31,6 +31,14 @@ void MidiSequence::dump(StructureDumper& d)
     d.dec();
 }
 
+void MidiSequence::reserveIndex()
+{
+    if (indexCapacity == 0) {
+        index.ensureStorageAllocated(IndexCapacity);
+        indexCapacity = IndexCapacity;
+    }
+}
+
 /**
  * Pool cleanser
  */
@@ -51,6 +59,11 @@ void MidiSequence::reset()
     insertPosition = nullptr;
     count = 0;
     totalFrames = 0;
+    index.clearQuick();
+    stride = IndexStride;
+    indexValid = true;
+    reachValid = true;
+    unindexed = 0;
 }
 
 int MidiSequence::size()
@@ -92,9 +105,43 @@ void MidiSequence::clear(MidiEventPool* pool)
     reset();
 }
 
+/**
+ * The last frame an event sounds on.
+ */
+static int getLastFrame(MidiEvent* e)
+{
+    return (e->duration > 0) ? (e->frame + e->duration - 1) : e->frame;
+}
+
 void MidiSequence::add(MidiEvent* e)
 {
     if (e != nullptr) {
+        if (indexValid) {
+            if (tail != nullptr && e->frame < tail->frame) {
+                // not adding in order, this isn't really supposed
+                // to happen but it used to be allowed
+                invalidateIndex();
+            }
+            else if (index.size() == 0 || unindexed >= stride) {
+                if (index.size() < indexCapacity) {
+                    IndexEntry entry;
+                    entry.event = e;
+                    entry.reach = getLastFrame(e);
+                    index.add(entry);
+                    unindexed = 1;
+                }
+                else if (indexCapacity > 0) {
+                    // out of room, the next seek rebuilds with a wider stride
+                    invalidateIndex();
+                }
+            }
+            else {
+                IndexEntry& entry = index.getReference(index.size() - 1);
+                entry.reach = juce::jmax(entry.reach, getLastFrame(e));
+                unindexed++;
+            }
+        }
+        
         if (tail == nullptr) {
             if (events != nullptr)
               Trace(1, "MidiSequence: This is bad");
@@ -112,14 +159,16 @@ void MidiSequence::add(MidiEvent* e)
 void MidiSequence::insert(MidiEvent* e)
 {
     if (e != nullptr) {
-        if (insertPosition == nullptr) {
-            // never inserted before, start at the beginning
-            insertPosition = events;
-        }
-        else if (insertPosition->frame > e->frame) {
-            // last insert position was after the new event, start over
+        if (insertPosition == nullptr || insertPosition->frame > e->frame) {
+            // never inserted before, or the last insert position was after
+            // the new event, start over from the closest indexed event
             // since we can't go backward yet
             insertPosition = events;
+            if (!indexValid)
+              rebuildIndex();
+            int entry = findEntry(e->frame);
+            if (entry >= 0)
+              insertPosition = index[entry].event;
         }
     
         MidiEvent* prev = nullptr;
@@ -133,6 +182,10 @@ void MidiSequence::insert(MidiEvent* e)
             // inserting at the head
             e->next = events;
             events = e;
+            if (tail == nullptr)
+              tail = e;
+            // the index must start with the head
+            invalidateIndex();
         }
         else {
             MidiEvent* next = prev->next;
@@ -147,6 +200,12 @@ void MidiSequence::insert(MidiEvent* e)
         insertPosition = e;
 
         count++;
+
+        // inserts widen the gaps between index entries, once they get too
+        // wide start over
+        reachValid = false;
+        if (indexCapacity > 0 && count > (index.size() + 1) * stride * 2)
+          invalidateIndex();
     }
 }
 
@@ -182,6 +241,7 @@ void MidiSequence::remove(MidiEventPool* pool, MidiEvent* e)
         found->next = nullptr;
         pool->checkin(found);
         count--;
+        invalidateIndex();
     }
 }
 
@@ -260,6 +320,7 @@ void MidiSequence::transferFrom(MidiSequence* src)
         }
         
         count += src->size();
+        invalidateIndex();
     }
     src->reset();
 }
@@ -366,6 +427,7 @@ void MidiSequence::cut(MidiEventPool* pool, int start, int end, bool includeHold
 
     // this is usually invalid too
     insertPosition = nullptr;
+    invalidateIndex();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -425,6 +487,10 @@ void MidiSequence::insertTime(MidiEventPool* pool, int startFrame, int insertFra
         event->frame += insertFrames;
         event = event->next;
     }
+
+    // order is the same and the splits land between two events so the
+    // index still works, the reach of everything moved
+    reachValid = false;
 }
 
 /**
@@ -493,6 +559,13 @@ int MidiSequence::removeTime(MidiEventPool* pool, int startFrame, int removeFram
         event = event->next;
     }
 
+    // tail may have been removed
+    tail = events;
+    while (tail != nullptr && tail->next != nullptr)
+      tail = tail->next;
+    insertPosition = nullptr;
+    invalidateIndex();
+
     return adjustments;
 }
 
@@ -513,12 +586,129 @@ void MidiSequence::truncate(MidiEventPool* pool, int startFrame)
       events = nullptr;
     else
       prev->next = nullptr;
+    tail = prev;
 
     while (garbage != nullptr) {
         MidiEvent* next = garbage->next;
-        pool->checkin(event);
-        event = next;
+        garbage->next = nullptr;
+        pool->checkin(garbage);
+        count--;
+        garbage = next;
+    }
+
+    insertPosition = nullptr;
+    invalidateIndex();
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Index
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Don't rebuild until someone needs it, there may be several
+ * edits in a row.
+ */
+void MidiSequence::invalidateIndex()
+{
+    indexValid = false;
+    reachValid = false;
+}
+
+void MidiSequence::durationsChanged()
+{
+    reachValid = false;
+}
+
+/**
+ * The stride is chosen so the index is at most half full, leaving
+ * room for the sequence to double before it has to be rebuilt.
+ */
+void MidiSequence::rebuildIndex()
+{
+    index.clearQuick();
+    unindexed = 0;
+    stride = IndexStride;
+    if (indexCapacity > 0)
+      stride = juce::jmax(IndexStride, (count * 2) / indexCapacity + 1);
+    
+    for (MidiEvent* e = events ; e != nullptr && indexCapacity > 0 ; e = e->next) {
+        if (index.size() == 0 || unindexed >= stride) {
+            IndexEntry entry;
+            entry.event = e;
+            entry.reach = getLastFrame(e);
+            index.add(entry);
+            unindexed = 0;
+        }
+        else {
+            IndexEntry& entry = index.getReference(index.size() - 1);
+            entry.reach = juce::jmax(entry.reach, getLastFrame(e));
+        }
+        unindexed++;
+    }
+    indexValid = true;
+    reachValid = true;
+}
+
+/**
+ * Binary search for the last entry whose event is before a frame.
+ * Returns -1 if the frame is at or before the first event.
+ * Events on the same frame may span entries so this has to be
+ * strictly before to be sure it doesn't skip one.
+ */
+int MidiSequence::findEntry(int frame)
+{
+    int low = 0;
+    int high = index.size() - 1;
+    int found = -1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (index.getReference(mid).event->frame < frame) {
+            found = mid;
+            low = mid + 1;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+    return found;
+}
+
+MidiEvent* MidiSequence::seek(int frame)
+{
+    if (!indexValid)
+      rebuildIndex();
+
+    int entry = findEntry(frame);
+    MidiEvent* event = (entry >= 0) ? index.getReference(entry).event : events;
+    while (event != nullptr && event->frame < frame)
+      event = event->next;
+    return event;
+}
+
+/**
+ * Anything that starts after the frame can't be held, so this stops at the
+ * first entry that either reaches the frame or starts after it.  This is a
+ * linear scan of the index which is still much smaller than the list.
+ *
+ * If nothing is held this returns the first event at or after the frame,
+ * or null which callers treat the same as seek().
+ */
+MidiEvent* MidiSequence::seekHeld(int frame)
+{
+    if (!indexValid || !reachValid)
+      rebuildIndex();
+
+    MidiEvent* found = nullptr;
+    for (int i = 0 ; i < index.size() ; i++) {
+        IndexEntry& entry = index.getReference(i);
+        if (entry.reach >= frame || entry.event->frame > frame) {
+            found = entry.event;
+            break;
+        }
     }
+    return found;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -543,7 +733,9 @@ MidiSequencePool::~MidiSequencePool()
  */
 PooledObject* MidiSequencePool::alloc()
 {
-    return new MidiSequence();
+    MidiSequence* seq = new MidiSequence();
+    seq->reserveIndex();
+    return seq;
 }
 
 /**
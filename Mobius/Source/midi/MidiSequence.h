@@ -3,6 +3,19 @@
  *
  * Keeping it out here since it is potentially more general than Mobius and
  * would be useful elsewhere.
+ *
+ * Events are a linked list ordered by frame.  To avoid walking the list
+ * from the front every time the player jumps, an index of every IndexStride'th
+ * event is kept for binary search.  The index is just an ordered subset of the
+ * list so it survives inserts and time shifts, it only goes stale when events
+ * are removed and is rebuilt the next time someone seeks.
+ *
+ * Index storage is reserved once when the sequence is created by the pool
+ * or loaded from a file, and never grows after that, so adding events in
+ * the audio thread doesn't allocate.  When a sequence outgrows it the
+ * index is rebuilt with more events between entries.  Sequences that were
+ * never given storage, like temporary ones on the stack, aren't indexed
+ * and seeking walks the list.
  */
 
 #pragma once
@@ -22,6 +35,11 @@ class MidiSequence : public PooledObject
     void dump(class StructureDumper& d);
     void poolInit() override;
 
+    /**
+     * Allocate index storage, not for the audio thread.
+     */
+    void reserveIndex();
+
     class MidiEvent* getFirst() {
         return events;
     }
@@ -50,6 +68,24 @@ class MidiSequence : public PooledObject
     void insertTime(class MidiEventPool* pool, int startFrame, int insertFrames);
     int removeTime(class MidiEventPool* pool, int startFrame, int removeFrames);
     void truncate(class MidiEventPool* pool, int startFrame);
+
+    /**
+     * Return the first event at or after a frame.
+     */
+    class MidiEvent* seek(int frame);
+
+    /**
+     * Return the first event that may still be sounding at a frame.
+     * Events between this one and the frame may not be, but nothing
+     * before it is.
+     */
+    class MidiEvent* seekHeld(int frame);
+
+    /**
+     * Called when note durations were changed by something other than
+     * the sequence, usually the recorder closing held notes.
+     */
+    void durationsChanged();
     
   protected:
     
@@ -71,11 +107,42 @@ class MidiSequence : public PooledObject
     // which may contain empty space after the last event
     int totalFrames = 0;
 
+    /**
+     * Minimum events between index entries.
+     */
+    static const int IndexStride = 32;
+
+    /**
+     * Index entries reserved for each sequence, at the minimum stride
+     * that covers 16K events before the stride has to widen.
+     */
+    static const int IndexCapacity = 512;
+
+    class IndexEntry
+    {
+      public:
+        class MidiEvent* event = nullptr;
+        // the last frame sounded by anything from this event up to the next entry
+        int reach = 0;
+    };
+
+    // storage is reserved up front and retained when pooled
+    // sequences are reused
+    juce::Array<IndexEntry> index;
+    int indexCapacity = 0;
+    int stride = IndexStride;
+    bool indexValid = true;
+    bool reachValid = true;
+    int unindexed = 0;
+
     // todo: might be interesting to capture other things from the midi file
     // or add a MidiFile wrapper that has all this since sequences don't need it
     // at runtime
 
     void reset();
+    void invalidateIndex();
+    void rebuildIndex();
+    int findEntry(int frame);
     
 };
 
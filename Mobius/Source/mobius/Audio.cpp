@@ -136,6 +136,7 @@ void Audio::init()
 	mBufferCount = 0;
 	mStartFrame = 0;
 	mFrames = 0;
+	mPeakChanges = 0;
 
 	mPlay = NEW2(AudioCursor, "Play", this);
 	mRecord = NEW2(AudioCursor, "Record", this);
@@ -533,6 +534,7 @@ void Audio::setFrames(long frames)
 					// happen very often
 					int bytes = (mBufferSize - offset) * sizeof(float);
 					memset(&buffer[offset], 0, bytes);
+					clearPeaks(buffer, offset / mChannels, mBufferSize / mChannels);
 				}
 
 				// then release any remaining buffers
@@ -636,6 +638,7 @@ void Audio::setStartFrame(long frame)
 					// happen often enough to be worth optimizing?
 					int bytes = offset * sizeof(float);
 					memset(buffer, 0, bytes);
+					clearPeaks(buffer, 0, offset / mChannels);
 				}
 			
 				// then release any remaining buffers
@@ -948,6 +951,13 @@ void Audio::copy(Audio* src, int feedback)
 
 					memcpy(destb, srcb, mBufferSize * sizeof(float));
 					applyFeedback(destb, feedback);
+
+					if (mPool != nullptr && src->mPool != nullptr) {
+						float scale = 1.0f;
+						if (feedback < 127 && feedback >= 0)
+						  scale = AudioFade::getRamp128()[feedback];
+						AudioPool::getPeaks(destb)->copy(AudioPool::getPeaks(srcb), scale);
+					}
 				}
 			}
 		}
@@ -971,6 +981,80 @@ void Audio::applyFeedback(float* buffer, int feedback)
 	}
 }
 
+/****************************************************************************
+ *                                                                          *
+ *   							WAVEFORM PEAKS                              *
+ *                                                                          *
+ ****************************************************************************/
+
+/**
+ * Return the peaks for the buffers covering the valid frames.
+ * Missing buffers are returned as nullptr and are silent.
+ * The offset is the frame within the first block where frame zero is.
+ * This does not allocate, the caller provides the array.
+ */
+int Audio::getPeaks(WavePeaks** blocks, int max, int* offset)
+{
+	int count = 0;
+	*offset = 0;
+	if (mPool != nullptr && mFrames > 0 && mBuffers != nullptr) {
+		long framesPerBuffer = mBufferSize / mChannels;
+		int first = (int)(mStartFrame / framesPerBuffer);
+		int last = (int)((mStartFrame + mFrames - 1) / framesPerBuffer);
+		*offset = (int)(mStartFrame % framesPerBuffer);
+
+		for (int i = first ; i <= last && count < max ; i++) {
+			float* buffer = getBuffer(i);
+			blocks[count] = (buffer != nullptr) ? AudioPool::getPeaks(buffer) : nullptr;
+			count++;
+		}
+	}
+	return count;
+}
+
+int Audio::getPeakChanges()
+{
+	return mPeakChanges;
+}
+
+/**
+ * Recalculate the peaks for a range of frames after it was modified
+ * by something other than a cursor.  Only the buckets covering the
+ * range are scanned.
+ */
+void Audio::rebuildPeaks(long startFrame, long endFrame)
+{
+	if (mPool != nullptr && startFrame < endFrame) {
+		long framesPerBuffer = mBufferSize / mChannels;
+		long first = (mStartFrame + startFrame) / framesPerBuffer;
+		long last = (mStartFrame + endFrame - 1) / framesPerBuffer;
+		for (long i = first ; i <= last && i < mBufferCount ; i++) {
+			float* buffer = mBuffers[i];
+			if (buffer != nullptr) {
+				long base = i * framesPerBuffer;
+				long start = mStartFrame + startFrame - base;
+				long end = mStartFrame + endFrame - base;
+				if (start < 0) start = 0;
+				if (end > framesPerBuffer) end = framesPerBuffer;
+				AudioPool::getPeaks(buffer)->rebuild(buffer, mChannels, (int)start, (int)end);
+			}
+		}
+		mPeakChanges++;
+	}
+}
+
+/**
+ * Adjust the peaks for one buffer after a range of it was zeroed.
+ * Frames are relative to the buffer.
+ */
+void Audio::clearPeaks(float* buffer, int startFrame, int endFrame)
+{
+	if (mPool != nullptr) {
+		AudioPool::getPeaks(buffer)->clear(buffer, mChannels, startFrame, endFrame);
+		mPeakChanges++;
+	}
+}
+
 /****************************************************************************
  *                                                                          *
  *   							 DIAGNOSTICS                                *
@@ -1253,6 +1337,9 @@ void Audio::insert(Audio* audio, long insertFrame)
 
             setFrames(mFrames + newFrames);
 			mVersion++;
+			// only the shifted frames changed, this costs about
+			// the same as the shift
+			rebuildPeaks(insertFrame, mFrames);
 
             // Now replace the opened area
 			put(audio, insertFrame);
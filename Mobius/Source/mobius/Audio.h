@@ -327,6 +327,7 @@ class AudioCursor {
 	void prepareFrame();
 	void locateFrame();
 	void incFrame();
+	void flushPeak();
 	void get(AudioBuffer* buf, float* dest, float modifier);
 
 	char* mName;
@@ -361,6 +362,16 @@ class AudioCursor {
      */
     bool mOverflowTraced;
 
+	/**
+	 * The range of the level zero peak bucket being accumulated by put().
+	 * Offsets are in samples within mPeakBuffer.
+	 */
+	float* mPeakBuffer;
+	int mPeakStart;
+	int mPeakEnd;
+	float mPeakLow;
+	float mPeakHigh;
+
 };
 
 /****************************************************************************
@@ -451,6 +462,12 @@ class Audio {
 
 	void fadeEdges();
 
+	// Waveform peaks
+
+	int getPeaks(class WavePeaks** blocks, int max, int* offset);
+	int getPeakChanges();
+	void rebuildPeaks(long startFrame, long endFrame);
+
 	// Diagnostics
 
 	void dump();
@@ -481,6 +498,7 @@ class Audio {
 	bool isEmpty(float* buffer);
 	void setStartFrame(long frame);
 	void applyFeedback(float* buffer, int feedback);
+	void clearPeaks(float* buffer, int startFrame, int endFrame);
 
 	// allow these to be directly accessible by AudioCursor
 
@@ -560,6 +578,12 @@ class Audio {
 	AudioCursor* mPlay;
 	AudioCursor* mRecord;
 
+	/**
+	 * Incremented by AudioCursor whenever the peaks of any buffer widen,
+	 * lets the UI know the waveform needs to be redrawn.
+	 */
+	int mPeakChanges;
+
 };
 
 /****************************************************************************/
@@ -20,6 +20,7 @@
 //#include <math.h>
 
 #include "Audio.h"
+#include "AudioPool.h"
 #include "core/Mem.h"
 
 /****************************************************************************
@@ -494,6 +495,11 @@ void AudioCursor::init()
 	mAutoExtend = false;
     mOverflowTraced = false;
 	mFade.init();
+	mPeakBuffer = nullptr;
+	mPeakStart = 0;
+	mPeakEnd = 0;
+	mPeakLow = 0.0f;
+	mPeakHigh = 0.0f;
 }
 
 void AudioCursor::setName(const char* name)
@@ -854,17 +860,33 @@ void AudioCursor::put(AudioBuffer* buf, AudioOp op)
 		// since we're recording, have to flesh out the buffers as we go
 		prepareFrame();
 
+		// start a new peak bucket if we crossed into another one
+		if (mBuffer != mPeakBuffer || mBufferOffset < mPeakStart ||
+			mBufferOffset >= mPeakEnd) {
+			flushPeak();
+			int bucketSamples = WavePeaks::BaseFrames * mAudio->mChannels;
+			mPeakBuffer = mBuffer;
+			mPeakStart = (mBufferOffset / bucketSamples) * bucketSamples;
+			mPeakEnd = mPeakStart + bucketSamples;
+		}
+
 		for (int j = 0 ; j < channels ; j++) {
 			float sample = (src != nullptr) ? src[j] : 0.0f;
 
 			sample = mFade.fade(sample);
 
+			float* loc = &(mBuffer[mBufferOffset + j]);
 			if (op == OpReplace)
-			  mBuffer[mBufferOffset + j] = sample;
+			  *loc = sample;
 			else if (op == OpRemove)
-			  mBuffer[mBufferOffset + j] -= sample;
+			  *loc -= sample;
 			else
-			  mBuffer[mBufferOffset + j] += sample;
+			  *loc += sample;
+
+			if (*loc < mPeakLow)
+			  mPeakLow = *loc;
+			else if (*loc > mPeakHigh)
+			  mPeakHigh = *loc;
 		}
 		
 		incFrame();
@@ -872,6 +894,28 @@ void AudioCursor::put(AudioBuffer* buf, AudioOp op)
 		if (src != nullptr)
 		  src += channels;
 	}
+
+	// don't hold on to the buffer between calls, it may be freed
+	flushPeak();
+}
+
+/**
+ * Fold the range accumulated by put() into the peaks for the buffer.
+ * This happens once per level zero bucket rather than once per frame.
+ * Peaks are only kept for pooled buffers.
+ */
+void AudioCursor::flushPeak()
+{
+	if (mPeakBuffer != nullptr) {
+		if (mAudio->mPool != nullptr) {
+			WavePeaks* peaks = AudioPool::getPeaks(mPeakBuffer);
+			if (peaks->widen(mPeakStart / mAudio->mChannels, mPeakLow, mPeakHigh))
+			  mAudio->mPeakChanges++;
+		}
+		mPeakBuffer = nullptr;
+	}
+	mPeakLow = 0.0f;
+	mPeakHigh = 0.0f;
 }
 
 void AudioCursor::put(AudioBuffer* buf, AudioOp op, long frame)
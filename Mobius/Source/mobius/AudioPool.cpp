@@ -12,6 +12,9 @@
 
 #include "core/Mem.h"
 
+static_assert(WavePeaks::BlockFrames == FRAMES_PER_BUFFER,
+              "WavePeaks block size must match the Audio buffer size");
+
 /**
  * Create an initially empty audio pool.
  * There is normally only one of these in a Mobius instance.
@@ -122,6 +125,7 @@ float* AudioPool::newBuffer()
     // !! these are big, need to keep the list clean and do it
     // in a worker thread
     memset(buffer, 0, BUFFER_SIZE * sizeof(float));
+    getPeaks(buffer)->reset();
 
     //	}
 
@@ -158,6 +162,15 @@ void AudioPool::freeBuffer(float* buffer)
 	}
 }
 
+/**
+ * Locate the peaks for a buffer.  The buffer must have come from newBuffer.
+ */
+WavePeaks* AudioPool::getPeaks(float* buffer)
+{
+    OldPooledBuffer* pb = (OldPooledBuffer*)(((char*)buffer) - sizeof(OldPooledBuffer));
+    return &(pb->peaks);
+}
+
 void AudioPool::dump()
 {
 	//if (mNewPool != nullptr) {
@@ -10,6 +10,8 @@
 // for CriticalSection, unfortunate that the users will drag that in
 #include <JuceHeader.h>
 
+#include "../model/WavePeaks.h"
+
 /**
  * This structure is allocated at the top of every Audio buffer.
  */
@@ -19,6 +21,9 @@ struct OldPooledBuffer {
 	OldPooledBuffer* next;
 	int pooled;
 
+    // waveform summary of the samples that follow
+    WavePeaks peaks;
+
 };
 
 class AudioPool {
@@ -38,6 +43,9 @@ class AudioPool {
     float* newBuffer();
     void freeBuffer(float* b);
 
+    // peaks in the header of a buffer allocated by newBuffer
+    static WavePeaks* getPeaks(float* buffer);
+
   private:
 
     //class CriticalSection* mCsect;
@@ -0,0 +1,138 @@
+/**
+ * Implementation of the oversized block splitter.
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/Trace.h"
+
+#include "MobiusInterface.h"
+#include "BlockSplitter.h"
+
+/**
+ * Bytes of MIDI data reserved for one piece.  If a host sends more
+ * than this in a single block the extra messages may allocate.
+ */
+const int BlockSplitterMidiBytes = 8192;
+
+BlockSplitter::BlockSplitter()
+{
+    midi.ensureSize(BlockSplitterMidiBytes);
+}
+
+BlockSplitter::~BlockSplitter()
+{
+}
+
+void BlockSplitter::setSource(MobiusAudioStream* src)
+{
+    source = src;
+    sourceFrames = src->getInterruptFrames();
+    offset = 0;
+    length = 0;
+    previousOffset = 0;
+}
+
+/**
+ * The piece only has a MIDI buffer if the source does, so the
+ * kernel sends to the host in the same cases it would without splitting.
+ */
+bool BlockSplitter::next(int maxFrames)
+{
+    previousOffset = offset;
+    offset += length;
+    length = juce::jmin(maxFrames, sourceFrames - offset);
+
+    bool more = (length > 0);
+    if (more) {
+        midi.clear();
+        hasMidi = (source->getMidiMessages() != nullptr);
+    }
+    return more;
+}
+
+int BlockSplitter::getOffset()
+{
+    return offset;
+}
+
+/**
+ * The source buffer still has the host's input, which is left
+ * there as it is when the block isn't split.
+ */
+void BlockSplitter::returnMidi()
+{
+    if (hasMidi && !midi.isEmpty()) {
+        juce::MidiBuffer* all = source->getMidiMessages();
+        if (all != nullptr)
+          all->addEvents(midi, 0, -1, offset);
+    }
+}
+
+int BlockSplitter::getSampleRate()
+{
+    return source->getSampleRate();
+}
+
+int BlockSplitter::getInterruptFrames()
+{
+    return length;
+}
+
+void BlockSplitter::getInterruptBuffers(int inport, float** input,
+                                        int outport, float** output)
+{
+    source->getInterruptBuffers(inport, input, outport, output);
+    if (input != nullptr && *input != nullptr)
+      *input += (offset * 2);
+    if (output != nullptr && *output != nullptr)
+      *output += (offset * 2);
+}
+
+bool BlockSplitter::getPlanarInput(int port, const float** left, const float** right)
+{
+    bool available = source->getPlanarInput(port, left, right);
+    if (available) {
+        *left += offset;
+        *right += offset;
+    }
+    return available;
+}
+
+float* BlockSplitter::getTrackOutputBuffer(int trackNumber)
+{
+    float* buffer = source->getTrackOutputBuffer(trackNumber);
+    if (buffer != nullptr)
+      buffer += (offset * 2);
+    return buffer;
+}
+
+juce::MidiBuffer* BlockSplitter::getMidiMessages()
+{
+    return (hasMidi) ? &midi : nullptr;
+}
+
+double BlockSplitter::getStreamTime()
+{
+    double time = source->getStreamTime();
+    int rate = source->getSampleRate();
+    if (rate > 0)
+      time += (double)offset / (double)rate;
+    return time;
+}
+
+double BlockSplitter::getLastInterruptStreamTime()
+{
+    double time = source->getLastInterruptStreamTime();
+    if (offset > 0) {
+        int rate = source->getSampleRate();
+        time = source->getStreamTime();
+        if (rate > 0)
+          time += (double)previousOffset / (double)rate;
+    }
+    return time;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,80 @@
+/**
+ * Wraps a MobiusAudioStream whose block is larger than the core can
+ * handle and presents it to the kernel as a series of smaller blocks.
+ *
+ * The core streams, fade tails, segments and layers are all sized for
+ * AUDIO_MAX_FRAMES_PER_BUFFER and a larger block would overrun them.
+ * Hosts are supposed to tell prepareToPlay the largest block they will
+ * send, but some don't, so MobiusKernel runs anything larger through
+ * this one piece at a time.
+ *
+ * Unlike AudioStreamSlicer this is the stream the whole kernel sees,
+ * so stream time moves forward with each piece.  MIDI input from the
+ * host was staged by the kernel before splitting, so the MIDI buffer for
+ * a piece starts empty and collects what the kernel sends to the host.
+ * That is added to the host's buffer at the piece offset when the piece
+ * is done.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "MobiusInterface.h"
+
+class BlockSplitter : public MobiusAudioStream
+{
+  public:
+
+    BlockSplitter();
+    ~BlockSplitter();
+
+    /**
+     * Start splitting a block from the container.
+     */
+    void setSource(MobiusAudioStream* src);
+
+    /**
+     * Select the next piece, returns false when there are no more.
+     */
+    bool next(int maxFrames);
+
+    /**
+     * Where the current piece starts in the source block.
+     */
+    int getOffset();
+
+    /**
+     * Add the MIDI sent during the current piece to the source.
+     */
+    void returnMidi();
+
+    // MobiusAudioStream
+    int getSampleRate() override;
+	int getInterruptFrames() override;
+	void getInterruptBuffers(int inport, float** input,
+                             int outport, float** output) override;
+    bool getPlanarInput(int port, const float** left, const float** right) override;
+    float* getTrackOutputBuffer(int trackNumber) override;
+    juce::MidiBuffer* getMidiMessages() override;
+    double getStreamTime() override;
+    double getLastInterruptStreamTime() override;
+
+  private:
+
+    MobiusAudioStream* source = nullptr;
+    int sourceFrames = 0;
+    int offset = 0;
+    int length = 0;
+    int previousOffset = 0;
+
+    // messages sent to the host during the current piece, reserved
+    // up front so filling it doesn't allocate in the audio thread
+    juce::MidiBuffer midi;
+    bool hasMidi = false;
+
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
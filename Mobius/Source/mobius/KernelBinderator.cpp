@@ -1,6 +1,7 @@
 /**
  * Wrapper around Binderator for mapping MIDI events received
- * in the plugin audio thread into actions.
+ * in the audio thread into actions, from the plugin host or from
+ * the MidiManager input queue.
  *
  * todo: this didn't end up doing much compared to ApplicationBindertor
  * could just have MobiusKernel use a Binderator directly.
@@ -20,23 +21,23 @@ KernelBinderator::KernelBinderator(MobiusKernel* k)
 
 KernelBinderator::~KernelBinderator()
 {
-    // assuming that if we're destructing we're in a safe
-    // context to do memory allocation
-    delete binderator;
+    // the Binderator belongs to KernelPublisher
 }
 
 /**
  * Swap a previously constructed Binderator with the one
  * we have been using.
+ *
+ * The new one was compiled by Supervisor and arrives in a ConfigPayload
+ * adopted at the start of a block, so nothing can be using the old one.
+ * The shell deletes it after the kernel moves past the epoch.
  */
-Binderator* KernelBinderator::install(Binderator* b)
+void KernelBinderator::install(Binderator* b)
 {
-    Binderator* old = binderator;
     binderator = b;
-    return old;
 }
 
-UIAction* KernelBinderator::getMidiAction(juce::MidiMessage& msg)
+UIAction* KernelBinderator::getMidiAction(const juce::MidiMessage& msg)
 {
     UIAction* action = nullptr;
     if (binderator != nullptr)
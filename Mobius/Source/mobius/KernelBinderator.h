@@ -1,6 +1,7 @@
 /**
  * Wrapper around Binderator for mapping MIDI events received
- * in the plugin audio thread into actions.
+ * in the audio thread into actions, from the plugin host or from
+ * the MidiManager input queue.
  */
 
 #pragma once
@@ -12,9 +13,9 @@ class KernelBinderator
     KernelBinderator(class MobiusKernel* kernel);
     ~KernelBinderator();
 
-    class Binderator* install(class Binderator* b);
+    void install(class Binderator* b);
 
-    class UIAction* getMidiAction(juce::MidiMessage& msg);
+    class UIAction* getMidiAction(const juce::MidiMessage& msg);
 
   private:
 
@@ -23,6 +24,7 @@ class KernelBinderator
     // unlike ApplicationBinderator this has to be
     // built and passed down whenever it changes so we use
     // a pointer rather than a static member
+    // it is owned by KernelPublisher
     class Binderator* binderator = nullptr;
 
 };
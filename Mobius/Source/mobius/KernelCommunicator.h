@@ -29,8 +29,8 @@
 /**
  * The types of messages
  *
- * Configure and Samples message are sent by the shell to the kernel
- * to update configuration objects.
+ * Configuration objects used to be sent down as messages too, they
+ * now go through KernelPublisher.
  *
  * Action messages are sent from shell to kernel to perform an action.
  *
@@ -41,11 +41,7 @@
 typedef enum {
 
     MsgNone = 0,
-    MsgConfigure,
     MsgAction,
-    MsgSamples,
-    MsgScripts,
-    MsgBinderator,
     MsgEvent,
     MsgLoadLoop,
     MsgMidi,
@@ -61,11 +57,7 @@ typedef enum {
 typedef union {
 
     void* pointer;
-    class ConfigPayload* payload;
     class UIAction* action;
-    class SampleManager* samples;
-    class Scriptarian* scripts;
-    class Binderator* binderator;
     class KernelEvent* event;
     class Audio* audio;
     class MidiEvent* midi;
@@ -198,6 +190,11 @@ class KernelCommunicator
     // only for shell maintenance
     void checkCapacity();
     void traceStatistics();
+
+    // kernel uses this to tell when it sent something during a block
+    int getKernelSends() {
+        return totalKernelSends;
+    }
     
   private:
 
@@ -0,0 +1,167 @@
+/**
+ * Implementation of the configuration hand-off between the
+ * shell and the kernel.
+ */
+
+#include <JuceHeader.h>
+
+#include "../model/ConfigPayload.h"
+#include "../model/Session.h"
+#include "../model/SessionDiff.h"
+#include "../model/ParameterSets.h"
+#include "../model/GroupDefinition.h"
+#include "../Binderator.h"
+
+#include "core/Scriptarian.h"
+#include "track/LogicalTrack.h"
+#include "SampleManager.h"
+
+#include "KernelPublisher.h"
+
+KernelPublisher::KernelPublisher()
+{
+    current.reset(new Generation());
+}
+
+KernelPublisher::~KernelPublisher()
+{
+    flush();
+}
+
+/**
+ * Retired objects and payloads are always deleted here in the shell.
+ * The objects in the payload itself belong to another generation
+ * by now, only the things that travelled with it go.
+ */
+KernelPublisher::Generation::~Generation()
+{
+    if (payload != nullptr) {
+        delete payload->diffs;
+        // prepared tracks the kernel didn't need and
+        // the ones it removed
+        for (auto lt : payload->tracks)
+          delete lt;
+        for (auto lt : payload->retired)
+          delete lt;
+        delete payload;
+    }
+    delete session;
+    delete parameters;
+    delete groups;
+    delete samples;
+    delete scripts;
+    delete binderator;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Shell
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Whatever the payload replaces is retired with its epoch, which is
+ * the first publication that doesn't include it.  If the kernel
+ * hasn't taken the last one yet this goes on the list with it, it
+ * doesn't replace it since payloads are sparse and a Session
+ * diff only makes sense after the Session before it.
+ */
+void KernelPublisher::publish(ConfigPayload* p)
+{
+    if (p != nullptr) {
+        const juce::ScopedLock lock(criticalSection);
+
+        p->epoch = ++publications;
+
+        Generation* old = new Generation();
+        old->epoch = p->epoch;
+        old->payload = p;
+
+        if (p->session != nullptr) {
+            old->session = current->session;
+            current->session = p->session;
+        }
+        if (p->parameters != nullptr) {
+            old->parameters = current->parameters;
+            current->parameters = p->parameters;
+        }
+        if (p->groups != nullptr) {
+            old->groups = current->groups;
+            current->groups = p->groups;
+        }
+        if (p->samples != nullptr) {
+            old->samples = current->samples;
+            current->samples = p->samples;
+        }
+        if (p->scripts != nullptr) {
+            old->scripts = current->scripts;
+            current->scripts = p->scripts;
+        }
+        if (p->binderator != nullptr) {
+            old->binderator = current->binderator;
+            current->binderator = p->binderator;
+        }
+        retired.add(old);
+
+        p->next = pending.load();
+        while (!pending.compare_exchange_weak(p->next, p)) {}
+    }
+}
+
+void KernelPublisher::reclaim()
+{
+    const juce::ScopedLock lock(criticalSection);
+
+    int epoch = kernelEpoch.load();
+    int index = 0;
+    while (index < retired.size()) {
+        if (retired[index]->epoch <= epoch) {
+            retired.remove(index);
+            reclaimed++;
+        }
+        else {
+            index++;
+        }
+    }
+}
+
+/**
+ * Payloads the kernel never took are held by the generations
+ * they retired, so clearing those is enough.
+ */
+void KernelPublisher::flush()
+{
+    const juce::ScopedLock lock(criticalSection);
+
+    pending.store(nullptr);
+    retired.clear();
+    current.reset(new Generation());
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Kernel
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * The list is pushed newest first, turn it around so Sessions are
+ * seen in the order they were sent.  This only touches the next
+ * pointers, the shell doesn't use them again.
+ */
+ConfigPayload* KernelPublisher::adopt()
+{
+    ConfigPayload* list = pending.exchange(nullptr);
+    ConfigPayload* ordered = nullptr;
+    while (list != nullptr) {
+        ConfigPayload* next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    return ordered;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
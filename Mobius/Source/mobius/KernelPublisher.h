@@ -0,0 +1,134 @@
+/**
+ * Hands configuration objects from the shell to the kernel and decides
+ * when the ones they replace can be deleted.
+ *
+ * Everything the kernel is configured with arrives in a ConfigPayload:
+ * Session, ParameterSets, GroupDefinitions, SampleManager, Scriptarian,
+ * and the Binderator.  A payload is sparse, anything left null means
+ * keep what you have.  Once published the shell doesn't change it.
+ *
+ * The shell owns every object in every payload for their entire life.
+ * The kernel only borrows them, so it never has anything to give back
+ * and never deletes anything when the configuration changes.
+ *
+ * Publishing gives the payload the next epoch number and pushes it on
+ * a list the kernel takes with a single exchange at the start of a block.
+ * The objects it replaces are retired with that epoch.  After the kernel
+ * has adopted a payload and let go of everything it replaced, it stores
+ * the epoch, and the shell deletes anything retired at or before it the
+ * next time it reclaims.
+ *
+ * The kernel may hold back the epoch when something it replaced is still
+ * in use, which happens when Mobius waits for running scripts to finish
+ * before installing a new Scriptarian.
+ *
+ * This is the same arrangement MslEnvironment uses for the linkage table.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class KernelPublisher
+{
+  public:
+
+    KernelPublisher();
+    ~KernelPublisher();
+
+    //
+    // Shell
+    //
+
+    /**
+     * Give a payload to the kernel.  Ownership of the payload and
+     * everything in it transfers to the publisher.
+     */
+    void publish(class ConfigPayload* p);
+
+    /**
+     * Delete anything the kernel can no longer reach.
+     * Called periodically by the maintenance thread.
+     */
+    void reclaim();
+
+    /**
+     * Delete everything, including the objects the kernel is using.
+     * Only for MobiusKernel during destruction.
+     */
+    void flush();
+
+    int getPublications() {
+        return publications;
+    }
+
+    int getRetired() {
+        return retired.size();
+    }
+
+    int getReclaimed() {
+        return reclaimed;
+    }
+
+    //
+    // Kernel
+    //
+
+    /**
+     * Take everything published since the last call, in the order
+     * it was published.
+     */
+    class ConfigPayload* adopt();
+
+    /**
+     * Tell the shell the kernel no longer uses anything retired
+     * at or before this epoch.
+     */
+    void setKernelEpoch(int epoch) {
+        kernelEpoch.store(epoch);
+    }
+
+    int getKernelEpoch() {
+        return kernelEpoch.load();
+    }
+
+  private:
+
+    /**
+     * The objects introduced or retired by one publication.
+     * The payload is kept with the retired objects since the kernel
+     * reads it while adopting, and the diffs and any prepared
+     * tracks it didn't use are deleted with it.
+     */
+    class Generation
+    {
+      public:
+        ~Generation();
+        int epoch = 0;
+        class ConfigPayload* payload = nullptr;
+        class Session* session = nullptr;
+        class ParameterSets* parameters = nullptr;
+        class GroupDefinitions* groups = nullptr;
+        class SampleManager* samples = nullptr;
+        class Scriptarian* scripts = nullptr;
+        class Binderator* binderator = nullptr;
+    };
+
+    // shell side state, publish can happen in the UI thread and
+    // reclaim in the maintenance thread
+    juce::CriticalSection criticalSection;
+    int publications = 0;
+    int reclaimed = 0;
+    std::unique_ptr<Generation> current;
+    juce::OwnedArray<Generation> retired;
+
+    // payloads waiting for the kernel, newest first
+    std::atomic<class ConfigPayload*> pending {nullptr};
+
+    // last epoch the kernel has completely moved past
+    std::atomic<int> kernelEpoch {0};
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
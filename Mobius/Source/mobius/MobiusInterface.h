@@ -126,17 +126,11 @@ class MobiusInterface {
     
     /**
      * Refresh the primary system state immediately after initialize()
-     * Unlike requestState this is a synchronous operation and can only happen
+     * and begin publishing it to the buffer periodically from the audio
+     * thread.  The initial refresh is a synchronous operation and can only happen
      * during initialization or when the kernel is suspended.
      */
-    virtual void initializeState(class SystemState* state) = 0;
-    
-    /**
-     * Request an asynchronous refresh of the system state.
-     * The state will be refreshed on the next audio block and sent back
-     * with a MobiusListener notification.
-     */
-    virtual void requestState(class SystemState* state) = 0;
+    virtual void initializeState(class SystemStateBuffer* states) = 0;
     
     /**
      * Refresh and return the high-resolution state.
@@ -447,9 +441,30 @@ class MobiusContainer
     // proper abstraction here
     virtual class MidiManager* getMidiManager() = 0;
 
+    /**
+     * Queues between the MIDI devices and the kernel.  The kernel
+     * reads device input and sends timed device output through these
+     * rather than going through MidiManager.
+     */
+    virtual class MidiInputQueue* getMidiInputQueue() = 0;
+    virtual class MidiOutputQueue* getMidiOutputQueue() = 0;
+
     // only for SyncMaster/HostAnalyzer
     virtual juce::AudioProcessor* getAudioProcessor() = 0;
 
+    /**
+     * Called from the audio thread at the end of a block when the
+     * kernel sent messages to the shell.  The container should arrange
+     * for MobiusInterface::performMaintenance to be called soon.
+     */
+    virtual void notifyKernelMessages() = 0;
+
+    /**
+     * Called from the audio thread when a new SystemState has
+     * been published.
+     */
+    virtual void notifyStatePublished() = 0;
+
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -543,11 +558,6 @@ class MobiusListener {
      */
     virtual void mobiusMidiReceived(juce::MidiMessage& msg) = 0;
 
-    /**
-     * A SystemState refresh has been completed.
-     */
-    virtual void mobiusStateRefreshed(class SystemState* state) = 0;
-
     /**
      * The engine would like to change the focused track.
      * This happens after processing a NextTrack/PrevTrack/SelectTrack
@@ -807,9 +817,36 @@ class MobiusAudioStream
      * Access the interleaved input and output buffers for a "port".
      * Ports are arrangements of stereo pairs of mono channels.
      */
-	virtual void getInterruptBuffers(int inport, float** input, 
+	virtual void getInterruptBuffers(int inport, float** input,
                                      int outport, float** output) = 0;
-    
+
+    /**
+     * Optional direct access to the non-interleaved channels of an input port.
+     * When this returns true the left and right pointers reference the
+     * host's own channel buffers for the current block and the caller may
+     * read them without forcing the port to be interleaved.  Returns false
+     * if the stream doesn't have planar buffers, or if something in this
+     * block already asked for the interleaved input, since that copy may
+     * have been modified by sample injection.
+     */
+    virtual bool getPlanarInput(int port, const float** left, const float** right) {
+        (void)port;
+        (void)left;
+        (void)right;
+        return false;
+    }
+
+    /**
+     * Optional interleaved buffer that receives the output of one
+     * audio track, in addition to the track's output port.
+     * Used by Freewheeler to render stems.  Streams connected to devices
+     * don't need this and return nullptr.
+     */
+    virtual float* getTrackOutputBuffer(int trackNumber) {
+        (void)trackNumber;
+        return nullptr;
+    }
+
     /**
      * Receive the MIDI messages queued for processing during this stream
      * cycle.  This is only used when running as a plugin and Binderator
@@ -21,6 +21,7 @@
 #include "../model/SampleProperties.h"
 #include "../model/ScriptProperties.h"
 #include "../model/SystemState.h"
+#include "../model/SystemStateBuffer.h"
 
 #include "../script/MslEnvironment.h"
 #include "../script/MslContext.h"
@@ -30,12 +31,15 @@
 #include "../script/ScriptExternals.h"
 
 #include "../Binderator.h"
+#include "../midi/MidiInputQueue.h"
+#include "../midi/MidiOutputQueue.h"
 #include "../PluginParameter.h"
 #include "../Parametizer.h"
 #include "../MslUtil.h"
 
 #include "MobiusInterface.h"
 #include "MobiusShell.h"
+#include "KernelPublisher.h"
 
 #include "Audio.h"
 #include "SampleManager.h"
@@ -43,6 +47,7 @@
 
 // drag this bitch in
 #include "core/Mobius.h"
+#include "core/AudioConstants.h"
 #include "core/Function.h"
 #include "core/Action.h"
 #include "core/Mem.h"
@@ -78,6 +83,10 @@ MobiusKernel::MobiusKernel(MobiusShell* argShell, KernelCommunicator* comm)
     communicator = comm;
     // something we did for leak debugging
     Mobius::initStaticObjects();
+
+    // room for a few hundred short messages per device each block
+    for (int i = 0 ; i < MaxMidiOutputs ; i++)
+      midiOutputs[i].ensureSize(2048);
 }
 
 void MobiusKernel::setListener(MobiusListener* l)
@@ -103,12 +112,16 @@ void MobiusKernel::setMidiListener(MobiusMidiListener* l)
 MobiusKernel::~MobiusKernel()
 {
     Trace(2, "MobiusKernel: Destructing\n");
-    delete sampleManager;
     
     // old interface wanted a shutdown method not in the destructor
     // revisit this
     if (mCore != nullptr) {
         mCore->shutdown();
+        // configuration objects belong to the publisher, the Scriptarian
+        // needs to go after shutdown but before the core the way it did
+        // when Mobius owned it
+        if (publisher != nullptr)
+          publisher->flush();
         delete mCore;
     }
 
@@ -117,11 +130,8 @@ MobiusKernel::~MobiusKernel()
     if (container != nullptr && !container->isPlugin())
       Mobius::freeStaticObjects();
 
-    // we do not own shell, communicator, or container
-    // use a unique_ptr here!!
-    delete groups;
-    delete parameters;
-    delete session;
+    // we do not own shell, communicator, container, or anything
+    // that came from the publisher
 
     // stop listening
     if (container != nullptr)
@@ -135,11 +145,11 @@ MobiusKernel::~MobiusKernel()
  * when the audio stream won't be active and we will be in the UI thread
  * so we can avoid kernel message passing.
  *
- * Configuration is a copy we get to keep until it is replaced
- * by a later MsgConfigure
- *
+ * Configuration is borrowed from the publisher until it is replaced
+ * by a later publication.  Only the initial payload is expected here,
+ * anything else will be adopted with the first block.
  */
-void MobiusKernel::initialize(MobiusContainer* cont, ConfigPayload* p)
+void MobiusKernel::initialize(MobiusContainer* cont)
 {
     Trace(2, "MobiusKernel::initialize\n");
     
@@ -147,16 +157,21 @@ void MobiusKernel::initialize(MobiusContainer* cont, ConfigPayload* p)
     container = cont;
     audioPool = shell->getAudioPool();
     actionPool = shell->getActionPool();
-
-    // transfer the payload objects and discard it
-    // ugly
-    session = p->session;
-    p->session = nullptr;
-    parameters = p->parameters;
-    p->parameters = nullptr;
-    groups = p->groups;
-    p->groups = nullptr;
-    delete p;
+    publisher = shell->getPublisher();
+
+    ConfigPayload* p = publisher->adopt();
+    while (p != nullptr) {
+        if (p->session != nullptr) session = p->session;
+        if (p->parameters != nullptr) parameters = p->parameters;
+        if (p->groups != nullptr) groups = p->groups;
+        if (p->samples != nullptr) sampleManager = p->samples;
+        if (p->binderator != nullptr) binderator.install(p->binderator);
+        if (p->scripts != nullptr)
+          Trace(1, "MobiusKernel: Scripts published before initialization were ignored");
+        adoptedEpoch = p->epoch;
+        p = p->next;
+    }
+    publisher->setKernelEpoch(adoptedEpoch);
 
     // immediately give the Session a SymbolTable so it can support the
     // SymbolId interfaces everyone wants
@@ -246,44 +261,45 @@ bool MobiusKernel::isGlobalReset()
 
 /**
  * This is called by Supervisor during initialization to force a synchronous
- * refresh of the system state after loading the session.
- */
-void MobiusKernel::initializeState(SystemState* state)
-{
-    refreshStateNow(state);
-}
-
-/**
- * This is called from the maintenance thread to ask for a state refresh.
- * We save it in a special place and handle it on the next block.
+ * refresh of the system state after loading the session.  It also gives us
+ * the buffer we publish to from then on.
  */
-void MobiusKernel::requestState(SystemState* state)
+void MobiusKernel::initializeState(SystemStateBuffer* states)
 {
-    if (stateToRefresh == nullptr)
-      stateToRefresh = state;
-    else {
-        Trace(1, "MobiusKernel: State refresh requested before finishing the last one");
-    }
+    stateBuffer = states;
+    refreshStateNow(stateBuffer->getWriteState());
+    stateBuffer->publish();
+    stateFrames = 0;
 }
 
 /**
- * Called at the beginning of each block to handle a state refresh request.
+ * Called at the beginning of each block to publish state for the UI.
+ *
+ * There is no request from the UI, we publish on an interval as long as
+ * the UI has picked up the last one.  If the UI isn't looking, nothing is
+ * done here at all.
  */
 void MobiusKernel::checkStateRefresh()
 {
-    if (stateToRefresh != nullptr) {
-        
-        refreshStateNow(stateToRefresh);
-
-        stateToRefresh = nullptr;
-        
-        if (listener != nullptr)
-          listener->mobiusStateRefreshed(stateToRefresh);
+    if (stateBuffer != nullptr) {
+        stateFrames += stream->getInterruptFrames();
+        if (stateBuffer->isConsumed()) {
+            int interval = (container->getSampleRate() * stateBuffer->getInterval()) / 1000;
+            if (stateFrames >= interval) {
+                refreshStateNow(stateBuffer->getWriteState());
+                stateBuffer->publish();
+                stateFrames = 0;
+                container->notifyStatePublished();
+            }
+        }
     }
 }
 
 void MobiusKernel::refreshStateNow(SystemState* state)
 {
+    // the UI tells us which track to include in FocusedTrackState
+    state->focusedTrackNumber = stateBuffer->getFocusedTrack();
+    
     syncMaster.refreshState(state);
     mTracks->refreshState(state);
 
@@ -306,9 +322,9 @@ void MobiusKernel::refreshPriorityState(PriorityState* state)
  * Consume any messages from the shell at the beginning of each
  * audio listener interrupt.
  * 
- * This is done in two stage: 1) configuration and another things that
- * won't cause UIActions to happen 2) UIAction and MIDI which may cause
- * UIAction.
+ * This is done in two stage: 1) things that won't cause UIActions
+ * to happen 2) UIAction and MIDI which may cause UIAction.
+ * Configuration was adopted just before this, see adoptConfiguration.
  *
  * The priority of configuration over action is probably not necessary but
  * has een done that way for a long time.  The deferral of actions actually
@@ -362,10 +378,6 @@ void MobiusKernel::consumeCommunications()
 void MobiusKernel::doMessage(KernelMessage* msg)
 {
     switch (msg->type) {
-        case MsgConfigure: reconfigure(msg); break;
-        case MsgSamples: installSamples(msg); break;
-        case MsgScripts: installScripts(msg); break;
-        case MsgBinderator: installBinderator(msg); break;
         case MsgLoadLoop: doLoadLoop(msg); break;
         case MsgMidiLoad: doMidiLoad(msg); break;
         case MsgAction: doAction(msg); break;
@@ -382,38 +394,71 @@ void MobiusKernel::doMessage(KernelMessage* msg)
 }
 
 /**
- * Process a MsgConfigure message containing configuration object
- * changes. This may be sparse.  Take ownership of what was passed
- * but keep the others.  Return the old ones for reclamation.
+ * Take everything the shell has published since the last block.
+ * After initialization this is the only place configuration changes.
+ *
+ * Nothing is deleted or returned, the shell deletes what was replaced
+ * once we tell it we've moved past the epoch.  If Mobius is waiting for
+ * scripts to finish before installing a new Scriptarian the old one is
+ * still in use, so the epoch is held back until it goes in.
  */
-void MobiusKernel::reconfigure(KernelMessage* msg)
+void MobiusKernel::adoptConfiguration()
 {
-    ConfigPayload* p = msg->object.payload;
+    ConfigPayload* p = publisher->adopt();
+    while (p != nullptr) {
+        reconfigure(p);
+        adoptedEpoch = p->epoch;
+        p = p->next;
+    }
 
-    // swap the objects in the payload
-    // ugly
+    if (adoptedEpoch > publisher->getKernelEpoch() && !mCore->isScriptarianPending())
+      publisher->setKernelEpoch(adoptedEpoch);
+}
 
-    Session* newSession = nullptr;
-    ParameterSets* newParams = nullptr;
-    GroupDefinitions* newGroups = nullptr;
-    
-    if (p->session != nullptr) {
-        newSession = p->session;
-        p->session = session;
-        session = newSession;
+/**
+ * Install a ConfigPayload containing configuration object
+ * changes. This may be sparse, keep what we have for anything
+ * that wasn't passed.
+ *
+ * When the shell could tell that the new Session is an edit of the one
+ * we have with the same tracks, it sends what changed and TrackManager
+ * only refreshes the tracks that need it.  Anything else, including
+ * ParameterSets and GroupDefinitions changes, does the full load.
+ */
+void MobiusKernel::reconfigure(ConfigPayload* p)
+{
+    // the runtime objects are simple replacements
+    if (p->samples != nullptr) {
+        // TODO: If samples are currently playing need to stop them gracefully
+        // or we'll get clicks.  Not important right now.
+        sampleManager = p->samples;
     }
+    
+    if (p->scripts != nullptr)
+      installScripts(p->scripts);
 
-    if (p->parameters != nullptr) {
-        newParams = p->parameters;
-        p->parameters = parameters;
-        parameters = newParams;
-    }
+    if (p->binderator != nullptr)
+      binderator.install(p->binderator);
 
-    if (p->groups != nullptr) {
-        newGroups = p->groups;
-        p->groups = groups;
-        groups = newGroups;
+    Session* newSession = p->session;
+    ParameterSets* newParams = p->parameters;
+    GroupDefinitions* newGroups = p->groups;
+
+    if (newSession == nullptr && newParams == nullptr && newGroups == nullptr && !p->globalReset) {
+        // nothing for the tracks
+        return;
     }
+    
+    juce::int64 startTicks = juce::Time::getHighResolutionTicks();
+
+    if (newSession != nullptr)
+      session = newSession;
+
+    if (newParams != nullptr)
+      parameters = newParams;
+
+    if (newGroups != nullptr)
+      groups = newGroups;
 
     // immediately give the Session a SymbolTable so it can support the
     // SymbolId interfaces everyone wants
@@ -425,32 +470,55 @@ void MobiusKernel::reconfigure(KernelMessage* msg)
     // actually doesn't do much any more, sets some Function flags to match the Symbols
     mCore->reconfigure();
 
-    // give TM the new GroupDefinitions first so it can parse scope names
-    // !! this is also needed by ParameterVault, but if that refreshes now
-    // it's going to do it all over again when we call loadSession
-    // have TrackManager defer refreshing vault groups until loadSession
-    mTracks->refresh(groups);
-    
-    if (p->globalReset) {
-        // this is normally set for ReloadSession that loads a session
-        // but also wants an unconditional GR along with it
-        // since it's hard to feed that in to the session loading process
-        // do it up front, easiest way is to pretent we got an action
-        mTracks->globalReset();
+    bool partial = false;
+    if (newSession != nullptr && newParams == nullptr && newGroups == nullptr &&
+        p->diffs != nullptr && !p->globalReset) {
+        // returns false if the tracks didn't line up after all
+        partial = mTracks->reloadSession(session, p->diffs);
     }
+
+    if (!partial) {
+        // give TM the new GroupDefinitions first so it can parse scope names
+        // !! this is also needed by ParameterVault, but if that refreshes now
+        // it's going to do it all over again when we call loadSession
+        // have TrackManager defer refreshing vault groups until loadSession
+        mTracks->refresh(groups);
+    
+        if (p->globalReset) {
+            // this is normally set for ReloadSession that loads a session
+            // but also wants an unconditional GR along with it
+            // since it's hard to feed that in to the session loading process
+            // do it up front, easiest way is to pretent we got an action
+            mTracks->globalReset();
+        }
     
-    // this will do the second call to core to configureTracks where
-    // most of the excitment happens
-    // note that this needs to happen even if the payload didn't have a new Session
-    // since the ParameterSets may have changed and this can impact the LogicalTrack
-    // parameter caches
-    mTracks->loadSession(session);
+        // this will do the second call to core to configureTracks where
+        // most of the excitment happens
+        // note that this needs to happen even if the payload didn't have a new Session
+        // since the ParameterSets may have changed and this can impact the LogicalTrack
+        // parameter caches
+        // tracks the shell built are taken from the payload as they are used
+        // and removed tracks are left there for the shell to delete
+        mTracks->loadSession(session, &(p->tracks), &(p->retired));
+    }
     
     notifier.configure(session);
     syncMaster.loadSession(session);
-    
-    // send the old ones back for reclamation
-    communicator->kernelSend(msg);
+
+    if (newSession != nullptr) {
+        juce::int64 ticks = juce::Time::getHighResolutionTicks() - startTicks;
+        ReconfigureStatistics& stats = reconfigureStatistics;
+        if (partial) {
+            stats.partial++;
+            stats.partialTicks += ticks;
+            if (ticks > stats.maxPartialTicks) stats.maxPartialTicks = ticks;
+        }
+        else {
+            stats.full++;
+            stats.fullTicks += ticks;
+            if (ticks > stats.maxFullTicks) stats.maxFullTicks = ticks;
+        }
+    }
 }
 
 /**
@@ -627,6 +695,14 @@ void MobiusKernel::clearExternalInput()
  * up before we start slamming actions at it.  We therefore have two preparation
  * phases in Mobius before the audio blocks are processed, and actions happen
  * in between those.
+ *
+ * The core can't take blocks larger than AUDIO_MAX_FRAMES_PER_BUFFER.
+ * PortAuthority will grow the port buffers if the host sends one anyway
+ * but everything after that is processed as a series of smaller blocks.
+ * Things that only need to happen once per host block are done before
+ * that: state publishing, configuration, and gathering MIDI input.
+ * The MIDI each piece sends to the host is added back to the host's
+ * buffer when the piece is done.
  */
 void MobiusKernel::processAudioStream(MobiusAudioStream* argStream)
 {
@@ -653,8 +729,53 @@ void MobiusKernel::processAudioStream(MobiusAudioStream* argStream)
         mCore->refreshParameters();
     }
 
+    // the whole host block until the pieces begin
+    stream = argStream;
+    hostFrames = argStream->getInterruptFrames();
+    pieceOffset = 0;
+
+    lastBlockTicks = blockTicks;
+    blockTicks = juce::Time::getHighResolutionTicks();
+
+    // publish state for the UI
+    checkStateRefresh();
+
+    // adopt any published configuration
+    adoptConfiguration();
+
+    // MIDI from the host and the devices, placed within the host block
+    stagedCount = 0;
+    consumeMidiMessages();
+    consumeMidiInput();
+
+    if (hostFrames <= AUDIO_MAX_FRAMES_PER_BUFFER) {
+        processBlock(argStream, 0);
+    }
+    else {
+        if (oversizedBlocks == 0)
+          Trace(1, "MobiusKernel: Splitting oversized block of %d frames", hostFrames);
+        oversizedBlocks++;
+        
+        splitter.setSource(argStream);
+        while (splitter.next(AUDIO_MAX_FRAMES_PER_BUFFER)) {
+            processBlock(&splitter, splitter.getOffset());
+            splitter.returnMidi();
+        }
+    }
+
+    // this becomes invalid till next time
+    stream = nullptr;
+}
+
+/**
+ * Process one block no larger than the core can handle.
+ * The offset is where it starts within the host block.
+ */
+void MobiusKernel::processBlock(MobiusAudioStream* argStream, int offset)
+{
     // save this here for the duration so we don't have to keep passing it around
     stream = argStream;
+    pieceOffset = offset;
 
     // let the core get ready for action
     mCore->beginAudioBlock(stream);
@@ -674,12 +795,10 @@ void MobiusKernel::processAudioStream(MobiusAudioStream* argStream)
 	if (noExternalInput)
       clearExternalInput();
 
-    // do this at the beginning or end of the block?
-    checkStateRefresh();
-
-    // consume any queueued configuration, actions, MIDI events, and host events
+    // consume queued actions, MIDI events that fall in this piece,
+    // and host events
     consumeCommunications();
-    consumeMidiMessages();
+    consumeStagedMidi();
     consumeParameters();
 
     // let SampleManager do it's thing
@@ -698,9 +817,9 @@ void MobiusKernel::processAudioStream(MobiusAudioStream* argStream)
     // before block advance
     mTracks->advanceLongWatcher(stream->getInterruptFrames());
     
-    // !! The TimeSlicer is going to need to include MSL track Waits in its
-    // dependency analysis which will complicate what mCore->beginAudioBlockAfterActions
-    // above is doing.  Need to merge that with whatever the surgeon is doing
+    // TimeSlicer also ends MSL waits for time and sync pulses where they fall
+    // in the block, MOS script waits are still advanced by the core
+    // in mCore->beginAudioBlockAfterActions above
     syncMaster.processAudioStream(stream);
 
     mCore->finishAudioBlock(stream);
@@ -708,9 +827,16 @@ void MobiusKernel::processAudioStream(MobiusAudioStream* argStream)
     updateParameters();
     notifier.afterBlock();
 
-    // this becomes invalid till next time
-    stream = nullptr;
-    
+    // send what the tracks played
+    flushMidiOutput();
+
+    // wake up the shell if we left it something
+    int sends = communicator->getKernelSends();
+    if (sends != lastKernelSends) {
+        lastKernelSends = sends;
+        container->notifyKernelMessages();
+    }
+
     // end whining
     MemTraceEnabled = false;
 }
@@ -721,12 +847,16 @@ int MobiusKernel::getBlockSize()
 }
 
 /**
- * Process any MIDI messages available during this audio block.
+ * Gather any MIDI messages the host sent with this audio block.
  * This will be null when running a standalone application.
  *
- * Juce can timestamp these so they could be handled at offsets within
- * the current audio block, which would be more accurate for timing, but
- * I've always queued them and done them up front.
+ * Juce timestamps these with offsets within the current audio block.
+ * They are staged with those offsets and consumeStagedMidi gives them to
+ * the piece of the block they fall in.  Messages at the start of a piece are
+ * processed immediately.  Later ones are handed to TimeSlicer which does the
+ * bound action after the target track has advanced to the offset, and gives
+ * the message to the tracks for recording at the offset.  Previously these
+ * were all done up front which is up to a block of jitter.
  *
  * midiListener is a hack for MIDI logging utilities to redirect messages up to the UI.
  * We bypass the usual audio thread message passing and call MobiusListener directly
@@ -740,50 +870,178 @@ void MobiusKernel::consumeMidiMessages()
 {
     juce::MidiBuffer* buffer = stream->getMidiMessages();
     if (buffer != nullptr) {
+        int frames = stream->getInterruptFrames();
         // iteration taken from a tutorial except I'm not using references
         // due to the awkward processAudioStream callback style
         for (const auto metadata : *buffer) {
-            // do we really need to pass these by value?
-            juce::MidiMessage msg = metadata.getMessage();
+            // hosts shouldn't give us anything outside the block but be safe
+            int offset = metadata.samplePosition;
+            if (offset < 0 || offset >= frames)
+              offset = 0;
 
-            // only consider the ones we can use in bindings
-            // realtime might be interesting for Synchronizer, but when
-            // comming through the host are likely to be jittery so get
-            // sync with direct device connections working first
+            stageMidi(metadata.getMessage(), 0, offset, true);
+        }
+    }
 
-            bool actionFound = false;
-            if (msg.isNoteOnOrOff() || msg.isProgramChange() || msg.isController()) {
+    // todo: unclear whether we're supposed to leave the messages in this block
+    // docs say that anything left in here will be passed as output from the plugin
+    //buffer->clear();
+}
 
-                bool doit = true;
-                if (midiListener != nullptr)
-                  doit = midiListener->mobiusMidiReceived(msg);
-                
-                if (doit) {
-                    UIAction* action = binderator.getMidiAction(msg);
-                    if (action != nullptr) {
-                        // Binderator owns the action so for consistency with
-                        // all other action passing in the kernel, convert it to
-                        // a pooled action that can be returned to the pool
-                        UIAction* pooled = actionPool->newAction();
-                        pooled->copy(action);
-                        doAction(pooled);
-                        actionFound = true;
-                    }
+/**
+ * Process messages MidiManager queued directly from the input devices.
+ * This is how the standalone application receives MIDI.
+ *
+ * Messages are placed in this block at the same offset they arrived
+ * within the last one.  That adds one block of latency, but it is
+ * the same block for every message so the spacing between them survives,
+ * rather than everything landing at the front of whatever block happened
+ * to follow the message thread.
+ *
+ * The device id is the index MidiManager uses for its open inputs, the
+ * same as when events were recorded through the message thread.
+ */
+void MobiusKernel::consumeMidiInput()
+{
+    MidiInputQueue* queue = container->getMidiInputQueue();
+    if (queue != nullptr) {
+        int frames = stream->getInterruptFrames();
+        int rate = container->getSampleRate();
+        juce::int64 ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+        MidiInputQueue::Entry e;
+
+        for (int ring = 0 ; ring < MidiInputQueue::MaxDevices ; ring++) {
+            // if staging is full the rest wait for the next block
+            while (stagedCount < MaxStagedMidi && queue->next(ring, e)) {
+                int offset = 0;
+                if (lastBlockTicks > 0 && rate > 0 && e.ticks > lastBlockTicks) {
+                    juce::int64 delta = (e.ticks - lastBlockTicks) * rate / ticksPerSecond;
+                    offset = (delta < frames) ? (int)delta : frames - 1;
                 }
+
+                stageMidi(juce::MidiMessage(e.data, e.size), e.device, offset, false);
+
+                if (rate > 0)
+                  queue->addDelay(e, blockTicks + ((juce::int64)offset * ticksPerSecond / rate));
             }
+        }
+        queue->consumed(blockTicks);
+    }
+}
+
+/**
+ * Hold a message until the piece of the host block containing
+ * its offset is processed.  The messages were constructed up front so
+ * the stage doesn't allocate unless something sends sysex.
+ */
+void MobiusKernel::stageMidi(const juce::MidiMessage& msg, int device, int offset, bool fromHost)
+{
+    if (stagedCount < MaxStagedMidi) {
+        StagedMidi& staged = stagedMidi[stagedCount];
+        staged.msg = msg;
+        staged.device = device;
+        staged.offset = offset;
+        staged.fromHost = fromHost;
+        stagedCount++;
+    }
+    else {
+        if (stagedOverflows == 0)
+          Trace(1, "MobiusKernel: MIDI input overflow, dropping messages");
+        stagedOverflows++;
+    }
+}
+
+/**
+ * Consume the staged messages that fall within the current piece,
+ * at their offset within it.  When the block wasn't split this is
+ * all of them.
+ */
+void MobiusKernel::consumeStagedMidi()
+{
+    int frames = stream->getInterruptFrames();
+    for (int i = 0 ; i < stagedCount ; i++) {
+        StagedMidi& staged = stagedMidi[i];
+        int offset = staged.offset - pieceOffset;
+        if (offset >= 0 && offset < frames)
+          consumeMidiMessage(staged.msg, staged.device, offset, staged.fromHost);
+    }
+}
 
-            // now we need to pass it along to the MidiTracks, if this was bound
-            // to an action, suppress that in case the bindings use the same
-            // device that is used for recording?
-            // wrapping it in our MidiEvent is the convention used by MidiManager
-            // when receiving MIDI directly
-            mTracks->midiEvent(msg, 0);
+/**
+ * Handle one MIDI message from the host or a device at a block offset.
+ *
+ * Messages at the start of the block are processed immediately.  Later ones
+ * are handed to TimeSlicer which does the bound action after the target track
+ * has advanced to the offset, and gives the message to the tracks for recording
+ * at the offset.
+ */
+void MobiusKernel::consumeMidiMessage(const juce::MidiMessage& msg, int deviceId, int offset,
+                                      bool fromHost)
+{
+    // only consider the ones we can use in bindings
+    // realtime might be interesting for Synchronizer, but when
+    // comming through the host are likely to be jittery so get
+    // sync with direct device connections working first
+    if (msg.isNoteOnOrOff() || msg.isProgramChange() || msg.isController()) {
+
+        // monitoring of device input happens in MidiManager
+        bool doit = true;
+        if (fromHost && midiListener != nullptr)
+          doit = midiListener->mobiusMidiReceived(msg);
+                
+        if (doit) {
+            UIAction* action = binderator.getMidiAction(msg);
+            if (action != nullptr) {
+                // Binderator owns the action so for consistency with
+                // all other action passing in the kernel, convert it to
+                // a pooled action that can be returned to the pool
+                UIAction* pooled = actionPool->newAction();
+                pooled->copy(action);
+                int track = (offset > 0) ? getSliceTrack(pooled) : 0;
+                if (track == 0 || !syncMaster.sliceAction(track, offset, pooled))
+                  doAction(pooled);
+            }
         }
     }
 
-    // todo: unclear whether we're supposed to leave the messages in this block
-    // docs say that anything left in here will be passed as output from the plugin
-    //buffer->clear();
+    // now we need to pass it along to the MidiTracks, if this was bound
+    // to an action, suppress that in case the bindings use the same
+    // device that is used for recording?
+    mTracks->midiEvent(msg, deviceId, offset);
+}
+
+/**
+ * Determine whether an action can be done when a track reaches the block
+ * offset of the MIDI message that triggered it, and which track.
+ * Zero means it must be done immediately.
+ *
+ * TimeSlicer advances one track at a time, so only track functions going
+ * to a single track can wait for that track.  Unscoped actions go to the
+ * focused track.  Groups, globals, scripts, and things for the shell
+ * are done up front like they always were.
+ */
+int MobiusKernel::getSliceTrack(UIAction* action)
+{
+    int track = 0;
+    Symbol* s = action->symbol;
+    if (s != nullptr &&
+        s->behavior == BehaviorFunction &&
+        s->level != LevelUI && s->level != LevelShell && s->level != LevelKernel &&
+        s->script == nullptr &&
+        (s->functionProperties == nullptr || !s->functionProperties->global)) {
+
+        int scope = action->getScopeTrack();
+        if (scope > 0)
+          track = scope;
+        else if (scope == 0)
+          track = mTracks->getFocusedTrackIndex() + 1;
+    }
+    return track;
+}
+
+void MobiusKernel::doSlicedAction(UIAction* action)
+{
+    doAction(action);
 }
 
 /**
@@ -791,8 +1049,25 @@ void MobiusKernel::consumeMidiMessages()
  * When running as a plugin, device id 0 is reserved for the host application, otherwise
  * the device is the index of the devices returned by MidiManager::getOpenOutputDevices
  * todo: need more flexible id mapping
+ *
+ * During a block messages are collected with their offset and sent
+ * together by flushMidiOutput at the end.
+ */
+void MobiusKernel::midiSend(juce::MidiMessage& msg, int deviceId, int offset)
+{
+    if (stream != nullptr && deviceId >= 0 && deviceId < MaxMidiOutputs) {
+        midiOutputs[deviceId].addEvent(msg, offset);
+        midiOutputCount++;
+    }
+    else {
+        sendMidiNow(msg, deviceId);
+    }
+}
+
+/**
+ * Send the old way, at the front of the block.
  */
-void MobiusKernel::midiSend(juce::MidiMessage& msg, int deviceId)
+void MobiusKernel::sendMidiNow(juce::MidiMessage& msg, int deviceId)
 {
     if (container->isPlugin()) {
         if (deviceId == 0) {
@@ -815,6 +1090,60 @@ void MobiusKernel::midiSend(juce::MidiMessage& msg, int deviceId)
     }
 }
 
+/**
+ * Deliver the MIDI collected during the block.
+ *
+ * The host device gets the buffer with the offsets as they are.  Other
+ * devices go through MidiOutputQueue stamped with the time of their offset.
+ * This block is heard one block after it started so that is added, which
+ * puts everything behind by a block but keeps the spacing, and the sender
+ * thread won't have to catch up on things that were already due.
+ * The block is the host block, and a piece of a split block adds where
+ * it starts within that.
+ *
+ * The buffers were given some room in the constructor so they shouldn't
+ * need to allocate unless something is sending an unusual amount.
+ */
+void MobiusKernel::flushMidiOutput()
+{
+    if (midiOutputCount > 0) {
+        MidiOutputQueue* queue = container->getMidiOutputQueue();
+        int rate = container->getSampleRate();
+        juce::int64 ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+        bool plugin = container->isPlugin();
+
+        for (int device = 0 ; device < MaxMidiOutputs ; device++) {
+            juce::MidiBuffer& buffer = midiOutputs[device];
+            if (!buffer.isEmpty()) {
+                if (plugin && device == 0) {
+                    juce::MidiBuffer* hostBuffer = stream->getMidiMessages();
+                    if (hostBuffer != nullptr)
+                      hostBuffer->addEvents(buffer, 0, -1, 0);
+                }
+                else {
+                    int containerDevice = (plugin) ? device - 1 : device;
+                    for (const auto metadata : buffer) {
+                        juce::MidiMessage msg = metadata.getMessage();
+                        bool queued = false;
+                        if (queue != nullptr && rate > 0) {
+                            juce::int64 position = hostFrames + pieceOffset + metadata.samplePosition;
+                            juce::int64 ticks = blockTicks + (position * ticksPerSecond / rate);
+                            queued = queue->add(containerDevice, msg, ticks);
+                        }
+                        if (!queued)
+                          container->midiSend(msg, containerDevice);
+                    }
+                }
+                buffer.clear();
+            }
+        }
+
+        if (queue != nullptr)
+          queue->blockSent(midiOutputCount);
+        midiOutputCount = 0;
+    }
+}
+
 /**
  * Called by the MidiOut function to send a sync message, usually Start/Stop/Continue
  * rather than clocks.  Unclear how much this was used.
@@ -1038,99 +1367,18 @@ void MobiusKernel::updateParameters()
 //////////////////////////////////////////////////////////////////////
 
 /**
- * Special accessor only for Test Mode to directly
- * replace the sample library and make it available for immediate
- * use without waiting for KernelCommunicator.
- * Obviously to be used with care.
- */
-void MobiusKernel::slamSampleManager(SampleManager* neu)
-{
-    delete sampleManager;
-    sampleManager = neu;
-}
-
-/**
- * We've just consumed the pending SampleManager from the shell.
- *
- * TODO: If samples are currently playing need to stop them gracefully
- * or we'll get clicks.  Not important right now.
- * 
- */
-void MobiusKernel::installSamples(KernelMessage* msg)
-{
-    SampleManager* old = sampleManager;
-    sampleManager = msg->object.samples;
-
-    if (old == nullptr) {
-        // nothing to return
-        communicator->kernelAbandon(msg);
-    }
-    else {
-        // return the old one
-        msg->object.samples = old;
-        communicator->kernelSend(msg);
-    }
-}
-
-/**
- * We've just consumed the pending Scriptarian from the shell.
+ * We've just adopted a new Scriptarian from the shell.
  * Pass it along and hope it doesn't blow up.
+ * Mobius may hold on to it until the current one is quiet.
  */
-void MobiusKernel::installScripts(KernelMessage* msg)
+void MobiusKernel::installScripts(Scriptarian* scripts)
 {
     if (mCore == nullptr) {
         // this really can't happen,
         Trace(1, "MobiusKernel: Can't install Scriptarian without a core!\n");
-        // guess we can clean up, but this is the least of your worries
     }
     else {
-        mCore->installScripts(msg->object.scripts);
-    }
-    
-    // nothing to return
-    communicator->kernelAbandon(msg);
-}
-
-/**
- * Called by Mobius when it has finished installing a Scriptarian
- * and can pass the old back up to the shell for deletion.
- */
-void MobiusKernel::returnScriptarian(Scriptarian* old)
-{
-    KernelMessage* msg = communicator->kernelAlloc();
-    msg->type = MsgScripts;
-    msg->object.scripts = old;
-    communicator->kernelSend(msg);
-}
-
-/**
- * Replace our Binderator with a new one.
- */
-void MobiusKernel::installBinderator(KernelMessage* msg)
-{
-    Binderator* old = binderator.install(msg->object.binderator);
-    
-    if (old == nullptr) {
-        // nothing to return
-        communicator->kernelAbandon(msg);
-    }
-    else {
-        // return the old one
-        msg->object.binderator = old;
-        communicator->kernelSend(msg);
-    }
-}
-
-/**
- * During initialization only, allow MobiusShell to directly give us
- * the initial Binderator.
- */
-void MobiusKernel::slamBinderator(Binderator* b)
-{
-    Binderator* old = binderator.install(b);
-    if (old != nullptr) {
-        Trace(1, "MobiusKernel::slamBinderator How did we get here with an old Binderator?\n");
-        delete old;
+        mCore->installScripts(scripts);
     }
 }
 
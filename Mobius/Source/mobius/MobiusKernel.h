@@ -29,6 +29,7 @@
 #include "KernelBinderator.h"
 #include "MobiusPools.h"
 #include "Notifier.h"
+#include "BlockSplitter.h"
 
 #include "track/TrackManager.h"
 
@@ -50,8 +51,11 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
      * The difference between this and what we pass in the constructor
      * is kind of arbitrary, consider doing it one way or the other.
      * Or just pulling it from the MobiusShell
+     *
+     * The initial configuration has already been published
+     * to the shell's KernelPublisher.
      */
-    void initialize(class MobiusContainer* cont, class ConfigPayload* p);
+    void initialize(class MobiusContainer* cont);
     void propagateSymbolProperties();
 
     void shutdown();
@@ -98,6 +102,9 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
     // This is where all the interesting action happens
     void processAudioStream(MobiusAudioStream* stream) override;
 
+    // TimeSlicer callback when a track reaches a MIDI triggered action
+    void doSlicedAction(class UIAction* a);
+
     int getBlockSize();
 
     class TrackContent* getTrackContent(bool includeLayers);
@@ -118,9 +125,40 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
 
     class TrackManager* getTrackManager();
     class LogicalTrack* getLogicalTrack(int number);
+
+    /**
+     * Time spent in reconfigure() for Session changes, split between the
+     * partial reloads after an edit and full session loads.  Kept for the
+     * session benchmark in MobiusConsole.  Updated by the audio thread and
+     * reset by the console from the UI thread.  The members are atomic but
+     * not as a group, a reset that lands during a reconfigure may leave
+     * that one sample half counted, which is fine for a benchmark.
+     */
+    class ReconfigureStatistics
+    {
+      public:
+        std::atomic<int> partial {0};
+        std::atomic<int> full {0};
+        std::atomic<juce::int64> partialTicks {0};
+        std::atomic<juce::int64> fullTicks {0};
+        std::atomic<juce::int64> maxPartialTicks {0};
+        std::atomic<juce::int64> maxFullTicks {0};
+
+        void reset() {
+            partial = 0;
+            full = 0;
+            partialTicks = 0;
+            fullTicks = 0;
+            maxPartialTicks = 0;
+            maxFullTicks = 0;
+        }
+    };
+
+    ReconfigureStatistics* getReconfigureStatistics() {
+        return &reconfigureStatistics;
+    }
     
-    void initializeState(class SystemState* state);
-    void requestState(class SystemState* state);
+    void initializeState(class SystemStateBuffer* states);
     void refreshPriorityState(class PriorityState* state);
     
     class AudioPool* getAudioPool() {
@@ -152,10 +190,6 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
     void sendEvent(KernelEvent* e);
     void sendMobiusMessage(const char* msg);
     
-    // called by Mobius when it has finished activating a new Scriptarian
-    // return the old one to the shell
-    void returnScriptarian(class Scriptarian* old);
-
     // test scripts need the size of the last sample triggered for waiting
     // would make this protected but it is called by SampleFramesVariableType
     // and I don't want to get too comfortable having all the internal variables
@@ -200,7 +234,7 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
     // used by the MidiOut function handler
     void midiSendSync(juce::MidiMessage& msg);
     void midiSendExport(juce::MidiMessage& msg);
-    void midiSend(juce::MidiMessage& msg, int deviceId);
+    void midiSend(juce::MidiMessage& msg, int deviceId, int offset = 0);
     int getMidiOutputDeviceId(const char* name);
 
     // used by SyncMaster to send alert messages to Supervisor
@@ -226,9 +260,6 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
         return sampleManager;
     }
 
-    void slamSampleManager(SampleManager* neu);
-    void slamBinderator(class Binderator* bindings);
-    
     // used by Mobius to start the execution of MSL scripts
     void runExternalScripts();
 
@@ -276,6 +307,11 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
     class MobiusShell* shell = nullptr;
     class MobiusListener* listener = nullptr;
     class KernelCommunicator* communicator = nullptr;
+    class KernelPublisher* publisher = nullptr;
+    // epoch of the last ConfigPayload adopted
+    int adoptedEpoch = 0;
+    // send count at the end of the last block
+    int lastKernelSends = 0;
     class MobiusContainer* container = nullptr;
     class Session* session = nullptr;
     class ParameterSets* parameters = nullptr;
@@ -283,7 +319,9 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
     class AudioPool* audioPool = nullptr;
     class UIActionPool* actionPool = nullptr;
 
-    class SystemState* stateToRefresh = nullptr;
+    // where we publish state for the UI and the frames since the last one
+    class SystemStateBuffer* stateBuffer = nullptr;
+    int stateFrames = 0;
     
     // important that we track changes in block sizes to adjust latency compensation
     int lastBlockSize = 0;
@@ -309,20 +347,61 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
     class Mobius* mCore = nullptr;
 
     std::unique_ptr<TrackManager> mTracks;
+
+    ReconfigureStatistics reconfigureStatistics;
+
+    // for host blocks larger than the core can handle
+    BlockSplitter splitter;
+    int oversizedBlocks = 0;
+
+    // frames in the host block and where the current piece starts in it
+    int hostFrames = 0;
+    int pieceOffset = 0;
     
     // special mode for TestDriver
     bool testMode = false;
     // special mode for MidiMonitorPanel and MidiDevicesPanel
     class MobiusMidiListener* midiListener = nullptr;
+
+    // high resolution time at the start of this block and the last one
+    // for placing MIDI device input
+    juce::int64 blockTicks = 0;
+    juce::int64 lastBlockTicks = 0;
+
+    // MIDI input for the host block, gathered once and handed
+    // to each piece of a split block at its offset
+    class StagedMidi
+    {
+      public:
+        juce::MidiMessage msg;
+        int device = 0;
+        int offset = 0;
+        bool fromHost = false;
+    };
+    static const int MaxStagedMidi = 1024;
+    StagedMidi stagedMidi[MaxStagedMidi];
+    int stagedCount = 0;
+    int stagedOverflows = 0;
+    void stageMidi(const juce::MidiMessage& msg, int device, int offset, bool fromHost);
+    void consumeStagedMidi();
+
+    // MIDI the tracks sent during this block, by device id with sample offsets
+    static const int MaxMidiOutputs = 16;
+    juce::MidiBuffer midiOutputs[MaxMidiOutputs];
+    int midiOutputCount = 0;
+    void sendMidiNow(juce::MidiMessage& msg, int deviceId);
+    void flushMidiOutput();
     
     void installSymbols();
+    void processBlock(MobiusAudioStream* stream, int offset);
 
+    // configuration
+    void adoptConfiguration();
+    void reconfigure(class ConfigPayload* p);
+    void installScripts(class Scriptarian* scripts);
+    
     // KernelMessage handling
     void doMessage(class KernelMessage* msg);
-    void reconfigure(class KernelMessage*);
-    void installSamples(class KernelMessage* msg);
-    void installScripts(class KernelMessage* msg);
-    void installBinderator(class KernelMessage* msg);
     void doAction(KernelMessage* msg);
     void doEvent(KernelMessage* msg);
     void doLoadLoop(KernelMessage* msg);
@@ -331,6 +410,10 @@ class MobiusKernel : public MobiusAudioListener, public MslContext, public MslUt
     
     void clearExternalInput();
     void consumeMidiMessages();
+    void consumeMidiInput();
+    void consumeMidiMessage(const juce::MidiMessage& msg, int deviceId, int offset,
+                            bool fromHost);
+    int getSliceTrack(class UIAction* a);
     
     void checkStateRefresh();
     void refreshStateNow(class SystemState* state);
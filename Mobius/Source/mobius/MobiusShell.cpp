@@ -42,6 +42,7 @@
 
 #include "../model/ConfigPayload.h"
 #include "../model/Session.h"
+#include "../model/SessionDiff.h"
 #include "../model/ParameterSets.h"
 #include "../model/GroupDefinition.h"
 #include "../model/UIAction.h"
@@ -54,6 +55,7 @@
 #include "../model/SampleProperties.h"
 
 #include "../Binderator.h"
+#include "../SessionDifferencer.h"
 
 #include "core/Mobius.h"
 #include "core/Scriptarian.h"
@@ -61,6 +63,9 @@
 
 #include "MobiusInterface.h"
 #include "MobiusKernel.h"
+#include "track/LogicalTrack.h"
+#include "track/TrackManager.h"
+#include "midi/MidiPools.h"
 #include "SampleManager.h"
 #include "SampleReader.h"
 #include "AudioPool.h"
@@ -198,12 +203,20 @@ void MobiusShell::shutdown()
  *
  * update: Shell no longer has any need for either of these two
  * objects, one copy is passed through to the kernel.
+ *
+ * update: Shell keeps a copy of the Session again, but only to
+ * compare with the next one, see prepareSession.
  */
 void MobiusShell::initialize(ConfigPayload* p)
 {
     Trace(2, "MobiusShell::initialize\n");
-    
-    kernel.initialize(container, p);
+
+    if (p->session != nullptr)
+      lastSession.reset(new Session(p->session));
+
+    // the kernel takes it from the publisher as it initializes
+    publisher.publish(p);
+    kernel.initialize(container);
 }
 
 /**
@@ -213,16 +226,117 @@ void MobiusShell::initialize(ConfigPayload* p)
 void MobiusShell::reconfigure(ConfigPayload* p)
 {
     Trace(2, "MobiusShell::reconfigure\n");
+    prepareSession(p);
     sendKernelConfigure(p);
 }
 
+/**
+ * Do the expensive part of a Session change here rather than in the kernel.
+ *
+ * If the new Session is an edit of the last one that kept the same tracks,
+ * which is the usual result of the session editor or a parameter change
+ * in the UI, compute the differences so the kernel only refreshes the
+ * tracks and parameters that changed.
+ *
+ * If tracks were added, build the LogicalTracks for them now, and make
+ * room in the payload for the ones the kernel removes so they can be
+ * deleted here.  The core Tracks are still made and deleted in the kernel.
+ */
+void MobiusShell::prepareSession(ConfigPayload* p)
+{
+    Session* neu = p->session;
+    if (neu != nullptr) {
+        Session* last = lastSession.get();
+        if (last != nullptr) {
+            if (isSameTracks(last, neu)) {
+                // GlobalReset wants the full load
+                if (!p->globalReset) {
+                    SessionDifferencer differencer(container->getSymbols());
+                    p->diffs = differencer.diff(last, neu);
+                }
+            }
+            else {
+                prepareTracks(last, neu, p);
+            }
+        }
+        lastSession.reset(new Session(neu));
+    }
+}
+
+/**
+ * This needs to match TrackManager::isSameTracks which makes the
+ * final decision.
+ */
+bool MobiusShell::isSameTracks(Session* last, Session* neu)
+{
+    bool same = (last->getId() == neu->getId() &&
+                 last->getTrackCount() == neu->getTrackCount());
+    if (same) {
+        for (int i = 0 ; i < neu->getTrackCount() ; i++) {
+            Session::Track* t1 = last->getTrackByIndex(i);
+            Session::Track* t2 = neu->getTrackByIndex(i);
+            if (t1->id != t2->id || t1->type != t2->type) {
+                same = false;
+                break;
+            }
+        }
+    }
+    return same;
+}
+
+/**
+ * Predict how many new tracks TrackManager::configureTracks will need.
+ * Within the same Session tracks are matched by id, after loading a different
+ * one they are matched by type.  If we guess wrong the kernel makes them
+ * itself and any we made come back unused.
+ */
+void MobiusShell::prepareTracks(Session* last, Session* neu, ConfigPayload* p)
+{
+    juce::Array<Session::TrackType> types;
+    if (last->getId() == neu->getId()) {
+        for (int i = 0 ; i < neu->getTrackCount() ; i++) {
+            Session::Track* t = neu->getTrackByIndex(i);
+            if (last->getTrackById(t->id) == nullptr)
+              types.add(t->type);
+        }
+    }
+    else {
+        juce::Array<Session::TrackType> available;
+        for (int i = 0 ; i < last->getTrackCount() ; i++)
+          available.add(last->getTrackByIndex(i)->type);
+        
+        for (int i = 0 ; i < neu->getTrackCount() ; i++) {
+            Session::TrackType type = neu->getTrackByIndex(i)->type;
+            if (available.contains(type))
+              available.removeFirstMatchingValue(type);
+            else
+              types.add(type);
+        }
+    }
+
+    // any track the kernel has now may be removed
+    p->retired.ensureStorageAllocated(last->getTrackCount());
+
+    TrackManager* tm = kernel.getTrackManager();
+    for (auto type : types) {
+        LogicalTrack* lt = new LogicalTrack(tm);
+        lt->prepareTrack(type);
+        p->tracks.add(lt);
+    }
+    
+    if (types.size() > 0)
+      Trace(2, "MobiusShell: Prepared %d tracks for the kernel", types.size());
+}
+
 /**
  * When running as a plugin, MIDI bindings needs to be handled
  * by the kernel.  The container must build this and pass it down.
  */
 void MobiusShell::installBindings(Binderator* b)
 {
-    sendKernelBinderator(b);
+    ConfigPayload* p = new ConfigPayload();
+    p->binderator = b;
+    sendKernelConfigure(p);
 }
 
 void MobiusShell::propagateSymbolProperties()
@@ -398,14 +512,9 @@ bool MobiusShell::doQuery(Query* query)
 //
 //////////////////////////////////////////////////////////////////////
 
-void MobiusShell::initializeState(SystemState* state)
-{
-    kernel.initializeState(state);
-}
-
-void MobiusShell::requestState(SystemState* state)
+void MobiusShell::initializeState(SystemStateBuffer* states)
 {
-    kernel.requestState(state);
+    kernel.initializeState(states);
 }
 
 void MobiusShell::refreshPriorityState(PriorityState* state)
@@ -425,6 +534,9 @@ void MobiusShell::performMaintenance()
 {
     // process KernelEvent and other things sent up
     consumeCommunications();
+
+    // delete configuration the kernel has moved past
+    publisher.reclaim();
     
     // extend the message pool if necessary
     communicator.checkCapacity();
@@ -432,6 +544,11 @@ void MobiusShell::performMaintenance()
     // fluff other pools
     actionPool.fluff();
 
+    // the kernel packs MIDI layers from chunks checked out in bulk
+    TrackManager* tm = kernel.getTrackManager();
+    if (tm != nullptr)
+      tm->getMidiPools()->fluff();
+
     // todo: all object pool fluffing should be done here now too
     // need to redesign the old pools to be consistent and allow
     // management from another thread
@@ -462,37 +579,18 @@ UIActionPool* MobiusShell::getActionPool()
 }
 
 /**
- * Pass the configuration payload on ot the kernel.
- * Ownership transfers.
+ * Pass a configuration payload on to the kernel.
+ * Ownership transfers to the publisher which deletes what it
+ * replaces after the kernel has adopted it.
  */
 void MobiusShell::sendKernelConfigure(ConfigPayload* p)
 {
-    KernelMessage* msg = communicator.shellAlloc();
-    if (msg != nullptr) {
-        msg->type = MsgConfigure;
-        msg->object.payload = p;
-        communicator.shellSend(msg);
-    }
-    // else, pool exhaustion, already traced
-}
-
-/**
- * Send a new MIDI binding handler down.
- */
-void MobiusShell::sendKernelBinderator(Binderator* b)
-{
-    KernelMessage* msg = communicator.shellAlloc();
-    if (msg != nullptr) {
-        msg->type = MsgBinderator;
-        msg->object.binderator = b;
-        communicator.shellSend(msg);
-    }
+    publisher.publish(p);
 }
 
 /**
  * Consume any messages sent back from the kernel.
- * Most of these are objects we allocated and passed down,
- * and now they are being returned to us for reclamation.
+ * Configuration no longer comes back this way, see KernelPublisher.
  *
  * More complex requests are handled through a KernelEvent
  * which is passed over to KernelEventHandler.
@@ -512,37 +610,6 @@ void MobiusShell::consumeCommunications()
             
             case MsgNone: break;
 
-            case MsgConfigure: {
-                // kernel is done with the previous configuration
-                // this may be sparse, delete whatever was returned
-                ConfigPayload* p = msg->object.payload;
-                if (p != nullptr) {
-                    delete p->session;
-                    delete p->parameters;
-                    delete p->groups;
-                    delete p;
-                }
-            }
-                break;
-                
-            case MsgSamples: {
-                // kernel is giving us back the old SampleManager
-                delete msg->object.samples;
-            }
-                break;
-                
-            case MsgScripts: {
-                // kerel is giving back an old Scriptarian
-                delete msg->object.scripts;
-            }
-                break;
-                
-            case MsgBinderator: {
-                // kerel is giving back an old Binderator
-                delete msg->object.binderator;
-            }
-                break;
-                
             case MsgLoadLoop: {
                 // not expecting to get this back, if we do free it
                 // since most of this is pooled audio buffers kernel can
@@ -887,7 +954,7 @@ void MobiusShell::doTimeBoundary(KernelEvent* e)
 void MobiusShell::installSamples(SampleConfig* src)
 {
     SampleManager* manager = compileSamples(src);
-    sendSamples(manager, false);
+    sendSamples(manager);
 }
 
 /**
@@ -978,20 +1045,11 @@ SampleConfig* MobiusShell::expandPaths(SampleConfig* src)
  * Update the SymbolTable to have symbols for the samples and unresolve
  * symbols for prevous samples that no longer exist.
  *
- * The kludgey "safeMode" flag is for Test Mode where this is
- * being initiated from a script and we want to skip KernelMessage
- * passing and slam the samples directly into the kernel.  This is so
- * that the samples are available immediately when the test script
- * continues.  Life means nothing if you can't live dangerously.
- *
- * update: I don't think the last comment is still relevant since
- * test mode is handled up in the UI and test samples must still
- * come down through the usual channels.  Still need to support
- * "save mode" but need a different way to specify that since
- * TestDriver can't call this directly.  Or maybe it can just
- * want for the mobiusDynamicConfigChanged before proceeding.
+ * The kernel adopts it with the next block like any other configuration
+ * change.  TestDriver needs them before the test script continues so
+ * it waits for the kernel epoch to catch up.
  */
-void MobiusShell::sendSamples(SampleManager* manager, bool safeMode)
+void MobiusShell::sendSamples(SampleManager* manager)
 {
     if (manager != nullptr) {
         // refresh the symbol table for the samples
@@ -1005,20 +1063,9 @@ void MobiusShell::sendSamples(SampleManager* manager, bool safeMode)
         if (listener != nullptr)
           listener->mobiusDynamicConfigChanged();
     
-        if (safeMode) {
-            // at this point we would normally send a MsgSamples
-            // down through KernelCommunicator, but we're going to play
-            // fast and loose and assume kernel was left in GlobalReset
-            kernel.slamSampleManager(manager);
-        }
-        else {
-            KernelMessage* msg = communicator.shellAlloc();
-            if (msg != nullptr) {
-                msg->type = MsgSamples;
-                msg->object.samples = manager;
-                communicator.shellSend(msg);
-            }
-        }
+        ConfigPayload* p = new ConfigPayload();
+        p->samples = manager;
+        sendKernelConfigure(p);
     }
 }
 
@@ -1107,7 +1154,7 @@ void MobiusShell::installScripts(ScriptConfig* config)
 {
     Trace(2, "MobiusShell::installScripts\n");
     Scriptarian* scriptarian =  compileScripts(config);
-    sendScripts(scriptarian, false);
+    sendScripts(scriptarian);
 }
 
 /**
@@ -1146,10 +1193,9 @@ Scriptarian* MobiusShell::compileScripts(ScriptConfig* src)
 
 /**
  * Send a previously constructed Scriptarian down to the core.
- * Like sendSamples, the safeMode flag is only true when we are
- * in test mode in where it is safe to skip the KernelCommunicator.
+ * Like sendSamples, it is adopted with the next block.
  */
-void MobiusShell::sendScripts(Scriptarian* scriptarian, bool safeMode)
+void MobiusShell::sendScripts(Scriptarian* scriptarian)
 {
     // refresh the symbol table for the scripts
     installSymbols(scriptarian);
@@ -1162,19 +1208,10 @@ void MobiusShell::sendScripts(Scriptarian* scriptarian, bool safeMode)
     if (listener != nullptr)
       listener->mobiusDynamicConfigChanged();
 
-    if (safeMode) {
-        Mobius* core = kernel.getCore();
-        core->slamScriptarian(scriptarian);
-    }
-    else {
-        // send it down
-        KernelMessage* msg = communicator.shellAlloc();
-        if (msg != nullptr) {
-            msg->type = MsgScripts;
-            msg->object.scripts = scriptarian;
-            communicator.shellSend(msg);
-        }
-    }
+    // send it down
+    ConfigPayload* p = new ConfigPayload();
+    p->scripts = scriptarian;
+    sendKernelConfigure(p);
 }
 
 /**
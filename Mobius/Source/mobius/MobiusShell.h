@@ -11,6 +11,7 @@
 #include "MobiusInterface.h"
 #include "KernelCommunicator.h"
 #include "AudioPool.h"
+#include "KernelPublisher.h"
 #include "MobiusKernel.h"
 #include "MobiusInterface.h"
 #include "KernelEventHandler.h"
@@ -33,8 +34,7 @@ class MobiusShell : public MobiusInterface
     void initialize(class ConfigPayload* payload) override;
     void propagateSymbolProperties() override;
     void reconfigure(class ConfigPayload* payload) override;
-    void initializeState(class SystemState* state) override;
-    void requestState(class SystemState* state) override;
+    void initializeState(class SystemStateBuffer* states) override;
     void refreshPriorityState(class PriorityState* state) override;
     void performMaintenance() override;
     void doAction(class UIAction* action) override;
@@ -82,14 +82,17 @@ class MobiusShell : public MobiusInterface
     
     // accessors for the Kernel only
     class UIActionPool* getActionPool();
+    class KernelPublisher* getPublisher() {
+        return &publisher;
+    }
     void doKernelEvent(class KernelEvent* e);
     
     // temporary accessors for TestDriver only
     class Scriptarian* compileScripts(class ScriptConfig* src);
-    void sendScripts(class Scriptarian* manager, bool safeMode);
+    void sendScripts(class Scriptarian* manager);
     
     class SampleManager* compileSamples(class SampleConfig* src);
-    void sendSamples(class SampleManager* manager, bool safeMode);
+    void sendSamples(class SampleManager* manager);
 
     bool suspendKernel();
     void resumeKernel();
@@ -118,6 +121,11 @@ class MobiusShell : public MobiusInterface
     // ActionPool is also shared with Kernel
     class UIActionPool actionPool;
 
+    // owns the configuration objects the kernel uses, like AudioPool
+    // this must be declared before Kernel so it outlives it, and
+    // after AudioPool since SampleManager returns things to it
+    KernelPublisher publisher;
+
     // the kernel itself
     // todo: try to avoid passing this down, can we do
     // everything with messages?
@@ -127,6 +135,9 @@ class MobiusShell : public MobiusInterface
 
     // flag enabling direct shell/kernel communication
     bool testMode = false;
+
+    // copy of the last Session sent to the kernel for differencing
+    std::unique_ptr<class Session> lastSession;
     
     //
     // internal functions
@@ -156,8 +167,10 @@ class MobiusShell : public MobiusInterface
     void initializeScripts();
     
     void consumeCommunications();
+    void prepareSession(class ConfigPayload* payload);
+    bool isSameTracks(class Session* last, class Session* neu);
+    void prepareTracks(class Session* last, class Session* neu, class ConfigPayload* payload);
     void sendKernelConfigure(class ConfigPayload* payload);
-    void sendKernelBinderator(class Binderator* b);
     void sendKernelAction(UIAction* action);
     void doKernelAction(UIAction* action);
 
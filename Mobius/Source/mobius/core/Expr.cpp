@@ -1055,6 +1055,16 @@ bool ExNode::isSymbol()
 	return false;
 }
 
+bool ExNode::isLiteral()
+{
+	return false;
+}
+
+bool ExNode::isPure()
+{
+	return false;
+}
+
 int ExNode::getPrecedence()
 {
 	return 0;
@@ -1137,6 +1147,16 @@ ExLiteral::ExLiteral(const char* str)
 	mValue.setString(str);
 }
 
+ExLiteral::ExLiteral(ExValue* value)
+{
+	mValue.set(value);
+}
+
+bool ExLiteral::isLiteral()
+{
+	return true;
+}
+
 void ExLiteral::eval(ExContext* context, ExValue* value)
 {
     (void)context;
@@ -1178,6 +1198,18 @@ const char* ExSymbol::getName()
 	return mName;
 }
 
+void ExSymbol::setResolver(ExResolver* r)
+{
+	delete mResolver;
+	mResolver = r;
+	mResolved = true;
+}
+
+bool ExSymbol::isResolved()
+{
+	return mResolved;
+}
+
 /**
  * If we have not looked for an ExResolver, do so now, but
  * only do this once.  If there is no resolver, the value is the
@@ -1217,6 +1249,11 @@ bool ExOperator::isOperator()
 	return true;
 }
 
+bool ExOperator::isPure()
+{
+	return true;
+}
+
 int ExOperator::getDesiredOperands()
 {
 	return 2;
@@ -2002,6 +2039,11 @@ const char* ExInt::getFunction()
 	return "int";
 }
 
+bool ExInt::isPure()
+{
+	return true;
+}
+
 void ExInt::eval(ExContext* context, ExValue* value)
 {
 	ExValue v;
@@ -2018,6 +2060,11 @@ const char* ExFloat::getFunction()
 	return "float";
 }
 
+bool ExFloat::isPure()
+{
+	return true;
+}
+
 void ExFloat::eval(ExContext* context, ExValue* value)
 {
 	ExValue v;
@@ -2034,6 +2081,11 @@ const char* ExString::getFunction()
 	return "string";
 }
 
+bool ExString::isPure()
+{
+	return true;
+}
+
 void ExString::eval(ExContext* context, ExValue* value)
 {
 	ExValue v;
@@ -2050,6 +2102,11 @@ const char* ExAbs::getFunction()
 	return "abs";
 }
 
+bool ExAbs::isPure()
+{
+	return true;
+}
+
 void ExAbs::eval(ExContext* context, ExValue* value)
 {
 	ExValue v;
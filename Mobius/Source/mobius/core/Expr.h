@@ -275,11 +275,16 @@ class ExNode {
 	virtual bool isOperator();
 	virtual bool isBlock();
 	virtual bool isSymbol();
+	virtual bool isLiteral();
 	virtual int getPrecedence();
     virtual int getDesiredOperands();
 
 	bool hasPrecedence(ExNode* other);
 
+    // true if the value depends only on the values of the children,
+    // these can be replaced with a literal when the children are literals
+    virtual bool isPure();
+
 	// runtime evaluation
 
 	virtual void toString(class Vbuf* b);
@@ -317,7 +322,9 @@ class ExLiteral : public ExNode {
 	ExLiteral(int i);
 	ExLiteral(float f);
 	ExLiteral(const char* str);
+	ExLiteral(ExValue* value);
 
+	bool isLiteral();
 	void toString(class Vbuf* b);
 	void eval(ExContext* context, ExValue *value);
 
@@ -344,6 +351,11 @@ class ExSymbol : public ExNode {
 	void toString(class Vbuf* b);
 	void eval(ExContext* context, ExValue *value);
 
+    // resolve the symbol before evaluation, ownership of the resolver
+    // transfers and it may be null if this is not a reference
+    void setResolver(ExResolver* r);
+    bool isResolved();
+
   private:
 
 	char* mName;
@@ -363,6 +375,7 @@ class ExOperator : public ExNode {
 	virtual const char* getOperator() = 0;
 	bool isOperator();
 	bool isParent();
+	bool isPure();
 	void toString(class Vbuf* b);
     virtual int getDesiredOperands();
 };
@@ -593,6 +606,7 @@ class ExIndex : public ExBlock {
 class ExInt : public ExFunction {
   public:
 	const char* getFunction();
+	bool isPure();
 	void eval(ExContext* context, ExValue* value);
 };
 
@@ -602,6 +616,7 @@ class ExInt : public ExFunction {
 class ExFloat : public ExFunction {
   public:
 	const char* getFunction();
+	bool isPure();
 	void eval(ExContext* context, ExValue* value);
 };
 
@@ -611,6 +626,7 @@ class ExFloat : public ExFunction {
 class ExString : public ExFunction {
   public:
 	const char* getFunction();
+	bool isPure();
 	void eval(ExContext* context, ExValue* value);
 };
 
@@ -631,6 +647,7 @@ class ExRand : public ExFunction {
 class ExAbs : public ExFunction {
   public:
 	const char* getFunction();
+	bool isPure();
 	void eval(ExContext* context, ExValue* value);
 };
 
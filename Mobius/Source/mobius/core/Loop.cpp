@@ -1127,6 +1127,24 @@ void Loop::refreshState(TrackState* s)
       s->historyFrames = (int)getHistoryFrames();
     else
       s->historyFrames = 0;
+
+    // waveform, the record layer only has everything during the initial
+    // recording, after that show the play layer and new overdubs appear
+    // when the layer is shifted
+    s->peakCount = 0;
+    s->peakOffset = 0;
+    s->peakLayer = 0;
+    s->peakChanges = 0;
+    Layer* peakLayer = (mMode == RecordMode) ? mRecord : mPlay;
+    if (peakLayer != nullptr) {
+        Audio* audio = peakLayer->getAudio();
+        if (audio != nullptr) {
+            s->peakCount = audio->getPeaks(s->peaks.getRawDataPointer(), s->peaks.size(),
+                                           &(s->peakOffset));
+            s->peakLayer = peakLayer->getNumber();
+            s->peakChanges = audio->getPeakChanges();
+        }
+    }
     
 	// these are set during buffer processing, and are cleared when
 	// the application requests them, avoid having to have a callback
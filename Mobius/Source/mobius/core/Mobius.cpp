@@ -141,8 +141,7 @@ Mobius::~Mobius()
     // mContainer, mAudioPool
 
     delete mCaptureAudio;
-    delete mScriptarian;
-    delete mPendingScriptarian;
+    // Scriptarians belong to KernelPublisher
     
 	for (int i = 0 ; i < mTrackCount ; i++) {
 		Track* t = mTracks[i];
@@ -290,25 +289,6 @@ void Mobius::refreshParameters()
 	}
 }
 
-/**
- * Special accessor just for MobiusShell/UnitTests to slam in
- * a new Scriptarian without checking to see if we're busy or
- * sending back the old one.  This can only be called in
- * a state of GlobalReset with nothing pending in the audio interrupt
- * to mess things up.
- *
- * Used during the initialize() process, and by UnitTestMode.
- */
-void Mobius::slamScriptarian(Scriptarian* neu)
-{
-    if (mScriptarian != nullptr && mScriptarian->isBusy()) {
-        Trace(1, "Mobius:slamScriptarian Scriptarian is busy, and you are in serious trouble son\n");
-    }
-
-    delete mScriptarian;
-    mScriptarian = neu;
-}
-
 /**
  * Annotate function and parameter Symbols with things from the old
  * static definitions.
@@ -466,6 +446,10 @@ void Mobius::configureTracks(juce::Array<MobiusLooperTrack*>& trackdefs)
     }
     else {
         Trace(2, "Mobius::configureTracks Reconfiguring tracks");
+
+        // note: unlike LogicalTracks, which the shell builds and deletes,
+        // core Tracks are still made and deleted here in the audio thread
+        // when the track count changes
             
         // remember the ones we have now in a better collection
         juce::Array<Track*> existing;
@@ -582,13 +566,16 @@ void Mobius::doTrackReset(Track* t)
  * but we can't depend on that safely.
  *
  * If the current Scriptarian is busy, wait until it isn't.
+ *
+ * Old ones are never deleted here, the shell owns them and deletes
+ * them after MobiusKernel says it has moved past them, which it won't
+ * do while one is pending.
  */
 void Mobius::installScripts(Scriptarian* neu)
 {
     if (mPendingScriptarian != nullptr) {
         // the user is apparently impatient and keeps sending them down
         // ignore the last one
-        mKernel->returnScriptarian(mPendingScriptarian);
         mPendingScriptarian = nullptr;
         Trace(1, "Pending Scriptarian was not consumed before we received another!\n");
         Trace(1, "This may indiciate a hung script\n");
@@ -599,8 +586,6 @@ void Mobius::installScripts(Scriptarian* neu)
         mPendingScriptarian = neu;
     }
     else {
-        if (mScriptarian != nullptr)
-          mKernel->returnScriptarian(mScriptarian);
         mScriptarian = neu;
     }
 }
@@ -809,7 +794,6 @@ void Mobius::beginAudioBlock(MobiusAudioStream* stream)
             mPendingScriptarian = nullptr;
         }
         else if (!mScriptarian->isBusy()) {
-            mKernel->returnScriptarian(mScriptarian);
             mScriptarian = mPendingScriptarian;
             mPendingScriptarian = nullptr;
         }
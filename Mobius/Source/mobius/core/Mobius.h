@@ -145,6 +145,14 @@ class Mobius
      * after we've been initialized and running.
      */
     void installScripts(class Scriptarian* s);
+
+    /**
+     * True if a new Scriptarian is waiting for running scripts
+     * to finish, the old one is still in use.
+     */
+    bool isScriptarianPending() {
+        return (mPendingScriptarian != nullptr);
+    }
     
     /**
      * Retrieve the capture audio for the KernelEvent handler
@@ -158,11 +166,6 @@ class Mobius
      */
 	class Audio* getPlaybackAudio();
 
-    /**
-     * Special interface only for UnitTests
-     */
-    void slamScriptarian(class Scriptarian* scriptarian);
-
     /**
      * Install Audio loaded from above into a loop.
      */
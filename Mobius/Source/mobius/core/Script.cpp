@@ -204,6 +204,70 @@ ScriptResolver::~ScriptResolver()
 	// we don't own the symbol, it owns us
 }
 
+/**
+ * An array containing names of variables that may be set by the interpreter
+ * but do not need to be declared.
+ */
+const char* InterpreterVariables[] = {
+    "interrupted",
+    nullptr
+};
+
+/**
+ * Search for a stack argument, internal variable, block variable,
+ * parameter, or auto-declared interpreter variable with the symbol's name.
+ * This is done by ScriptCompiler after the script has been parsed so
+ * evaluation never has to search by name.  
+ */
+ScriptResolver* ScriptResolver::resolve(Mobius* m, ScriptBlock* block, ExSymbol* symbol)
+{
+	ScriptResolver* resolver = nullptr;
+	const char* name = symbol->getName();
+	int arg = 0;
+
+	// a leading $ is required for numeric stack argument references,
+	// but must also support them for legacy symbolic references
+	if (name[0] == '$') {
+		name = &name[1];
+		arg = ToInt(name);
+	}
+
+	if (arg > 0)
+	  resolver = NEW2(ScriptResolver, symbol, arg);
+
+    // next try internal variables
+	if (resolver == nullptr) {
+		ScriptInternalVariable* iv = ScriptInternalVariable::getVariable(name);
+		if (iv != nullptr)
+		  resolver = NEW2(ScriptResolver, symbol, iv);
+	}
+    
+    // next look for a Variable in the innermost block
+	if (resolver == nullptr && block != nullptr) {
+        ScriptVariableStatement* v = block->findVariable(name);
+        if (v != nullptr)
+          resolver = NEW2(ScriptResolver, symbol, v);
+    }
+
+    if (resolver == nullptr) {
+        Symbol* s = m->findSymbol(name);
+        if (s != nullptr && s->parameterProperties != nullptr)
+          resolver = NEW2(ScriptResolver, symbol, s);
+    }
+
+    // try some auto-declared system variables
+    if (resolver == nullptr) {
+        for (int i = 0 ; InterpreterVariables[i] != nullptr ; i++) {
+            if (StringEqualNoCase(name, InterpreterVariables[i])) {
+                resolver = NEW2(ScriptResolver, symbol, name);
+                break;
+            }
+        }
+    }
+
+	return resolver;
+}
+
 /**
  * Return the value of a resolved reference.
  * The ExContext passed here will be a ScriptInterpreter.
@@ -2760,9 +2824,8 @@ void ScriptCallStatement::resolve(Mobius* m)
 	// think locally, then globally
 	mProc = mParentBlock->findProc(mArgs[0]);
 	
-    // TODO: I don't like deferring resolution within
-    // the ExNode until the first evaluation.  Find a way to do at least
-    // most of them now.
+    // symbols within the ExNode are resolved by ScriptCompiler
+    // once the whole script has been parsed
 }
 
 /**
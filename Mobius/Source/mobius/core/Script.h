@@ -480,6 +480,14 @@ class ScriptResolver : public ExResolver {
 	ScriptResolver(ExSymbol* symbol, const char* name);
 	~ScriptResolver();
 
+    /**
+     * Find what a symbol in an expression refers to, as seen from
+     * a block.  Returns nullptr if it is not a reference in which
+     * case the value is the symbol name.
+     */
+    static ScriptResolver* resolve(class Mobius* m, class ScriptBlock* block,
+                                   ExSymbol* symbol);
+
 	void getExValue(ExContext* exContext, ExValue* value);
 
   private:
@@ -21,12 +21,15 @@
  * 
  */
 
+#include <JuceHeader.h>
+
 #include "../../util/Trace.h"
 #include "../../util/Util.h"
 #include "../../model/ScriptConfig.h"
 #include "../../script/MslError.h"
 
 #include "Mobius.h"
+#include "Expr.h"
 #include "Script.h"
 
 #include "ScriptCompiler.h"
@@ -107,6 +110,8 @@ MScriptLibrary* ScriptCompiler::compile(Mobius* m, ScriptConfig* config)
     
     mLibrary->setScripts(mScripts);
 
+    traceStatistics();
+
     // ownership transfers
     MScriptLibrary* retval = mLibrary;
     mLibrary = nullptr;
@@ -185,6 +190,9 @@ void ScriptCompiler::link(Script* s)
     mScript = s;
 
     s->link(this);
+
+    // in case linking parsed anything
+    resolveExpressions();
 }
 
 /**
@@ -206,6 +214,7 @@ void ScriptCompiler::parse(ScriptRef* ref)
 		}
         else {
 			Trace(2, "Reading Mobius script %s\n", filename);
+            double start = juce::Time::getMillisecondCounterHiRes();
 
             Script* script = new Script(mLibrary, filename);
             
@@ -243,6 +252,7 @@ void ScriptCompiler::parse(ScriptRef* ref)
             // new way of marking test scripts
             script->setTest(ref->isTest());
 
+            ref->parseTime = juce::Time::getMillisecondCounterHiRes() - start;
             mScriptRef = nullptr;
         }
     }
@@ -263,6 +273,7 @@ bool ScriptCompiler::parse(FILE* fp, Script* script)
     // NOTE: If this is still being interpreted someone has to wait
     // for all threads to finish...how does THAt work?
 	mScript->clear();
+    mPending.clear();
 
     // start by parsing in to the script block
     mBlock = mScript->getBlock();
@@ -431,6 +442,9 @@ bool ScriptCompiler::parse(FILE* fp, Script* script)
     // do internal resolution
     script->resolve(mMobius);
 
+    // and the symbols in expressions now that the blocks are complete
+    resolveExpressions();
+
     // TODO: do some sanity checks, like looking for Param
     // statements in a script that isn't declared with !parameter
 
@@ -747,10 +761,113 @@ ExNode* ScriptCompiler::parseExpression(ScriptStatement* stmt,
         // will need to look at one of these to pick the right formatting
         addError(buffer, line);
 	}
+    else if (expr != nullptr) {
+        mExpressions++;
+        expr = fold(expr);
+        PendingExpression pending;
+        pending.statement = stmt;
+        pending.node = expr;
+        mPending.push_back(pending);
+    }
 
 	return expr;
 }
 
+//////////////////////////////////////////////////////////////////////
+//
+// Expression Optimization
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Replace operators and the pure functions whose operands are all
+ * literals with the literal result.  Children are folded first so
+ * this works up from the leaves.  Lists are left alone, literals can't
+ * hold them.
+ */
+ExNode* ScriptCompiler::fold(ExNode* node)
+{
+    ExNode* result = node;
+    bool constant = node->isPure();
+
+    ExNode* child = node->stealChildren();
+    while (child != nullptr) {
+        ExNode* next = child->getNext();
+        child->setNext(nullptr);
+        child = fold(child);
+        if (!child->isLiteral())
+          constant = false;
+        node->addChild(child);
+        child = next;
+    }
+
+    if (constant) {
+        // no context, nothing below here needs it
+        ExValue value;
+        node->eval(nullptr, &value);
+        if (value.getType() != EX_LIST) {
+            result = NEW1(ExLiteral, &value);
+            result->setParent(node->getParent());
+            delete node;
+            mFolded++;
+        }
+    }
+    return result;
+}
+
+/**
+ * Resolve the symbols in the expressions parsed since the last time.
+ * This used to happen when each symbol was first evaluated, which meant
+ * searching internal variables, script variables and parameters by name
+ * and allocating resolvers in the audio thread.
+ */
+void ScriptCompiler::resolveExpressions()
+{
+    double start = juce::Time::getMillisecondCounterHiRes();
+    
+    for (auto& pending : mPending) {
+        ScriptBlock* block = pending.statement->getParentBlock();
+        if (block == nullptr) {
+            // parsed but never added to a block, leave it for
+            // the interpreter to resolve
+            Trace(1, "ScriptCompiler: Expression statement has no block\n");
+        }
+        else {
+            resolveSymbols(block, pending.node);
+        }
+    }
+    mPending.clear();
+
+    mResolveTime += juce::Time::getMillisecondCounterHiRes() - start;
+}
+
+void ScriptCompiler::resolveSymbols(ScriptBlock* block, ExNode* node)
+{
+    for ( ; node != nullptr ; node = node->getNext()) {
+        if (node->isSymbol()) {
+            ExSymbol* symbol = (ExSymbol*)node;
+            if (!symbol->isResolved()) {
+                ScriptResolver* resolver = ScriptResolver::resolve(mMobius, block, symbol);
+                symbol->setResolver(resolver);
+                if (resolver != nullptr)
+                  mResolved++;
+                else
+                  mUnresolved++;
+            }
+        }
+        else if (node->isBlock() && ((ExBlock*)node)->isIndex()) {
+            resolveSymbols(block, ((ExIndex*)node)->getIndexes());
+        }
+        resolveSymbols(block, node->getChildren());
+    }
+}
+
+void ScriptCompiler::traceStatistics()
+{
+    Trace(2, "ScriptCompiler: %d expressions %d folded %d symbols resolved %d literal symbols in %d msec\n",
+          mExpressions, mFolded, mResolved, mUnresolved, (int)mResolveTime);
+}
+
 /**
  * Generic syntax error callback.
  */
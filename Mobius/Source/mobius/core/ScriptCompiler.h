@@ -2,6 +2,7 @@
 #pragma once
 
 #include <stdio.h>
+#include <vector>
 
 /****************************************************************************
  *                                                                          *
@@ -62,6 +63,11 @@ class ScriptCompiler {
     void link(class Script* s);
     Script* resolveScript(class Script* scripts, const char* name);
 
+    class ExNode* fold(class ExNode* node);
+    void resolveExpressions();
+    void resolveSymbols(class ScriptBlock* block, class ExNode* node);
+    void traceStatistics();
+
     /**
      * Supplies resolution for some references.
      */
@@ -95,6 +101,25 @@ class ScriptCompiler {
     ScriptRef* mScriptRef = nullptr;
     void addError(const char* msg, int line = 0);
 
+    /**
+     * Expressions parsed since the last resolution pass and the
+     * statements that own them.  Symbols can't be resolved until the
+     * statement is in a block and the block has all of its variables.
+     */
+    class PendingExpression {
+      public:
+        class ScriptStatement* statement = nullptr;
+        class ExNode* node = nullptr;
+    };
+    std::vector<PendingExpression> mPending;
+
+    // statistics for the compilation
+    int mExpressions = 0;
+    int mFolded = 0;
+    int mResolved = 0;
+    int mUnresolved = 0;
+    double mResolveTime = 0.0;
+
 };
 
 /****************************************************************************/
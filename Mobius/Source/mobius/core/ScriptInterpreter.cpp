@@ -1363,15 +1363,6 @@ void ScriptInterpreter::expand(const char* value, ExValue* retval)
  *                                                                          *
  ****************************************************************************/
 
-/**
- * An array containing names of variables that may be set by the interpreter
- * but do not need to be declared.
- */
-const char* InterpreterVariables[] = {
-    "interrupted",
-    nullptr
-};
-
 /**
  * ExContext interface.
  * Given the a symbol in an expression, search for a parameter,
@@ -1379,70 +1370,25 @@ const char* InterpreterVariables[] = {
  * If one is found return an ExResolver that will be called during evaluation
  * to retrieve the value.
  *
- * Note that this is called during the first evaluation, so we have
- * to get the current script from the interpreter stack.  
- *
- * !! Consider doing resolver assignment up front for consistency
- * with how ScriptArguments are resolved?
- * 
+ * ScriptCompiler now resolves every symbol before the script is installed
+ * so this should only be reached by expressions built somewhere else.
+ * It is called during the first evaluation, so we have to get the current
+ * script from the interpreter stack.
  */
 ExResolver* ScriptInterpreter::getExResolver(ExSymbol* symbol)
 {
-	ExResolver* resolver = nullptr;
-	const char* name = symbol->getName();
-	int arg = 0;
-
-	// a leading $ is required for numeric stack argument references,
-	// but must also support them for legacy symbolic references
-	if (name[0] == '$') {
-		name = &name[1];
-		arg = ToInt(name);
-	}
-
-	if (arg > 0)
-	  resolver = NEW2(ScriptResolver, symbol, arg);
-
-    // next try internal variables
-	if (resolver == nullptr) {
-		ScriptInternalVariable* iv = ScriptInternalVariable::getVariable(name);
-		if (iv != nullptr)
-		  resolver = NEW2(ScriptResolver, symbol, iv);
-	}
+    ScriptBlock* block = nullptr;
     
-    // next look for a Variable in the innermost block
-	if (resolver == nullptr) {
-        // we should only be called during evaluation!
-        if (mStatement == nullptr)
-          Trace(1, "Script %s: getExResolver has no statement!\n", getTraceName());
-        else {
-            ScriptBlock* block = mStatement->getParentBlock();
-            if (block == nullptr)
-              Trace(1, "Script %s: getExResolver has no block!\n", getTraceName());
-            else {
-                ScriptVariableStatement* v = block->findVariable(name);
-                if (v != nullptr)
-                  resolver = NEW2(ScriptResolver, symbol, v);
-            }
-        }
-    }
-
-    if (resolver == nullptr) {
-        Symbol* s = mMobius->findSymbol(name);
-        if (s != nullptr && s->parameterProperties != nullptr)
-          resolver = NEW2(ScriptResolver, symbol, s);
-    }
-
-    // try some auto-declared system variables
-    if (resolver == nullptr) {
-        for (int i = 0 ; InterpreterVariables[i] != nullptr ; i++) {
-            if (StringEqualNoCase(name, InterpreterVariables[i])) {
-                resolver = NEW2(ScriptResolver, symbol, name);
-                break;
-            }
-        }
+    // we should only be called during evaluation!
+    if (mStatement == nullptr)
+      Trace(1, "Script %s: getExResolver has no statement!\n", getTraceName());
+    else {
+        block = mStatement->getParentBlock();
+        if (block == nullptr)
+          Trace(1, "Script %s: getExResolver has no block!\n", getTraceName());
     }
 
-	return resolver;
+	return ScriptResolver::resolve(mMobius, block, symbol);
 }
 
 /**
@@ -2111,6 +2111,59 @@ void InputStream::setInputBuffer(MobiusAudioStream* aus, float* input,
 	scaleInput();
 }
 
+/**
+ * Variant of setInputBuffer used when the container can give us the
+ * host's non-interleaved channels directly.  Since we always make a
+ * level adjusted copy we can interleave as we go, which saves the container
+ * from interleaving the port just so we can copy it again.
+ *
+ * There is no original buffer to remember, so notifyBufferModified
+ * will never match.  Containers only offer planar input when nothing
+ * has touched the interleaved port buffer, and SampleManager always does
+ * when samples are loaded, so that's what we want.
+ */
+void InputStream::setInputBuffer(MobiusAudioStream* aus, const float* left,
+                                 const float* right, long srcFrames, float* echo)
+{
+    (void)aus;
+	mAudioBuffer = nullptr;
+	mAudioBufferFrames = srcFrames;
+	mOriginalFramesConsumed = 0;
+	mAudioPtr = mLevelBuffer;
+	mRemainingFrames = srcFrames;
+
+    float max = 0.0f;
+    int sample = 0;
+
+	for (int i = 0 ; i < srcFrames ; i++) {
+        float level = mSmoother->getValue();
+        float l = left[i];
+        float r = right[i];
+
+        mLevelBuffer[sample] = l * level;
+        mLevelBuffer[sample+1] = r * level;
+        if (mSmoother->isActive())
+          mSmoother->advance();
+
+        if (echo != nullptr) {
+            echo[sample] += l;
+            echo[sample+1] += r;
+        }
+        sample += 2;
+
+        if (l < 0) l = -l;
+        if (r < 0) r = -r;
+        if (l > max) max = l;
+        if (r > max) max = r;
+	}
+
+    // convert to 16 bit integer
+    mMonitorLevel = (int)(max * 32767.0f);
+
+	// do rate processing
+	scaleInput();
+}
+
 /**
  * Called indirectly by SampleManager when one of the original
  * input buffers was modified to inject Sample content.
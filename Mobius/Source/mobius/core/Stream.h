@@ -343,6 +343,8 @@ class InputStream : public Stream {
     void setPlugin(class StreamPlugin* plugin);
 	void setInputBuffer(class MobiusAudioStream* stream, float* input, long frames, 
 						float* echo);
+	void setInputBuffer(class MobiusAudioStream* stream, const float* left,
+                        const float* right, long frames, float* echo);
 
     void notifyBufferModified(float* buffer);
 
@@ -1177,6 +1177,11 @@ bool Track::isPriority()
 /**
  * The new primary interface for buffer processing without Recorder.
  * Forwards to the old method after locating the right port buffers.
+ *
+ * If the stream can give us the input channels directly we read those
+ * and the port is never interleaved.  Output is always interleaved since
+ * the host buffers are usually shared with the input and other tracks
+ * may not have read them yet.
  */
 void Track::processAudioStream(MobiusAudioStream* stream)
 {
@@ -1184,11 +1189,33 @@ void Track::processAudioStream(MobiusAudioStream* stream)
 
     float* input = nullptr;
     float* output = nullptr;
-    
-    stream->getInterruptBuffers(mInputPort, &input,
-                                   mOutputPort, &output);
-    
-    processBuffers(stream, input, output, frames);
+    const float* left = nullptr;
+    const float* right = nullptr;
+
+    if (stream->getPlanarInput(mInputPort, &left, &right)) {
+        stream->getInterruptBuffers(mInputPort, nullptr,
+                                    mOutputPort, &output);
+    }
+    else {
+        left = nullptr;
+        right = nullptr;
+        stream->getInterruptBuffers(mInputPort, &input,
+                                    mOutputPort, &output);
+    }
+
+    // when rendering stems, the track plays into its own buffer which
+    // is then mixed into the shared port
+    float* tap = stream->getTrackOutputBuffer(getLogicalNumber());
+    if (tap == nullptr || output == nullptr) {
+        processBuffers(stream, input, left, right, output, frames);
+    }
+    else {
+        long samples = frames * 2;
+        memset(tap, 0, sizeof(float) * samples);
+        processBuffers(stream, input, left, right, tap, frames);
+        for (long i = 0 ; i < samples ; i++)
+          output[i] += tap[i];
+    }
 }
 
 /**
@@ -1212,7 +1239,8 @@ void Track::processAudioStream(MobiusAudioStream* stream)
  * to maintain another pointer.
  */
 void Track::processBuffers(MobiusAudioStream* stream, 
-						   float* inbuf, float *outbuf, long frames)
+						   float* inbuf, const float* inLeft, const float* inRight,
+                           float *outbuf, long frames)
 {
 	int eventsProcessed = 0;
     long startFrame = mLoop->getFrame();
@@ -1232,7 +1260,8 @@ void Track::processBuffers(MobiusAudioStream* stream,
 	// Expect there to be both buffers, there's too much logic build
 	// around this.  Also, when we're debugging PortAudio feeds them
 	// to us out of sync.
-	if (inbuf == nullptr || outbuf == nullptr) {	
+    bool planar = (inLeft != nullptr && inRight != nullptr);
+	if ((inbuf == nullptr && !planar) || outbuf == nullptr) {
 		if (inbuf == nullptr && outbuf == nullptr)
 		  Trace(this, 1, "Audio buffers both null, dropping interrupt\n");
 		else if (inbuf == nullptr)
@@ -1255,7 +1284,10 @@ void Track::processBuffers(MobiusAudioStream* stream,
     // no longer need this
 	//mSynchronizer->prepare(this);
 
-	mInput->setInputBuffer(stream, inbuf, frames, echo);
+    if (planar)
+      mInput->setInputBuffer(stream, inLeft, inRight, frames, echo);
+    else
+      mInput->setInputBuffer(stream, inbuf, frames, echo);
     mOutput->setOutputBuffer(stream, outbuf, frames);
 
     // Streams do funky stuff for speed scaling, sync drift needs
@@ -282,7 +282,8 @@ class Track : public TraceContext
 	float* playTailRegion(float* outbuf, long frames);
 
     void processBuffers(class MobiusAudioStream* stream, 
-                        float* inbuf, float *outbuf, long frames);
+                        float* inbuf, const float* inLeft, const float* inRight,
+                        float *outbuf, long frames);
 
     void notifyBufferModified(float* buffer);
     
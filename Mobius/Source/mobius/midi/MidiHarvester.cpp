@@ -32,6 +32,7 @@ MidiHarvester::~MidiHarvester()
     if (pools != nullptr) {
         pools->clear(&playNotes);
         pools->clear(&playEvents);
+        pools->clear(&heldNotes);
     }
 }
 
@@ -44,6 +45,7 @@ void MidiHarvester::reset()
 {
     pools->clear(&playNotes);
     pools->clear(&playEvents);
+    pools->clear(&heldNotes);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -78,6 +80,9 @@ void MidiHarvester::harvestRange(MidiLayer* layer, int startFrame, int endFrame,
     }
 
     MidiEvent* nextEvent = layer->seekNextEvent;
+    if (layer->isPacked())
+      harvestPacked(layer, endFrame, heldOnly, noteResult, eventResult);
+    
     while (nextEvent != nullptr) {
 
         if (nextEvent->frame <= endFrame) {
@@ -164,6 +169,29 @@ void MidiHarvester::harvestRange(MidiLayer* layer, int startFrame, int endFrame,
     layer->seekNextSegment = nextSegment;
 }
 
+/**
+ * Finished layers keep their events packed, this walks them from the
+ * cursor the same way harvestRange walks the sequence.
+ */
+void MidiHarvester::harvestPacked(MidiLayer* layer, int endFrame, bool heldOnly,
+                                  MidiSequence* noteResult, MidiSequence* eventResult)
+{
+    MidiPackedSequence* packed = layer->getPacked();
+    int count = packed->size();
+    int next = layer->seekNextPacked;
+    while (next < count) {
+        MidiPackedSequence::Event& e = packed->get(next);
+        if (e.frame > endFrame)
+          break;
+
+        int eventLast = e.frame + e.duration - 1;
+        if (!heldOnly || eventLast > endFrame)
+          (void)add(packed, next, noteResult, eventResult);
+        next++;
+    }
+    layer->seekNextPacked = next;
+}
+
 /**
  * Orient the play cursor to include the given range.
  */
@@ -172,16 +200,10 @@ void MidiHarvester::seek(MidiLayer* layer, int startFrame)
     MidiEvent* nextEvent = nullptr;
     
     MidiSequence* sequence = layer->getSequence();
-    if (sequence != nullptr) {
-        MidiEvent* event = sequence->getFirst();
-        while (event != nullptr) {
-            if (event->frame < startFrame)
-              event = event->next;
-            else
-              break;
-        }
-        nextEvent = event;
-    }
+    if (sequence != nullptr)
+      nextEvent = sequence->seek(startFrame);
+    if (layer->isPacked())
+      layer->seekNextPacked = layer->getPacked()->seek(startFrame);
 
     MidiSegment* seg = layer->getSegments();
     while (seg != nullptr) {
@@ -411,6 +433,31 @@ MidiEvent* MidiHarvester::add(MidiEvent* e, MidiSequence* noteResult, MidiSequen
     return copy;
 }
 
+/**
+ * Same for packed events, the peer isn't needed for these since
+ * they are not being recorded.
+ */
+MidiEvent* MidiHarvester::add(MidiPackedSequence* packed, int index,
+                              MidiSequence* noteResult, MidiSequence* eventResult)
+{
+    MidiEvent* copy = nullptr;
+    
+    if (packed->isNoteOff(index)) {
+        Trace(1, "MidiHarvester: Encountered NoteOff event, what's the deal?");
+    }
+    else if (packed->isNoteOn(index)) {
+        copy = pools->newEvent();
+        packed->toEvent(index, copy);
+        noteResult->add(copy);
+    }
+    else if (eventResult != nullptr) {
+        copy = pools->newEvent();
+        packed->toEvent(index, copy);
+        eventResult->add(copy);
+    }
+    return copy;
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // Playback Harvest
@@ -464,7 +511,6 @@ void MidiHarvester::harvestPrefix(MidiSegment* segment)
     int blockSize = 1024;
     int remaining = endFrame - startFrame + 1;
 
-    MidiSequence heldNotes;
     while (remaining > 0) {
 
         if (remaining < blockSize)
@@ -530,7 +576,15 @@ MidiFragment* MidiHarvester::harvestCheckpoint(MidiLayer* layer, int frame)
     // the entire range, assume this works do prefix harvesting the same way
     int blockSize = endFrame - startFrame + 1;
 
-    MidiSequence heldNotes;
+    // segments start from the beginning to pick up prefixes, but the layer's
+    // own events can start from the first one that might still be held
+    seek(layer, startFrame);
+    MidiSequence* sequence = layer->getSequence();
+    if (sequence != nullptr)
+      layer->seekNextEvent = sequence->seekHeld(endFrame);
+    if (layer->isPacked())
+      layer->seekNextPacked = layer->getPacked()->seekHeld(endFrame);
+
     harvestRange(layer, startFrame, startFrame + blockSize - 1,
                  true, true, &heldNotes, nullptr);
 
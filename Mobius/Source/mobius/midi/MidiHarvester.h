@@ -17,6 +17,7 @@
 #include <JuceHeader.h>
 
 #include "../../midi/MidiSequence.h"
+#include "../../midi/MidiPackedSequence.h"
 
 class MidiHarvester
 {
@@ -65,11 +66,18 @@ class MidiHarvester
     class MidiSequence playNotes;
     class MidiSequence playEvents;
 
+    // scratch for prefix and checkpoint harvesting, emptied
+    // by transferring what is left to the result
+    class MidiSequence heldNotes;
+
     void harvestRange(class MidiLayer* layer, int startFrame, int endFrame,
                       bool heldOnly, bool forceFirstPrefix,
                       class MidiSequence* noteResult, class MidiSequence* eventResult);
 
     void seek(class MidiLayer* layer, int startFrame);
+
+    void harvestPacked(class MidiLayer* layer, int endFrame, bool heldOnly,
+                       class MidiSequence* noteResult, class MidiSequence* eventResult);
     
     void harvest(class MidiSegment* segment, int startFrame, int endFrame,
                  bool heldOnly, bool forceFirstPrefix,
@@ -79,6 +87,8 @@ class MidiHarvester
     
     class MidiEvent* add(class MidiEvent* e, class MidiSequence* noteResult,
                          class MidiSequence* eventResult);
+    class MidiEvent* add(class MidiPackedSequence* packed, int index,
+                         class MidiSequence* noteResult, class MidiSequence* eventResult);
     
     void decay(class MidiSequence* seq, int blockSize);
 
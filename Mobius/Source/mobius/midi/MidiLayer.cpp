@@ -32,8 +32,11 @@ MidiLayer::~MidiLayer()
 void MidiLayer::poolInit()
 {
     next = nullptr;
+    nextPack = nullptr;
+    packPending = false;
     pools = nullptr;
     sequence = nullptr;
+    packed.reset();
     segments = nullptr;
     fragments = nullptr;
     layerFrames = 0;
@@ -68,6 +71,7 @@ void MidiLayer::clear()
 {
     pools->reclaim(sequence);
     sequence = nullptr;
+    packed.clear(pools->getChunkPool());
 
     clearSegments();
     clearFragments();
@@ -104,6 +108,23 @@ void MidiLayer::setSequence(MidiSequence* seq)
     layerCycles = 1;
 }
 
+/**
+ * Convert the sequence to packed form and return the events to the pool.
+ * Only done for layers nothing is recording into, the recorder keeps
+ * pointers to held notes in the sequence.  Sequences that are too
+ * large or have sysex stay as they are.
+ */
+void MidiLayer::pack()
+{
+    if (sequence != nullptr && sequence->size() > 0) {
+        if (packed.pack(pools->getChunkPool(), sequence)) {
+            pools->reclaim(sequence);
+            sequence = nullptr;
+            resetPlayState();
+        }
+    }
+}
+
 void MidiLayer::clearSegments()
 {
     while (segments != nullptr) {
@@ -172,6 +193,7 @@ void MidiLayer::resetPlayState()
 {
     seekFrame = -1;
     seekNextEvent = nullptr;
+    seekNextPacked = 0;
     seekNextSegment = nullptr;
 }
 
@@ -263,6 +285,8 @@ int MidiLayer::getCycles()
 
 int MidiLayer::getEventCount()
 {
+    if (isPacked())
+      return packed.size();
     return (sequence != nullptr) ? sequence->size() : 0;
 }
 
@@ -300,7 +324,10 @@ void MidiLayer::copy(MidiLayer* src, int start, int end, int origin)
 {
     Trace(2, "MidiLayer: Copy layer %d %d %d", start, end, origin);
     // first the sequence
-    copy(src->getSequence(), start, end, origin);
+    if (src->isPacked())
+      copy(src->getPacked(), start, end, origin);
+    else
+      copy(src->getSequence(), start, end, origin);
     
     // then the segments
     MidiSegment* seg = src->getSegments();
@@ -316,7 +343,7 @@ void MidiLayer::copy(MidiLayer* src, int start, int end, int origin)
 void MidiLayer::copy(MidiSequence* src, int start, int end, int origin)
 {
     if (src != nullptr) {
-        MidiEvent* event = src->getFirst();
+        MidiEvent* event = src->seek(start);
         while (event != nullptr) {
             if (event->frame >= end)
               break;
@@ -336,6 +363,18 @@ void MidiLayer::copy(MidiSequence* src, int start, int end, int origin)
     }
 }
 
+void MidiLayer::copy(MidiPackedSequence* src, int start, int end, int origin)
+{
+    for (int i = src->seek(start) ; i < src->size() ; i++) {
+        if (src->get(i).frame >= end)
+          break;
+        MidiEvent* ce = pools->newEvent();
+        src->toEvent(i, ce);
+        ce->frame += origin;
+        sequence->insert(ce);
+    }
+}
+
 void MidiLayer::copy(MidiSegment* seg, int origin)
 {
     copy(seg->layer, seg->referenceFrame, seg->referenceFrame + seg->segmentFrames, origin);
@@ -405,6 +444,9 @@ void MidiLayer::dump(StructureDumper& d, bool primary)
         if (sequence != nullptr) {
             sequence->dump(d);
         }
+        if (isPacked()) {
+            packed.dump(d);
+        }
 
         for (MidiSegment* seg = segments ; seg != nullptr ; seg = seg->next) {
             seg->dump(d);
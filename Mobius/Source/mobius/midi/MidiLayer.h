@@ -4,6 +4,7 @@
 #include <JuceHeader.h>
 
 #include "../../model/ObjectPool.h"
+#include "../../midi/MidiPackedSequence.h"
 
 class MidiLayer : public PooledObject
 {
@@ -16,6 +17,10 @@ class MidiLayer : public PooledObject
     
     MidiLayer* next = nullptr;
     int number = 0;
+
+    // MidiLoop's list of layers waiting to be packed
+    MidiLayer* nextPack = nullptr;
+    bool packPending = false;
     
     void dump(class StructureDumper& d, bool primary = false);
     void poolInit() override;
@@ -26,6 +31,18 @@ class MidiLayer : public PooledObject
     }
 
     void setSequence(MidiSequence* seq);
+
+    /**
+     * Finished layers keep their events in packed form.  Once packed
+     * getSequence returns nullptr.
+     */
+    void pack();
+    bool isPacked() {
+        return packed.size() > 0;
+    }
+    MidiPackedSequence* getPacked() {
+        return &packed;
+    }
     
     class MidiSegment* getSegments() {
         return segments;
@@ -69,12 +86,14 @@ class MidiLayer : public PooledObject
     
     int seekFrame = -1;
     class MidiEvent* seekNextEvent = nullptr;
+    int seekNextPacked = 0;
     class MidiSegment* seekNextSegment = nullptr;
 
   private:
 
     class MidiPools* pools = nullptr;
     class MidiSequence* sequence = nullptr;
+    MidiPackedSequence packed;
     class MidiSegment* segments = nullptr;
     class MidiFragment* fragments = nullptr;
     int layerFrames = 0;
@@ -88,6 +107,7 @@ class MidiLayer : public PooledObject
 
     void copy(class MidiLayer* src, int start, int end, int origin);
     void copy(class MidiSequence* src, int start, int end, int origin);
+    void copy(class MidiPackedSequence* src, int start, int end, int origin);
     void copy(class MidiSegment* seg, int origin);
     
     void cutSequence(int start, int end);
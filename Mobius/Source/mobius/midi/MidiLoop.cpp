@@ -4,6 +4,7 @@
 #include "../../util/StructureDumper.h"
 
 #include "MidiTrack.h"
+#include "MidiLayer.h"
 #include "MidiLoop.h"
 #include "MidiPools.h"
 
@@ -46,12 +47,15 @@ void MidiLoop::reset()
     reclaimLayers(redoLayers);
     redoLayers = nullptr;
     redoCount = 0;
+    packCandidates = nullptr;
 }
 
 void MidiLoop::reclaimLayers(MidiLayer* list)
 {
     while (list != nullptr) {
         MidiLayer* next = list->next;
+        if (list->packPending)
+          removePackCandidate(list);
         list->clear();
         list->next = nullptr;
         pools->checkin(list);
@@ -61,6 +65,8 @@ void MidiLoop::reclaimLayers(MidiLayer* list)
 
 void MidiLoop::add(MidiLayer* l)
 {
+    if (layers != nullptr)
+      addPackCandidate(layers);
     l->next = layers;
     layers = l;
     layerCount++;
@@ -108,6 +114,7 @@ MidiLayer* MidiLoop::undo()
         undone->next = redoLayers;
         redoLayers = undone;
         redoCount++;
+        addPackCandidate(undone);
 
         // todo: configurable redo limit
         int maxRedo = 4;
@@ -140,7 +147,9 @@ MidiLayer* MidiLoop::redo()
         MidiLayer* redone = redoLayers;
         redoLayers = redoLayers->next;
         redoCount--;
-        
+
+        if (layers != nullptr)
+          addPackCandidate(layers);
         redone->next = layers;
         layers = redone;
         layerCount++;
@@ -152,3 +161,61 @@ MidiLayer* MidiLoop::getPlayLayer()
 {
     return layers;
 }
+
+/**
+ * Pack every layer except the one playing.  They can only be played
+ * from now on, either directly after undo/redo or through segments in the
+ * layers that follow them.
+ *
+ * Only layers that moved out of the play position since the last time
+ * are looked at.  Packing is tried once, a layer that can't be packed
+ * won't be able to next time either.  The play layer stays on the list
+ * if undo put a candidate back there.
+ */
+void MidiLoop::packHistory()
+{
+    MidiLayer* prev = nullptr;
+    MidiLayer* l = packCandidates;
+    while (l != nullptr) {
+        MidiLayer* nextPack = l->nextPack;
+        if (l == layers) {
+            prev = l;
+        }
+        else {
+            l->pack();
+            if (prev == nullptr)
+              packCandidates = nextPack;
+            else
+              prev->nextPack = nextPack;
+            l->nextPack = nullptr;
+            l->packPending = false;
+        }
+        l = nextPack;
+    }
+}
+
+void MidiLoop::addPackCandidate(MidiLayer* l)
+{
+    if (!l->packPending) {
+        l->nextPack = packCandidates;
+        packCandidates = l;
+        l->packPending = true;
+    }
+}
+
+void MidiLoop::removePackCandidate(MidiLayer* l)
+{
+    MidiLayer* prev = nullptr;
+    for (MidiLayer* c = packCandidates ; c != nullptr ; c = c->nextPack) {
+        if (c == l) {
+            if (prev == nullptr)
+              packCandidates = c->nextPack;
+            else
+              prev->nextPack = c->nextPack;
+            break;
+        }
+        prev = c;
+    }
+    l->nextPack = nullptr;
+    l->packPending = false;
+}
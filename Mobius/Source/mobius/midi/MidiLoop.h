@@ -25,6 +25,7 @@ class MidiLoop
     int getLayerCount();
     int getRedoCount();
     MidiLayer* getPlayLayer();
+    void packHistory();
     
     int number = 0;
     
@@ -40,7 +41,12 @@ class MidiLoop
     class MidiLayer* redoLayers = nullptr;
     int redoCount = 0;
 
+    // layers that fell behind the play layer and haven't been packed
+    class MidiLayer* packCandidates = nullptr;
+
     void reclaimLayers(MidiLayer* list);
+    void addPackCandidate(MidiLayer* l);
+    void removePackCandidate(MidiLayer* l);
 
 };
 
@@ -86,6 +86,16 @@ void MidiPlayer::setChannelOverride(int chan)
     channelOverride = chan;
 }
 
+void MidiPlayer::setBlockOffset(int offset)
+{
+    blockOffset = offset;
+}
+
+void MidiPlayer::setCapture(juce::MidiBuffer* buffer)
+{
+    capture = buffer;
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // Layer Management
@@ -318,7 +328,7 @@ void MidiPlayer::setMute(bool b)
             // them from the tracking list
             MidiEvent* held = heldNotes;
             while (held != nullptr) {
-                sendOff(held);
+                sendOff(held, blockOffset);
                 held = held->next;
             }
             muted = true;
@@ -330,7 +340,7 @@ void MidiPlayer::setMute(bool b)
         muted = false;
         MidiEvent* held = heldNotes;
         while (held != nullptr) {
-            sendOn(held);
+            sendOn(held, blockOffset);
             held = held->next;
         }
     }
@@ -364,7 +374,7 @@ void MidiPlayer::setPause(bool b, bool noHold)
             // turning pause on
             MidiEvent* held = heldNotes;
             while (held != nullptr) {
-                sendOff(held);
+                sendOff(held, blockOffset);
                 held = held->next;
             }
             paused = true;
@@ -377,7 +387,7 @@ void MidiPlayer::setPause(bool b, bool noHold)
         else {
             MidiEvent* held = heldNotes;
             while (held != nullptr) {
-                sendOn(held);
+                sendOn(held, blockOffset);
                 held = held->next;
             }
         }
@@ -454,9 +464,16 @@ int MidiPlayer::captureEventsSent()
 /**
  * Play anything from the current position forward until the end
  * of the play region.
+ *
+ * Events go out at the offset of their frame from the play frame
+ * added to where this region starts in the block, so their spacing is
+ * the same however the blocks and regions happened to fall.
  */
 void MidiPlayer::play(int blockFrames)
 {
+    int base = blockOffset;
+    blockOffset += blockFrames;
+    
     // ignored in pause mode
     if (paused) return;
     
@@ -479,17 +496,18 @@ void MidiPlayer::play(int blockFrames)
             MidiSequence* events = harvester.getEvents();
             if (events != nullptr) {
                 for (MidiEvent* e = events->getFirst() ; e != nullptr ; e = e->next) {
-                    track->midiSend(e->juceMessage, outputDevice);
+                    send(e->juceMessage, base + getRelativeOffset(e, blockFrames));
                     eventsSent++;
                 }
             }
 
             // add the restoredHeld notes if we were jumping
+            // these were sounding before the jump so they go out first
             if (restoredHeld != nullptr) {
                 MidiEvent* notes = restoredHeld->sequence.steal();
                 while (notes != nullptr) {
                     MidiEvent* next = notes->next;
-                    play(notes);
+                    play(notes, base, 0);
                     notes = next;
                 }
                 pools->reclaim(restoredHeld);
@@ -502,7 +520,7 @@ void MidiPlayer::play(int blockFrames)
                 MidiEvent* notes = noteseq->steal();
                 while (notes != nullptr) {
                     MidiEvent* next = notes->next;
-                    play(notes);
+                    play(notes, base, getRelativeOffset(notes, blockFrames));
                     notes = next;
                 }
             }
@@ -510,13 +528,27 @@ void MidiPlayer::play(int blockFrames)
             // keep this clean between calls
             harvester.reset();
             
-            advanceHeld(blockFrames);
+            advanceHeld(base, blockFrames);
             
             playFrame += blockFrames;
         }
     }
 }
 
+/**
+ * The offset of a harvested event from the play frame, kept within
+ * the region being played.
+ */
+int MidiPlayer::getRelativeOffset(MidiEvent* e, int blockFrames)
+{
+    int offset = e->frame - playFrame;
+    if (offset < 0)
+      offset = 0;
+    else if (offset >= blockFrames)
+      offset = blockFrames - 1;
+    return offset;
+}
+
 /**
  * Begin tracking a note and send it to the device if we're not muted.
  * Continue note duration tracking even if we are in mute mode so that
@@ -526,8 +558,13 @@ void MidiPlayer::play(int blockFrames)
  *
  * The notes will have been gathered by MidiHarvester and we take
  * ownership of them.
+ *
+ * The base is where the region starts in the block and the offset
+ * is relative to the play frame.  Remaining is counted from
+ * there too since advanceHeld takes whole regions off, which means a note
+ * starting late in the region has that much longer to go.
  */
-void MidiPlayer::play(MidiEvent* note)
+void MidiPlayer::play(MidiEvent* note, int base, int offset)
 {
     if (note != nullptr) {
 
@@ -535,11 +572,11 @@ void MidiPlayer::play(MidiEvent* note)
         if (note->duration == 0)
           Trace(1, "MidiPlayer: Playing a note with no duration");
 
-        note->remaining = note->duration;
+        note->remaining = note->duration + offset;
         note->next = heldNotes;
         heldNotes = note;
 
-        sendOn(note);
+        sendOn(note, base + offset);
     }
 }
 
@@ -548,7 +585,7 @@ void MidiPlayer::play(MidiEvent* note)
  * This just sends the NoteOn event and doesn't mess with durations which
  * in the case of setMute are already being tracked.
  */
-void MidiPlayer::sendOn(MidiEvent* note)
+void MidiPlayer::sendOn(MidiEvent* note, int offset)
 {
     // bump the sent count even if we're muted so we can see the levels
     // flicker
@@ -556,14 +593,14 @@ void MidiPlayer::sendOn(MidiEvent* note)
     if (!muted && !paused) {
 
         if (channelOverride == 0) {
-            track->midiSend(note->juceMessage, outputDevice);
+            send(note->juceMessage, offset);
         }
         else {
             juce::MidiMessage msg =
                 juce::MidiMessage::noteOn(channelOverride,
                                           note->juceMessage.getNoteNumber(),
                                           note->juceMessage.getVelocity());
-            track->midiSend(msg, outputDevice);
+            send(msg, offset);
             // remember this in the held note tracking state so we turn
             // off the right one
             note->channelOverride = channelOverride;
@@ -614,8 +651,11 @@ void MidiPlayer::flushHeld()
  *
  * Think about when we advance for notes we just added to the list in the
  * current block.  Do those advance now or on the next block?
+ *
+ * The NoteOff goes out at the frame where the duration ran out, which
+ * is where remaining went to zero counting back from the end of the region.
  */
-void MidiPlayer::advanceHeld(int blockFrames)
+void MidiPlayer::advanceHeld(int base, int blockFrames)
 {
     MidiEvent* prev = nullptr;
     MidiEvent* held = heldNotes;
@@ -624,7 +664,10 @@ void MidiPlayer::advanceHeld(int blockFrames)
 
         held->remaining -= blockFrames;
         if (held->remaining <= 0) {
-            sendOff(held);
+            int offset = blockFrames + held->remaining;
+            if (offset < 0)
+              offset = 0;
+            sendOff(held, base + offset);
             if (prev == nullptr)
               heldNotes = next;
             else
@@ -646,7 +689,7 @@ void MidiPlayer::advanceHeld(int blockFrames)
 void MidiPlayer::forceOff()
 {
     while (heldNotes != nullptr) {
-        sendOff(heldNotes);
+        sendOff(heldNotes, blockOffset);
         MidiEvent* next = heldNotes->next;
         heldNotes->next = nullptr;
         pools->checkin(heldNotes);
@@ -657,7 +700,7 @@ void MidiPlayer::forceOff()
 /**
  * Send a NoteOff to the device
  */
-void MidiPlayer::sendOff(MidiEvent* note)
+void MidiPlayer::sendOff(MidiEvent* note, int offset)
 {
     // is it safe to test mute mode or should we just send a redundant off
     // every time?  when entering mute mode it is supposed to have
@@ -674,13 +717,24 @@ void MidiPlayer::sendOff(MidiEvent* note)
             juce::MidiMessage::noteOff(channel,
                                        note->juceMessage.getNoteNumber(),
                                        (juce::uint8)(note->releaseVelocity));
-        track->midiSend(msg, outputDevice);
+        send(msg, offset);
 
         // shouldn't matter but be clean
         note->channelOverride = 0;
     }
 }
 
+/**
+ * Everything goes out through here with the offset in the block.
+ */
+void MidiPlayer::send(juce::MidiMessage& msg, int offset)
+{
+    if (capture != nullptr)
+      capture->addEvent(msg, offset);
+    else
+      track->midiSend(msg, outputDevice, offset);
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
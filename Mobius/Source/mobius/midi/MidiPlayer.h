@@ -59,6 +59,18 @@ class MidiPlayer
 
     void setDeviceId(int id);
     int getDeviceId();
+
+    /**
+     * Where the next play() starts within the audio block.  Messages
+     * are sent with offsets from here so they land on the sample
+     * they were recorded on.
+     */
+    void setBlockOffset(int offset);
+
+    /**
+     * Collect messages in a buffer rather than sending them, for TestDriver.
+     */
+    void setCapture(juce::MidiBuffer* buffer);
     
   private:
 
@@ -82,6 +94,8 @@ class MidiPlayer
     bool paused = false;
     class MidiFragment* restoredHeld = nullptr;
     int eventsSent = 0;
+    int blockOffset = 0;
+    juce::MidiBuffer* capture = nullptr;
     
     // transient buffers used during event gathering
     MidiHarvester harvester;
@@ -89,13 +103,15 @@ class MidiPlayer
     // note duration tracking state
     class MidiEvent* heldNotes = nullptr;
     
-    void play(class MidiEvent* n);
+    void play(class MidiEvent* n, int base, int offset);
+    int getRelativeOffset(class MidiEvent* e, int blockFrames);
     void setMuteInternal(bool b, bool setMuteMode);
-    void sendOn(class MidiEvent* e);
+    void sendOn(class MidiEvent* e, int offset);
     void flushHeld();
-    void advanceHeld(int blockFrames);
+    void advanceHeld(int base, int blockFrames);
     void forceOff();
-    void sendOff(class MidiEvent* note);
+    void sendOff(class MidiEvent* note, int offset);
+    void send(juce::MidiMessage& msg, int offset);
     void saveHeld();
     void prepareHeld();
 };
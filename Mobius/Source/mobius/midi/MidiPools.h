@@ -30,6 +30,7 @@
 
 #include "../../midi/MidiEvent.h"
 #include "../../midi/MidiSequence.h"
+#include "../../midi/MidiPackedSequence.h"
 #include "../../model/UIAction.h"
 
 #include "MidiLayer.h"
@@ -56,6 +57,7 @@ class MidiPools
 
     MidiEventPool midiPool;
     MidiSequencePool sequencePool;
+    MidiPackedChunkPool chunkPool;
     MidiLayerPool layerPool;
     MidiSegmentPool segmentPool;
     MidiFragmentPool fragmentPool;
@@ -120,6 +122,22 @@ class MidiPools
         }
     }
 
+    //
+    // MidiPackedChunk
+    //
+
+    MidiPackedChunkPool* getChunkPool() {
+        return &chunkPool;
+    }
+
+    /**
+     * Packing takes many chunks at once in the audio thread, the
+     * shell keeps some on hand.
+     */
+    void fluff() {
+        chunkPool.fluff();
+    }
+
     //
     // MidiLayer
     //
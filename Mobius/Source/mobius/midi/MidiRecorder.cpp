@@ -1324,6 +1324,15 @@ int MidiRecorder::getEventCount()
     return (recordLayer != nullptr) ? recordLayer->getEventCount() : 0;
 }
 
+/**
+ * True if notes are being held whose duration will be copied back
+ * to events in a layer sequence.
+ */
+bool MidiRecorder::hasHeldNotes()
+{
+    return (watcher.getHeldNotes() != nullptr);
+}
+
 int MidiRecorder::getModeStartFrame()
 {
     return modeStartFrame;
@@ -1529,9 +1538,11 @@ MidiEvent* MidiRecorder::copyEvent(MidiEvent* src)
  * added on the previous block and the current block only adds duration to
  * new events.
  *
- * Currently, MobiusKernel processes MIDI events BEFORE the calls to
- * processAudioStream for the tracks.  This is the same time as UIActions
- * are processed.  So add() will always be called before advance().
+ * MIDI events at the start of the block are processed by MobiusKernel BEFORE
+ * the calls to processAudioStream for the tracks.  This is the same time as
+ * UIActions are processed.  Events from the host later in the block are
+ * delivered by TimeSlicer after the track has advanced to the event offset,
+ * so in both cases add() is called before the advance() that follows it.
  *
  * In the unlikely case of short notes that go off on the next block after they started,
  * the duration either needs to have the length of the block when it was added,
@@ -1667,6 +1678,11 @@ void MidiRecorder::finalizeHold(MidiEvent* note, MidiEvent* off)
         // could also have just done this in the adance
         note->peer->duration = note->duration;
 
+        // the sequence index needs to know how far notes reach
+        MidiSequence* sequence = (recordLayer != nullptr) ? recordLayer->getSequence() : nullptr;
+        if (sequence != nullptr)
+          sequence->durationsChanged();
+
         if (off != nullptr) {
             // this must be a NoteOff, remember the release velocity
             if (off->juceMessage.isNoteOff()) {
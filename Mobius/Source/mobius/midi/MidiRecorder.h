@@ -81,6 +81,7 @@ class MidiRecorder : public MidiWatcher::Listener
     int getCycleFrames();
     bool hasChanges();
     int getEventCount();
+    bool hasHeldNotes();
 
     //
     // MIDI events
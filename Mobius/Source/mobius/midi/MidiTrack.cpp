@@ -207,8 +207,9 @@ void MidiTrack::midiEvent(MidiEvent* e)
     if (midiThru) {
         // this came from the Session::Track and player keeps it
         // may want some filtering here
+        // this arrives between slices where TimeSlicer knows the offset
         int device = player.getDeviceId();
-        midiSend(e->juceMessage, device);
+        midiSend(e->juceMessage, device, syncMaster->getBlockOffset());
     }
 }
 
@@ -348,20 +349,6 @@ bool MidiTrack::scheduleWaitEvent(class MslWait* wait)
         }
             break;
 
-        case MslWaitBlock: {
-            // these don't have anything to hang off of BaseScheduler needs to find
-            // it on the next advance
-            TrackEvent* e = scheduler.newEvent();
-            e->type = TrackEvent::EventWait;
-            e->pending = true;
-            e->wait = wait;
-            wait->coreEvent = e;
-            wait->coreEventFrame = 0;
-            scheduler.addEvent(e);
-            success = true;
-        }
-            break;
-            
         case MslWaitSwitch: {
             TrackEvent* event = scheduler.findEvent(TrackEvent::EventSwitch);
             if (event != nullptr) {
@@ -487,10 +474,11 @@ float MidiTrack::getRate()
 
 /**
  * Called internally by Player to send events.
+ * The offset is the sample within the current block.
  */
-void MidiTrack::midiSend(juce::MidiMessage& msg, int deviceId)
+void MidiTrack::midiSend(juce::MidiMessage& msg, int deviceId, int offset)
 {
-    manager->midiSend(msg, deviceId);
+    manager->midiSend(msg, deviceId, offset);
 }
 
 /**
@@ -529,6 +517,8 @@ void MidiTrack::loadLoop(MidiSequence* seq, int loopNumber)
                 }
             }
             layer->setFrames(totalFrames);
+            // nothing records into a loaded layer
+            layer->pack();
 
             // at minimum, put the new layer into the target loop
             MidiLoop* loop = loops[targetIndex];
@@ -980,6 +970,9 @@ void MidiTrack::doParameter(UIAction* a)
  */
 void MidiTrack::processAudioStream(MobiusAudioStream* stream)
 {
+    // the stream may be a slice of the block, TimeSlicer knows where
+    sliceOffset = syncMaster->getBlockOffset();
+    blockOffset = 0;
     scheduler.advance(stream);
 }
 
@@ -990,6 +983,9 @@ void MidiTrack::processAudioStream(MobiusAudioStream* stream)
  */
 void MidiTrack::advance(int frames)
 {
+    // player sends at offsets from where this section starts
+    player.setBlockOffset(sliceOffset + blockOffset);
+    
     if (mode == TrackState::ModeReset) {
         // nothing to do
         // if we ever get around to latency compensation, may need
@@ -1000,6 +996,8 @@ void MidiTrack::advance(int frames)
         advancePlayer(frames);
         advanceRegion(frames);
     }
+
+    blockOffset += frames;
 }
 
 /**
@@ -1032,6 +1030,11 @@ void MidiTrack::shift(bool unrounded)
     int layers = loop->getLayerCount();
     neu->number = layers + 1;
     loop->add(neu);
+
+    // the layers behind this one are finished, unless a held note
+    // is still going to have it's duration set in one of them
+    if (!recorder.hasHeldNotes())
+      loop->packHistory();
     
     player.shift(neu);
     resetRegions();
@@ -175,7 +175,7 @@ class MidiTrack : public LooperTrack, public MslTrack
     //
     
     // Support for Player
-    void midiSend(juce::MidiMessage& msg, int deviceId);
+    void midiSend(juce::MidiMessage& msg, int deviceId, int offset = 0);
 
     // Support for Recorder
     class MidiEvent* getHeldNotes();
@@ -224,6 +224,11 @@ class MidiTrack : public LooperTrack, public MslTrack
     int outputMonitor = 0;
     int outputDecay = 0;
     bool midiThru = false;
+
+    // where the stream TimeSlicer gave us starts within the audio block,
+    // and where the current advance starts within that
+    int sliceOffset = 0;
+    int blockOffset = 0;
     
     // rate shift/resize
     float rate = 0.0f;
@@ -53,6 +53,10 @@ int AudioStreamSlicer::getInterruptFrames()
  * provided by the container stream, but offset by the blockOffset.
  * Since these are interleaved buffers of stereo samples, the pointer
  * increments by blockOffset * 2
+ *
+ * Only ask the container for the buffers the caller wants, asking for
+ * the input forces the port to be interleaved even if the track
+ * is reading it through getPlanarInput.
  */
 void AudioStreamSlicer::getInterruptBuffers(int inport, float** input, 
                                             int outport, float** output)
@@ -60,7 +64,8 @@ void AudioStreamSlicer::getInterruptBuffers(int inport, float** input,
     float* adjustedInput = nullptr;
     float* adjustedOutput = nullptr;
 
-    containerStream->getInterruptBuffers(inport, &adjustedInput, outport, &adjustedOutput);
+    containerStream->getInterruptBuffers(inport, (input != nullptr) ? &adjustedInput : nullptr,
+                                         outport, (output != nullptr) ? &adjustedOutput : nullptr);
 
     // should have prevented this in setSlice but check again
     // before we let the caller scribble all over it
@@ -70,14 +75,43 @@ void AudioStreamSlicer::getInterruptBuffers(int inport, float** input,
         adjustedOutput = nullptr;
     }
     else {
-        adjustedInput += (blockOffset * 2);
-        adjustedOutput += (blockOffset * 2);
+        if (adjustedInput != nullptr)
+          adjustedInput += (blockOffset * 2);
+        if (adjustedOutput != nullptr)
+          adjustedOutput += (blockOffset * 2);
     }
 
     if (input != nullptr) *input = adjustedInput;
     if (output != nullptr) *output = adjustedOutput;
 }
 
+/**
+ * Planar channels are offset by frames rather than samples.
+ */
+bool AudioStreamSlicer::getPlanarInput(int port, const float** left, const float** right)
+{
+    bool available = false;
+    if (blockLength > 0 && (blockOffset + blockLength) <= fullBlockSize) {
+        available = containerStream->getPlanarInput(port, left, right);
+        if (available) {
+            *left += blockOffset;
+            *right += blockOffset;
+        }
+    }
+    return available;
+}
+
+/**
+ * Track output taps are offset the same way as the port buffers.
+ */
+float* AudioStreamSlicer::getTrackOutputBuffer(int trackNumber)
+{
+    float* buffer = containerStream->getTrackOutputBuffer(trackNumber);
+    if (buffer != nullptr)
+      buffer += (blockOffset * 2);
+    return buffer;
+}
+
 //
 // The following are not expected to be called by Tracks, but we have
 // to implement them since they're pure virtual in MobiusAudioStream
@@ -30,6 +30,8 @@ class AudioStreamSlicer : public MobiusAudioStream
 	int getInterruptFrames() override;
 	void getInterruptBuffers(int inport, float** input, 
                              int outport, float** output) override;
+    bool getPlanarInput(int port, const float** left, const float** right) override;
+    float* getTrackOutputBuffer(int trackNumber) override;
 
     // these are only used by the Kernel and SyncMaster
     // so we don't need to alter them, they actually shouldn't be called
@@ -271,6 +271,12 @@ void MidiAnalyzer::midiRealtime(const juce::MidiMessage& msg, juce::String& sour
     if (startPoint) {
         tempoMonitor.orient();
     }
+
+    // remember when the clock that completed a beat arrived
+    if (eventMonitor.elapsedBeats != lastRealtimeBeat) {
+        lastRealtimeBeat = eventMonitor.elapsedBeats;
+        beatTicks = tempoMonitor.getLastClockTicks();
+    }
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -287,6 +293,9 @@ void MidiAnalyzer::analyze(int blockFrames)
 {
     result.reset();
 
+    lastBlockTicks = blockTicks;
+    blockTicks = juce::Time::getHighResolutionTicks();
+
     // detect start and stop
     if (playing != eventMonitor.started) {
         if (eventMonitor.started) {
@@ -332,7 +341,7 @@ void MidiAnalyzer::analyze(int blockFrames)
         if (lastMonitorBeat + 1 != eventMonitor.elapsedBeats)
           Trace(1, "MidiAnalyzer: Missed beats");
 
-        ponderUnitLength();
+        ponderUnitLength(blockFrames);
 
         lastMonitorBeat = eventMonitor.elapsedBeats;
     }
@@ -373,7 +382,7 @@ void MidiAnalyzer::analyze(int blockFrames)
  * MIDI clocks keep coming in.  Suppress those, but they're unexpected normally
  * so trace an error.
  */
-void MidiAnalyzer::ponderUnitLength()
+void MidiAnalyzer::ponderUnitLength(int blockFrames)
 {
     int newUnitLength = tempoMonitor.getAverageUnitLength();
     // convert length to a clipped tempo to make it easier to sanity check
@@ -465,17 +474,46 @@ void MidiAnalyzer::ponderUnitLength()
     // advance doesn't bump the beat counter if we're unlocked so need to do
     // it here
     if (!locked || unitLength == 0) {
-        // generate a beat pulse in this block
+        // generate a beat pulse in this block where the clock arrived
+        // in the last one
+        int offset = getBeatOffset(blockFrames);
         result.beatDetected = true;
+        result.blockOffset = offset;
                 
-        // start the virtual play head over from the beginning
-        unitPlayHead = 0;
+        // start the virtual play head over from the beat, advance
+        // will add the rest of the block
+        unitPlayHead = -offset;
 
         elapsedBeats = eventMonitor.elapsedBeats;
         streamTime = elapsedBeats * unitLength;
     }
 }
 
+/**
+ * Convert the time the beat clock arrived into a position in this block.
+ *
+ * Like other MIDI input, a clock that arrived during the last block is
+ * placed in this block at the same distance from the start, which keeps
+ * the spacing between beats regardless of when the MIDI thread ran relative
+ * to the audio thread.  The tempo monitor stamps clocks with the same tick
+ * counter used here.  If it looks wrong it goes at the front like it
+ * used to.
+ */
+int MidiAnalyzer::getBeatOffset(int blockFrames)
+{
+    int offset = 0;
+    juce::int64 ticks = beatTicks.load();
+    if (blockFrames > 0 && lastBlockTicks > 0 && ticks >= lastBlockTicks && ticks < blockTicks) {
+        double seconds = (double)(ticks - lastBlockTicks) /
+            (double)juce::Time::getHighResolutionTicksPerSecond();
+        double position = seconds * (double)sampleRate;
+        offset = (int)position;
+        if (offset >= blockFrames)
+          offset = blockFrames - 1;
+    }
+    return offset;
+}
+
 /**
  * Advance the pseudo loop and keep track of beat bar boundaries.
  *
@@ -63,6 +63,11 @@ class MidiAnalyzer : public SyncAnalyzer, public MidiManager::RealtimeListener
     void checkClocks();
 
     bool forceUnitLength(int length);
+
+    // for the clock jitter test
+    MidiTempoMonitor* getTempoMonitor() {
+        return &tempoMonitor;
+    }
     
   private:
     
@@ -91,8 +96,16 @@ class MidiAnalyzer : public SyncAnalyzer, public MidiManager::RealtimeListener
     int streamTime = 0;
 
     int driftCheckCounter = 0;
+
+    // where raw beats arrived, the beat counter is only touched
+    // by the MIDI thread
+    std::atomic<juce::int64> beatTicks {0};
+    int lastRealtimeBeat = 0;
+    juce::int64 blockTicks = 0;
+    juce::int64 lastBlockTicks = 0;
     
-    void ponderUnitLength();
+    void ponderUnitLength(int blockFrames);
+    int getBeatOffset(int blockFrames);
     void advance(int frames);
 };
 
@@ -114,11 +114,13 @@
 #include "../../util/Trace.h"
 #include "../../midi/MidiByte.h"
 #include "../../MidiManager.h"
+#include "../MobiusInterface.h"
 
 #include "SyncTrace.h"
 #include "MidiQueue.h"
 #include "MidiSyncEvent.h"
 #include "SyncMaster.h"
+#include "Transport.h"
 
 #include "MidiRealizer.h"
 
@@ -181,6 +183,7 @@ void MidiRealizer::stopThread()
 void MidiRealizer::shutdown()
 {
     stopThread();
+    traceStatistics();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -223,6 +226,7 @@ MidiClockThread::MidiClockThread(MidiRealizer* mr) :
 
 {
     realizer = mr;
+    ticksPerMillisecond = juce::Time::getHighResolutionTicksPerSecond() / 1000;
 }
 
 MidiClockThread::~MidiClockThread()
@@ -241,8 +245,7 @@ bool MidiClockThread::start()
     
     juce::Thread::RealtimeOptions options;
 
-    (void)options.withPriority(10);
-    (void)options.withPeriodMs(1);
+    options = options.withPriority(10).withPeriodMs(1);
 
     started = startRealtimeThread(options);
     if (!started) {
@@ -262,15 +265,30 @@ void MidiClockThread::stop()
     }
 }
 
+/**
+ * With sample clocks the thread doesn't decide anything, it sends
+ * what the audio thread queued when the time comes.  wait(1) is too
+ * coarse for that so once the next message is less than a millisecond
+ * away it yields until it is due.
+ */
 void MidiClockThread::run()
 {
     // threadShouldExit returns true when the stopThread method is called
     while (!threadShouldExit()) {
-        // this seems to be innacurate, in testing my delta was frequently
-        // 2 and as high as 5 comparing getMilliseondCounter
-        wait(1);
-        if (realizer != nullptr)
-          realizer->clockThreadAdvance();
+        if (realizer != nullptr && realizer->isSampleClocks()) {
+            juce::int64 remaining = realizer->clockThreadSend();
+            if (remaining >= 0 && remaining < ticksPerMillisecond)
+              yield();
+            else
+              wait(1);
+        }
+        else {
+            // this seems to be innacurate, in testing my delta was frequently
+            // 2 and as high as 5 comparing getMilliseondCounter
+            wait(1);
+            if (realizer != nullptr)
+              realizer->clockThreadAdvance();
+        }
     }
 }
 
@@ -300,7 +318,7 @@ void MidiClockThread::run()
  */
 void MidiRealizer::clockThreadAdvance()
 {
-    if (running) {
+    if (running && !sampleClocks) {
         // I starated using this, but web chatter suggests that the HiRes variant
         // can be more accurate.  It returns a float however which complicates things.
         // Explore this someday
@@ -466,6 +484,7 @@ void MidiRealizer::startClocks()
         // crucial that you set this too so advance() knows to send the
         // first clock and reset the pulseWidth tracking state
         pendingStartClock = true;
+        pendingOffset = syncMaster->getBlockOffset();
         startClocksInternal();
     }
 }
@@ -523,6 +542,7 @@ void MidiRealizer::start()
     }
     else {
         pendingStart = true;
+        pendingOffset = syncMaster->getBlockOffset();
         startClocksInternal();
     }
 }
@@ -541,6 +561,7 @@ void MidiRealizer::midiContinue()
     }
     else {
         pendingContinue = true;
+        pendingOffset = syncMaster->getBlockOffset();
         startClocksInternal();
     }
 }
@@ -585,6 +606,7 @@ void MidiRealizer::stopSelective(bool sendStop, bool stopClocks)
         // for old devices, why would we want that now?
         pendingStop = true;
         pendingStopClocks = stopClocks;
+        pendingOffset = syncMaster->getBlockOffset();
     }
 }   
 
@@ -751,11 +773,12 @@ void MidiRealizer::flushEvents()
  * in current usage, Transport doesn't really care about beat detection
  * so most of this can go away.
  */
-void MidiRealizer::advance(int blockFrames)
+void MidiRealizer::advance(int frames)
 {
-    (void)blockFrames;
+    (void)frames;
     
     result.reset();
+    blockTicks = juce::Time::getHighResolutionTicks();
 
     outputQueue.iterateStart();
     MidiSyncEvent* mse = outputQueue.iterateNext();
@@ -818,6 +841,252 @@ SyncAnalyzerResult* MidiRealizer::getResult()
     return &result;
 }
 
+//////////////////////////////////////////////////////////////////////
+//
+// Sample Clocks
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Ask for clocks to be generated from the audio stream rather than
+ * by the clock thread.  Takes effect at the end of the next block.
+ */
+void MidiRealizer::setSampleClocks(bool b)
+{
+    sampleClocksRequested = b;
+}
+
+bool MidiRealizer::isSampleClocks()
+{
+    return sampleClocks;
+}
+
+/**
+ * Called by SyncMaster at the end of every block after the actions
+ * are done and the tracks have advanced, so the Transport is where it
+ * will be for the start of the next block.
+ *
+ * The pending flags work the same as they do for the clock thread, but
+ * they also remember the block offset of the action that set them.
+ * Start and Continue go out at that offset followed by clocks on the
+ * Transport timeline.  A Start happening on a beat therefore has its
+ * first clock at the same offset, the spec suggests a millisecond between
+ * them but the downbeat landing on the right sample is more important.
+ *
+ * When the Transport isn't running, clocks are spaced by the tempo from
+ * wherever the last one was.
+ */
+void MidiRealizer::generate(MobiusAudioStream* stream, Transport* transport)
+{
+    bool requested = sampleClocksRequested;
+    if (requested != sampleClocks) {
+        Trace(2, "MidiRealizer: %s sample clocks", (requested) ? "Starting" : "Stopping");
+        sampleClocks = requested;
+        // the next free clock is one clock away from the last one the
+        // thread sent, close enough
+        nextClock = 0.0;
+    }
+
+    if (!sampleClocks || !running)
+      return;
+
+    int frames = stream->getInterruptFrames();
+    blockFrames = frames;
+    int offset = pendingOffset;
+    if (offset < 0 || offset >= frames)
+      offset = 0;
+
+    if (pendingTempo > 0.0f)
+      setTempoNow(pendingTempo);
+
+    int from = 0;
+    if (pendingStart || pendingContinue) {
+        juce::uint32 now = juce::Time::getMillisecondCounter();
+        int position = getSongPosition(transport);
+        if (pendingContinue || position > 0) {
+            emit(offset, juce::MidiMessage::songPositionPointer(position), stream);
+            emit(offset, juce::MidiMessage::midiContinue(), stream);
+            outputQueue.add(MS_CONTINUE, now);
+        }
+        else {
+            emit(offset, juce::MidiMessage::midiStart(), stream);
+            outputQueue.add(MS_START, now);
+        }
+        pendingStart = false;
+        pendingContinue = false;
+        pendingStartClock = false;
+        from = offset;
+        nextClock = offset;
+    }
+    else if (pendingStartClock) {
+        pendingStartClock = false;
+        from = offset;
+        nextClock = offset;
+    }
+
+    if (pendingStop) {
+        // clocks up to the stop, then the stop, then clocks after it
+        // if they keep going
+        generateClocks(from, offset, transport, stream);
+
+        emit(offset, juce::MidiMessage::midiStop(), stream);
+        outputQueue.add(MS_STOP, juce::Time::getMillisecondCounter());
+        pendingStop = false;
+
+        if (pendingStopClocks) {
+            running = false;
+            pendingStopClocks = false;
+        }
+        else {
+            generateClocks(offset, frames, transport, stream);
+        }
+    }
+    else {
+        generateClocks(from, frames, transport, stream);
+    }
+
+    nextClock -= (double)frames;
+}
+
+/**
+ * Generate the clocks that fall between two block offsets.
+ *
+ * When the Transport is running the clocks are the 24 divisions of its
+ * beat.  The play head is where the Transport will be at the end of this
+ * block, so the start of the block is that many frames back which may be
+ * in the previous beat.  Each clock position in the previous and current
+ * beat is checked against the range.
+ */
+void MidiRealizer::generateClocks(int from, int to, Transport* transport,
+                                  MobiusAudioStream* stream)
+{
+    int length = transport->getUnitLength();
+    if (transport->isStarted() && length > 0) {
+        int start = transport->getPlayHead() - blockFrames;
+        for (int base = -length ; base <= 0 ; base += length) {
+            for (int clock = 0 ; clock < 24 ; clock++) {
+                int position = base + (int)(((juce::int64)clock * length) / 24);
+                int offset = position - start;
+                if (offset >= from && offset < to)
+                  emitClock(offset, stream);
+            }
+        }
+    }
+    else if (mSampleRate > 0 && tempo > 0.0f) {
+        // emitClock moves nextClock
+        if (nextClock < (double)from)
+          nextClock = (double)from;
+        while (nextClock < (double)to)
+          emitClock((int)nextClock, stream);
+    }
+}
+
+/**
+ * Send one clock and remember where the next free running one goes.
+ */
+void MidiRealizer::emitClock(int offset, MobiusAudioStream* stream)
+{
+    emit(offset, juce::MidiMessage::midiClock(), stream);
+    outputQueue.add(MS_CLOCK, juce::Time::getMillisecondCounter());
+
+    if (mSampleRate > 0 && tempo > 0.0f)
+      nextClock = (double)offset + ((double)mSampleRate * 60.0) / ((double)tempo * 24.0);
+}
+
+/**
+ * Send a message at a block offset.
+ *
+ * If there is a sync device it goes in the timed queue one block after
+ * the time this block started, which is about when the audio for this
+ * block is heard.  Otherwise in the plugin it goes to the host.
+ */
+void MidiRealizer::emit(int offset, const juce::MidiMessage& msg, MobiusAudioStream* stream)
+{
+    if (midiManager->hasOutputDevice(MidiManager::OutputSync)) {
+        if (mSampleRate > 0) {
+            juce::int64 ticksPerSecond = juce::Time::getHighResolutionTicksPerSecond();
+            const auto scope = timedFifo.write(1);
+            if (scope.blockSize1 > 0) {
+                TimedMessage& m = timedMessages[scope.startIndex1];
+                const juce::uint8* raw = msg.getRawData();
+                m.size = juce::jmin(msg.getRawDataSize(), 3);
+                for (int i = 0 ; i < m.size ; i++)
+                  m.data[i] = raw[i];
+                m.ticks = blockTicks +
+                    ((juce::int64)(blockFrames + offset) * ticksPerSecond / mSampleRate);
+            }
+            else {
+                timedOverflows++;
+            }
+        }
+    }
+    else {
+        juce::MidiBuffer* buffer = stream->getMidiMessages();
+        if (buffer != nullptr)
+          buffer->addEvent(msg, offset);
+    }
+}
+
+/**
+ * Song position in sixteenth notes from the Transport location.
+ */
+int MidiRealizer::getSongPosition(Transport* transport)
+{
+    int position = 0;
+    int length = transport->getUnitLength();
+    if (length > 0) {
+        int beats = ((transport->getLoop() * transport->getBarsPerLoop() + transport->getBar()) *
+                     transport->getBeatsPerBar()) + transport->getBeat();
+        position = (beats * 4) + ((transport->getPlayHead() * 4) / length);
+    }
+    // the pointer is 14 bits
+    return juce::jmin(position, 16383);
+}
+
+/**
+ * Called by the clock thread to send queued messages that are due.
+ * Returns the ticks until the next one, or -1 if the queue is empty.
+ */
+juce::int64 MidiRealizer::clockThreadSend()
+{
+    juce::int64 remaining = -1;
+    juce::int64 now = juce::Time::getHighResolutionTicks();
+    bool more = true;
+    while (more) {
+        more = false;
+        int start1, size1, start2, size2;
+        timedFifo.prepareToRead(1, start1, size1, start2, size2);
+        if (size1 > 0) {
+            TimedMessage& m = timedMessages[start1];
+            if (m.ticks <= now) {
+                midiManager->sendSync(juce::MidiMessage(m.data, m.size));
+                juce::int64 late = now - m.ticks;
+                totalLateness += late;
+                if (late > maxLateness)
+                  maxLateness = late;
+                timedSent++;
+                timedFifo.finishedRead(1);
+                more = true;
+            }
+            else {
+                remaining = m.ticks - now;
+            }
+        }
+    }
+    return remaining;
+}
+
+void MidiRealizer::traceStatistics()
+{
+    if (timedSent > 0) {
+        double ticksPerMicro = (double)juce::Time::getHighResolutionTicksPerSecond() / 1000000.0;
+        int average = (int)(((double)totalLateness / (double)timedSent) / ticksPerMicro);
+        int maximum = (int)((double)maxLateness / ticksPerMicro);
+        Trace(2, "MidiRealizer: %d timed messages %d overflows", timedSent, timedOverflows);
+        Trace(2, "MidiRealizer: Send lateness %d us average %d us maximum", average, maximum);
+    }
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
@@ -16,6 +16,14 @@
  * This was given the newer SyncAnalyzerResult for tracking beats like
  * MidiAnalyzer.  But Transport doesn't really care where this thinks beats
  * are, it is only used to detect drift.
+ *
+ * There are two ways clocks can be generated.  The original way has the
+ * clock thread watch the millisecond counter and send clocks when enough
+ * time has passed.  With "sample clocks" the clocks, start, stop, and continue
+ * are calculated at the end of each audio block from the Transport play head
+ * and given sample offsets within that block.  The plugin sends them through
+ * the host MidiBuffer, otherwise they are put in a timed queue and the clock
+ * thread sends them when their time arrives.
  */
 
 #pragma once
@@ -46,6 +54,7 @@ class MidiClockThread : public juce::Thread
   private:
 
     class MidiRealizer* realizer;
+    juce::int64 ticksPerMillisecond = 0;
     
 };
 
@@ -68,6 +77,12 @@ class MidiRealizer
     // SyncMaster interaction
     void advance(int blockFrames);
     SyncAnalyzerResult* getResult();
+
+    // sample accurate generation
+    void setSampleClocks(bool b);
+    bool isSampleClocks();
+    void generate(class MobiusAudioStream* stream, class Transport* transport);
+    void traceStatistics();
     
     // Transport control
     
@@ -99,9 +114,24 @@ class MidiRealizer
 
     // this is called from the clock thread NOT the SyncMaster on audio blocks
     void clockThreadAdvance();
+    juce::int64 clockThreadSend();
     void setTempoNow(float newTempo);
     
   private:
+
+    /**
+     * Messages waiting for the clock thread to send them at a given
+     * high resolution time.  The audio thread is the only producer.
+     */
+    static const int TimedQueueSize = 256;
+
+    class TimedMessage
+    {
+      public:
+        juce::uint8 data[3] = {0, 0, 0};
+        int size = 0;
+        juce::int64 ticks = 0;
+    };
     
     void startClocksInternal();
 
@@ -147,6 +177,38 @@ class MidiRealizer
     // true if we're allowing advance to send clocks
     bool running = false;
 
+    //
+    // Sample clocks
+    //
+
+    // requested by the session or the jitter test, applied on the next block
+    std::atomic<bool> sampleClocksRequested {false};
+    // the mode in effect, the clock thread looks at this too
+    std::atomic<bool> sampleClocks {false};
+
+    // block offset of the action that set one of the pending flags
+    int pendingOffset = 0;
+
+    // high resolution time at the start of the block
+    juce::int64 blockTicks = 0;
+
+    // where the next free running clock goes relative to the start of the
+    // block, carried between blocks so the spacing is continuous when
+    // switching between the transport timeline and free running clocks
+    double nextClock = 0.0;
+
+    // size of the block being generated
+    int blockFrames = 0;
+
+    juce::AbstractFifo timedFifo {TimedQueueSize};
+    TimedMessage timedMessages[TimedQueueSize];
+
+    // statistics, the clock thread keeps these
+    int timedSent = 0;
+    int timedOverflows = 0;
+    juce::int64 totalLateness = 0;
+    juce::int64 maxLateness = 0;
+
     // old stuff
 
     /**
@@ -173,6 +235,12 @@ class MidiRealizer
     bool pulseWaitWarning = false; 
 
     void detectBeat(MidiSyncEvent* mse);
+
+    void generateClocks(int from, int to, class Transport* transport,
+                        class MobiusAudioStream* stream);
+    void emitClock(int offset, class MobiusAudioStream* stream);
+    void emit(int offset, const juce::MidiMessage& msg, class MobiusAudioStream* stream);
+    int getSongPosition(class Transport* transport);
 };
 
 /****************************************************************************/
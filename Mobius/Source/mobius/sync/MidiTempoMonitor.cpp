@@ -16,10 +16,14 @@ void MidiTempoMonitor::setSampleRate(int rate)
 void MidiTempoMonitor::reset()
 {
     windowPosition = 0;
+    windowCount = 0;
     windowFull = false;
+    originTicks = 0;
     lastTimeStamp = 0.0f;
-    runningTotal = 0.0f;
+    fitOrigin = 0.0f;
     runningAverage = 0.0f;
+    fitError = 0.0f;
+    outlierCount = 0;
     receiving = false;
     orient();
 }
@@ -55,6 +59,11 @@ bool MidiTempoMonitor::isFilling()
     return !windowFull;
 }
 
+juce::int64 MidiTempoMonitor::getLastClockTicks()
+{
+    return lastClockTicks.load();
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // The Meat
@@ -66,17 +75,20 @@ void MidiTempoMonitor::consume(const juce::MidiMessage& msg)
     const juce::uint8* data = msg.getRawData();
     const juce::uint8 status = *data;
 
-    if (status == MS_CLOCK) {
-
-        receiving = true;
-        
-        double ts = msg.getTimeStamp();
+    if (status == MS_CLOCK)
+      consumeClock(juce::Time::getHighResolutionTicks());
+}
 
-        if (lastTimeStamp == 0.0f) {
-            // first one
-            Trace(2, "MidiTempoMonitor: Clocks starting");
-        }
-        else if (ts < lastTimeStamp) {
+void MidiTempoMonitor::consumeClock(juce::int64 ticks)
+{
+    lastClockTicks = ticks;
+    if (ticksPerSecond == 0.0)
+      ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+
+    double ts = 0.0f;
+    if (originTicks != 0) {
+        ts = (double)(ticks - originTicks) / ticksPerSecond;
+        if (ts < lastTimeStamp) {
             // not expecting this
             Trace(1, "MidiTempoMonitor: TimeStamp went back in time");
             reset();
@@ -88,30 +100,7 @@ void MidiTempoMonitor::consume(const juce::MidiMessage& msg)
 
             if (looksReasonable(delta)) {
 
-                // if the window is full, we're looping and remove
-                // the oldest sample before we add the new one
-                if (windowFull) {
-                    double old = clockSamples[windowPosition];
-                    runningTotal -= old;
-                }
-
-                // dsposit the new sample
-                clockSamples[windowPosition] = delta;
-                windowPosition++;
-                if (windowPosition >= windowSize) {
-                    windowFull = true;
-                    windowPosition = 0;
-                }
-
-                // and add it to the total
-                runningTotal += delta;
-
-                // calculate the running average
-                if (windowFull)
-                  runningAverage = runningTotal / (float)windowSize;
-                else
-                  runningAverage = runningTotal / (float)windowPosition;
-
+                addStamp(ts);
 
                 // simulate a corresponding advance in "audio time" based on the time
                 // difference between the clocks
@@ -123,23 +112,209 @@ void MidiTempoMonitor::consume(const juce::MidiMessage& msg)
                 // we reoriented, treat this like the first clock
             }
         }
-        lastTimeStamp = ts;
     }
+
+    if (originTicks == 0) {
+        // first one, or starting over
+        Trace(2, "MidiTempoMonitor: Clocks starting");
+        originTicks = ticks;
+        ts = 0.0f;
+        addStamp(ts);
+    }
+    
+    lastTimeStamp = ts;
+    receiving = true;
+}
+
+/**
+ * Add a clock stamp to the window and fit a new line.
+ *
+ * Once there are enough clocks to trust the fit, a clock that is too far
+ * from where the line says it should be is replaced with the prediction.
+ * If that keeps happening in the same direction the tempo changed and
+ * the window starts over with the outliers.
+ */
+void MidiTempoMonitor::addStamp(double stamp)
+{
+    if (windowCount >= OutlierClocks) {
+        double expected = fitOrigin + (runningAverage * windowCount);
+        double residual = stamp - expected;
+
+        if (windowFull)
+          addJitter(residual);
+
+        double tolerance = fitError * OutlierFactor;
+        if (tolerance < OutlierFloor)
+          tolerance = OutlierFloor;
+
+        if (fabs(residual) <= tolerance) {
+            outlierCount = 0;
+        }
+        else {
+            if (outlierCount > 0 && (residual > 0) != outlierLate)
+              outlierCount = 0;
+            outlierLate = (residual > 0);
+            outliers[outlierCount] = stamp;
+            outlierCount++;
+            if (outlierCount >= TempoChangeClocks) {
+                Trace(2, "MidiTempoMonitor: Tempo change, restarting window");
+                restart(outliers, outlierCount);
+                return;
+            }
+            stamp = expected;
+        }
+    }
+
+    clockSamples[windowPosition] = stamp;
+    windowPosition++;
+    if (windowPosition >= windowSize)
+      windowPosition = 0;
+    if (windowCount < windowSize)
+      windowCount++;
+    if (windowCount >= LockClocks)
+      windowFull = true;
+
+    fit();
+}
+
+/**
+ * Start the window over with a few recent clocks.
+ */
+void MidiTempoMonitor::restart(double* stamps, int count)
+{
+    windowPosition = 0;
+    windowCount = 0;
+    windowFull = false;
+    for (int i = 0 ; i < count ; i++) {
+        clockSamples[windowPosition] = stamps[i];
+        windowPosition++;
+        windowCount++;
+    }
+    outlierCount = 0;
+    fit();
+}
+
+/**
+ * Least squares line through the stamps in the window with the
+ * clock number as x, oldest clock is zero.  The slope is seconds per clock.
+ *
+ * Stamps are centered on their mean before multiplying so precision
+ * doesn't depend on how long clocks have been running.  With at most a few
+ * hundred clocks it's cheap enough to do all of it on every clock.
+ */
+void MidiTempoMonitor::fit()
+{
+    int n = windowCount;
+    int first = windowPosition - n;
+    if (first < 0)
+      first += windowSize;
+    
+    if (n < 2) {
+        fitOrigin = (n > 0) ? clockSamples[first] : 0.0f;
+        runningAverage = 0.0f;
+        fitError = 0.0f;
+    }
+    else {
+        double meanX = (double)(n - 1) / 2.0;
+        double meanY = 0.0f;
+        int index = first;
+        for (int i = 0 ; i < n ; i++) {
+            meanY += clockSamples[index];
+            index++;
+            if (index >= windowSize) index = 0;
+        }
+        meanY /= (double)n;
+
+        double sxy = 0.0f;
+        index = first;
+        for (int i = 0 ; i < n ; i++) {
+            sxy += ((double)i - meanX) * (clockSamples[index] - meanY);
+            index++;
+            if (index >= windowSize) index = 0;
+        }
+        double sxx = (double)n * ((double)n * (double)n - 1.0) / 12.0;
+        double slope = sxy / sxx;
+        double origin = meanY - (slope * meanX);
+
+        double squares = 0.0f;
+        index = first;
+        for (int i = 0 ; i < n ; i++) {
+            double r = clockSamples[index] - (origin + (slope * i));
+            squares += (r * r);
+            index++;
+            if (index >= windowSize) index = 0;
+        }
+
+        fitOrigin = origin;
+        runningAverage = slope;
+        fitError = (n > 2) ? sqrt(squares / (double)(n - 2)) : 0.0f;
+    }
+}
+
+/**
+ * Accumulate the distance of one clock from the fitted line.
+ */
+void MidiTempoMonitor::addJitter(double delta)
+{
+    if (jitterResetPending) {
+        jitterCount = 0;
+        jitterTotal = 0.0;
+        jitterSquares = 0.0;
+        jitterMax = 0.0;
+        jitterResetPending = false;
+    }
+    
+    double jitter = fabs(delta);
+    jitterCount++;
+    jitterTotal += jitter;
+    jitterSquares += (jitter * jitter);
+    if (jitter > jitterMax)
+      jitterMax = jitter;
+}
+
+void MidiTempoMonitor::resetJitter()
+{
+    jitterResetPending = true;
+}
+
+/**
+ * Timestamps are in seconds, trace in microseconds.
+ */
+void MidiTempoMonitor::traceJitter(const char* label)
+{
+    int average = 0;
+    int rms = getJitterRms();
+    if (jitterCount > 0)
+      average = (int)((jitterTotal / jitterCount) * 1000000.0);
+    Trace(2, "MidiTempoMonitor: %s jitter %d clocks %d us average %d us rms %d us maximum",
+          label, jitterCount, average, rms, (int)(jitterMax * 1000000.0));
+}
+
+int MidiTempoMonitor::getJitterCount()
+{
+    return jitterCount;
+}
+
+/**
+ * In microseconds.
+ */
+int MidiTempoMonitor::getJitterRms()
+{
+    int rms = 0;
+    if (jitterCount > 0)
+      rms = (int)(sqrt(jitterSquares / jitterCount) * 1000000.0);
+    return rms;
 }
 
 /**
  * Here on each delta.
  *
- * There are two things we can do here.  First if the delta is outside the expected range
- * we may be picking after a period of clock stoppage and need to reset.
- * This should only happen if the periodic advance() didn't happen, clocks
- * stopped, then picked up again some time later.
+ * If the delta is outside the expected range we may be picking after a period of
+ * clock stoppage and need to reset.  This should only happen if the periodic advance()
+ * didn't happen, clocks stopped, then picked up again some time later.
  *
- * Second, we could try to suppress the occasional outlier to prevent them from adding
- * noise to the average.  Punting on this, since it is difficult to know whether this is
- * in fact a jitter outlier, or if it represents a deliberate tempo change.  I suppose
- * if we get more than a few outliers in a row then it's a tempo change.
- * Do the standard deviation thing.
+ * Suppressing the occasional jitter outlier is done by addStamp where we know
+ * where the clock should have been.
  *
  * For stop detection, at 30BPM, there are .5 beats per second, or 12 clocks per second
  * each delta would be 1/12 or .0833.  So once the delta passes .1 it's REALLY slow.
@@ -164,10 +339,9 @@ void MidiTempoMonitor::checkStop()
 {
     double now = juce::Time::getMillisecondCounterHiRes();
     
-    if (lastTimeStamp != 0.0f) {
-        // juce timestamps are / 1000
-        double scaledNow = now / 1000.0f;
-        double delta = scaledNow  - lastTimeStamp;
+    if (originTicks != 0) {
+        juce::int64 ticks = juce::Time::getHighResolutionTicks();
+        double delta = (double)(ticks - lastClockTicks.load()) / ticksPerSecond;
         if (delta < 0.0f || delta > 1.0f) {
             Trace(2, "MidiTempoMonitor: Clocks stopped");
             reset();
@@ -206,8 +380,7 @@ double MidiTempoMonitor::getAverageClockLength()
 }
 
 /**
- * The runningAverage is secondsPerClock since Juce timestamps
- * are the milliisecond counter / 1000.
+ * The runningAverage is secondsPerClock, the slope of the fit.
  * seconds per beat is that * 24.
  * seconds per beat is that / 1000
  * beats per second is 1 / seconds per beat
@@ -1,10 +1,13 @@
 /**
  * Subcomponent of MidiAnalyzer to monitor MIDI clocks and guess the tempo.
  * 
- * The juce::MidiMessage timestamp is "milliseconds / 1000.0f",
- * in other words a timestamp in fractions of seconds.  The delta
- * between clocks is then "seconds per clock".  Docs say this is derived
- * from juce::Time::getMillisecondCounterHiRes().
+ * Clocks are stamped with the high resolution tick counter as soon as
+ * they arrive in the device thread rather than using the juce::MidiMessage
+ * timestamp, which is "milliseconds / 1000.0f" and on some platforms is
+ * assigned well after the fact.  Stamps are kept in seconds so the
+ * period between clocks is "seconds per clock".  The tick counter is the
+ * same one the kernel stamps audio blocks with so a clock can also be
+ * placed in the audio stream.
  *
  * There are 24 clocks per quarter note so tempo is:
  *
@@ -29,11 +32,22 @@
  * handler, but I expect it does it about as well as can be done.  Clock jitter is
  * just inherant with MIDI and you need to take steps to compensate for it.
  *
- * Clock jitter is smoothed using the usual "averaging" approach which makes it better
- * but still not great.  There is a "window" of clock distance samples that is averaged
- * to produce the tempo/unit length.  The number of clocks to include in the window
- * is tunable but typically a number of quarter notes like 4.  A larger window yields
- * smoother tempos but responds to deliberate tempo changes more gradually.
+ * Clock jitter used to be smoothed by averaging the deltas between clocks in a window.
+ * The average of the deltas is just the distance between the first and last clock in
+ * the window divided by the count, so it only ever used two stamps and was at the mercy
+ * of the jitter in both of them.
+ *
+ * Now the window holds the clock stamps themselves and the period is the slope of a
+ * least squares line through all of them.  Every clock contributes, so the error falls
+ * much faster as the window fills and a usable tempo is available after a couple of beats
+ * instead of four.  The line also predicts when the next clock should arrive.  A clock
+ * that lands far from the prediction is an outlier and the predicted time is used in
+ * its place.  If several land on the same side in a row it is a deliberate tempo change
+ * and the window starts over from those clocks so it relocks quickly.
+ *
+ * The number of clocks to include in the window is typically a number of quarter notes
+ * like 4.  A larger window yields smoother tempos but responds to gradual tempo changes
+ * more slowly.
  *
  * For Mobius, I'm erring on the side of user initiated tempo changes being rare.
  * It is far more common for the tempo to just sit there for the duration of a
@@ -63,6 +77,18 @@ class MidiTempoMonitor
      */
     void consume(const juce::MidiMessage& msg);
 
+    /**
+     * Add one clock received at a high resolution tick time.
+     * consume() stamps the clock and calls this, the clock lock test
+     * calls it directly with synthetic times.
+     */
+    void consumeClock(juce::int64 ticks);
+
+    /**
+     * The tick time of the last clock received.
+     */
+    juce::int64 getLastClockTicks();
+
     /**
      * Set the current audio device sample rate for simulating elapsed
      * "stream time" on each clock.
@@ -112,13 +138,13 @@ class MidiTempoMonitor
     bool isReceiving();
 
     /**
-     * True if it is still in the process of filling the sample window
-     * ala the "warmup period". Tempo will be unreliable.
+     * True if there are not yet enough clocks in the window for a
+     * reliable tempo ala the "warmup period".
      */
     bool isFilling();
 
     /**
-     * Various averaging calculations
+     * Various averaging calculations, these all come from the fitted period
      */
     double getAverageClock();
     double getAverageClockLength();
@@ -130,6 +156,16 @@ class MidiTempoMonitor
      */
     float unitLengthToTempo(int length);
 
+    /**
+     * Jitter statistics for the clock loopback test.  Once the window
+     * is full each clock is compared to where the fit said it would be.
+     * The statistics are kept in the MIDI thread so reset is only a request.
+     */
+    void resetJitter();
+    void traceJitter(const char* label);
+    int getJitterCount();
+    int getJitterRms();
+
   private:
 
     int sampleRate = 0;
@@ -156,7 +192,31 @@ class MidiTempoMonitor
     static const int ClockSampleMax = ClockWindowDefault * 4;
 
     /**
-     * The clock delta samples.
+     * The number of clocks in the window before the tempo is considered
+     * stable, 2 beats.  With the fit this is more accurate than the old
+     * average was with a full window.
+     */
+    static const int LockClocks = 48;
+
+    /**
+     * The number of clocks in the window before outliers are rejected.
+     */
+    static const int OutlierClocks = 8;
+
+    /**
+     * An outlier is this many times the fit error away from the
+     * prediction, and never closer than OutlierFloor seconds.
+     */
+    static const int OutlierFactor = 4;
+    static constexpr double OutlierFloor = 0.002;
+
+    /**
+     * Consecutive outliers on the same side that mean the tempo changed.
+     */
+    static const int TempoChangeClocks = 3;
+
+    /**
+     * The clock stamps in seconds relative to originTicks.
      */
     double clockSamples[ClockSampleMax];
 
@@ -173,24 +233,44 @@ class MidiTempoMonitor
      */
     int windowPosition = 0;
 
+    /**
+     * The number of stamps in the window, at most windowSize.
+     */
+    int windowCount = 0;
+
     /**
      * Set to true when enough samples have been received to begin
-     * doing tempo analysis.  This becomes true the first time
-     * windowPosition reaches windowSize and remains true until
-     * the analyzer is reset.
+     * doing tempo analysis.  This becomes true when windowCount
+     * reaches LockClocks and remains true until the window restarts.
      */
     bool windowFull = false;
 
     /**
-     * The timestamp of the last clock received.
+     * Tick time stamps are relative to this to keep the seconds small.
+     */
+    juce::int64 originTicks = 0;
+    double ticksPerSecond = 0.0;
+
+    /**
+     * The timestamp of the last clock received in seconds.
      */
     double lastTimeStamp = 0.0f;
+    std::atomic<juce::int64> lastClockTicks {0};
 
     /**
-     * The running total and average.
+     * The fitted line, the time of the oldest clock in the window, the
+     * seconds per clock, and the RMS distance of the clocks from the line.
      */
-    double runningTotal = 0.0f;
+    double fitOrigin = 0.0f;
     double runningAverage = 0.0f;
+    double fitError = 0.0f;
+
+    /**
+     * Consecutive outliers waiting to see if they are a tempo change.
+     */
+    double outliers[TempoChangeClocks];
+    int outlierCount = 0;
+    bool outlierLate = false;
 
     /**
      * The number of clocks that have been receieved since orientation.
@@ -210,6 +290,16 @@ class MidiTempoMonitor
      */
     bool traceEnabled = false;
 
+    std::atomic<bool> jitterResetPending {false};
+    int jitterCount = 0;
+    double jitterTotal = 0.0;
+    double jitterSquares = 0.0;
+    double jitterMax = 0.0;
+
     bool looksReasonable(double delta);
+    void addStamp(double stamp);
+    void restart(double* stamps, int count);
+    void fit();
+    void addJitter(double delta);
      
 };
@@ -275,6 +275,16 @@ Pulse* Pulsator::getAnyBlockPulse(LogicalTrack* t)
     return pulse;
 }
 
+/**
+ * Return the Transport pulse if there was one in this block.
+ * Transport detects bars itself so the unit is already right
+ * and this doesn't need to go through BarTender.
+ */
+Pulse* Pulsator::getTransportBlockPulse()
+{
+    return getBlockPulse(SyncSourceTransport, 0);
+}
+
 /**
  * Return the pulse object for a source if it is active in this block.
  */
@@ -47,6 +47,10 @@ class Pulsator
     // pulse widths
     Pulse* getAnyBlockPulse(class LogicalTrack* t);
 
+    // called by TimeSlicer for MSL beat and bar waits in tracks
+    // that don't follow anything
+    Pulse* getTransportBlockPulse();
+
   private:
 
     class SyncMaster* syncMaster = nullptr;
@@ -431,6 +431,35 @@ void SyncMaster::refreshSampleRate(int rate)
 void SyncMaster::processAudioStream(MobiusAudioStream* stream)
 {
     timeSlicer->processAudioStream(stream);
+
+    // the Transport is now where it will be at the end of the block
+    midiRealizer->generate(stream, transport.get());
+}
+
+/**
+ * Kernel wants an action bound to MIDI done when the track reaches
+ * the message offset.
+ */
+bool SyncMaster::sliceAction(int trackNumber, int offset, UIAction* a)
+{
+    return timeSlicer->addAction(trackNumber, offset, a);
+}
+
+/**
+ * TrackManager wants a MIDI event given to the tracks at the message offset.
+ */
+bool SyncMaster::sliceMidiEvent(int offset, MidiEvent* e)
+{
+    return timeSlicer->addMidiEvent(offset, e);
+}
+
+/**
+ * TrackMslHandler wants an MSL wait that isn't a track location
+ * to end at the right point in the block.
+ */
+bool SyncMaster::scheduleWait(LogicalTrack* t, MslWait* w)
+{
+    return timeSlicer->scheduleWait(t, w);
 }
 
 int SyncMaster::getBlockCount()
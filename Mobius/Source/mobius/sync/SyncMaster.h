@@ -88,6 +88,13 @@ class SyncMaster
 
     class Pulse* getBlockPulse(class LogicalTrack* t);
 
+    // MIDI received within the block
+    bool sliceAction(int trackNumber, int blockOffset, class UIAction* a);
+    bool sliceMidiEvent(int blockOffset, class MidiEvent* e);
+
+    // MSL waits for time and pulses
+    bool scheduleWait(class LogicalTrack* t, class MslWait* w);
+
     //
     // Masters
     //
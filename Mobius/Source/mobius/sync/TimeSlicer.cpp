@@ -14,6 +14,19 @@
  * relationships can change as tracks are advanced, so the list may need to be
  * reordered during iteration.
  *
+ * MIDI from the host is timestamped with a block offset.  Rather than doing
+ * everything at the start of the block, MobiusKernel gives us bound actions
+ * and TrackManager gives us events for MIDI recording.  These are sliced
+ * into the tracks that need them so the track has advanced to the exact
+ * frame before the action happens.  With large blocks this removes up to
+ * a block of jitter from every footswitch.
+ *
+ * Only actions that target a single track can be sliced this way since the
+ * tracks are advanced one at a time.  Kernel decides that and does anything
+ * else up front.
+ *
+ * MSL waits for time and sync pulses are kept in a WaitWheel and become
+ * slices in the track that scheduled them when they expire.
  */
  
 #include <JuceHeader.h>
@@ -22,7 +35,12 @@
 #include "../MobiusKernel.h"
 
 #include "../../model/SyncConstants.h"
+#include "../../model/UIAction.h"
+#include "../../midi/MidiEvent.h"
+#include "../../script/MslWait.h"
 #include "Pulse.h"
+#include "Pulsator.h"
+#include "BarTender.h"
 #include "SyncMaster.h"
 #include "../track/LogicalTrack.h"
 #include "../track/TrackManager.h"
@@ -37,7 +55,8 @@ TimeSlicer::TimeSlicer(SyncMaster* sm, TrackManager* tm)
 
     // make sure this is large enough to contain a reasonably high number
     // of slices without dynamic allocation in the audio thread
-    slices.ensureStorageAllocated(32);
+    slices.ensureStorageAllocated(32 + MaxDeferred);
+    deferred.ensureStorageAllocated(MaxDeferred);
 
     // this one is a bit more variable, though Bert only goes up to 64
     // ...so far
@@ -64,12 +83,58 @@ void TimeSlicer::resetBlockOffset()
     blockOffset = 0;
 }
 
+/**
+ * Called by MobiusKernel for an action bound to a MIDI message that was
+ * received in the middle of the block.  Returns false if we're full and
+ * the action needs to be done immediately.  These arrive in order for each
+ * MIDI source but sources are interleaved, insertSlice puts them in order
+ * when the slices are gathered.
+ */
+bool TimeSlicer::addAction(int trackNumber, int offset, UIAction* a)
+{
+    bool added = false;
+    if (deferred.size() < MaxDeferred) {
+        Slice s;
+        s.blockOffset = offset;
+        s.action = a;
+        s.trackNumber = trackNumber;
+        deferred.add(s);
+        added = true;
+    }
+    else {
+        Trace(1, "TimeSlicer: Deferred slice overflow");
+    }
+    return added;
+}
+
+/**
+ * Called by TrackManager for a MIDI event received in the middle of the block.
+ * This goes to every track.
+ */
+bool TimeSlicer::addMidiEvent(int offset, MidiEvent* e)
+{
+    bool added = false;
+    if (deferred.size() < MaxDeferred) {
+        Slice s;
+        s.blockOffset = offset;
+        s.midiEvent = e;
+        deferred.add(s);
+        added = true;
+    }
+    else {
+        Trace(1, "TimeSlicer: Deferred slice overflow");
+    }
+    return added;
+}
+
 /**
  * Where the rubber meets the road and/or the shit hits the fan.
  */
 void TimeSlicer::processAudioStream(MobiusAudioStream* stream)
 {
     bool traceDetails = false;
+    int frames = stream->getInterruptFrames();
+    waits.advance(streamFrame, frames);
     prepareTracks();
     
     LogicalTrack* track = nextTrack();
@@ -104,24 +169,22 @@ void TimeSlicer::processAudioStream(MobiusAudioStream* stream)
                     blockOffset += sliceLength;
                 }
 
-                // now let the track know about this pulse
+                // now let the track know about this pulse or action
 
                 if (traceDetails) {
-                    Trace(2, "TimeSlicer: Track %d pulse %d", track->getNumber(),
+                    Trace(2, "TimeSlicer: Track %d slice %d", track->getNumber(),
                           s.blockOffset);
                 }
 
-                // this can only be an SM pulse righ tnow
-                syncMaster->handleBlockPulse(track, s.pulse);
-                
+                handleSlice(track, s);
 
                 if (traceDetails) {
-                    Trace(2, "TimeSlicer: Track %d post pulse length %d", track->getNumber(),
+                    Trace(2, "TimeSlicer: Track %d post slice length %d", track->getNumber(),
                           track->getSyncLength());
                 }
             }
 
-            int remainder = stream->getInterruptFrames() - blockOffset;
+            int remainder = frames - blockOffset;
             if(remainder > 0) {
                 ass.setSlice(blockOffset, remainder);
 
@@ -140,6 +203,62 @@ void TimeSlicer::processAudioStream(MobiusAudioStream* stream)
         track->setAdvanced(true);
         track = nextTrack();
     }
+
+    finishDeferred();
+    streamFrame += frames;
+}
+
+/**
+ * Do whatever a slice was made for after the track has advanced up to it.
+ */
+void TimeSlicer::handleSlice(LogicalTrack* track, Slice& s)
+{
+    if (s.pulse != nullptr) {
+        // this can only be an SM pulse righ tnow
+        syncMaster->handleBlockPulse(track, s.pulse);
+    }
+    else if (s.action != nullptr) {
+        // the kernel owns action routing, it may go to other tracks
+        // in the focus group too, those will see it at whatever
+        // point they are in the block
+        Slice& d = deferred.getReference(s.deferredIndex);
+        d.action = nullptr;
+        syncMaster->kernel->doSlicedAction(s.action);
+    }
+    else if (s.midiEvent != nullptr) {
+        track->midiEvent(s.midiEvent);
+    }
+    else if (s.wait != nullptr) {
+        finishWait(s.wait);
+    }
+}
+
+/**
+ * After all tracks have advanced, do any actions whose track
+ * didn't exist and return the MIDI events.
+ */
+void TimeSlicer::finishDeferred()
+{
+    for (int i = 0 ; i < deferred.size() ; i++) {
+        Slice& d = deferred.getReference(i);
+        if (d.action != nullptr) {
+            Trace(2, "TimeSlicer: Deferred action for missing track %d", d.trackNumber);
+            blockOffset = d.blockOffset;
+            syncMaster->kernel->doSlicedAction(d.action);
+        }
+        else if (d.midiEvent != nullptr) {
+            trackManager->finishMidiEvent(d.midiEvent);
+        }
+    }
+    deferred.clearQuick();
+
+    // waits for tracks that don't exist any more, or that were scheduled
+    // by a script after its track had passed the frame
+    while (waits.getDueCount() > 0) {
+        WaitWheel::Entry* e = waits.getDue(0);
+        blockOffset = (int)(e->frame - streamFrame);
+        finishWait(e);
+    }
 }
 
 /**
@@ -162,6 +281,71 @@ void TimeSlicer::advanceTrack(LogicalTrack* track, MobiusAudioStream* stream)
     track->processAudioStream(stream);
 }
 
+//////////////////////////////////////////////////////////////////////
+//
+// MSL Waits
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Called by TrackMslHandler for the wait types that are not track locations.
+ *
+ * Time waits are measured from wherever the block is now, which is the
+ * start of the block for actions and the slice offset when a script
+ * is resumed while the tracks advance.  Unlike the old track events these
+ * are not adjusted for the track rate, a second is a second.
+ */
+bool TimeSlicer::scheduleWait(LogicalTrack* track, MslWait* w)
+{
+    bool success = false;
+    int number = track->getNumber();
+    juce::int64 now = streamFrame + blockOffset;
+    int sampleRate = syncMaster->sampleRate;
+
+    // for pulses the amount is the number of them
+    int count = (w->amount > 0) ? w->amount : 1;
+    if (w->repeats > 0) count *= w->repeats;
+    
+    switch (w->type) {
+        case MslWaitMsec: {
+            int frames = (int)((float)sampleRate * ((float)w->amount / 1000.0f));
+            if (w->repeats > 0) frames *= w->repeats;
+            success = waits.schedule(number, w, now + frames);
+        }
+            break;
+        case MslWaitSecond: {
+            int frames = sampleRate * w->amount;
+            if (w->repeats > 0) frames *= w->repeats;
+            success = waits.schedule(number, w, now + frames);
+        }
+            break;
+        case MslWaitBlock:
+            success = waits.scheduleBlock(number, w);
+            break;
+        case MslWaitBeat:
+            success = waits.schedulePulse(number, w, SyncUnitBeat, count);
+            break;
+        case MslWaitBar:
+            success = waits.schedulePulse(number, w, SyncUnitBar, count);
+            break;
+        default:
+            Trace(1, "TimeSlicer: Unable to schedule wait type %s",
+                  MslWait::typeToKeyword(w->type));
+            break;
+    }
+    return success;
+}
+
+/**
+ * The track has advanced to where the wait ends, let the session go.
+ */
+void TimeSlicer::finishWait(WaitWheel::Entry* e)
+{
+    MslWait* w = waits.release(e);
+    if (w != nullptr)
+      syncMaster->kernel->finishWait(w, false);
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // Slice Ordering
@@ -182,29 +366,89 @@ void TimeSlicer::gatherSlices(LogicalTrack* track)
 
     // first the sync pulses
     insertPulse(syncMaster->getBlockPulse(track));
+
+    // then MIDI actions for this track and MIDI events for everyone
+    int number = track->getNumber();
+    for (int i = 0 ; i < deferred.size() ; i++) {
+        Slice& d = deferred.getReference(i);
+        if ((d.action != nullptr && d.trackNumber == number) ||
+            d.midiEvent != nullptr) {
+            Slice s = d;
+            s.deferredIndex = i;
+            insertSlice(s);
+        }
+    }
+                
+    gatherWaits(track);
                 
     // todo: now add slices for external quantization points
     // or other more obscure things
 }
 
-void TimeSlicer::insertPulse(Pulse* p)
+/**
+ * Add slices for the MSL waits this track has that end in this block.
+ * Pulse waits are counted first, which only happens if the track has some.
+ * The pulse here is the same one synchronized recording would see, but
+ * it doesn't matter whether it would start a recording.
+ *
+ * A track with no sync source never gets pulses from Pulsator, so those
+ * count Transport beats and bars instead.  If the Transport is stopped
+ * the wait ends when it starts again, same as waiting on a stopped
+ * MIDI clock.
+ */
+void TimeSlicer::gatherWaits(LogicalTrack* track)
 {
-    if (p != nullptr) {
-        int location = 0;
-        while (location < slices.size()) {
-            Slice& s = slices.getReference(location);
-            if (p->blockFrame < s.blockOffset)
-              break;
-            else
-              location++;
+    int number = track->getNumber();
+
+    if (waits.hasPulseWaits(number)) {
+        Pulse* annotated = nullptr;
+        if (track->getSyncSource() == SyncSourceNone) {
+            annotated = syncMaster->pulsator->getTransportBlockPulse();
+        }
+        else {
+            Pulse* p = syncMaster->pulsator->getAnyBlockPulse(track);
+            if (p != nullptr)
+              annotated = syncMaster->barTender->annotate(track, p);
+        }
+        if (annotated != nullptr)
+          waits.pulse(number, annotated->unit, streamFrame + annotated->blockFrame);
+    }
+
+    for (int i = 0 ; i < waits.getDueCount() ; i++) {
+        WaitWheel::Entry* e = waits.getDue(i);
+        if (e->track == number) {
+            Slice s;
+            s.blockOffset = (int)(e->frame - streamFrame);
+            s.wait = e;
+            insertSlice(s);
         }
+    }
+}
 
+void TimeSlicer::insertPulse(Pulse* p)
+{
+    if (p != nullptr) {
         Slice neu;
         neu.blockOffset = p->blockFrame;
         neu.pulse = p;
-        slices.insert(location, neu);
+        insertSlice(neu);
+    }
+}
 
+/**
+ * Slices on the same frame stay in the order they were inserted.
+ */
+void TimeSlicer::insertSlice(Slice& neu)
+{
+    int location = 0;
+    while (location < slices.size()) {
+        Slice& s = slices.getReference(location);
+        if (neu.blockOffset < s.blockOffset)
+          break;
+        else
+          location++;
     }
+    slices.insert(location, neu);
 }
 
 void TimeSlicer::test()
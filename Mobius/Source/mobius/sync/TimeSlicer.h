@@ -16,19 +16,41 @@
  * locations in the sample stream before doing things.  And tracks may depend on
  * other tracks for timing when actions are performed.
  *
+ * MIDI received from the host carries a position within the block.  Actions
+ * bound to those messages and the messages themselves are given to the
+ * TimeSlicer rather than being processed at the start of the block, and
+ * become slices in the tracks they target.
  */
 
 #pragma once
 
+#include "WaitWheel.h"
+
 class TimeSlicer
 {
   public:
 
+    /**
+     * The maximum number of MIDI triggered actions and events that
+     * can be sliced in one block.  Beyond this they are processed
+     * at the start of the block like they used to be.
+     */
+    static const int MaxDeferred = 64;
+
     class Slice {
       public:
         int blockOffset = 0;
         class Pulse* pulse = nullptr;
-        // todo: other slice types are Script Waits, leader pulses
+        // MIDI triggered action for one track
+        class UIAction* action = nullptr;
+        // MIDI event delivered to every track
+        class MidiEvent* midiEvent = nullptr;
+        // MSL wait that ends here
+        WaitWheel::Entry* wait = nullptr;
+        // track the action is for, and where it lives in the deferred list
+        int trackNumber = 0;
+        int deferredIndex = -1;
+        // todo: other slice types are leader pulses
     };
 
     TimeSlicer(class SyncMaster* sm, class TrackManager* tm);
@@ -42,6 +64,15 @@ class TimeSlicer
     int getBlockOffset();
     void resetBlockOffset();
 
+    bool addAction(int trackNumber, int blockOffset, class UIAction* a);
+    bool addMidiEvent(int blockOffset, class MidiEvent* e);
+
+    /**
+     * Schedule an MSL wait for time or sync pulses.  Waits for track
+     * locations stay with the track.
+     */
+    bool scheduleWait(class LogicalTrack* track, class MslWait* w);
+
   private:
 
     class SyncMaster* syncMaster = nullptr;
@@ -53,6 +84,13 @@ class TimeSlicer
     juce::Array<Slice> slices;
     int sliceCount = 0;
     int blockOffset = 0;
+
+    // MIDI triggered things waiting for the tracks to reach them
+    juce::Array<Slice> deferred;
+
+    // MSL waits and the stream frame at the start of the block
+    WaitWheel waits;
+    juce::int64 streamFrame = 0;
     
     juce::Array<class LogicalTrack*> orderedTracks;
     int orderedIndex = 0;
@@ -60,6 +98,11 @@ class TimeSlicer
 
     void gatherSlices(class LogicalTrack* track);
     void insertPulse(class Pulse* p);
+    void gatherWaits(class LogicalTrack* track);
+    void finishWait(WaitWheel::Entry* e);
+    void insertSlice(Slice& s);
+    void handleSlice(class LogicalTrack* track, Slice& s);
+    void finishDeferred();
     void test();
     
     void prepareTracks();
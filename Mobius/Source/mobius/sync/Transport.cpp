@@ -224,6 +224,7 @@ void Transport::cacheSessionParameters(bool force)
     sendClocksWhenStopped = session->getBool(SessionTransportClocks);
     manualStart = session->getBool(SessionTransportManualStart);
     metronomeEnabled = session->getBool(SessionTransportMetronome);
+    midiRealizer->setSampleClocks(session->getBool(SessionTransportSampleClocks));
     
     int min = session->getInt(SessionTransportMinTempo);
     if (min == 0) min = 30;
@@ -371,6 +372,10 @@ bool Transport::doAction(UIAction* a)
         case ParamTransportMetronome:
             userSetMetronome(a->value != 0);
             break;
+
+        case ParamTransportSampleClocks:
+            midiRealizer->setSampleClocks(a->value != 0);
+            break;
             
         case FuncTransportStop:
             userStop();
@@ -435,6 +440,10 @@ bool Transport::doQuery(Query* q)
             q->value = metronomeEnabled;
             break;
 
+        case ParamTransportSampleClocks:
+            q->value = midiRealizer->isSampleClocks();
+            break;
+
         default: handled = false; break;
     }
     return handled;
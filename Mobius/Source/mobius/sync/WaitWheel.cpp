@@ -0,0 +1,374 @@
+/**
+ * Implementation of the MSL wait schedule.
+ *
+ * Placement follows the usual hierarchical wheel rules.  An entry goes in
+ * the inner ring if it is in the same inner rotation as the base frame, in the
+ * outer ring if it is in the same outer rotation, and on the overflow list
+ * otherwise.  When the inner ring comes back around to slot zero the next
+ * outer slot is spread into it, and when the outer ring does the same the
+ * overflow list is placed again.
+ */
+
+#include <JuceHeader.h>
+
+#include "../../util/Trace.h"
+#include "../../script/MslWait.h"
+#include "../../script/MslSession.h"
+
+#include "WaitWheel.h"
+
+WaitWheel::WaitWheel()
+{
+    for (int i = 0 ; i < MaxWaits ; i++) {
+        entries[i].next = freeList;
+        freeList = &(entries[i]);
+    }
+    for (int i = 0 ; i < InnerSlots ; i++)
+      inner[i] = nullptr;
+    for (int i = 0 ; i < OuterSlots ; i++)
+      outer[i] = nullptr;
+
+    due.ensureStorageAllocated(MaxWaits);
+}
+
+WaitWheel::~WaitWheel()
+{
+    traceStatistics();
+}
+
+void WaitWheel::traceStatistics()
+{
+    if (scheduled > 0) {
+        Trace(2, "WaitWheel: %d scheduled %d expired %d stale %d canceled %d cascades %d maximum active",
+              scheduled, expired, stale, canceled, cascades, maxActive);
+        if (failures > 0)
+          Trace(1, "WaitWheel: %d waits could not be scheduled", failures);
+    }
+}
+
+WaitWheel::Entry* WaitWheel::newEntry(int track, MslWait* w)
+{
+    if (freeList == nullptr)
+      sweep();
+    
+    Entry* e = freeList;
+    if (e == nullptr) {
+        Trace(1, "WaitWheel: Wait pool exhausted");
+        failures++;
+    }
+    else {
+        freeList = e->next;
+        e->next = nullptr;
+        e->wait = w;
+        e->session = w->session;
+        e->generation = (w->session != nullptr) ? w->session->getGeneration() : 0;
+        e->track = track;
+        e->frame = 0;
+        e->unit = SyncUnitNone;
+        e->remaining = 0;
+
+        // nothing in the track refers to these
+        w->coreEvent = nullptr;
+        w->coreEventFrame = 0;
+
+        scheduled++;
+        active++;
+        if (active > maxActive)
+          maxActive = active;
+    }
+    return e;
+}
+
+void WaitWheel::freeEntry(Entry* e)
+{
+    e->wait = nullptr;
+    e->session = nullptr;
+    e->generation = 0;
+    e->next = freeList;
+    freeList = e;
+    active--;
+}
+
+/**
+ * The stack holding the wait goes back to the pool if the session
+ * is canceled and the session can be reused for another script,
+ * make sure it is still the same run of the same session.
+ */
+bool WaitWheel::isCurrent(Entry* e)
+{
+    MslWait* w = e->wait;
+    return (w != nullptr && w->active && !w->finished &&
+            w->session != nullptr && w->session == e->session &&
+            w->session->getGeneration() == e->generation);
+}
+
+/**
+ * Free the pending entries whose sessions are no longer waiting for them.
+ * Entries on the due list are left for release.
+ */
+void WaitWheel::sweep()
+{
+    for (int i = 0 ; i < InnerSlots ; i++)
+      inner[i] = sweep(inner[i]);
+    for (int i = 0 ; i < OuterSlots ; i++)
+      outer[i] = sweep(outer[i]);
+    overflow = sweep(overflow);
+    blockWaits = sweep(blockWaits);
+    pulseWaits = sweep(pulseWaits);
+}
+
+WaitWheel::Entry* WaitWheel::sweep(Entry* list)
+{
+    Entry* kept = nullptr;
+    Entry* last = nullptr;
+    while (list != nullptr) {
+        Entry* next = list->next;
+        if (isCurrent(list)) {
+            // keep the order, pulse waits are counted in it
+            list->next = nullptr;
+            if (last == nullptr)
+              kept = list;
+            else
+              last->next = list;
+            last = list;
+        }
+        else {
+            canceled++;
+            freeEntry(list);
+        }
+        list = next;
+    }
+    return kept;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Scheduling
+//
+//////////////////////////////////////////////////////////////////////
+
+bool WaitWheel::schedule(int track, MslWait* w, juce::int64 frame)
+{
+    Entry* e = newEntry(track, w);
+    if (e != nullptr) {
+        e->frame = frame;
+        if (frame < blockEnd) {
+            // scheduled by something running in the middle of the block
+            // and it ends before the block does
+            addDue(e);
+        }
+        else {
+            place(e, blockEnd);
+        }
+    }
+    return (e != nullptr);
+}
+
+bool WaitWheel::scheduleBlock(int track, MslWait* w)
+{
+    Entry* e = newEntry(track, w);
+    if (e != nullptr) {
+        e->next = blockWaits;
+        blockWaits = e;
+    }
+    return (e != nullptr);
+}
+
+bool WaitWheel::schedulePulse(int track, MslWait* w, SyncUnit unit, int count)
+{
+    Entry* e = newEntry(track, w);
+    if (e != nullptr) {
+        e->unit = unit;
+        e->remaining = (count > 0) ? count : 1;
+        e->next = pulseWaits;
+        pulseWaits = e;
+    }
+    return (e != nullptr);
+}
+
+/**
+ * Put a frame wait in the ring it belongs in relative to a base frame.
+ */
+void WaitWheel::place(Entry* e, juce::int64 base)
+{
+    juce::int64 tick = e->frame >> TickBits;
+    juce::int64 baseTick = base >> TickBits;
+
+    if ((tick >> InnerBits) == (baseTick >> InnerBits)) {
+        int slot = (int)(tick & InnerMask);
+        e->next = inner[slot];
+        inner[slot] = e;
+    }
+    else if ((tick >> (InnerBits + OuterBits)) == (baseTick >> (InnerBits + OuterBits))) {
+        int slot = (int)((tick >> InnerBits) & OuterMask);
+        e->next = outer[slot];
+        outer[slot] = e;
+    }
+    else {
+        e->next = overflow;
+        overflow = e;
+    }
+}
+
+void WaitWheel::cascade(Entry* list, juce::int64 base)
+{
+    while (list != nullptr) {
+        Entry* next = list->next;
+        place(list, base);
+        list = next;
+        cascades++;
+    }
+}
+
+/**
+ * The due list is small and kept in frame order so slices for the
+ * same track come out in the right order.
+ */
+void WaitWheel::addDue(Entry* e)
+{
+    e->next = nullptr;
+    int location = 0;
+    while (location < due.size() && due[location]->frame <= e->frame)
+      location++;
+    due.insert(location, e);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Advance
+//
+//////////////////////////////////////////////////////////////////////
+
+void WaitWheel::advance(juce::int64 start, int frames)
+{
+    blockEnd = start + frames;
+
+    juce::int64 rotation = start >> (TickBits + InnerBits);
+    if (rotation != sweepRotation) {
+        sweepRotation = rotation;
+        if (active > 0)
+          sweep();
+    }
+
+    // the block waits were scheduled during the last block
+    while (blockWaits != nullptr) {
+        Entry* e = blockWaits;
+        blockWaits = e->next;
+        e->frame = start;
+        addDue(e);
+    }
+
+    if (frames > 0) {
+        juce::int64 firstTick = start >> TickBits;
+        juce::int64 endTick = (blockEnd - 1) >> TickBits;
+
+        for (juce::int64 tick = firstTick ; tick <= endTick ; tick++) {
+
+            if (tick > lastTick) {
+                // entering this tick for the first time
+                if ((tick & InnerMask) == 0) {
+                    juce::int64 base = tick << TickBits;
+                    if (((tick >> InnerBits) & OuterMask) == 0) {
+                        Entry* list = overflow;
+                        overflow = nullptr;
+                        cascade(list, base);
+                    }
+                    int slot = (int)((tick >> InnerBits) & OuterMask);
+                    Entry* list = outer[slot];
+                    outer[slot] = nullptr;
+                    cascade(list, base);
+                }
+                lastTick = tick;
+            }
+
+            // entries later in the slot than this block stay where they are
+            int slot = (int)(tick & InnerMask);
+            Entry* remaining = nullptr;
+            Entry* e = inner[slot];
+            while (e != nullptr) {
+                Entry* next = e->next;
+                if (e->frame < blockEnd) {
+                    addDue(e);
+                }
+                else {
+                    e->next = remaining;
+                    remaining = e;
+                }
+                e = next;
+            }
+            inner[slot] = remaining;
+        }
+    }
+}
+
+bool WaitWheel::hasPulseWaits(int track)
+{
+    bool found = false;
+    for (Entry* e = pulseWaits ; e != nullptr ; e = e->next) {
+        if (e->track == track) {
+            found = true;
+            break;
+        }
+    }
+    return found;
+}
+
+/**
+ * Relevance is the same as it is for synchronized recording,
+ * anything is a beat, and loops are also bars.
+ */
+void WaitWheel::pulse(int track, SyncUnit unit, juce::int64 frame)
+{
+    Entry* prev = nullptr;
+    Entry* e = pulseWaits;
+    while (e != nullptr) {
+        Entry* next = e->next;
+        bool relevant = false;
+        if (e->track == track) {
+            if (e->unit == SyncUnitBeat)
+              relevant = true;
+            else if (e->unit == SyncUnitBar)
+              relevant = (unit == SyncUnitBar || unit == SyncUnitLoop);
+            else
+              relevant = (unit == SyncUnitLoop);
+        }
+
+        if (relevant) {
+            e->remaining--;
+            if (e->remaining <= 0) {
+                if (prev == nullptr)
+                  pulseWaits = next;
+                else
+                  prev->next = next;
+                e->frame = frame;
+                addDue(e);
+                // prev stays where it is
+                e = next;
+                continue;
+            }
+        }
+        prev = e;
+        e = next;
+    }
+}
+
+MslWait* WaitWheel::release(Entry* e)
+{
+    MslWait* wait = nullptr;
+    due.removeFirstMatchingValue(e);
+
+    if (isCurrent(e)) {
+        wait = e->wait;
+        expired++;
+    }
+    else {
+        stale++;
+    }
+
+    freeEntry(e);
+    return wait;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
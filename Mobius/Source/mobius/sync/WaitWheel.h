@@ -0,0 +1,177 @@
+/**
+ * Schedule for MSL waits that are not attached to a track location.
+ *
+ * Waits for a number of milliseconds or seconds used to be converted into
+ * track frames and put on the track event list, which meant they stretched
+ * with the playback rate and never expired while the track was in Reset.
+ * Waits for the next block were pending track events that every track
+ * looked for at the start of every block.  And waits for beats and bars
+ * were never implemented.
+ *
+ * Those now live here and are keyed by absolute stream frame, which
+ * TimeSlicer counts from the first block.  The frame waits go into a
+ * hierarchical timer wheel: the inner ring has a slot for every 256 frames
+ * covering a little over a second, the outer ring has a slot for each
+ * rotation of the inner ring covering about a minute and a half, and
+ * anything further than that goes on an overflow list.  As the block
+ * advances only the inner slots it covers are examined, and outer slots
+ * are spread into the inner ring as it comes around.  A block with nothing
+ * expiring touches one or two empty slots regardless of how many waits
+ * are pending.
+ *
+ * Waits for symbolic boundaries are kept in separate queues.  Block waits
+ * expire at the start of the next block.  Beat and bar waits are queued
+ * with a count, and only tracks with something in that queue ask SyncMaster
+ * for a pulse.
+ *
+ * Expired waits are put on the due list with their stream frame and
+ * TimeSlicer makes them slices in the track that scheduled them, so the
+ * script resumes exactly where the wait ended rather than at the start
+ * of the block.
+ *
+ * Everything here is done in the kernel.  Entries come from a fixed pool,
+ * if that runs out the wait fails to schedule.
+ *
+ * A session can be canceled or end with errors while it is waiting, and
+ * a wait for a minute or for a bar of a stopped clock would then hold its
+ * entry long after anyone cared.  Once every inner rotation, and before
+ * giving up when the pool is empty, the pending lists are swept for entries
+ * whose session has moved on and those are freed.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "../../model/SyncConstants.h"
+
+class WaitWheel
+{
+  public:
+
+    /**
+     * The maximum number of waits that can be pending.  Each session can
+     * only wait on one thing at a time so this is plenty.
+     */
+    static const int MaxWaits = 64;
+
+    class Entry
+    {
+      public:
+        Entry* next = nullptr;
+        class MslWait* wait = nullptr;
+        // the session that owned the wait when it was scheduled
+        // and the generation it was in, pooled sessions are reused
+        class MslSession* session = nullptr;
+        int generation = 0;
+        int track = 0;
+        // absolute stream frame where the wait ends
+        juce::int64 frame = 0;
+        // for pulse waits, the unit and the number of them remaining
+        SyncUnit unit = SyncUnitNone;
+        int remaining = 0;
+    };
+
+    WaitWheel();
+    ~WaitWheel();
+
+    /**
+     * Schedule a wait that ends at an absolute stream frame.
+     */
+    bool schedule(int track, class MslWait* w, juce::int64 frame);
+
+    /**
+     * Schedule a wait that ends at the start of the next block.
+     */
+    bool scheduleBlock(int track, class MslWait* w);
+
+    /**
+     * Schedule a wait that ends after a number of sync pulses.
+     */
+    bool schedulePulse(int track, class MslWait* w, SyncUnit unit, int count);
+
+    /**
+     * Called at the start of each block with the first stream frame in the block.
+     * Anything that expires before the end of the block is moved to the due list.
+     */
+    void advance(juce::int64 start, int frames);
+
+    /**
+     * True if the track has pulse waits so the slicer knows to look
+     * for pulses.
+     */
+    bool hasPulseWaits(int track);
+
+    /**
+     * Count a sync pulse of the given unit detected at a stream frame.
+     * Any pulse waits for the track that reach zero become due.
+     */
+    void pulse(int track, SyncUnit unit, juce::int64 frame);
+
+    // due list, ordered by frame
+    int getDueCount() {
+        return due.size();
+    }
+    Entry* getDue(int index) {
+        return due[index];
+    }
+
+    /**
+     * Remove an entry from the due list and return the wait if the session
+     * that scheduled it is still waiting for it.
+     */
+    class MslWait* release(Entry* e);
+
+    void traceStatistics();
+
+  private:
+
+    static const int TickBits = 8;
+    static const int InnerBits = 8;
+    static const int OuterBits = 6;
+    static const int InnerSlots = 1 << InnerBits;
+    static const int OuterSlots = 1 << OuterBits;
+    static const int InnerMask = InnerSlots - 1;
+    static const int OuterMask = OuterSlots - 1;
+
+    Entry entries[MaxWaits];
+    Entry* freeList = nullptr;
+
+    Entry* inner[InnerSlots];
+    Entry* outer[OuterSlots];
+    Entry* overflow = nullptr;
+
+    Entry* blockWaits = nullptr;
+    Entry* pulseWaits = nullptr;
+
+    juce::Array<Entry*> due;
+
+    // the end of the block being advanced, where the next one starts
+    juce::int64 blockEnd = 0;
+    juce::int64 lastTick = -1;
+
+    int active = 0;
+    int maxActive = 0;
+    int scheduled = 0;
+    int expired = 0;
+    int stale = 0;
+    int cascades = 0;
+    int failures = 0;
+
+    // the inner rotation of the last sweep
+    juce::int64 sweepRotation = -1;
+    int canceled = 0;
+
+    Entry* newEntry(int track, class MslWait* w);
+    void freeEntry(Entry* e);
+    bool isCurrent(Entry* e);
+    void sweep();
+    Entry* sweep(Entry* list);
+    void place(Entry* e, juce::int64 base);
+    void cascade(Entry* list, juce::int64 base);
+    void addDue(Entry* e);
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -520,7 +520,6 @@ void BaseScheduler::leaderLoopResize(TrackProperties& props)
  */
 void BaseScheduler::advance(MobiusAudioStream* stream)
 {
-    activateBlockWait();
     framesConsumed = 0;
     
     if (scheduledTrack->isPaused()) {
@@ -628,35 +627,6 @@ void BaseScheduler::advance(MobiusAudioStream* stream)
     }
 }
 
-/**
- * Called at the top of advance() to activate any MslWaits with type Block
- * This assumes that advance() can only be called for the full block, not partial blocks.
- */
-void BaseScheduler::activateBlockWait()
-{
-    // should only have one, but activate all of them
-    int count = 0;
-    for (TrackEvent* e = events.getEvents() ; e != nullptr ; e = e->next) {
-        if (e->type == TrackEvent::EventWait) {
-            if (e->wait == nullptr) {
-                Trace(1, "BaseScheduler: Found EventWait with no MslWait");
-            }
-            else if (e->wait->type == MslWaitBlock) {
-                if (!e->pending)
-                  Trace(1, "BaseScheduler: Found activated block wait");
-                e->pending = false;
-                // we can activate it and process it normally
-                // or inform the script now, should be effectively the same
-                e->frame = scheduledTrack->getFrame();
-                count++;
-            }
-        }
-    }
-
-    if (count > 1)
-      Trace(1, "BaseScheduler: Found %d wait events, what's the deal?", count);
-}    
-
 /**
  * Called immediately after MidiTrack::loop has rewound to the beginning.
  * See where the leader track is and how far off we are.
@@ -154,7 +154,6 @@ class BaseScheduler
     // Advance
     //
 
-    void activateBlockWait();
     void traceFollow();
     int scale(int blockFrames);
     int scaleWithCarry(int blockFrames);
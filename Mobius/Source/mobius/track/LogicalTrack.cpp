@@ -7,6 +7,7 @@
 #include "../../model/ParameterConstants.h"
 #include "../../model/SyncConstants.h"
 #include "../../model/Session.h"
+#include "../../model/SessionDiff.h"
 #include "../../model/ParameterSets.h"
 #include "../../model/UIAction.h"
 #include "../../model/Query.h"
@@ -185,6 +186,43 @@ void LogicalTrack::loadSession()
       track->refreshParameters();
 }
 
+/**
+ * After a session edit that didn't add, remove or move tracks, TrackManager
+ * will have given us the new Session::Track with setSession and this
+ * refreshes just the parameters that changed.  If nothing changed in
+ * this track the inner track is left alone.
+ */
+void LogicalTrack::loadSession(SessionDiffs* diffs)
+{
+    if (sessionTrack == nullptr) {
+        Trace(1, "LogicalTrack::loadSession Session object was not set");
+        return;
+    }
+
+    // the vault always needs to be pointed at the new Session objects
+    // even if none of the ordinals changed
+    vault.refresh(sessionTrack->getSession(), sessionTrack, diffs, number);
+
+    // this also tells the inner track, including core tracks
+    // which TrackManager doesn't send to Mobius in bulk this time
+    if (diffs->hasTrack(number))
+      cacheParameters(false, false, false);
+}
+
+/**
+ * Called by MobiusShell for a track that is about to be added by a new
+ * session.  The inner track for a MIDI track does a fair bit of allocation
+ * so it is built here rather than in loadSession.  This is not in the kernel
+ * yet so the only thing it may touch is the TrackManager pointers the inner
+ * track constructors wire up.  Audio tracks are built by Mobius.
+ */
+void LogicalTrack::prepareTrack(Session::TrackType type)
+{
+    trackType = type;
+    if (trackType == Session::TypeMidi)
+      track.reset(new MidiTrack(manager, this));
+}
+
 void LogicalTrack::refresh(ParameterSets* sets)
 {
     vault.refresh(sets);
@@ -336,20 +374,6 @@ void LogicalTrack::trackNotification(NotificationId notification, TrackPropertie
     track->trackNotification(notification, props);
 }
 
-/**
- * This is intended for waits that are normaly attached to another scheduled
- * event, or scheduled pending waiting for actiation.
- * Midi tracks use the local scheduler.
- * Audio tracks use...what exactly?
- */
-bool LogicalTrack::scheduleWait(MslWait* w)
-{
-    (void)w;
-    // todo: create an EventWait with this wait object
-    // mark it pending, have beginAudioBlock look for it
-    return false;
-}
-
 int LogicalTrack::scheduleFollowerEvent(QuantizeMode q, int followerTrack, int eventId)
 {
     return track->scheduleFollowerEvent(q, followerTrack, eventId);
@@ -592,6 +616,10 @@ void LogicalTrack::refreshState(TrackState* state)
     state->subcycles = getSubcycles();
     state->focus = focusLock;
     state->group = groupNumber;
+
+    // only audio tracks have waveforms, and TrackStates may be reused
+    // by a different track type
+    state->peakCount = 0;
     
     track->refreshState(state);
 }
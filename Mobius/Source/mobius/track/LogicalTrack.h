@@ -44,6 +44,10 @@ class LogicalTrack
     void prepareParameters();
     // this causes the session to be fully loaded and the BaseTracks initialized
     void loadSession();
+    // partial reload after a session edit that kept the same tracks
+    void loadSession(class SessionDiffs* diffs);
+    // called by the shell to build the inner track ahead of time
+    void prepareTrack(Session::TrackType type);
     void globalReset();
     void refresh(class ParameterSets* sets);
     void refresh(class GroupDefinitions* groups);
@@ -67,7 +71,6 @@ class LogicalTrack
     void midiEvent(class MidiEvent* e);
 
     void trackNotification(NotificationId notification, TrackProperties& props);
-    bool scheduleWait(class MslWait* wait);
     int scheduleFollowerEvent(QuantizeMode q, int followerTrack, int eventId);
 
     bool scheduleWait(class TrackWait& wait);
@@ -30,6 +30,7 @@
 #include "../../model/Symbol.h"
 #include "../../model/ParameterProperties.h"
 #include "../../model/Session.h"
+#include "../../model/SessionDiff.h"
 #include "../../model/ValueSet.h"
 #include "../../model/ParameterSets.h"
 #include "../../model/GroupDefinition.h"
@@ -129,6 +130,36 @@ void ParameterVault::refresh(GroupDefinitions* groups)
     }
 }
 
+/**
+ * The overlays are located first since selecting a different one
+ * can change anything.  Otherwise the layers are the same ones we
+ * flattened last time except for the diffs.
+ */
+void ParameterVault::refresh(Session* s, Session::Track* t, SessionDiffs* diffs, int number)
+{
+    session = s;
+    track = t;
+
+    ValueSet* defaults = session->ensureGlobals();
+    ValueSet* trackValues = track->ensureParameters();
+    ValueSet* newSessionOverlay = findSessionOverlay(defaults);
+    ValueSet* newTrackOverlay = findTrackOverlay(defaults, trackValues);
+    
+    if (newSessionOverlay != sessionOverlay || newTrackOverlay != trackOverlay) {
+        refresh();
+    }
+    else {
+        for (auto& diff : diffs->diffs) {
+            if (diff.track == number) {
+                int index = getParameterIndex(diff.symbol);
+                if (index >= 0)
+                  install(index, resolveOrdinal(diff.symbol, defaults, trackValues));
+            }
+        }
+        promotePorts();
+    }
+}
+
 void ParameterVault::refresh()
 {
     ValueSet* defaults = session->ensureGlobals();
@@ -207,28 +238,34 @@ void ParameterVault::install(juce::Array<int>& ordinals)
               ordinals.size(), localOrdinals.size());
     }
     else {
-        for (int i = 0 ; i < ordinals.size() ; i++) {
-            int current = sessionOrdinals[i];
-            int neu = ordinals[i];
-            if (current != neu) {
-                // local binding goes away
-                if (localOrdinals[i] >= 0) {
-                    // temporary so I can watch what's happening
-                    Symbol* s = symbols->getParameterWithIndex(i);
-                    Trace(2, "ParameterVault: Parameter %s changed from %d to %d, canceling local override",
-                          s->getName(), current, neu);
-                    localOrdinals.set(i, -1);
-                }
-                sessionOrdinals.set(i, neu);
-            }
-            else {
-                // also temporary
-                if (localOrdinals[i] >= 0) {
-                    Symbol* s = symbols->getParameterWithIndex(i);
-                    Trace(2, "ParameterVault: Parameter %s preserved local override",
-                          s->getName());
-                }
-            }
+        for (int i = 0 ; i < ordinals.size() ; i++)
+          install(i, ordinals[i]);
+    }
+}
+
+/**
+ * Install one flattened ordinal.
+ */
+void ParameterVault::install(int index, int neu)
+{
+    int current = sessionOrdinals[index];
+    if (current != neu) {
+        // local binding goes away
+        if (localOrdinals[index] >= 0) {
+            // temporary so I can watch what's happening
+            Symbol* s = symbols->getParameterWithIndex(index);
+            Trace(2, "ParameterVault: Parameter %s changed from %d to %d, canceling local override",
+                  s->getName(), current, neu);
+            localOrdinals.set(index, -1);
+        }
+        sessionOrdinals.set(index, neu);
+    }
+    else {
+        // also temporary
+        if (localOrdinals[index] >= 0) {
+            Symbol* s = symbols->getParameterWithIndex(index);
+            Trace(2, "ParameterVault: Parameter %s preserved local override",
+                  s->getName());
         }
     }
 }
@@ -61,6 +61,14 @@ class ParameterVault
     void refresh(class ParameterSets* sets);
     void refresh(class GroupDefinitions* groups);
 
+    /**
+     * Partial refresh after a session edit that kept the same tracks.
+     * Only the parameters in the diffs for this track number are resolved
+     * again, unless an overlay changed which needs a full refresh.
+     */
+    void refresh(class Session* s, class Session::Track* t,
+                 class SessionDiffs* diffs, int number);
+
     /**
      * Remove all local parameter bindings.
      */
@@ -113,6 +121,7 @@ class ParameterVault
     void initArray(juce::Array<int>& array, int size);
     void refresh();
     void install(juce::Array<int>& ordinals);
+    void install(int index, int ordinal);
 
     // Overlay shit to do flattening
     class ValueSet* findSessionOverlay(class ValueSet* globals);
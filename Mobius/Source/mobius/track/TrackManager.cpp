@@ -8,6 +8,7 @@
 #include "../../model/ScriptProperties.h"
 #include "../../model/GroupDefinition.h"
 #include "../../model/Session.h"
+#include "../../model/SessionDiff.h"
 #include "../../model/UIAction.h"
 #include "../../model/Query.h"
 #include "../../model/Scope.h"
@@ -129,8 +130,14 @@ void TrackManager::globalReset()
  * Changing the audio track count is awkward because it is still done through the Setup
  * which must have already been processed by the core.
  *
+ * If the shell built LogicalTracks ahead of time for the tracks this session
+ * adds they are passed in and used before making new ones.  Any that
+ * are left over are returned to the shell with the rest of the payload.
+ * Tracks the session removes go back the same way if the shell gave us
+ * room for them in the retired list.
  */
-void TrackManager::loadSession(Session* s) 
+void TrackManager::loadSession(Session* s, juce::Array<LogicalTrack*>* prepared,
+                               juce::Array<LogicalTrack*>* retired)
 {
     session = s;
     longWatcher.initialize(session, kernel->getContainer()->getSampleRate());
@@ -138,7 +145,7 @@ void TrackManager::loadSession(Session* s)
     // allow this to be disabled during debugging
     longDisable = session->getBool(ParamLongDisable);
 
-    configureTracks(session);
+    configureTracks(session, prepared, retired);
 
     // !! the relationship here is old and stupid
     // Tracks don't actually listen to each other, the only TrackListener
@@ -155,14 +162,63 @@ void TrackManager::loadSession(Session* s)
     }
 }
 
+/**
+ * Apply an edited session that has the same tracks in the same order
+ * as the one we have now.  This is what happens for almost every change
+ * made in the session editor.  The Session::Tracks are swapped in place
+ * and only the tracks with differences refresh their parameters, there is
+ * no track reorganization and nothing is sent to Mobius in bulk.
+ *
+ * Returns false if the tracks don't line up and loadSession
+ * must be used instead.
+ */
+bool TrackManager::reloadSession(Session* s, SessionDiffs* diffs)
+{
+    bool reloaded = false;
+    if (isSameTracks(s)) {
+        session = s;
+        longWatcher.initialize(session, kernel->getContainer()->getSampleRate());
+        longDisable = session->getBool(ParamLongDisable);
+
+        for (int i = 0 ; i < tracks.size() ; i++) {
+            LogicalTrack* lt = tracks[i];
+            lt->setSession(session->getTrackByIndex(i), i+1);
+            lt->loadSession(diffs);
+        }
+        reloaded = true;
+    }
+    return reloaded;
+}
+
+/**
+ * True if the session is an edit of the one we have, and the track
+ * ids and types are the same as the ones configureTracks matched last time.
+ */
+bool TrackManager::isSameTracks(Session* s)
+{
+    bool same = (s->getId() == lastSessionId && s->getTrackCount() == tracks.size());
+    if (same) {
+        for (int i = 0 ; i < tracks.size() ; i++) {
+            LogicalTrack* lt = tracks[i];
+            Session::Track* def = s->getTrackByIndex(i);
+            if (def == nullptr || def->id != lt->getSessionId() || def->type != lt->getType()) {
+                same = false;
+                break;
+            }
+        }
+    }
+    return same;
+}
+
 /**
  * Organize the track array for a new session.
  * The Session is authoritative over the track order and numbering.
  *
- * Note: this is going to do a small amount of memory allocation which
- * we ordinarlly try not to do in the audio thread.  I'm too tired to bother
- * with it, and since this represents the propagation of a session change
- * it only happens during a significant period of quiet time.
+ * Note: this can still do a small amount of memory allocation which
+ * we ordinarlly try not to do in the audio thread, when the session has
+ * more tracks than any before it and the shell didn't prepare them.
+ * Removed tracks are not deleted here when the shell passes a retired
+ * list, they go back to the shell with the payload.
  *
  * Still, in the future some parameter changes like adjusting audio port
  * routing might come down this way and need to be done "live" so revisit this.
@@ -182,15 +238,18 @@ void TrackManager::loadSession(Session* s)
  * rather than the uuid in the Session.  
  * 
  */
-void TrackManager::configureTracks(Session* ses)
+void TrackManager::configureTracks(Session* ses, juce::Array<LogicalTrack*>* prepared,
+                                   juce::Array<LogicalTrack*>* retired)
 {
     // transfer the current track list to a holding area
-    juce::Array<LogicalTrack*> oldTracks;
-    while (tracks.size() > 0) {
-        LogicalTrack* lt = tracks.removeAndReturn(0);
-        oldTracks.add(lt);
-        
-    }
+    // tracks that are reused or consumed are nulled rather than removed
+    // so the arrays don't resize
+    oldTracks.clearQuick();
+    oldTracks.ensureStorageAllocated(tracks.size());
+    for (auto lt : tracks)
+      oldTracks.add(lt);
+    tracks.clearQuick(false);
+    tracks.ensureStorageAllocated(session->getTrackCount());
 
     bool strictMode = false;    // keep this off unless it becomes interesting
     bool reuseTracks = true;
@@ -220,28 +279,41 @@ void TrackManager::configureTracks(Session* ses)
         if (reuseTracks) {
             if (checkSessionIds) {
                 // reassign by id
-                int index = 0;
-                for (auto old : oldTracks) {
-                    if (old->getSessionId() == def->id) {
-                        lt = oldTracks.removeAndReturn(index);
+                for (int index = 0 ; index < oldTracks.size() ; index++) {
+                    LogicalTrack* old = oldTracks[index];
+                    if (old != nullptr && old->getSessionId() == def->id) {
+                        lt = old;
+                        oldTracks.set(index, nullptr);
                         break;
                     }
-                    index++;
                 }
             }
             else {
                 // reassign by position
-                int index = 0;
-                for (auto old : oldTracks) {
-                    if (old->getType() == def->type) {
-                        lt = oldTracks.removeAndReturn(index);
+                for (int index = 0 ; index < oldTracks.size() ; index++) {
+                    LogicalTrack* old = oldTracks[index];
+                    if (old != nullptr && old->getType() == def->type) {
+                        lt = old;
+                        oldTracks.set(index, nullptr);
                         break;
                     }
-                    index++;
                 }
             }
         }
 
+        // use one the shell built if it has the right type
+        // the payload deletes whatever is left in the shell
+        if (lt == nullptr && prepared != nullptr) {
+            for (int index = 0 ; index < prepared->size() ; index++) {
+                LogicalTrack* p = (*prepared)[index];
+                if (p != nullptr && p->getType() == def->type) {
+                    lt = p;
+                    prepared->set(index, nullptr);
+                    break;
+                }
+            }
+        }
+        
         if (lt == nullptr)
           lt = new LogicalTrack(this);
         tracks.add(lt);
@@ -259,8 +331,10 @@ void TrackManager::configureTracks(Session* ses)
 
     // remove deleted track numbers before calling Mobius as a signal
     // that these tracks are no longer valid
-    for (auto lt : oldTracks)
-      lt->markDying();
+    for (auto lt : oldTracks) {
+        if (lt != nullptr)
+          lt->markDying();
+    }
     
     // this is how core tracks get the session updates
     configureMobiusTracks();
@@ -272,14 +346,23 @@ void TrackManager::configureTracks(Session* ses)
         track->loadSession();
     }
     
-    while (oldTracks.size() > 0) {
-        LogicalTrack* lt = oldTracks.removeAndReturn(0);
-        const char* tracktype = "Audio";
-        if (lt->getType() == Session::TypeMidi)
-          tracktype = "Midi";
-        Trace(2, "TrackManager: Removing unused %s track", tracktype);
-        delete lt;
+    for (auto lt : oldTracks) {
+        if (lt != nullptr) {
+            const char* tracktype = "Audio";
+            if (lt->getType() == Session::TypeMidi)
+              tracktype = "Midi";
+            Trace(2, "TrackManager: Removing unused %s track", tracktype);
+            if (retired != nullptr && retired->size() < retired->getNumAllocated()) {
+                retired->add(lt);
+            }
+            else {
+                if (retired != nullptr)
+                  Trace(1, "TrackManager: No room to retire track, deleting in the kernel");
+                delete lt;
+            }
+        }
     }
+    oldTracks.clearQuick();
 }
 
 /**
@@ -509,6 +592,28 @@ void TrackManager::midiEvent(juce::MidiMessage& msg, int deviceId)
     midiEvent(e);
 }
 
+/**
+ * An event from the host that arrived after the start of the block.
+ * The watcher sees it now, the tracks see it when TimeSlicer has advanced
+ * them to the offset so recorded events land on the right frame.
+ * TimeSlicer calls back to finishMidiEvent when everyone has seen it.
+ */
+void TrackManager::midiEvent(juce::MidiMessage& msg, int deviceId, int blockOffset)
+{
+    MidiEvent* e = midiPools.newEvent();
+    e->juceMessage = msg;
+    e->device = deviceId;
+    if (blockOffset > 0 && getSyncMaster()->sliceMidiEvent(blockOffset, e))
+      watcher.midiEvent(e);
+    else
+      midiEvent(e);
+}
+
+void TrackManager::finishMidiEvent(MidiEvent* e)
+{
+    midiPools.checkin(e);
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // Outbound Events
@@ -520,9 +625,9 @@ void TrackManager::alert(const char* msg)
     kernel->sendMobiusMessage(msg);
 }
 
-void TrackManager::midiSend(juce::MidiMessage& msg, int deviceId)
+void TrackManager::midiSend(juce::MidiMessage& msg, int deviceId, int offset)
 {
-    kernel->midiSend(msg, deviceId);
+    kernel->midiSend(msg, deviceId, offset);
 }
 
 void TrackManager::writeDump(juce::String file, juce::String content)
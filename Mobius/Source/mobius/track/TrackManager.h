@@ -50,7 +50,9 @@ class TrackManager : public LongWatcher::Listener, public TrackListener
     void initialize(class Session* s, class GroupDefinitions* g, class Mobius* engine);
     void refresh(class GroupDefinitions* groups);
     void refresh(class ParameterSets* sets);
-    void loadSession(class Session* s);
+    void loadSession(class Session* s, juce::Array<class LogicalTrack*>* prepared = nullptr,
+                     juce::Array<class LogicalTrack*>* retired = nullptr);
+    bool reloadSession(class Session* s, class SessionDiffs* diffs);
     void globalReset();
 
     // part of project export
@@ -104,6 +106,10 @@ class TrackManager : public LongWatcher::Listener, public TrackListener
     // the interface for receiving events from the host, and now MidiManager
     void midiEvent(juce::MidiMessage& msg, int deviceId);
 
+    // host events with a position within the block
+    void midiEvent(juce::MidiMessage& msg, int deviceId, int blockOffset);
+    void finishMidiEvent(class MidiEvent* e);
+
     void doAction(class UIAction* a);
     void doActionWithResult(class UIAction* a, ActionResult& result);
     bool doQuery(class Query* q);
@@ -128,7 +134,7 @@ class TrackManager : public LongWatcher::Listener, public TrackListener
     // Outbound Events
     //
 
-    void midiSend(juce::MidiMessage& msg, int deviceId);
+    void midiSend(juce::MidiMessage& msg, int deviceId, int offset = 0);
     int getMidiOutputDeviceId(const char* name);
 
     // used by TrackScheduler to schedule a follower event in a core track
@@ -164,8 +170,13 @@ class TrackManager : public LongWatcher::Listener, public TrackListener
     
     juce::OwnedArray<class LogicalTrack> tracks;
 
-    void configureTracks(class Session* session);
+    // holding area for configureTracks, kept so the storage is reused
+    juce::Array<class LogicalTrack*> oldTracks;
+
+    void configureTracks(class Session* session, juce::Array<class LogicalTrack*>* prepared,
+                         juce::Array<class LogicalTrack*>* retired);
     void configureMobiusTracks();
+    bool isSameTracks(class Session* s);
     
     void sendActions(UIAction* actions, ActionResult& result);
     class UIAction* replicateAction(class UIAction* src);
@@ -11,6 +11,8 @@
 
 // for MobiusContainer
 #include "../MobiusInterface.h"
+#include "../MobiusKernel.h"
+#include "../sync/SyncMaster.h"
 
 #include "MslTrack.h"
 #include "LogicalTrack.h"
@@ -240,16 +242,14 @@ bool TrackMslHandler::mslWait(LogicalTrack* ltrack, MslWait* wait, MslContextErr
             }
                 break;
                 
-            case MslWaitBeat: {
-                // todo: Schedule an EventWait marked pending in our TrackEventList
-                // then have TrackAdvancer look for it
-                // for repeats, give it a countdown
-            }
-                break;
-                
-            case MslWaitBar: {
-                // todo: Schedule an EventWait marked pending in our TrackEventList
-                // then have TrackAdvancer look for it
+            case MslWaitBeat:
+            case MslWaitBar:
+            case MslWaitMsec:
+            case MslWaitSecond:
+            case MslWaitBlock: {
+                // these aren't locations in the track, TimeSlicer
+                // ends them where they fall in the block
+                success = kernel->getSyncMaster()->scheduleWait(ltrack, wait);
             }
                 break;
 
@@ -263,30 +263,6 @@ bool TrackMslHandler::mslWait(LogicalTrack* ltrack, MslWait* wait, MslContextErr
             }
                 break;
                 
-            case MslWaitMsec: {
-                int frames = getMsecFrames(track, wait->amount);
-                if (wait->repeats > 0) frames *= wait->repeats;
-                int frame = track->getFrame() + frames;
-                success = track->scheduleWaitFrame(wait, frame);
-            }
-                break;
-                
-            case MslWaitSecond: {
-                int frames = getSecondFrames(track, wait->amount);
-                if (wait->repeats > 0) frames *= wait->repeats;
-                int frame = track->getFrame() + frames;
-                success = track->scheduleWaitFrame(wait, frame);
-            }
-                break;
-                
-            case MslWaitBlock: {
-                // this we don't need to ask the track to schedule, just put
-                // it on our event list and handle it
-                LogicalTrack* lt = manager->getLogicalTrack(wait->track);
-                success = lt->scheduleWait(wait);
-            }
-                break;
-    
             case MslWaitLast: {
                 // this is track engine specific
                 success = track->scheduleWaitEvent(wait);
@@ -312,44 +288,6 @@ bool TrackMslHandler::mslWait(LogicalTrack* ltrack, MslWait* wait, MslContextErr
     return success;
 }
 
-/**
- * Return the number of frames represented by a millisecond.
- * Adjusted for the current playback rate.  
- * For accurate waits, you have to ensure that the rate can't
- * change while we're waiting.
- *
- * new: Revisit this I hate having to rely on rate adjusted track
- * advance for absolute time waits.  Instead, the event could be pending
- * with a countdown frame counter that decrements on each block at the
- * normal sampleRate and is independent of the track advance.
- */
-int TrackMslHandler::getMsecFrames(MslTrack* track, int msecs)
-{
-    // old code uses the MSEC_TO_FRAMES macro which was defined
-    // as this buried in MobiusConfig.h
-    // #define MSEC_TO_FRAMES(msec) (int)(CD_SAMPLE_RATE * ((float)msec / 1000.0f))
-    // that obviously doesn't work with variable sample rates so need to weed
-    // out all uses of that old macro
-	// should we ceil() here?
-    int msecFrames = (int)((float)(manager->getContainer()->getSampleRate()) * ((float)msecs / 1000.0f));
-
-    // adjust by playback rate
-	//float rate = track->getEffectiveSpeed();
-	float rate = track->getRate();
-    int frames = (int)((float)msecFrames * rate);
-    
-    return frames;
-}
-
-int TrackMslHandler::getSecondFrames(MslTrack* track, int seconds)
-{
-    int secFrames = manager->getContainer()->getSampleRate();
-    secFrames *= seconds;
-	float rate = track->getRate();
-    int frames = (int)((float)secFrames * rate);
-    return frames;
-}
-
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
@@ -30,7 +30,4 @@ class TrackMslHandler
     class TrackManager* manager = nullptr;
     TrackMslVariableHandler variables;
 
-    int getMsecFrames(class MslTrack* track, int msecs);
-    int getSecondFrames(class MslTrack* track, int seconds);
-
 };    
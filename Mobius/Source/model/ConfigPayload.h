@@ -6,8 +6,9 @@
  * and needs to be integrated.  If the object pointer is null the Kernel must keep
  * the existing version of that object.  One of these will be sent whenever any of them change.
  *
- * Ownership of the objects is expected to be taken and the ConfigPayload wrapper
- * object discarded.
+ * Ownership of the objects stays with KernelPublisher in the shell, the kernel
+ * adopts them at the start of a block and the ones they replace are deleted
+ * once the kernel has moved past them.  See KernelPublisher.
  */
 
 #pragma once
@@ -23,12 +24,31 @@ class ConfigPayload
     // when true, this means that in addition to load (reloading) the
     // session it should do a full unconditional GlobalReset
     bool globalReset = false;
+
+    // set by MobiusShell when the session has the same tracks as the
+    // last one it sent, the parameters that changed in each track
+    class SessionDiffs* diffs = nullptr;
+
+    // tracks built by MobiusShell for the ones this session adds
+    // so the kernel doesn't have to, any it doesn't use come back
+    juce::Array<class LogicalTrack*> tracks;
+
+    // room reserved by MobiusShell for the tracks this session removes,
+    // the kernel puts them here so they are deleted in the shell
+    juce::Array<class LogicalTrack*> retired;
+    
+    // runtime objects the shell builds from ScriptConfig and SampleConfig
+    // and the MIDI bindings for plugins, these used to have their
+    // own KernelMessages
+    class SampleManager* samples = nullptr;
+    class Scriptarian* scripts = nullptr;
+    class Binderator* binderator = nullptr;
     
     // this may be where FunctionProperties need to live too
 
-    // todo: now that we have this, it could also be the mechanism for passing
-    // down ScriptConfig and SampleConfigs rather than having
-    // specific methods for those in MobiusInterface
-    // also Binderator
+    // set by KernelPublisher, the publication number and the
+    // chain of payloads waiting for the kernel
+    int epoch = 0;
+    ConfigPayload* next = nullptr;
 
 };
@@ -80,6 +80,14 @@ const char* ParameterProperties::getEnumLabel(int enumOrdinal)
     return label;
 }
 
+int ParameterProperties::getEnumId(int enumOrdinal)
+{
+    int id = 0;
+    if (enumOrdinal >= 0 && enumOrdinal < valueIds.size())
+      id = valueIds[enumOrdinal];
+    return id;
+}
+
 /****************************************************************************/
 /****************************************************************************/
 /****************************************************************************/
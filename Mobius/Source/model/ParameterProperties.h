@@ -74,6 +74,12 @@ class ParameterProperties
      */
     juce::StringArray valueLabels;
 
+    /**
+     * For TypeEnum, ids of the values in the MSL interned string table
+     * so scripts can be given enum names without copying them.
+     */
+    juce::Array<int> valueIds;
+
     /**
      * For TypeInt, the lowest allowed value.
      */
@@ -233,6 +239,12 @@ class ParameterProperties
      */
     const char* getEnumLabel(int ordinal);
 
+    /**
+     * For type=enum, the interned string id of the symbolic value,
+     * zero if it was not interned.
+     */
+    int getEnumId(int ordinal);
+
     // For similar utilities on Structures, see ParameterHelper
     // Maybe put the Enum utils in there too
     
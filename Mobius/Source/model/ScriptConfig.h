@@ -76,6 +76,9 @@ class ScriptRef {
 
     // errors encountered during compilation
     juce::OwnedArray<MslError> errors;
+
+    // milliseconds spent reading and parsing the file
+    double parseTime = 0.0;
     
   private:
 
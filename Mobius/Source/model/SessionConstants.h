@@ -23,6 +23,8 @@ static const char* SessionTransportManualStart = "transportManualStart";
 static const char* SessionTransportMinTempo = "transportMinTempo";
 static const char* SessionTransportMaxTempo = "transportMaxTempo";
 static const char* SessionTransportMetronome = "transportMetronome";
+// generate MIDI clocks from the audio stream rather than the clock thread
+static const char* SessionTransportSampleClocks = "transportSampleClocks";
 
 static const char* SessionHostBeatsPerBar = "hostBeatsPerBar";
 static const char* SessionHostBarsPerLoop = "hostBarsPerLoop";
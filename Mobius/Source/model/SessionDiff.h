@@ -3,6 +3,9 @@
  * by the engine when an edited session is received to seletively
  * reset parameters that had been modified dynamically outside the
  * session editor.
+ *
+ * MobiusShell builds these and sends them down with the Session
+ * so TrackManager can refresh only the tracks that changed.
  */
 
 #pragma once
@@ -23,6 +26,17 @@ class SessionDiffs
   public:
 
     juce::Array<SessionDiff> diffs;
+
+    bool hasTrack(int number) {
+        bool found = false;
+        for (auto& diff : diffs) {
+            if (diff.track == number) {
+                found = true;
+                break;
+            }
+        }
+        return found;
+    }
 };
 
     
@@ -208,6 +208,7 @@ SymbolDefinition SymbolDefinitions[] = {
     {SessionTransportMinTempo, ParamTransportMinTempo},
     {SessionTransportMaxTempo, ParamTransportMaxTempo},
     {SessionTransportMetronome, ParamTransportMetronome},
+    {SessionTransportSampleClocks, ParamTransportSampleClocks},
     {SessionHostBeatsPerBar, ParamHostBeatsPerBar},
     {SessionHostBarsPerLoop, ParamHostBarsPerLoop},
     {SessionHostOverride, ParamHostOverride},
@@ -133,6 +133,7 @@ typedef enum {
     ParamTransportMinTempo,
     ParamTransportMaxTempo,
     ParamTransportMetronome,
+    ParamTransportSampleClocks,
     ParamHostBeatsPerBar,
     ParamHostBarsPerLoop,
     ParamHostOverride,
@@ -1,6 +1,6 @@
 /**
  * An object representing the state of Kernel components at a moment in time.
- * One of these will be maintained by Supervisor and passed down to the Kernel periodically.
+ * Three of these are maintained by SystemStateBuffer which the Kernel fills periodically.
  * Each component may then contribute it's state.  The state refresh is handled during
  * block processing in the audio thread, and then passed back to the UI where it
  * can drive the refresh of the UI.
@@ -8,8 +8,8 @@
  * You might think of it like a very large Query result, where there is a single query
  * to refresh state rather than hundreds of individual Query's to access each piece.
  *
- * The state object is allocated by the UI/Shell and must be fleshed out with enough variable
- * length containers to hold what the kernel wants to return.
+ * The state objects are allocated by SystemStateBuffer with enough fixed capacity
+ * to hold what the kernel wants to return, and published to the UI through it.
  *
  * TrackState contains that is needed for all tracks.
  * FocusedTrackState contains additional details that are only gathered for one track.
@@ -34,7 +34,11 @@ class SystemState
     // the old version
     int sessionVersion = 0;
 
-    // full state for each track
+    // incremented by SystemStateBuffer each time a state is published
+    // TrackState::changeSequence is compared against this
+    int sequence = 0;
+
+    // full state for each track, pre-allocated and never resized
     juce::OwnedArray<TrackState> tracks;
 
     // number of tracks used, this may be smaller than the array size
@@ -0,0 +1,152 @@
+/**
+ * Triple buffered SystemState publication.
+ *
+ * The slot exchange follows the usual triple buffer protocol.  The
+ * waiting index carries FreshBit when the kernel has put something there
+ * the UI hasn't seen.  The kernel swaps its filled state into the waiting
+ * slot and takes back whatever was there, the UI swaps its old state into
+ * the waiting slot when it sees FreshBit.  Neither side ever touches a
+ * state the other one owns.
+ *
+ * The one exception is change detection.  The kernel compares the
+ * state it just filled with the last one it published, which may now be
+ * owned by the UI.  Both sides only read the compared fields, the UI only
+ * writes the latching flags which are not compared.
+ */
+
+#include <JuceHeader.h>
+
+#include "SystemState.h"
+#include "SystemStateBuffer.h"
+
+SystemStateBuffer::SystemStateBuffer()
+{
+    for (int i = 0 ; i < 3 ; i++)
+      allocate(&(states[i]));
+}
+
+SystemStateBuffer::~SystemStateBuffer()
+{
+}
+
+/**
+ * Flesh out one state with everything the kernel might want to deposit.
+ * This used to be done by Supervisor every time the session changed.
+ */
+void SystemStateBuffer::allocate(SystemState* state)
+{
+    for (int i = 0 ; i < MaxTracks ; i++) {
+        TrackState* ts = new TrackState();
+        // in theory should whip through the config model and calculate
+        // the maximum
+        for (int l = 0 ; l < TrackState::MaxLoops ; l++) {
+            TrackState::Loop loop;
+            ts->loops.add(loop);
+        }
+        ts->loopCount = 0;
+        ts->peaks.insertMultiple(0, nullptr, TrackState::MaxPeakBlocks);
+        state->tracks.add(ts);
+    }
+
+    FocusedTrackState* focused = &(state->focusedState);
+
+    // not crucial, the number of events is typically less than 4 but with
+    // stacking can be higher, it's okay to miss a few since if there are that many
+    // it's hard to read anyway
+    focused->events.resize(FocusedTrackState::MaxEvents);
+    focused->regions.resize(FocusedTrackState::MaxRegions);
+    focused->layers.resize(FocusedTrackState::MaxLayers);
+
+    focused->eventCount = 0;
+    focused->regionCount = 0;
+    focused->layerCount = 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// UI Side
+//
+//////////////////////////////////////////////////////////////////////
+
+SystemState* SystemStateBuffer::acquire()
+{
+    SystemState* result = nullptr;
+    if (waiting.load(std::memory_order_relaxed) & FreshBit) {
+        front = waiting.exchange(front, std::memory_order_acq_rel) & IndexMask;
+        result = &(states[front]);
+    }
+    return result;
+}
+
+void SystemStateBuffer::setFocusedTrack(int number)
+{
+    focusedTrack = number;
+}
+
+void SystemStateBuffer::setInterval(int msec)
+{
+    interval = msec;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Kernel Side
+//
+//////////////////////////////////////////////////////////////////////
+
+bool SystemStateBuffer::isConsumed()
+{
+    return ((waiting.load(std::memory_order_acquire) & FreshBit) == 0);
+}
+
+SystemState* SystemStateBuffer::getWriteState()
+{
+    return &(states[back]);
+}
+
+int SystemStateBuffer::getFocusedTrack()
+{
+    return focusedTrack;
+}
+
+int SystemStateBuffer::getInterval()
+{
+    return interval;
+}
+
+/**
+ * Stamp the write state and hand it over.
+ *
+ * A track is changed if it differs from the last publication, or if it
+ * is latching a flag the UI must see.  The change sequence is remembered
+ * per track so the UI will still notice if it somehow missed a publication.
+ */
+void SystemStateBuffer::publish()
+{
+    SystemState* neu = &(states[back]);
+    SystemState* last = (lastPublished >= 0) ? &(states[lastPublished]) : nullptr;
+
+    sequence++;
+    neu->sequence = sequence;
+
+    int changed = 0;
+    for (int i = 0 ; i < neu->totalTracks && i < MaxTracks ; i++) {
+        TrackState* tstate = neu->tracks[i];
+        if (last == nullptr || i >= last->totalTracks ||
+            tstate->refreshLoopContent ||
+            !tstate->isSame(last->tracks[i])) {
+            trackChanges[i] = sequence;
+            changed++;
+        }
+        tstate->changeSequence = trackChanges[i];
+    }
+    tracksChanged += changed;
+    publications++;
+
+    lastPublished = back;
+    back = waiting.exchange(back | FreshBit, std::memory_order_acq_rel) & IndexMask;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,133 @@
+/**
+ * A triple buffer of SystemState objects used to publish engine state
+ * to the UI without locks and without a request/response exchange.
+ *
+ * The kernel owns one state it fills during a block, the UI owns one state
+ * it is currently viewing, and the third is the most recently published
+ * state waiting to be picked up.  Publishing and acquiring each swap a state
+ * with the waiting slot using a single atomic exchange.
+ *
+ * All three states are allocated for MaxTracks when the buffer is constructed
+ * and never grow, so the kernel never sees a state being resized under it.
+ *
+ * Each publication is stamped with a sequence number and each TrackState
+ * carries the sequence number of the publication where it last changed.
+ * The UI remembers the last sequence it consumed and only needs to
+ * re-derive the tracks that changed since then.
+ *
+ * The kernel does not publish again until the UI has picked up the last
+ * state.  Nobody would see the intermediate states, skipping them keeps the
+ * audio thread cost at one refresh per UI refresh no matter how many tracks
+ * there are, and latching flags in the TrackState are never lost.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "SystemState.h"
+
+class SystemStateBuffer
+{
+  public:
+
+    /**
+     * The number of TrackStates pre-allocated in each SystemState.
+     */
+    static const int MaxTracks = 64;
+
+    /**
+     * The default minimum time between publications.
+     */
+    static const int DefaultInterval = 100;
+
+    SystemStateBuffer();
+    ~SystemStateBuffer();
+
+    //
+    // UI side
+    //
+
+    /**
+     * Return the most recently published state if there is one we haven't
+     * seen yet, otherwise nullptr.  The returned state is owned by the UI
+     * until the next call to acquire.
+     */
+    SystemState* acquire();
+
+    /**
+     * The track the UI would like details for in FocusedTrackState.
+     */
+    void setFocusedTrack(int number);
+
+    /**
+     * The minimum time in milliseconds between publications.
+     */
+    void setInterval(int msec);
+
+    //
+    // Kernel side
+    //
+
+    /**
+     * True if the UI has picked up the last state and the
+     * kernel may publish another.
+     */
+    bool isConsumed();
+
+    /**
+     * The state the kernel may fill.
+     */
+    SystemState* getWriteState();
+
+    int getFocusedTrack();
+    int getInterval();
+
+    /**
+     * Mark tracks that changed since the last publication and
+     * make the write state available to the UI.
+     */
+    void publish();
+
+    /**
+     * Publication statistics traced at shutdown.
+     */
+    int getPublications() {
+        return publications.load();
+    }
+    int getTracksChanged() {
+        return tracksChanged.load();
+    }
+
+  private:
+
+    // flag or'd into the index when the waiting state is fresh
+    static const int FreshBit = 4;
+    static const int IndexMask = 3;
+
+    SystemState states[3];
+
+    // index of the waiting state, with FreshBit if not yet acquired
+    std::atomic<int> waiting {1};
+
+    // owned by the UI
+    int front = 0;
+
+    // owned by the kernel
+    int back = 2;
+    int lastPublished = -1;
+    int sequence = 0;
+    int trackChanges[MaxTracks] = {};
+    std::atomic<int> publications {0};
+    std::atomic<int> tracksChanged {0};
+
+    std::atomic<int> focusedTrack {0};
+    std::atomic<int> interval {DefaultInterval};
+
+    void allocate(SystemState* state);
+
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -34,3 +34,85 @@ const char* TrackState::getModeName(TrackState::Mode amode)
     }
     return name;
 }
+
+bool TrackState::isSame(TrackState* other)
+{
+    if (number != other->number ||
+        type != other->type ||
+        active != other->active ||
+        preset != other->preset ||
+        inputMonitorLevel != other->inputMonitorLevel ||
+        outputMonitorLevel != other->outputMonitorLevel ||
+        syncSource != other->syncSource ||
+        syncUnit != other->syncUnit ||
+        trackSyncUnit != other->trackSyncUnit ||
+        syncBeat != other->syncBeat ||
+        syncBar != other->syncBar ||
+        focus != other->focus ||
+        group != other->group)
+      return false;
+
+    if (loopCount != other->loopCount ||
+        activeLoop != other->activeLoop ||
+        layerCount != other->layerCount ||
+        activeLayer != other->activeLayer ||
+        nextLoop != other->nextLoop ||
+        returnLoop != other->returnLoop ||
+        switchConfirm != other->switchConfirm ||
+        switchWait != other->switchWait ||
+        windowOffset != other->windowOffset ||
+        historyFrames != other->historyFrames)
+      return false;
+
+    if (frames != other->frames ||
+        frame != other->frame ||
+        subcycles != other->subcycles ||
+        subcycle != other->subcycle ||
+        cycles != other->cycles ||
+        cycle != other->cycle)
+      return false;
+
+    if (input != other->input ||
+        output != other->output ||
+        feedback != other->feedback ||
+        altFeedback != other->altFeedback ||
+        pan != other->pan ||
+        solo != other->solo ||
+        globalMute != other->globalMute ||
+        globalPause != other->globalPause)
+      return false;
+
+    if (mode != other->mode ||
+        overdub != other->overdub ||
+        reverse != other->reverse ||
+        mute != other->mute ||
+        pause != other->pause ||
+        recording != other->recording ||
+        modified != other->modified ||
+        rate != other->rate ||
+        speed != other->speed ||
+        pitch != other->pitch ||
+        speedToggle != other->speedToggle ||
+        speedOctave != other->speedOctave ||
+        speedStep != other->speedStep ||
+        speedBend != other->speedBend ||
+        pitchOctave != other->pitchOctave ||
+        pitchStep != other->pitchStep ||
+        pitchBend != other->pitchBend ||
+        timeStretch != other->timeStretch ||
+        pending != other->pending)
+      return false;
+
+    if (peakCount != other->peakCount ||
+        peakOffset != other->peakOffset ||
+        peakLayer != other->peakLayer ||
+        peakChanges != other->peakChanges)
+      return false;
+
+    for (int i = 0 ; i < loopCount && i < loops.size() && i < other->loops.size() ; i++) {
+        if (loops.getReference(i).frames != other->loops.getReference(i).frames)
+          return false;
+    }
+
+    return true;
+}
@@ -61,6 +61,14 @@ class TrackState
     } Mode;
 
     static const char* getModeName(Mode amode);
+
+    /**
+     * True if this state would display the same as another.
+     * Used by SystemStateBuffer to decide which tracks changed.
+     * Latching flags are not compared since the UI clears them.
+     * New fields must be added here or the UI won't see them change.
+     */
+    bool isSame(TrackState* other);
     
     /**
      * The types of event that can be scheduled within a track.
@@ -307,6 +315,23 @@ class TrackState
     // latching flag indiciating that loops were loaded from files
     // or otherwise had their size adjusted when not active
     bool refreshLoopContent = false;
+
+    // sequence number of the SystemState publication where
+    // this track last changed
+    int changeSequence = 0;
+
+    // waveform peaks for the active loop, one for each block of
+    // WavePeaks::BlockFrames, peakOffset is the frame within the first
+    // block where the loop starts
+    // these point into kernel memory that lives as long as the engine
+    // and are only valid until the next state is acquired
+    static const int MaxPeakBlocks = 256;
+    juce::Array<class WavePeaks*> peaks;
+    int peakCount = 0;
+    int peakOffset = 0;
+    // changes when the peaks need to be redrawn
+    int peakLayer = 0;
+    int peakChanges = 0;
 };
 
 ///////////////////////////////////////////////////////////////////////
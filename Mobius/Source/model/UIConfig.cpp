@@ -878,6 +878,7 @@ void UIConfig::hackDefinitions()
     definitions.add(new UIElementDefinition("MinorModesElement"));
     definitions.add(new UIElementDefinition("TempoElement"));
     definitions.add(new UIElementDefinition("LoopWindowElement"));
+    definitions.add(new UIElementDefinition("WaveformElement"));
     definitions.add(new UIElementDefinition("Transport"));
     definitions.add(new UIElementDefinition("MidiSync"));
     definitions.add(new UIElementDefinition("HostSync"));
@@ -0,0 +1,222 @@
+/**
+ * Implementation of the waveform peak pyramid.
+ */
+
+#include <JuceHeader.h>
+
+#include "WavePeaks.h"
+
+void WavePeaks::reset()
+{
+    memset(lows, 0, sizeof(lows));
+    memset(highs, 0, sizeof(highs));
+}
+
+/**
+ * Index of the first bucket of a level.
+ */
+int WavePeaks::getOffset(int level)
+{
+    int offset = 0;
+    int buckets = BlockFrames / BaseFrames;
+    for (int i = 0 ; i < level ; i++) {
+        offset += buckets;
+        buckets /= Factor;
+    }
+    return offset;
+}
+
+/**
+ * Widen the bucket containing a frame and all the buckets above it.
+ * The caller accumulates the range of a run of frames within one
+ * level zero bucket so this happens once per bucket, not once per frame.
+ * If the level zero bucket didn't change, the ones above it can't either.
+ * Returns true if anything changed.
+ */
+bool WavePeaks::widen(int frame, float low, float high)
+{
+    bool widened = false;
+    int lo = (int)std::floor(juce::jlimit(-1.0f, 1.0f, low) * 127.0f);
+    int hi = (int)std::ceil(juce::jlimit(-1.0f, 1.0f, high) * 127.0f);
+    
+    int bucket = frame / BaseFrames;
+    int offset = 0;
+    int buckets = BlockFrames / BaseFrames;
+    for (int level = 0 ; level < Levels && bucket < buckets ; level++) {
+        int index = offset + bucket;
+        bool changed = false;
+        if (lo < lows[index]) {
+            lows[index] = (juce::int8)lo;
+            changed = true;
+        }
+        if (hi > highs[index]) {
+            highs[index] = (juce::int8)hi;
+            changed = true;
+        }
+        if (!changed)
+          break;
+        
+        widened = true;
+        offset += buckets;
+        buckets /= Factor;
+        bucket /= Factor;
+    }
+    return widened;
+}
+
+/**
+ * Recalculate everything from the samples.
+ * This scans the entire block so it is not for the audio thread.
+ */
+void WavePeaks::rebuild(const float* samples, int channels)
+{
+    rebuild(samples, channels, 0, BlockFrames);
+}
+
+/**
+ * Recalculate the level zero buckets touching the range and
+ * the buckets above them.  This and clear are the only ways
+ * the peaks can shrink.
+ */
+void WavePeaks::rebuild(const float* samples, int channels, int startFrame, int endFrame)
+{
+    if (startFrame < 0) startFrame = 0;
+    if (endFrame > BlockFrames) endFrame = BlockFrames;
+    if (startFrame < endFrame) {
+        int first = startFrame / BaseFrames;
+        int last = (endFrame - 1) / BaseFrames;
+        for (int bucket = first ; bucket <= last ; bucket++)
+          scanBucket(bucket, samples, channels);
+        propagate(first, last);
+    }
+}
+
+void WavePeaks::clear(const float* samples, int channels, int startFrame, int endFrame)
+{
+    if (startFrame < 0) startFrame = 0;
+    if (endFrame > BlockFrames) endFrame = BlockFrames;
+    if (startFrame < endFrame) {
+        int first = startFrame / BaseFrames;
+        int last = (endFrame - 1) / BaseFrames;
+        for (int bucket = first ; bucket <= last ; bucket++) {
+            int bucketStart = bucket * BaseFrames;
+            if (bucketStart >= startFrame && bucketStart + BaseFrames <= endFrame) {
+                lows[bucket] = 0;
+                highs[bucket] = 0;
+            }
+            else {
+                scanBucket(bucket, samples, channels);
+            }
+        }
+        propagate(first, last);
+    }
+}
+
+/**
+ * Set one level zero bucket from the samples it covers.
+ */
+void WavePeaks::scanBucket(int bucket, const float* samples, int channels)
+{
+    int samplesPerBucket = BaseFrames * channels;
+    const float* start = samples + (bucket * samplesPerBucket);
+    float low = 0.0f;
+    float high = 0.0f;
+    for (int i = 0 ; i < samplesPerBucket ; i++) {
+        float sample = start[i];
+        if (sample < low) low = sample;
+        if (sample > high) high = sample;
+    }
+    lows[bucket] = (juce::int8)std::floor(juce::jlimit(-1.0f, 1.0f, low) * 127.0f);
+    highs[bucket] = (juce::int8)std::ceil(juce::jlimit(-1.0f, 1.0f, high) * 127.0f);
+}
+
+/**
+ * Recalculate the buckets above a range of level zero buckets
+ * from the ones below them.
+ */
+void WavePeaks::propagate(int firstBucket, int lastBucket)
+{
+    int childOffset = 0;
+    int buckets = BlockFrames / BaseFrames;
+    for (int level = 1 ; level < Levels ; level++) {
+        int offset = childOffset + buckets;
+        buckets /= Factor;
+        firstBucket /= Factor;
+        lastBucket /= Factor;
+        for (int bucket = firstBucket ; bucket <= lastBucket ; bucket++) {
+            int child = childOffset + (bucket * Factor);
+            juce::int8 low = lows[child];
+            juce::int8 high = highs[child];
+            for (int i = 1 ; i < Factor ; i++) {
+                if (lows[child + i] < low) low = lows[child + i];
+                if (highs[child + i] > high) high = highs[child + i];
+            }
+            lows[offset + bucket] = low;
+            highs[offset + bucket] = high;
+        }
+        childOffset = offset;
+    }
+}
+
+/**
+ * Copy the peaks of another block that was copied with a level adjustment.
+ */
+void WavePeaks::copy(WavePeaks* src, float scale)
+{
+    for (int i = 0 ; i < TotalBuckets ; i++) {
+        lows[i] = (juce::int8)std::floor((float)(src->lows[i]) * scale);
+        highs[i] = (juce::int8)std::ceil((float)(src->highs[i]) * scale);
+    }
+}
+
+void WavePeaks::get(int level, int bucket, float& low, float& high)
+{
+    int index = getOffset(level) + bucket;
+    low = (float)lows[index] / 127.0f;
+    high = (float)highs[index] / 127.0f;
+}
+
+/**
+ * Walk the region using the largest bucket that starts at the current
+ * position and does not extend beyond the end.  Drawing a pixel that
+ * covers thousands of frames touches only a handful of buckets.
+ * The region is expanded to level zero bucket boundaries.
+ */
+void WavePeaks::scan(WavePeaks* const* blocks, int count,
+                     int startFrame, int endFrame, float& low, float& high)
+{
+    low = 0.0f;
+    high = 0.0f;
+    
+    int frame = (startFrame / BaseFrames) * BaseFrames;
+    if (frame < 0) frame = 0;
+    int limit = count * BlockFrames;
+    if (endFrame > limit) endFrame = limit;
+
+    while (frame < endFrame) {
+        int blockIndex = frame / BlockFrames;
+        int blockFrame = frame % BlockFrames;
+
+        int level = 0;
+        while (level < Levels - 1) {
+            int next = getBucketFrames(level + 1);
+            if ((blockFrame % next) != 0 || (frame + next) > endFrame)
+              break;
+            level++;
+        }
+        int bucketFrames = getBucketFrames(level);
+        
+        WavePeaks* peaks = blocks[blockIndex];
+        if (peaks != nullptr) {
+            float lo, hi;
+            peaks->get(level, blockFrame / bucketFrames, lo, hi);
+            if (lo < low) low = lo;
+            if (hi > high) high = hi;
+        }
+        frame += bucketFrames;
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,100 @@
+/**
+ * A compact min/max summary of one block of audio at several resolutions,
+ * used to draw waveforms without touching the audio itself.
+ *
+ * One of these lives in the header of every pooled Audio buffer, so they
+ * are allocated, reused, and shared along with the audio.  Anything that
+ * references a buffer can reference its peaks.
+ *
+ * Level zero has one bucket for every BaseFrames frames.  Each level above
+ * it covers Factor buckets from the level below, up to a single bucket
+ * for the entire block.  Values are quantized to 8 bits which is more
+ * than enough for display.
+ *
+ * Peaks are maintained incrementally as frames are recorded and only ever
+ * widen.  Operations that reduce the content, like fades or subtraction,
+ * leave the peaks conservatively large until the block is rebuilt.
+ *
+ * The kernel writes these and the UI reads them without synchronization.
+ * A reader may see a partially updated bucket which is harmless for drawing.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class WavePeaks
+{
+  public:
+
+    /**
+     * Frames in one block, this must match FRAMES_PER_BUFFER in Audio.
+     */
+    static const int BlockFrames = 65536;
+
+    /**
+     * Frames summarized by one level zero bucket.
+     */
+    static const int BaseFrames = 256;
+
+    /**
+     * Buckets in each level that are combined in the level above.
+     */
+    static const int Factor = 4;
+
+    static const int Levels = 5;
+
+    /**
+     * Level zero has 256 buckets, then 64, 16, 4, and 1.
+     */
+    static const int TotalBuckets = 341;
+
+    void reset();
+    bool widen(int frame, float low, float high);
+    void rebuild(const float* samples, int channels);
+    void copy(WavePeaks* src, float scale);
+
+    /**
+     * Recalculate only the buckets covering a range of frames.
+     * The cost is proportional to the range, not the block.
+     */
+    void rebuild(const float* samples, int channels, int startFrame, int endFrame);
+
+    /**
+     * A range of frames was zeroed.  Buckets entirely within it are
+     * cleared without looking at the samples, at most two buckets on
+     * the edges are scanned.
+     */
+    void clear(const float* samples, int channels, int startFrame, int endFrame);
+
+    /**
+     * The number of frames covered by one bucket at a level.
+     */
+    static int getBucketFrames(int level) {
+        return BaseFrames << (level * 2);
+    }
+
+    void get(int level, int bucket, float& low, float& high);
+
+    /**
+     * Find the range of a region spanning a list of blocks, using the
+     * coarsest buckets that fit.  Frames are relative to the start
+     * of the first block, missing blocks are silent.
+     */
+    static void scan(WavePeaks* const* blocks, int count,
+                     int startFrame, int endFrame, float& low, float& high);
+
+  private:
+
+    juce::int8 lows[TotalBuckets];
+    juce::int8 highs[TotalBuckets];
+
+    static int getOffset(int level);
+    void scanBucket(int bucket, const float* samples, int channels);
+    void propagate(int firstBucket, int lastBucket);
+
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
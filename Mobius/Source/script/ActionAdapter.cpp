@@ -90,11 +90,12 @@ void ActionAdapter::doAction(MslEnvironment* env, MslContext* c, UIAction* actio
         if (action->sustain || action->sustainEnd) {
             req.triggerId = action->sustainId;
 
-            if (req.linkage->unit == nullptr) {
+            MslCompilation* unit = env->getUnit(c, req.linkage);
+            if (unit == nullptr) {
                 Trace(1, "ActionAdapter: Calling MSL with a linkage without a unit");
                 allowIt = false;
             }
-            else if (req.linkage->unit->sustain) {
+            else if (unit->sustain) {
                 // this will recognize release
                 req.release = action->sustainEnd;
             }
@@ -34,6 +34,7 @@ void MslBinding::init()
     value = nullptr;
     position = 0;
     symbolId = 0;
+    nameId = 0;
     transient = false;
 }
 
@@ -57,6 +58,27 @@ MslBinding* MslBinding::find(const char* argName)
     return found;
 }
 
+/**
+ * Find a binding for a linked reference.  If both sides have an id
+ * they are compared, otherwise it falls back to the name.
+ */
+MslBinding* MslBinding::find(int refId, const char* refName)
+{
+    MslBinding* found = nullptr;
+    MslBinding* ptr = this;
+    while (found == nullptr && ptr != nullptr) {
+        if (refId > 0 && ptr->nameId > 0) {
+            if (refId == ptr->nameId)
+              found = ptr;
+        }
+        else if (StringEqual(refName, ptr->name)) {
+            found = ptr;
+        }
+        ptr = ptr->next;
+    }
+    return found;
+}
+
 MslBinding* MslBinding::find(int argPosition)
 {
     MslBinding* found = nullptr;
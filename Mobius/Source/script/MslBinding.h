@@ -33,6 +33,10 @@ class MslBinding
     // when the binding is used by Valuator, this is the associated Symbol id that
     // can be as an alternative to name comparisions
     int symbolId = 0;
+
+    // the MslEnvironment id of the name when the binding came from a
+    // linked variable or argument, zero if it can only be found by name
+    int nameId = 0;
     
     // bindings usually have a value, though it is not set until an assignment
     // node is reached during evaluation
@@ -53,6 +57,7 @@ class MslBinding
     void setName(const char* s);
     MslBinding* copy(MslBinding* src);
     MslBinding* find(const char* s);
+    MslBinding* find(int nameId, const char* s);
     MslBinding* find(int position);
     
 };
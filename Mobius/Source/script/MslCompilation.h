@@ -16,6 +16,7 @@
 #include "MslVariable.h"
 #include "MslCollision.h"
 #include "MslError.h"
+#include "MslProgram.h"
 
 class MslCompilation
 {
@@ -27,6 +28,14 @@ class MslCompilation
     // unique id for this unit once it has been installed
     juce::String id;
 
+    // the text this was parsed from, kept so the unit can be
+    // rebuilt when something it references changes
+    juce::String source;
+
+    // the publication of the linkage table that first included this unit,
+    // zero until the kernel can see it
+    int epoch = 0;
+
     //
     // Interesting information about the compilation
     // accessible to the application (ScriptClerk, ScriptEditor)
@@ -84,6 +93,35 @@ class MslCompilation
      */
     juce::OwnedArray<class MslCollision> collisions;
 
+    /**
+     * Exported variables in other units referenced by this one, by the
+     * name used in the script.  Rebuilt every time the unit is linked so
+     * MslSession::getVariable can find them without going through the
+     * environment's name table.
+     */
+    class LinkedReference
+    {
+      public:
+        juce::String name;
+        class MslLinkage* linkage = nullptr;
+    };
+    juce::Array<LinkedReference> linkedReferences;
+
+    /**
+     * Names this unit looked for in the environment when it was linked,
+     * whether or not they were found.  This is the unit's side of the
+     * dependency graph, when something with one of these names is published
+     * or removed, the unit needs to be linked again.
+     */
+    juce::StringArray references;
+
+    /**
+     * Compiled expressions left on nodes by MslCompiler.  When the unit
+     * is linked again the old ones go to MslGarbage rather than being
+     * deleted since a session in the kernel may be in the middle of one.
+     */
+    juce::OwnedArray<class MslProgram> programs;
+
     bool hasErrors() {
         return (errors.size() > 0);
     }
@@ -0,0 +1,159 @@
+/**
+ * Implementation of the MSL token cache.
+ *
+ * File layout, all integers little endian:
+ *
+ *    magic, version, entry count
+ *    for each entry: hash, token count
+ *      for each token: type byte, line, column, value
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/Trace.h"
+
+#include "MslTokenizer.h"
+#include "MslCompileCache.h"
+
+const int CompileCacheMagic = 0x4d534c43;
+
+MslCompileCache::MslCompileCache()
+{
+}
+
+MslCompileCache::~MslCompileCache()
+{
+}
+
+void MslCompileCache::clear()
+{
+    map.clear();
+    entries.clear();
+}
+
+/**
+ * Loaded once, the first time ScriptClerk installs files.
+ */
+void MslCompileCache::load(juce::File file)
+{
+    if (!loaded) {
+        loaded = true;
+        if (file.existsAsFile()) {
+            juce::FileInputStream in(file);
+            if (in.openedOk()) {
+                int magic = in.readInt();
+                int version = in.readInt();
+                if (magic != CompileCacheMagic || version != Version) {
+                    Trace(2, "MslCompileCache: Ignoring cache with version %d", version);
+                }
+                else {
+                    int count = in.readInt();
+                    for (int i = 0 ; i < count && !in.isExhausted() ; i++) {
+                        Entry* e = new Entry();
+                        e->hash = in.readInt64();
+                        int ntokens = in.readInt();
+                        e->tokens.ensureStorageAllocated(ntokens);
+                        for (int j = 0 ; j < ntokens ; j++) {
+                            MslToken t;
+                            t.type = (MslToken::Type)(in.readByte());
+                            t.line = in.readCompressedInt();
+                            t.column = in.readCompressedInt();
+                            t.value = in.readString();
+                            e->tokens.add(t);
+                        }
+                        entries.add(e);
+                        map.set(e->hash, e);
+                    }
+                    if (in.isExhausted() && entries.size() < count) {
+                        Trace(1, "MslCompileCache: Cache file was truncated");
+                        clear();
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Drop what wasn't used and write the rest if anything changed.
+ */
+void MslCompileCache::save(juce::File file)
+{
+    int index = 0;
+    while (index < entries.size()) {
+        Entry* e = entries[index];
+        if (!e->used) {
+            map.remove(e->hash);
+            entries.remove(index);
+            dirty = true;
+        }
+        else {
+            index++;
+        }
+    }
+
+    if (dirty) {
+        juce::MemoryOutputStream out;
+        out.writeInt(CompileCacheMagic);
+        out.writeInt(Version);
+        out.writeInt(entries.size());
+        for (auto e : entries) {
+            out.writeInt64(e->hash);
+            out.writeInt(e->tokens.size());
+            for (auto& t : e->tokens) {
+                out.writeByte((char)(t.type));
+                out.writeCompressedInt(t.line);
+                out.writeCompressedInt(t.column);
+                out.writeString(t.value);
+            }
+        }
+        if (!file.replaceWithData(out.getData(), out.getDataSize()))
+          Trace(1, "MslCompileCache: Unable to write %s", file.getFullPathName().toUTF8());
+        dirty = false;
+    }
+
+    // start counting again for the next install
+    for (auto e : entries)
+      e->used = false;
+}
+
+bool MslCompileCache::get(juce::int64 hash, juce::Array<MslToken>& tokens)
+{
+    bool found = false;
+    Entry* e = map[hash];
+    if (e != nullptr) {
+        tokens = e->tokens;
+        e->used = true;
+        found = true;
+        hits++;
+    }
+    else {
+        misses++;
+    }
+    return found;
+}
+
+void MslCompileCache::put(juce::int64 hash, juce::Array<MslToken>& tokens)
+{
+    Entry* e = map[hash];
+    if (e == nullptr) {
+        e = new Entry();
+        e->hash = hash;
+        entries.add(e);
+        map.set(hash, e);
+    }
+    e->tokens = tokens;
+    e->used = true;
+    dirty = true;
+}
+
+void MslCompileCache::keep(juce::int64 hash)
+{
+    Entry* e = map[hash];
+    if (e != nullptr)
+      e->used = true;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
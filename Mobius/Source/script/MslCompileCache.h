@@ -0,0 +1,87 @@
+/**
+ * A file of tokenized MSL source kept between runs.
+ *
+ * Most of the time spent parsing a script file is in the Juce C++ tokenizer,
+ * which is far more general than MSL needs.  The token list for a file only
+ * changes when the file does, so ScriptClerk keeps the tokens for every file
+ * it has parsed here, keyed by a hash of the file contents, and the parser
+ * replays them instead of tokenizing again.
+ *
+ * The cache is a binary file in the installation folder with a version
+ * number in the header.  If the version doesn't match, or the file is
+ * damaged, it is ignored and rebuilt.  Entries that were not used since
+ * the cache was loaded are dropped when it is saved, so it only holds
+ * the current versions of the current files.
+ *
+ * This is only used by the shell during installation.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "MslTokenizer.h"
+
+class MslCompileCache
+{
+  public:
+
+    /**
+     * Bump this whenever MslToken or the tokenizer changes in a way
+     * that would make old token lists parse differently.
+     */
+    static const int Version = 1;
+
+    MslCompileCache();
+    ~MslCompileCache();
+
+    void load(juce::File file);
+    void save(juce::File file);
+
+    /**
+     * Copy the tokens for source with this hash into the list.
+     * Returns false if there were none.
+     */
+    bool get(juce::int64 hash, juce::Array<MslToken>& tokens);
+
+    /**
+     * Remember the tokens for source with this hash.
+     */
+    void put(juce::int64 hash, juce::Array<MslToken>& tokens);
+
+    /**
+     * Keep the tokens for a file that didn't need to be parsed again.
+     */
+    void keep(juce::int64 hash);
+
+    int getHits() {
+        return hits;
+    }
+
+    int getMisses() {
+        return misses;
+    }
+
+  private:
+
+    class Entry
+    {
+      public:
+        juce::int64 hash = 0;
+        juce::Array<MslToken> tokens;
+        bool used = false;
+    };
+
+    juce::OwnedArray<Entry> entries;
+    juce::HashMap<juce::int64,Entry*> map;
+    bool loaded = false;
+    bool dirty = false;
+    int hits = 0;
+    int misses = 0;
+
+    void clear();
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
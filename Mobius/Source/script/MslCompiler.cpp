@@ -0,0 +1,347 @@
+/**
+ * Lowering of pure MSL subtrees into MslPrograms.
+ *
+ * This runs after linking so symbols have their resolutions.  The tree is
+ * walked top down, and the first node whose entire subtree can be compiled
+ * gets a program.  Nodes below that are not visited again.  If a node can't
+ * be compiled, its children are tried individually, so a block with a wait
+ * in the middle still gets the statements on either side of it compiled.
+ *
+ * The instruction sequences mirror what the node handlers in MslSession
+ * would do.  Where they leave nothing in childResults, for example an
+ * assignment, the program pushes a void marker so the result of a block or
+ * if is whatever the session would have returned.
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/Trace.h"
+
+#include "MslModel.h"
+#include "MslSymbol.h"
+#include "MslCompilation.h"
+#include "MslFunction.h"
+#include "MslProgram.h"
+#include "MslMachine.h"
+
+#include "MslCompiler.h"
+
+void MslCompiler::compile(MslCompilation* u)
+{
+    unit = u;
+    programs = 0;
+    compiledNodes = 0;
+
+    compile(unit->getBodyFunction());
+    for (auto func : unit->functions)
+      compile(func);
+
+    if (programs > 0)
+      Trace(2, "MslCompiler: %s %d programs replacing %d nodes",
+            unit->name.toUTF8(), programs, compiledNodes);
+}
+
+void MslCompiler::compile(MslFunction* f)
+{
+    if (f != nullptr)
+      walk(f->getBody());
+}
+
+void MslCompiler::walk(MslNode* node)
+{
+    if (node != nullptr) {
+        node->program = nullptr;
+
+        int nodes = 0;
+        bool isVoid = false;
+        if (isCompilable(node, nodes, isVoid) && nodes >= MinNodes) {
+
+            program = new MslProgram();
+            depth = 0;
+            emit(node);
+            program->nodes = nodes;
+
+            if (program->maxDepth > MslMachine::MaxStack ||
+                program->slots.size() > MslMachine::MaxSlots) {
+                // too big for the machine, these are rare enough
+                // that it isn't worth splitting them up
+                delete program;
+                for (auto child : node->children)
+                  walk(child);
+            }
+            else {
+                node->program = program;
+                unit->programs.add(program);
+                programs++;
+                compiledNodes += nodes;
+            }
+            program = nullptr;
+        }
+        else {
+            for (auto child : node->children)
+              walk(child);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Analysis
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * True if a symbol is a plain reference to something the machine can
+ * resolve into a slot.  Bindings always win in the session so
+ * innerVariable and functionArgument will be found on the stack, static
+ * variables are used only if there is no binding with the same name.
+ */
+bool MslCompiler::isSlotSymbol(MslNode* node)
+{
+    bool slot = false;
+    MslSymbolNode* sym = (node != nullptr) ? node->getSymbol() : nullptr;
+    if (sym != nullptr && sym->children.size() == 0 && sym->arguments.size() == 0) {
+        MslResolution& res = sym->resolution;
+        slot = (res.isResolved() &&
+                !res.isFunction() &&
+                !res.keyword &&
+                !res.carryover &&
+                !res.usageArgument &&
+                res.external == nullptr &&
+                res.linkage == nullptr &&
+                (res.innerVariable != nullptr ||
+                 res.functionArgument ||
+                 res.staticVariable != nullptr));
+    }
+    return slot;
+}
+
+/**
+ * Determine whether a subtree can be compiled, counting the nodes
+ * and whether it may leave nothing.  Void results are fine for statements
+ * but not for operands, where the session would accumulate them differently.
+ */
+bool MslCompiler::isCompilable(MslNode* node, int& nodes, bool& isVoid)
+{
+    bool compilable = false;
+    isVoid = false;
+
+    if (node->isLiteral()) {
+        compilable = true;
+        nodes++;
+    }
+    else if (node->isSymbol()) {
+        compilable = isSlotSymbol(node);
+        nodes++;
+    }
+    else if (node->isOperator()) {
+        MslOperatorNode* op = node->getOperator();
+        int operands = (op->opcode == MslNot) ? 1 : 2;
+        if (op->opcode != MslUnknown && op->children.size() == operands) {
+            compilable = true;
+            for (auto child : op->children) {
+                bool childVoid = false;
+                if (!isCompilable(child, nodes, childVoid) || childVoid) {
+                    compilable = false;
+                    break;
+                }
+            }
+        }
+        nodes++;
+    }
+    else if (node->isAssignment()) {
+        if (node->children.size() == 2 && isSlotSymbol(node->children[0])) {
+            bool initVoid = false;
+            compilable = (isCompilable(node->children[1], nodes, initVoid) && !initVoid);
+            nodes++;
+        }
+        nodes++;
+        isVoid = true;
+    }
+    else if (node->isBlock()) {
+        MslBlockNode* block = node->getBlock();
+        // [] blocks accumulate lists which the machine doesn't do
+        if (block->token.value != "[" && block->functions.size() == 0 &&
+            block->variables.size() == 0) {
+            compilable = isCompilable(block->children, nodes, isVoid);
+        }
+        nodes++;
+    }
+    else if (node->isElse()) {
+        compilable = isCompilable(node->children, nodes, isVoid);
+        nodes++;
+    }
+    else if (node->isIf()) {
+        int count = node->children.size();
+        if (count == 2 || count == 3) {
+            compilable = true;
+            bool condVoid = false;
+            bool trueVoid = false;
+            bool falseVoid = false;
+            if (!isCompilable(node->children[0], nodes, condVoid) ||
+                !isCompilable(node->children[1], nodes, trueVoid) ||
+                (count == 3 && !isCompilable(node->children[2], nodes, falseVoid)))
+              compilable = false;
+
+            // the result may be void if either branch leaves nothing,
+            // which the machine only knows when it gets there
+            isVoid = (trueVoid || falseVoid);
+        }
+        nodes++;
+    }
+
+    return compilable;
+}
+
+bool MslCompiler::isCompilable(juce::OwnedArray<MslNode>& children, int& nodes, bool& isVoid)
+{
+    bool compilable = true;
+    // an empty block returns nothing
+    isVoid = true;
+    for (auto child : children) {
+        if (!isCompilable(child, nodes, isVoid)) {
+            compilable = false;
+            break;
+        }
+    }
+    return compilable;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Emission
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Keep track of the operand stack depth as instructions are added.
+ * Void markers take a stack position like anything else.
+ */
+void MslCompiler::adjust(int delta)
+{
+    depth += delta;
+    if (depth > program->maxDepth)
+      program->maxDepth = depth;
+}
+
+int MslCompiler::emit(MslOpcode op, int operand)
+{
+    MslInstruction inst;
+    inst.op = op;
+    inst.operand = operand;
+    program->code.add(inst);
+    return program->code.size() - 1;
+}
+
+/**
+ * Point a previously emitted jump at the next instruction.
+ */
+void MslCompiler::patch(int index)
+{
+    program->code.getReference(index).operand = program->code.size();
+}
+
+int MslCompiler::getSlot(MslSymbolNode* sym)
+{
+    int index = -1;
+    for (int i = 0 ; i < program->slots.size() ; i++) {
+        if (program->slots.getReference(i).name == sym->token.value) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        MslProgram::Slot slot;
+        slot.name = sym->token.value;
+        slot.nameId = sym->nameId;
+        slot.staticVariable = sym->resolution.staticVariable;
+        program->slots.add(slot);
+        index = program->slots.size() - 1;
+    }
+    return index;
+}
+
+int MslCompiler::getConstant(juce::String s)
+{
+    int index = program->constants.indexOf(s);
+    if (index < 0) {
+        program->constants.add(s);
+        index = program->constants.size() - 1;
+    }
+    return index;
+}
+
+void MslCompiler::emit(MslNode* node)
+{
+    if (node->isLiteral()) {
+        MslLiteralNode* lit = node->getLiteral();
+        if (lit->isInt)
+          emit(MslOpPushInt, atoi(lit->token.value.toUTF8()));
+        else if (lit->isBool)
+          emit(MslOpPushBool, (lit->token.value == "true") ? 1 : 0);
+        else
+          emit(MslOpPushString, getConstant(lit->token.value));
+        adjust(1);
+    }
+    else if (node->isSymbol()) {
+        emit(MslOpLoad, getSlot(node->getSymbol()));
+        adjust(1);
+    }
+    else if (node->isOperator()) {
+        MslOperatorNode* op = node->getOperator();
+        for (auto child : op->children)
+          emit(child);
+        emit(MslOpOperator, (int)(op->opcode));
+        adjust(1 - op->children.size());
+    }
+    else if (node->isAssignment()) {
+        emit(node->children[1]);
+        emit(MslOpStore, getSlot(node->children[0]->getSymbol()));
+        // replaces the value with a void marker
+    }
+    else if (node->isBlock() || node->isElse()) {
+        emitChildren(node);
+    }
+    else if (node->isIf()) {
+        emit(node->children[0]);
+        int jumpFalse = emit(MslOpJumpFalse);
+        adjust(-1);
+
+        int base = depth;
+        emit(node->children[1]);
+        int jumpEnd = emit(MslOpJump);
+        patch(jumpFalse);
+
+        depth = base;
+        if (node->children.size() > 2)
+          emit(node->children[2]);
+        else {
+            // the session returns an empty value when there is no else
+            emit(MslOpPushNull);
+            adjust(1);
+        }
+        patch(jumpEnd);
+    }
+}
+
+void MslCompiler::emitChildren(MslNode* node)
+{
+    if (node->children.size() == 0) {
+        emit(MslOpPushVoid);
+        adjust(1);
+    }
+    else {
+        for (int i = 0 ; i < node->children.size() ; i++) {
+            if (i > 0) {
+                // only the last value is kept
+                emit(MslOpPop);
+                adjust(-1);
+            }
+            emit(node->children[i]);
+        }
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
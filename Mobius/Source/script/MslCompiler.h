@@ -0,0 +1,57 @@
+/**
+ * Utility class used by MslLinker to lower pure expressions in
+ * a compilation unit into MslPrograms.
+ *
+ * What can be compiled is deliberately narrow: literals, references to
+ * local and static variables, operators, assignments to those variables,
+ * unbracketed blocks and if/else.  Anything that could call out, wait,
+ * or transition is left for the session to walk, and compilation
+ * happens around it.
+ */
+
+#pragma once
+
+#include "MslProgram.h"
+
+class MslCompiler
+{
+  public:
+
+    /**
+     * Subtrees smaller than this aren't worth it, a single
+     * literal or symbol reference is just as fast walked.
+     */
+    static const int MinNodes = 3;
+
+    MslCompiler() {}
+    ~MslCompiler() {}
+
+    void compile(class MslCompilation* unit);
+
+  private:
+
+    class MslCompilation* unit = nullptr;
+    class MslProgram* program = nullptr;
+    int depth = 0;
+    int programs = 0;
+    int compiledNodes = 0;
+
+    void compile(class MslFunction* f);
+    void walk(class MslNode* node);
+
+    bool isCompilable(class MslNode* node, int& nodes, bool& isVoid);
+    bool isSlotSymbol(class MslNode* node);
+    bool isCompilable(juce::OwnedArray<class MslNode>& children, int& nodes, bool& isVoid);
+
+    void emit(class MslNode* node);
+    void emitChildren(class MslNode* node);
+    int emit(MslOpcode op, int operand = 0);
+    void patch(int index);
+    void adjust(int delta);
+    int getSlot(class MslSymbolNode* sym);
+    int getConstant(juce::String s);
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -343,6 +343,10 @@ void MslConductor::sendTransition(MslContext* c, MslSession* s)
     if (p != nullptr)
       p->state = MslStateTransitioning;
 
+    MslProfiler::Entry* profile = s->getProfile();
+    if (profile != nullptr)
+      profile->transitions.fetch_add(1, std::memory_order_relaxed);
+
     sendMessage(c, msg);
 }
 
@@ -371,6 +375,9 @@ MslProcess* MslConductor::makeProcess(MslSession* s)
     // MslRequest everwhere within Conductor too since it started here
     p->triggerId = s->getTriggerId();
 
+    // keeps old units alive while this runs
+    p->epoch = s->getEpoch();
+
     // can't have one without the other?
     p->session = s;
     s->setProcess(p);
@@ -430,6 +437,22 @@ bool MslConductor::captureProcess(int sessionId, MslProcess& result)
     return found;
 }
 
+/**
+ * Find the oldest linkage table any process may still be using.
+ * Sessions that never suspended don't have processes, but those can't
+ * outlive the block or shell call they started in.
+ */
+int MslConductor::getOldestEpoch(int current)
+{
+    int oldest = current;
+    juce::ScopedLock lock (criticalSection);
+    for (MslProcess* p = processes ; p != nullptr ; p = p->next) {
+        if (p->epoch < oldest)
+          oldest = p->epoch;
+    }
+    return oldest;
+}
+
 void MslConductor::listProcesses(juce::Array<MslProcess>& result)
 {
     juce::ScopedLock lock (criticalSection);
@@ -69,6 +69,9 @@ class MslConductor
     bool captureProcess(int sessionId, class MslProcess& result);
     void listProcesses(juce::Array<MslProcess>& result);
 
+    // the oldest linkage epoch still in use by a process
+    int getOldestEpoch(int current);
+
     void enableResultDiagnostics(bool b);
     
   private:
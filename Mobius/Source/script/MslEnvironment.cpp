@@ -21,6 +21,10 @@
 #include "MslMessage.h"
 #include "MslState.h"
 #include "MslRequest.h"
+#include "MslLinkage.h"
+#include "MslFunction.h"
+#include "MslVariable.h"
+#include "MslStringArena.h"
 
 #include "MslEnvironment.h"
 
@@ -31,6 +35,19 @@ MslEnvironment::MslEnvironment()
 MslEnvironment::~MslEnvironment()
 {
     Trace(2, "MslEnvironment: destructing");
+    if (relinks > 0)
+      Trace(2, "MslEnvironment: %d relinks %d units rebuilt %d reclaimed",
+            relinks, rebuilds, garbage.getReclaimed());
+
+    // the kernel is gone by now
+    delete kernelTable;
+    delete pendingTable.exchange(nullptr);
+    MslLinkageTable* table = finishedTables.exchange(nullptr);
+    while (table != nullptr) {
+        MslLinkageTable* next = table->next;
+        delete table;
+        table = next;
+    }
 }
 
 /**
@@ -55,6 +72,45 @@ bool MslEnvironment::isDiagnosticMode()
     return diagnosticMode;
 }
 
+void MslEnvironment::setBytecode(bool b)
+{
+    bytecode = b;
+}
+
+bool MslEnvironment::isBytecode()
+{
+    return bytecode;
+}
+
+void MslEnvironment::resetProfile()
+{
+    juce::Array<MslCompilation*> units;
+    for (auto unit : compilations)
+      units.add(unit);
+    profiler.reset(units);
+}
+
+void MslEnvironment::reportProfile(juce::String sort, int statements, juce::StringArray& lines)
+{
+    profiler.report(sort, lines);
+    if (statements > 0) {
+        juce::Array<MslCompilation*> units;
+        for (auto unit : compilations)
+          units.add(unit);
+        lines.add("");
+        lines.add("Statements");
+        profiler.reportStatements(units, statements, lines);
+    }
+}
+
+juce::String MslEnvironment::dumpProfile()
+{
+    juce::Array<MslCompilation*> units;
+    for (auto unit : compilations)
+      units.add(unit);
+    return profiler.dump(units);
+}
+
 //////////////////////////////////////////////////////////////////////
 //
 // Valuator Interface
@@ -148,6 +204,24 @@ MslLinkage* MslEnvironment::find(MslCompilation* unit, juce::String name)
     return link;
 }
 
+/**
+ * Return the binding id for a name, assigning one if this is the
+ * first time it has been seen.  Only the linker calls this so it
+ * happens in the shell.
+ */
+int MslEnvironment::internName(juce::String name)
+{
+    int id = 0;
+    if (name.length() > 0) {
+        id = nameIds[name];
+        if (id == 0) {
+            id = nameIds.size() + 1;
+            nameIds.set(name, id);
+        }
+    }
+    return id;
+}
+
 /**
  * Allocate a value structure for use in an MslRequest.
  */
@@ -205,10 +279,10 @@ MslResult* MslEnvironment::request(MslContext* c, MslRequest* req)
         // no one is watching
         Trace(1, "MslEnvironment::request Missing link");
     }
-    else if (link->variable != nullptr) {
+    else if (getVariable(c, link) != nullptr) {
         setVariable(c, link, req);
     }
-    else if (link->function == nullptr) {
+    else if (getFunction(c, link) == nullptr) {
         Trace(1, "MslEnvironment: Unresolved link %s", link->name.toUTF8());
         MslResultBuilder b(this);
         b.addError("Unresolved link");
@@ -237,8 +311,7 @@ MslResult* MslEnvironment::request(MslContext* c, MslRequest* req)
  */
 void MslEnvironment::setVariable(MslContext*c, MslLinkage* link, MslRequest* req)
 {
-    (void)c;
-    MslVariable* var = link->variable;
+    MslVariable* var = getVariable(c, link);
     if (var == nullptr) {
         // this must be an old linkage to a script that was unloaded
         // not uncommon if the variable was put in the Instant Parameters element
@@ -545,7 +618,8 @@ MslResult* MslEnvironment::scriptletCompile(MslContext* c, juce::String id, juce
                 // lots of complications
                 MslCompilation* old = unit;
                 compilationMap.set(id, neu);
-                garbage.add(old);
+                profiler.assign(neu);
+                garbage.add(old, retire());
                 installed = true;
             }
         }
@@ -621,7 +695,8 @@ MslResult* MslEnvironment::scriptletExtend(MslContext* c, juce::String id, juce:
             if (ponderLinkErrors(unit)) {
                 MslCompilation* old = unit;
                 compilationMap.set(id, neu);
-                garbage.add(old);
+                profiler.assign(neu);
+                garbage.add(old, retire());
                 installed = true;
             }
             else {
@@ -669,10 +744,20 @@ MslResult* MslEnvironment::scriptletExtend(MslContext* c, juce::String id, juce:
 MslDetails* MslEnvironment::install(MslContext* c, juce::String unitId,
                                     juce::String source, bool relinkNow)
 {
-    MslDetails* result = new MslDetails();
-
     MslParser parser;
     MslCompilation* unit = parser.parse(source);
+    return install(c, unitId, unit, relinkNow);
+}
+
+/**
+ * Install a unit that has already been parsed.  ScriptClerk parses files
+ * on other threads and brings the results here.  The unit is owned
+ * by the environment after this, and deleted if it could not be installed.
+ */
+MslDetails* MslEnvironment::install(MslContext* c, juce::String unitId,
+                                    MslCompilation* unit, bool relinkNow)
+{
+    MslDetails* result = new MslDetails();
     bool installed = false;
 
     if (!unit->hasErrors()) {
@@ -1027,6 +1112,7 @@ void MslEnvironment::install(MslContext* c, MslCompilation* unit, MslDetails* re
     }
     compilations.add(unit);
     compilationMap.set(unit->id, unit);
+    profiler.assign(unit);
 
     if (unit->collisions.size() == 0) {
         // a clean install
@@ -1042,6 +1128,11 @@ void MslEnvironment::install(MslContext* c, MslCompilation* unit, MslDetails* re
         // else to add to the result beyond collisions
     }
 
+    // anything that referenced these names needs to be linked again, even
+    // if the name was put back it is attached to something new
+    changedLinks.addArray(linksRemoved);
+    changedLinks.addArray(linksAdded);
+    
     if (linksRemoved.size() > 0 || linksAdded.size() > 0) {
 
         // look mom, it's set theory
@@ -1061,17 +1152,16 @@ void MslEnvironment::install(MslContext* c, MslCompilation* unit, MslDetails* re
 
         // at this point, linksRemoved has the names that were
         // not added, and linksAdded has the things that were not removed
-        // changes were made that might be visible
-        if (linksAdded.size() > 0 || linksRemoved.size() > 0) {
-            if (relinkNow)
-              link(c);
-        }
         // remember the deltas in the result, not required by anything
         // but interesting information
         result->linksAdded = linksAdded;
         result->linksRemoved = linksRemoved;
     }
 
+    // this also publishes the new unit to the kernel
+    if (relinkNow)
+      link(c);
+
     // restore persistent variable state
     // if unit couldn't be published, these may go nowhere and will be lost
     // dislike the temporary nature of state saves, might be better to always
@@ -1104,7 +1194,7 @@ void MslEnvironment::uninstall(MslContext* c, MslCompilation* unit, juce::String
     unit->published = false;
     compilations.removeObject(unit, false);
     compilationMap.set(unit->id, nullptr);
-    garbage.add(unit);
+    garbage.add(unit, retire());
 }
 
 /**
@@ -1217,6 +1307,7 @@ MslLinkage* MslEnvironment::internLinkage(MslCompilation* unit, juce::String nam
             if (link == nullptr) {
                 link = new MslLinkage();
                 link->name = qname;
+                link->index = linkages.size();
                 linkages.add(link);
 
                 // todo: need to make two entries, one qualified, and another not
@@ -1514,12 +1605,27 @@ void MslEnvironment::restoreState(MslState* state)
 //////////////////////////////////////////////////////////////////////
 
 /**
- * Do a full relink of the environment.
+ * Relink the units affected by the installs and uninstalls since the last
+ * link, then publish the result to the kernel.
  * Normally this is called automatically as a side effect of
  * Unloading or reloading units.
  *
+ * This used to link every unit in place.  That is fine until the kernel can
+ * see them, but linking rebuilds the call argument blocks on the symbol nodes,
+ * and a session in the kernel may be in the middle of one.  So units that have
+ * been published to the kernel are never linked again, they are parsed again
+ * from their source, and the new copies replace the old ones the same way
+ * as a file reload.  The old units go to the garbage collector.  Units the
+ * kernel hasn't seen yet, which is all of them during startup, are linked
+ * in place.
+ *
+ * Linking a copy in place of a unit republishes everything it exports,
+ * and call argument blocks in the units that reference those may point
+ * into the old unit for default argument values, so those are rebuilt too.
+ * See gatherAffected.
+ *
  * todo: For ScriptClerk, if there are files with intertwined dependencies
- * they may all resolve themselves after the full relink, but the MslDetails
+ * they may all resolve themselves after the relink, but the MslDetails
  * left in the registry after the individual file installs won't be refreshed
  * to reflect that.  Clerk will have to refresh them by itself, there is no
  * "push" of new details though that might be interesting.  Some sort of
@@ -1527,13 +1633,326 @@ void MslEnvironment::restoreState(MslState* state)
  */
 void MslEnvironment::link(MslContext* c)
 {
+    juce::Array<MslCompilation*> affected;
+    gatherAffected(affected);
+
+    juce::Array<MslCompilation*> relinking;
+    juce::Array<MslCompilation*> replaced;
+    juce::Array<MslCompilation*> replacements;
+    for (auto unit : affected) {
+        MslCompilation* neu = nullptr;
+        if (unit->epoch > 0) {
+            neu = rebuild(unit);
+            if (neu == nullptr)
+              Trace(1, "MslEnvironment: Unable to rebuild %s, linking in place",
+                    unit->id.toUTF8());
+        }
+        if (neu == nullptr) {
+            relinking.add(unit);
+        }
+        else {
+            replaced.add(unit);
+            replacements.add(neu);
+            relinking.add(neu);
+        }
+    }
+
+    // swap in all the copies before linking any of them so they
+    // only reference each other
+    juce::StringArray links;
+    for (int i = 0 ; i < replaced.size() ; i++) {
+        MslCompilation* old = replaced[i];
+        MslCompilation* neu = replacements[i];
+        bool wasPublished = old->published;
+        uninstall(c, old, links);
+        compilations.add(neu);
+        compilationMap.set(neu->id, neu);
+        if (wasPublished)
+          publish(neu, links);
+    }
+
     MslLinker linker;
+    for (auto unit : relinking)
+      linker.link(c, this, unit);
+
+    for (int i = 0 ; i < replaced.size() ; i++)
+      carryVariables(replaced[i], replacements[i]);
+
+    changedLinks.clear();
+    relinks++;
+    rebuilds += replaced.size();
+    if (replaced.size() > 0)
+      Trace(2, "MslEnvironment: Relinked %d units, rebuilt %d",
+            relinking.size(), replaced.size());
+
+    publishLinkages();
     
+    // todo: need to auto-publish units that no longer have name collisions
+}
+
+/**
+ * Walk the dependency graph out from the links that changed.
+ *
+ * Each unit remembers the names it looked up in the environment when it was
+ * linked.  A unit is affected if one of those names changed, and if it is
+ * rebuilt, the names it publishes change as well.  Names are compared without
+ * namespace qualifiers, which may relink a few more units than necessary.
+ * Units the kernel hasn't seen are always relinked, that is the deferred
+ * link after a bulk install.
+ */
+void MslEnvironment::gatherAffected(juce::Array<MslCompilation*>& affected)
+{
+    juce::StringArray names;
+    for (auto name : changedLinks)
+      names.addIfNotAlreadyThere(name.fromLastOccurrenceOf(":", false, false));
+
     for (auto unit : compilations) {
-        linker.link(c, this, unit);
+        if (unit->epoch == 0)
+          affected.add(unit);
+    }
+
+    bool more = true;
+    while (more) {
+        more = false;
+        for (auto unit : compilations) {
+            if (!affected.contains(unit) && isAffected(unit, names)) {
+                affected.add(unit);
+                for (auto link : linkages) {
+                    if (link->unit == unit) {
+                        names.addIfNotAlreadyThere(link->name.fromLastOccurrenceOf(":", false, false));
+                        more = true;
+                    }
+                }
+            }
+        }
     }
+}
 
-    // todo: need to auto-publish units that no longer have name collisions
+bool MslEnvironment::isAffected(MslCompilation* unit, juce::StringArray& names)
+{
+    bool affected = false;
+    for (auto ref : unit->references) {
+        if (names.contains(ref.fromLastOccurrenceOf(":", false, false))) {
+            affected = true;
+            break;
+        }
+    }
+    return affected;
+}
+
+/**
+ * Make a new copy of an installed unit from its source.
+ * The copy isn't linked yet.
+ */
+MslCompilation* MslEnvironment::rebuild(MslCompilation* unit)
+{
+    MslCompilation* neu = nullptr;
+    if (unit->source.length() > 0) {
+        MslParser parser;
+        neu = parser.parse(unit->source);
+        if (neu->hasErrors()) {
+            // it parsed before, how could this happen?
+            delete neu;
+            neu = nullptr;
+        }
+        else {
+            ensureUnitName(unit->id, neu);
+            // the console may have changed these
+            neu->package = unit->package;
+            neu->variableCarryover = unit->variableCarryover;
+        }
+    }
+    return neu;
+}
+
+/**
+ * The static variables in a rebuilt unit start over with their
+ * initializers which were not run, give them the values from the old one.
+ * Changes made by the kernel after this and before it adopts the new unit
+ * are lost.
+ */
+void MslEnvironment::carryVariables(MslCompilation* src, MslCompilation* dest)
+{
+    for (auto var : dest->variables) {
+        for (auto old : src->variables) {
+            if (old->name == var->name) {
+                MslValue value;
+                if (!old->isScoped()) {
+                    old->getValue(0, &value);
+                    var->setValue(0, &value);
+                }
+                else {
+                    for (int i = 1 ; i <= MslVariable::MaxScope ; i++) {
+                        if (old->isBound(i)) {
+                            old->getValue(i, &value);
+                            var->setValue(i, &value);
+                        }
+                    }
+                }
+                break;
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Kernel Publication
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Give the kernel a copy of what every linkage resolves to.
+ *
+ * The table is handed over through an atomic pointer, the kernel takes it
+ * at the start of the next block and gives back the one it replaced.  If
+ * the kernel hasn't taken the last one yet it is simply replaced, the kernel
+ * never saw it.  Publications are numbered and the number is the epoch used
+ * to decide when retired units can be deleted.
+ */
+void MslEnvironment::publishLinkages()
+{
+    MslLinkageTable* table = new MslLinkageTable(linkages.size());
+    table->epoch = ++publications;
+    for (auto link : linkages) {
+        MslLinkageTable::Entry* e = table->getEntry(link);
+        if (e != nullptr) {
+            e->unit = link->unit;
+            e->function = link->function;
+            e->variable = link->variable;
+        }
+    }
+
+    for (auto unit : compilations) {
+        if (unit->epoch == 0) {
+            unit->epoch = table->epoch;
+            // units rebuilt by link() need their slots again
+            profiler.assign(unit);
+        }
+    }
+    retiring = false;
+
+    delete pendingTable.exchange(table);
+}
+
+/**
+ * Called by the kernel at the start of each block.
+ * This is the only thing the kernel does when scripts change.
+ */
+void MslEnvironment::adoptLinkages()
+{
+    MslLinkageTable* table = pendingTable.exchange(nullptr);
+    if (table != nullptr) {
+        MslLinkageTable* old = kernelTable;
+        kernelTable = table;
+        kernelEpoch.store(table->epoch);
+        if (old != nullptr) {
+            old->next = finishedTables.load();
+            while (!finishedTables.compare_exchange_weak(old->next, old)) {}
+        }
+    }
+}
+
+/**
+ * Return the epoch for something being retired, which is the next
+ * publication since that is the first one that won't include it.
+ */
+int MslEnvironment::retire()
+{
+    retiring = true;
+    return publications + 1;
+}
+
+/**
+ * Called by MslLinker before a unit is compiled again.  The nodes
+ * are about to get new programs, the old ones wait in the garbage until
+ * no kernel session could still be running them.
+ */
+void MslEnvironment::retirePrograms(MslCompilation* unit)
+{
+    if (unit->programs.size() > 0) {
+        int epoch = retire();
+        while (unit->programs.size() > 0)
+          garbage.add(unit->programs.removeAndReturn(0), epoch);
+    }
+}
+
+/**
+ * Called by the shell periodically to delete things nothing can reach.
+ *
+ * A retired unit can be deleted once the kernel has adopted a table
+ * that doesn't include it, and every session that started before that
+ * has finished.  Sessions remember the kernel epoch when they started,
+ * and the ones that live long enough to matter have an MslProcess where
+ * the conductor can find it.  Sessions in the shell are always newer than
+ * the kernel so this is conservative for those.
+ */
+void MslEnvironment::reclaim()
+{
+    MslLinkageTable* table = finishedTables.exchange(nullptr);
+    while (table != nullptr) {
+        MslLinkageTable* next = table->next;
+        delete table;
+        table = next;
+    }
+
+    if (garbage.getPending() > 0) {
+        // scriptlets can be retired without anything being published,
+        // push a table through so the kernel epoch moves
+        if (retiring)
+          publishLinkages();
+
+        int safe = conductor.getOldestEpoch(kernelEpoch.load());
+        garbage.flush(safe);
+    }
+}
+
+MslFunction* MslEnvironment::getFunction(MslContext* c, MslLinkage* link)
+{
+    MslFunction* f = nullptr;
+    if (link != nullptr) {
+        if (c != nullptr && c->mslGetContextId() == MslContextKernel) {
+            MslLinkageTable::Entry* e = (kernelTable != nullptr) ? kernelTable->getEntry(link) : nullptr;
+            if (e != nullptr)
+              f = e->function;
+        }
+        else {
+            f = link->function;
+        }
+    }
+    return f;
+}
+
+MslVariable* MslEnvironment::getVariable(MslContext* c, MslLinkage* link)
+{
+    MslVariable* v = nullptr;
+    if (link != nullptr) {
+        if (c != nullptr && c->mslGetContextId() == MslContextKernel) {
+            MslLinkageTable::Entry* e = (kernelTable != nullptr) ? kernelTable->getEntry(link) : nullptr;
+            if (e != nullptr)
+              v = e->variable;
+        }
+        else {
+            v = link->variable;
+        }
+    }
+    return v;
+}
+
+MslCompilation* MslEnvironment::getUnit(MslContext* c, MslLinkage* link)
+{
+    MslCompilation* unit = nullptr;
+    if (link != nullptr) {
+        if (c != nullptr && c->mslGetContextId() == MslContextKernel) {
+            MslLinkageTable::Entry* e = (kernelTable != nullptr) ? kernelTable->getEntry(link) : nullptr;
+            if (e != nullptr)
+              unit = e->unit;
+        }
+        else {
+            unit = link->unit;
+        }
+    }
+    return unit;
 }
 
 /**
@@ -1552,12 +1971,13 @@ MslDetails* MslEnvironment::uninstall(MslContext* c, juce::String id, bool relin
     else {
         juce::StringArray linksRemoved;
         uninstall(c, unit, linksRemoved);
-
-        if (linksRemoved.size() > 0) {
-            result->linksRemoved = linksRemoved;
-            if (relinkNow)
-              link(c);
-        }
+        changedLinks.addArray(linksRemoved);
+        result->linksRemoved = linksRemoved;
+        
+        // even if nothing was published, the kernel needs a new
+        // table before the unit can be reclaimed
+        if (relinkNow)
+          link(c);
     }
 
     traceInteresting("uninstall", result);
@@ -1745,16 +2165,22 @@ void MslEnvironment::shellAdvance(MslContext* c)
 {
     if (c->mslGetContextId() != MslContextShell)
       Trace(1, "MslEnvironment: Wrong advance method called");
-    else
-      conductor.advance(c);
+    else {
+        conductor.advance(c);
+        reclaim();
+        // the kernel takes string blocks but never adds them
+        MslStringArena::getArena()->fluff();
+    }
 }
 
 void MslEnvironment::kernelAdvance(MslContext* c)
 {
     if (c->mslGetContextId() != MslContextKernel)
       Trace(1, "MslEnvironment: Wrong advance method called");
-    else
-      conductor.advance(c);
+    else {
+        adoptLinkages();
+        conductor.advance(c);
+    }
 }
 
 //////////////////////////////////////////////////////////////////////
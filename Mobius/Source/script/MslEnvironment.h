@@ -23,6 +23,7 @@
 #include "MslContext.h"
 #include "MslConductor.h"
 #include "MslGarbage.h"
+#include "MslProfiler.h"
 #include "MslConstants.h"
 
 /**
@@ -69,18 +70,24 @@ class MslEnvironment
      * be a "scriptlet" and an id will be generated and returned in the details.
      *
      * If a unit with this id already exists, it is replaced and the old unit is
-     * sent to the garbage collector.  A full environment link will take place that
-     * will re-resolve references into the new unit.  If the new unit lost exported symbols,
-     * this may result in unresolved references in other units.
+     * sent to the garbage collector.  The units that referenced anything the unit
+     * published or removed are then linked again, see link().  If the new unit lost
+     * exported symbols, this may result in unresolved references in other units.
      *
-     * By default, installing a new unit results in a full environment relink to
-     * address any unresolved symbol errors in other units that may now be provided
-     * by this unit.  When doing bulk loading (ScriptClerk) this may be deferred
-     * with link() called manually after all files are loaded.
+     * By default the relink happens immediately.  When doing bulk loading
+     * (ScriptClerk) this may be deferred with link() called manually after
+     * all files are loaded.
      */
     class MslDetails* install(class MslContext* c, juce::String unitId,
                               juce::String source, bool relinkNow=true);
 
+    /**
+     * Install a unit the application parsed itself.  This is how ScriptClerk
+     * parses many files at once in parallel.  The environment takes ownership.
+     */
+    class MslDetails* install(class MslContext* c, juce::String unitId,
+                              class MslCompilation* unit, bool relinkNow);
+
     /**
      * This interface is used only by the console to create a special scriptlet
      * unit that can carrover bindings from one run to the next.
@@ -103,8 +110,8 @@ class MslEnvironment
     juce::String setNamespace(juce::String unitId, juce::String ns);
 
     /**
-     * Uninstall a previoiusly installed compilation unit.   This will result in a
-     * full relink of the environment.  If the unit contained things that were
+     * Uninstall a previoiusly installed compilation unit.   This will relink
+     * the units that referenced it.  If the unit contained things that were
      * referenced by other units, this may result in unresolved references.
      *
      * This should be called whenever script files are removed from the library
@@ -163,9 +170,21 @@ class MslEnvironment
      * to externals, and compile the argument lists for function calls.
      * It is not usually necessary to call this function, it will be done automatically
      * when units are installed and uninstalled.
+     *
+     * Only the units affected by what was installed or uninstalled since the
+     * last link are linked, and the result is published to the kernel.
      */
     void link(class MslContext* c);
 
+    /**
+     * Resolve a linkage as seen from a context.  The shell sees the linkage
+     * as it is now, the kernel sees the last table it adopted.  Anything that
+     * might run in the kernel must use these rather than the linkage fields.
+     */
+    class MslFunction* getFunction(class MslContext* c, class MslLinkage* link);
+    class MslVariable* getVariable(class MslContext* c, class MslLinkage* link);
+    class MslCompilation* getUnit(class MslContext* c, class MslLinkage* link);
+
     //
     // User initiated actions
     //
@@ -270,6 +289,18 @@ class MslEnvironment
     void setDiagnosticMode(bool b);
     bool isDiagnosticMode();
 
+    // compiled expressions may be disabled for comparison
+    void setBytecode(bool b);
+    bool isBytecode();
+
+    // execution statistics, see MslProfiler
+    MslProfiler* getProfiler() {
+        return &profiler;
+    }
+    void resetProfile();
+    void reportProfile(juce::String sort, int statements, juce::StringArray& lines);
+    juce::String dumpProfile();
+
   protected:
 
     // for the inner component classes, mainly Session
@@ -290,6 +321,11 @@ class MslEnvironment
     class MslExternal* getExternal(juce::String name);
     void intern(class MslExternal* ext);
 
+    // for MslSession, the oldest linkage table the session may have seen
+    int getKernelEpoch() {
+        return kernelEpoch.load();
+    }
+
     void writeLog(class MslContext* c, class MslSession* s, class StructureDumper& d);
 
   private:
@@ -304,6 +340,8 @@ class MslEnvironment
 
     // garbage waiting to be collected
     MslGarbage garbage {&pool};
+
+    MslProfiler profiler;
     
     // registry of installed compilation units
     juce::OwnedArray<class MslCompilation> compilations;
@@ -319,14 +357,43 @@ class MslEnvironment
     // enables some result diagnostics and possibly other things
     bool diagnosticMode = false;
 
+    // when false sessions walk everything even if programs were compiled
+    bool bytecode = true;
+
     // exported links
     juce::OwnedArray<class MslLinkage> linkages;
     juce::HashMap<juce::String,class MslLinkage*> linkMap;
 
+    // names of links published or removed since the last link()
+    juce::StringArray changedLinks;
+
+    // the number of linkage tables published
+    int publications = 0;
+    // true if something was retired that no published table knows about
+    bool retiring = false;
+    // table waiting for the kernel
+    std::atomic<class MslLinkageTable*> pendingTable {nullptr};
+    // tables the kernel replaced, for the shell to delete
+    std::atomic<class MslLinkageTable*> finishedTables {nullptr};
+    // the table the kernel is using, touched only by the kernel
+    class MslLinkageTable* kernelTable = nullptr;
+    // publication number of kernelTable
+    std::atomic<int> kernelEpoch {0};
+
+    // statistics
+    int relinks = 0;
+    int rebuilds = 0;
+
     // external links
     juce::OwnedArray<class MslExternal> externals;
     juce::HashMap<juce::String,class MslExternal*> externalMap;
 
+    // ids for the names of local variables and arguments, assigned by the
+    // linker so sessions can match bindings without comparing strings
+    // ids are never reused so they survive relinking
+    juce::HashMap<juce::String,int> nameIds;
+    int internName(juce::String name);
+
     // request handling
     void setVariable(class MslContext*c, class MslLinkage* link, class MslRequest* req);
     void clean(class MslRequest* req);
@@ -361,5 +428,18 @@ class MslEnvironment
     class MslState* saveState(MslCompilation* unit);
     void saveState(MslCompilation* unit, class MslState* state);
 
+    // incremental relink
+    void gatherAffected(juce::Array<class MslCompilation*>& affected);
+    bool isAffected(class MslCompilation* unit, juce::StringArray& names);
+    class MslCompilation* rebuild(class MslCompilation* unit);
+    void carryVariables(class MslCompilation* src, class MslCompilation* dest);
+
+    // kernel publication and reclamation
+    int retire();
+    void retirePrograms(class MslCompilation* unit);
+    void publishLinkages();
+    void adoptLinkages();
+    void reclaim();
+
 };
 
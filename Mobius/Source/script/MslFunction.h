@@ -42,6 +42,7 @@ class MslFunction
     friend class MobiusConsole;
     friend class MslSession;
     friend class MslResolution;
+    friend class MslProfiler;
     
   public:
 
@@ -55,6 +56,9 @@ class MslFunction
     // todo: lots more here
     bool sustainable = false;
 
+    // location in MslProfiler, assigned when the unit is installed
+    int profileSlot = -1;
+
     bool isExport() {
         return (node != nullptr) ? node->keywordExport : false;
     }
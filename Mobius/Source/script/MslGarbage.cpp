@@ -2,6 +2,8 @@
 #include <JuceHeader.h>
 
 #include "MslCompilation.h"
+#include "MslModel.h"
+#include "MslProgram.h"
 #include "MslGarbage.h"
 
 MslGarbage::MslGarbage(MslPools* p)
@@ -17,11 +19,58 @@ MslGarbage::MslGarbage(MslPools* p)
  */
 void MslGarbage::flush()
 {
+    reclaimed += units.size() + blocks.size() + programs.size();
+    
     // units are not pooled
     units.clear();
+    unitEpochs.clear();
 
     // neither are blocks 
     blocks.clear();
+    blockEpochs.clear();
+
+    // or programs
+    programs.clear();
+    programEpochs.clear();
+}
+
+void MslGarbage::flush(int epoch)
+{
+    int index = 0;
+    while (index < units.size()) {
+        if (unitEpochs[index] <= epoch) {
+            units.remove(index);
+            unitEpochs.remove(index);
+            reclaimed++;
+        }
+        else {
+            index++;
+        }
+    }
+    
+    index = 0;
+    while (index < blocks.size()) {
+        if (blockEpochs[index] <= epoch) {
+            blocks.remove(index);
+            blockEpochs.remove(index);
+            reclaimed++;
+        }
+        else {
+            index++;
+        }
+    }
+
+    index = 0;
+    while (index < programs.size()) {
+        if (programEpochs[index] <= epoch) {
+            programs.remove(index);
+            programEpochs.remove(index);
+            reclaimed++;
+        }
+        else {
+            index++;
+        }
+    }
 }
 
 MslGarbage::~MslGarbage()
@@ -5,6 +5,11 @@
  * Currently this only has MslCompilation units since you can't
  * unload function and variable definitiosn independently of the unit.
  * This may change.
+ *
+ * Everything added is tagged with the linkage table publication that
+ * no longer includes it.  Once the kernel has adopted that table and
+ * every session that started before it has finished, nothing can reach
+ * the object and it can be deleted.  See MslEnvironment::reclaim.
  */
 
 #pragma once
@@ -18,24 +23,49 @@ class MslGarbage
     MslGarbage(class MslPools* p);
     ~MslGarbage();
 
-    void add(class MslCompilation* unit) {
+    void add(class MslCompilation* unit, int epoch) {
         units.add(unit);
+        unitEpochs.add(epoch);
     }
     
-    void add(class MslBlockNode* block) {
+    void add(class MslBlockNode* block, int epoch) {
         blocks.add(block);
+        blockEpochs.add(epoch);
     }
-    
+
+    void add(class MslProgram* program, int epoch) {
+        programs.add(program);
+        programEpochs.add(epoch);
+    }
+
+    /**
+     * Delete everything retired at or before the given epoch.
+     */
+    void flush(int epoch);
+
+    /**
+     * Delete everything.
+     */
     void flush();
 
+    int getPending() {
+        return units.size() + blocks.size() + programs.size();
+    }
+
+    int getReclaimed() {
+        return reclaimed;
+    }
+
   protected:
 
     class MslPools* pool = nullptr;
 
     juce::OwnedArray<class MslCompilation> units;
+    juce::Array<int> unitEpochs;
     juce::OwnedArray<class MslBlockNode> blocks;
+    juce::Array<int> blockEpochs;
+    juce::OwnedArray<class MslProgram> programs;
+    juce::Array<int> programEpochs;
+    int reclaimed = 0;
 
 };
-
-
-    
@@ -21,6 +21,9 @@ class MslLinkage
     // the name that can be referenced by an MslSymbol
     juce::String name;
 
+    // location of this linkage in the MslLinkageTable
+    int index = -1;
+
     // the compilation unit this came from
     class MslCompilation* unit = nullptr;
 
@@ -64,3 +67,53 @@ class MslLinkage
     
 };
 
+/**
+ * The kernel's view of the linkages.
+ *
+ * The fields in MslLinkage are changed by the shell as units are installed.
+ * The kernel can't watch that happen one field at a time, so each time the
+ * shell finishes a change it copies what every linkage resolves to into one
+ * of these and gives it to the kernel, which swaps it in at the start of
+ * the next block.  Sessions running in the kernel resolve linkages through
+ * the table rather than the linkage.  Tables are never modified after they
+ * are published, and the one replaced by the kernel goes back to the shell
+ * to be deleted.
+ */
+class MslLinkageTable
+{
+  public:
+
+    class Entry
+    {
+      public:
+        class MslCompilation* unit = nullptr;
+        class MslFunction* function = nullptr;
+        class MslVariable* variable = nullptr;
+    };
+
+    MslLinkageTable(int n) {
+        size = n;
+        if (n > 0)
+          entries = new Entry[n];
+    }
+    ~MslLinkageTable() {
+        delete[] entries;
+    }
+
+    // the publication number, see MslEnvironment::publishLinkages
+    int epoch = 0;
+    
+    int size = 0;
+    Entry* entries = nullptr;
+
+    // chain for the list of tables the kernel has finished with
+    MslLinkageTable* next = nullptr;
+
+    Entry* getEntry(class MslLinkage* link) {
+        Entry* e = nullptr;
+        if (link != nullptr && link->index >= 0 && link->index < size)
+          e = &(entries[link->index]);
+        return e;
+    }
+};
+
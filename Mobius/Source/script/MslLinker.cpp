@@ -97,6 +97,8 @@
 #include "MslError.h"
 #include "MslBinding.h"
 
+#include "MslStringArena.h"
+#include "MslCompiler.h"
 #include "MslLinker.h"
 
 /**
@@ -113,6 +115,8 @@ void MslLinker::link(MslContext* c, MslEnvironment* e, MslCompilation* u)
     unit->warnings.clear();
     unit->collisions.clear();
     unit->unresolved.clear();
+    unit->linkedReferences.clearQuick();
+    unit->references.clearQuick();
 
     // while library scripts don't technically have a callable
     // body function, it can serve as the static initialization
@@ -128,6 +132,15 @@ void MslLinker::link(MslContext* c, MslEnvironment* e, MslCompilation* u)
 
     // if symbol resolution was succesful check for name collisions
     checkCollisions();
+
+    // with everything resolved, the pure parts can be compiled
+    // a kernel session may be in the middle of one of the old programs
+    // so they are collected like replaced units
+    environment->retirePrograms(unit);
+    if (unit->errors.size() == 0) {
+        MslCompiler compiler;
+        compiler.compile(unit);
+    }
 }
 
 void MslLinker::link(MslFunction* f)
@@ -150,6 +163,16 @@ void MslLinker::link(MslNode* node)
         MslSymbolNode* sym = node->getSymbol();
         if (sym != nullptr)
           link(sym);
+
+        // local variables get the binding id their references will use
+        MslVariableNode* var = node->getVariable();
+        if (var != nullptr)
+          var->nameId = environment->internName(var->name);
+
+        // keyword values share the name rather than copying it
+        MslKeywordNode* key = node->getKeyword();
+        if (key != nullptr)
+          key->nameId = MslStringArena::getArena()->intern(key->name.toUTF8());
     }
 }
 
@@ -290,6 +313,10 @@ void MslLinker::link(MslSymbolNode* sym)
 {
     resolve(sym);
 
+    // whatever this resolves to, a binding on the stack comes first
+    // so the session needs the id
+    sym->nameId = environment->internName(sym->token.value);
+
     if (sym->isResolved()) {
 
         if (sym->parent->isAssignment() &&
@@ -310,8 +337,38 @@ void MslLinker::link(MslSymbolNode* sym)
         }
         else if (sym->resolution.isFunction()) {
             compileArguments(sym);
+            for (auto node : sym->arguments.children) {
+                MslArgumentNode* arg = node->getArgument();
+                if (arg != nullptr)
+                  arg->nameId = environment->internName(arg->name);
+            }
+        }
+
+        if (sym->resolution.linkage != nullptr && !sym->resolution.isFunction())
+          addLinkedReference(sym);
+    }
+}
+
+/**
+ * Remember a reference to a variable in another unit.  The linkage
+ * is stable across reloads of that unit, if it goes away entirely
+ * the environment relinks everything and this is rebuilt.
+ */
+void MslLinker::addLinkedReference(MslSymbolNode* sym)
+{
+    bool found = false;
+    for (auto& ref : unit->linkedReferences) {
+        if (ref.name == sym->token.value) {
+            found = true;
+            break;
         }
     }
+    if (!found) {
+        MslCompilation::LinkedReference ref;
+        ref.name = sym->token.value;
+        ref.linkage = sym->resolution.linkage;
+        unit->linkedReferences.add(ref);
+    }
 }
 
 /**
@@ -522,6 +579,8 @@ void MslLinker::resolveFunctionArgument(MslSymbolNode* sym, MslBlockNode* decl)
  */
 void MslLinker::resolveEnvironment(MslSymbolNode* sym)
 {
+    // remember we looked, the environment may have something by this name later
+    unit->references.addIfNotAlreadyThere(sym->token.value);
     sym->resolution.linkage = environment->find(unit, sym->token.value);
 }
 
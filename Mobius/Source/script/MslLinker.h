@@ -25,6 +25,7 @@ class MslLinker
     void link(class MslFunction* f);
     void link(class MslNode* node);
     void link(class MslSymbolNode* s);
+    void addLinkedReference(class MslSymbolNode* s);
     
     void addError(class MslNode* node, juce::String msg);
     void addWarning(class MslNode* node, juce::String msg);
@@ -0,0 +1,167 @@
+/**
+ * Implementation of the MslProgram interpreter.
+ *
+ * The operand stack is made of MslValues owned by the machine so nothing
+ * is taken from the pool until the very end when the result is handed
+ * back to the session.  Operators are applied by the same MslSession
+ * method the node handler uses so coercion is identical.
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/Trace.h"
+
+#include "MslValue.h"
+#include "MslBinding.h"
+#include "MslVariable.h"
+#include "MslPools.h"
+#include "MslProgram.h"
+#include "MslSession.h"
+
+#include "MslMachine.h"
+
+/**
+ * Locate the bindings and variables for each slot before anything is done.
+ * Like MslSymbolNode a binding on the stack is preferred.  If the compiler
+ * thought something would be there and it isn't, or the binding holds a
+ * list, let the session deal with it so the errors come out the same way.
+ */
+bool MslMachine::resolve(MslProgram* p)
+{
+    bool resolved = true;
+    for (int i = 0 ; i < p->slots.size() ; i++) {
+        MslProgram::Slot& slot = p->slots.getReference(i);
+        bindings[i] = session->findBinding(slot.nameId, slot.name.toUTF8());
+        statics[i] = nullptr;
+        if (bindings[i] != nullptr) {
+            MslValue* v = bindings[i]->value;
+            if (v != nullptr && v->list != nullptr) {
+                resolved = false;
+                break;
+            }
+        }
+        else if (slot.staticVariable != nullptr) {
+            statics[i] = slot.staticVariable;
+        }
+        else {
+            resolved = false;
+            break;
+        }
+    }
+    return resolved;
+}
+
+void MslMachine::load(int slot, MslValue* dest)
+{
+    MslBinding* b = bindings[slot];
+    if (b != nullptr)
+      dest->copy(b->value);
+    else
+      // !! needs to be csect protected, same as returnStaticVariable
+      statics[slot]->getValue(session->getEffectiveScope(), dest);
+}
+
+/**
+ * The session transfers the initializer value to the binding, here
+ * it has to be copied off the operand stack.
+ */
+void MslMachine::store(int slot, MslValue* src)
+{
+    MslBinding* b = bindings[slot];
+    if (b != nullptr) {
+        MslValue* v = session->pool->allocValue();
+        v->copy(src);
+        session->pool->free(b->value);
+        b->value = v;
+    }
+    else {
+        session->assignStaticVariable(statics[slot], src);
+    }
+}
+
+bool MslMachine::run(MslSession* s, MslProgram* p)
+{
+    session = s;
+    if (!resolve(p)) {
+        fallbacks++;
+        return false;
+    }
+    runs++;
+
+    int sp = 0;
+    int pc = 0;
+    int end = p->code.size();
+    while (pc < end) {
+        MslInstruction& inst = p->code.getReference(pc);
+        pc++;
+        switch (inst.op) {
+            case MslOpPushInt:
+                values[sp].setInt(inst.operand);
+                voids[sp++] = false;
+                break;
+            case MslOpPushBool:
+                values[sp].setBool(inst.operand != 0);
+                voids[sp++] = false;
+                break;
+            case MslOpPushString:
+                values[sp].setJString(p->constants[inst.operand]);
+                voids[sp++] = false;
+                break;
+            case MslOpPushNull:
+                values[sp].setNull();
+                voids[sp++] = false;
+                break;
+            case MslOpPushVoid:
+                values[sp].setNull();
+                voids[sp++] = true;
+                break;
+            case MslOpLoad:
+                load(inst.operand, &(values[sp]));
+                voids[sp++] = false;
+                break;
+            case MslOpStore:
+                store(inst.operand, &(values[sp - 1]));
+                values[sp - 1].setNull();
+                voids[sp - 1] = true;
+                break;
+            case MslOpOperator: {
+                MslOperators op = (MslOperators)(inst.operand);
+                MslValue* result = &scratch;
+                if (op == MslNot) {
+                    session->applyOperator(op, &(values[sp - 1]), nullptr, result);
+                    values[sp - 1].copy(result);
+                }
+                else {
+                    session->applyOperator(op, &(values[sp - 2]), &(values[sp - 1]), result);
+                    sp--;
+                    values[sp - 1].copy(result);
+                }
+            }
+                break;
+            case MslOpPop:
+                sp--;
+                break;
+            case MslOpJump:
+                pc = inst.operand;
+                break;
+            case MslOpJumpFalse:
+                sp--;
+                if (voids[sp] || !values[sp].getBool())
+                  pc = inst.operand;
+                break;
+        }
+    }
+
+    MslValue* v = nullptr;
+    if (sp > 0 && !voids[sp - 1]) {
+        v = session->pool->allocValue();
+        v->copy(&(values[sp - 1]));
+    }
+    session->popStack(v);
+
+    return true;
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,67 @@
+/**
+ * Interpreter for MslPrograms.
+ *
+ * Each MslSession has one of these.  When the session reaches a node with
+ * a compiled program it hands it here, and the machine runs it to
+ * completion on a fixed operand stack and pops the session stack frame with
+ * the result, exactly as the node handler would have.
+ *
+ * Nothing in a program can wait or transition so run() never suspends.
+ */
+
+#pragma once
+
+#include "MslValue.h"
+
+class MslMachine
+{
+  public:
+
+    /**
+     * Programs needing more than this are left to the tree walker.
+     */
+    static const int MaxStack = 16;
+    static const int MaxSlots = 16;
+
+    MslMachine() {}
+    ~MslMachine() {}
+
+    /**
+     * Run a program for the node on the top of the session stack.
+     * Returns false if the slots could not be resolved the way the compiler
+     * expected, in which case nothing has been done and the session should
+     * walk the node normally.
+     */
+    bool run(class MslSession* s, class MslProgram* p);
+
+    int getRuns() {
+        return runs;
+    }
+
+    int getFallbacks() {
+        return fallbacks;
+    }
+
+  private:
+
+    class MslSession* session = nullptr;
+
+    MslValue values[MaxStack];
+    bool voids[MaxStack];
+    // operator results before they replace the operands
+    MslValue scratch;
+
+    class MslBinding* bindings[MaxSlots];
+    class MslVariable* statics[MaxSlots];
+
+    int runs = 0;
+    int fallbacks = 0;
+
+    bool resolve(class MslProgram* p);
+    void load(int slot, MslValue* dest);
+    void store(int slot, MslValue* src);
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
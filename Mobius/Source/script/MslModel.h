@@ -147,6 +147,13 @@ class MslNode
     //////////////////////////////////////////////////////////////////////
     // Runtime State
     //////////////////////////////////////////////////////////////////////
+
+    // compiled form of this subtree, left here by MslCompiler and
+    // owned by the MslCompilation
+    class MslProgram* program = nullptr;
+
+    // number of times this was evaluated while MslProfiler was enabled
+    std::atomic<int> visits {0};
     
     bool hasBlock(juce::String bracket) {
         bool found = false;
@@ -300,6 +307,9 @@ class MslKeywordNode : public MslNode
     
     juce::String name;
 
+    // interned string id for the name, set by the linker
+    int nameId = 0;
+
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -587,6 +597,8 @@ class MslVariableNode : public MslScopedNode
     juce::String name;
     bool wantsInitializer = false;
     class MslVariable* staticVariable = nullptr;
+    // binding name id from MslEnvironment, set by the linker
+    int nameId = 0;
     juce::OwnedArray<MslPropertyNode> properties;
     
     MslVariableNode* getVariable() override {return this;}
@@ -57,12 +57,14 @@ MslCompilation* MslParser::parse(juce::String source)
     init();
     
     script = new MslCompilation();
+    script->source = source;
     root = new MslBlockNode();
 
     // the "stack"
     current = root;
 
-    parseInner(source);
+    tokenizer.setContent(source);
+    parseInner();
 
     if (script->errors.size() == 0) {
         sift();
@@ -81,6 +83,41 @@ MslCompilation* MslParser::parse(juce::String source)
     return result;
 }
 
+MslCompilation* MslParser::parse(juce::String source, juce::Array<MslToken>& tokens)
+{
+    init();
+    
+    script = new MslCompilation();
+    script->source = source;
+    root = new MslBlockNode();
+    current = root;
+
+    if (tokens.size() > 0) {
+        tokenizer.setTokens(&tokens);
+    }
+    else {
+        tokenizer.setContent(source);
+        tokenizer.setCapture(&tokens);
+    }
+    parseInner();
+    tokenizer.setCapture(nullptr);
+
+    if (script->errors.size() == 0) {
+        sift();
+    }
+    else {
+        delete root;
+        root = nullptr;
+    }
+
+    MslCompilation* result = script;
+    script = nullptr;
+    root = nullptr;
+    current = nullptr;
+    
+    return result;
+}
+
 /**
  * Clear out any lingering parse state before or after parsing.
  * The parser is normally a one-use stack object so this shouldn't be necessary.
@@ -294,10 +331,8 @@ bool MslParser::matchBracket(MslToken& t, MslNode* block)
 /**
  * Primary parse loop
  */
-void MslParser::parseInner(juce::String source)
+void MslParser::parseInner()
 {
-    tokenizer.setContent(source);
-
     // scope keyword intermediate parser
     // an oddment to "look backward" at previous tokens that were'nt acted upon
     // when encountered
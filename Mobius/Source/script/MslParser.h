@@ -28,6 +28,15 @@ class MslParser
     // usual file and scriptlet parsing interface
     MslCompilation* parse(juce::String source);
 
+    /**
+     * Parse with a token list kept by MslCompileCache.  If the list is
+     * empty the source is tokenized and the tokens are added to it,
+     * otherwise the tokens are parsed and the source is not used.
+     * The parser has no shared state so this may be called
+     * from any thread.
+     */
+    MslCompilation* parse(juce::String source, juce::Array<MslToken>& tokens);
+
     // make these public so the MslModel classes can add token errors
     void errorSyntax(MslToken& t, juce::String details);
     void errorSyntax(MslNode* node, juce::String details);
@@ -53,7 +62,7 @@ class MslParser
     void variableize(class MslVariableNode* node);
     void embody();
     
-    void parseInner(juce::String source);
+    void parseInner();
     bool matchBracket(MslToken& t, class MslNode* block);
 
     MslNode* checkKeywords(MslToken& t);
@@ -5,11 +5,13 @@
 #include "../util/Trace.h"
 
 #include "MslValue.h"
+#include "MslStringArena.h"
 #include "MslError.h"
 #include "MslResult.h"
 #include "MslStack.h"
 #include "MslSession.h"
 #include "MslBinding.h"
+#include "MslProfiler.h"
 
 #include "MslPools.h"
 
@@ -40,6 +42,7 @@ MslPools::~MslPools()
     
     traceSizes();
     traceStatistics();
+    MslStringArena::getArena()->traceStatistics();
 }
 
 /**
@@ -54,6 +57,11 @@ void MslPools::traceStatistics()
     for (MslValue* obj = valuePool ; obj != nullptr ; obj = obj->next) count++;
     Trace(2, "  values: %d %d %d %d",
           valuesCreated, valuesRequested, valuesReturned, valuesDeleted);
+    // values used to carry their own 1K string buffer, now long strings
+    // are in the arena so count both
+    Trace(2, "  value memory: %d bytes for %d values, %d bytes string arena",
+          valuesCreated * (int)sizeof(MslValue), valuesCreated,
+          MslStringArena::getArena()->getMemory());
 
     count = 0;
     for (MslError* obj = errorPool ; obj != nullptr ; obj = obj->next) count++;
@@ -82,6 +90,29 @@ void MslPools::traceStatistics()
     
 }
 
+/**
+ * Summarize what values and their strings cost, compared to
+ * values that carried their own string buffer.
+ * The counters are only written in the shell so reading them
+ * from the console is close enough.
+ */
+void MslPools::getMemoryStatistics(juce::StringArray& lines)
+{
+    MslStringArena* arena = MslStringArena::getArena();
+    int valueBytes = valuesCreated * (int)sizeof(MslValue);
+    int arenaBytes = arena->getMemory();
+    int oldBytes = valuesCreated * ((int)sizeof(MslValue) - MslValue::InlineString + MslValue::MaxString);
+
+    lines.add("Values: " + juce::String(valuesCreated) + " created, " +
+              juce::String(valuesRequested - valuesReturned) + " in use, " +
+              juce::String((int)sizeof(MslValue)) + " bytes each");
+    lines.add("Value memory: " + juce::String(valueBytes + arenaBytes) + " bytes, " +
+              juce::String(valueBytes) + " values " +
+              juce::String(arenaBytes) + " strings");
+    lines.add("With 1K string buffers: " + juce::String(oldBytes) + " bytes");
+    arena->getStatistics(lines);
+}
+
 void MslPools::initialize()
 {
     // todo: get initializes of these from a config
@@ -91,7 +122,7 @@ void MslPools::initialize()
 void MslPools::traceSizes()
 {
     Trace(2, "MslPools: object sizes");
-    Trace(2, "  MslValue: %d", sizeof(MslValue));
+    Trace(2, "  MslValue: %d", (int)sizeof(MslValue));
     Trace(2, "  MslError: %d", sizeof(MslError));
     Trace(2, "  MslResult: %d", sizeof(MslResult));
     Trace(2, "  MslBinding: %d", sizeof(MslBinding));
@@ -130,6 +161,7 @@ void MslPools::flushValues()
 MslValue* MslPools::allocValue()
 {
     MslValue* v = nullptr;
+    MslProfiler::countValue();
 
     if (valuePool != nullptr) {
         v = valuePool;
@@ -309,6 +341,7 @@ void MslPools::flushBindings()
 MslBinding* MslPools::allocBinding()
 {
     MslBinding* b = nullptr;
+    MslProfiler::countBinding();
 
     // todo: need a csect here
     if (bindingPool != nullptr) {
@@ -377,6 +410,7 @@ void MslPools::flushStacks()
 MslStack* MslPools::allocStack()
 {
     MslStack* s = nullptr;
+    MslProfiler::countStack();
     if (stackPool != nullptr) {
         s = stackPool;
         stackPool = stackPool->parent;
@@ -126,6 +126,9 @@ class MslPools
     void traceSizes();
     void traceStatistics();
 
+    // value and string memory, for the console
+    void getMemoryStatistics(juce::StringArray& lines);
+
   private:
 
     class MslEnvironment* environment = nullptr;
@@ -26,6 +26,7 @@ void MslProcess::poolInit()
     //context = MslContextNone;
     strcpy(name, "");
     triggerId = 0;
+    epoch = 0;
     session = nullptr;
 }
 
@@ -43,6 +44,7 @@ void MslProcess::copy(MslProcess* src)
     state = src->state;
     context = src->context;
     triggerId = src->triggerId;
+    epoch = src->epoch;
 
     // don't really need this
     strncpy(name, src->name, sizeof(name));
@@ -45,6 +45,10 @@ class MslProcess : public MslPooledObject
     // for correlating sustain and repeat actions
     int triggerId = 0;
 
+    // the kernel linkage table epoch when the session started
+    // nothing retired after this can be reclaimed while the process lives
+    int epoch = 0;
+
     void setName(const char* s);
     void copy(MslProcess* src);
 
@@ -0,0 +1,332 @@
+/**
+ * Implementation of the MSL profiler.
+ *
+ * Slots are assigned by name so a script that is edited and installed
+ * again keeps accumulating in the same place.  The body of a script uses
+ * the unit name, other functions are qualified with it.
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/Trace.h"
+
+#include "MslModel.h"
+#include "MslFunction.h"
+#include "MslCompilation.h"
+#include "MslProfiler.h"
+
+// the entry of the session running on this thread, if any
+static thread_local MslProfiler::Entry* ProfilerActive = nullptr;
+
+MslProfiler::MslProfiler()
+{
+}
+
+MslProfiler::~MslProfiler()
+{
+}
+
+void MslProfiler::Entry::reset()
+{
+    calls = 0;
+    statements = 0;
+    kernelRuns = 0;
+    shellRuns = 0;
+    kernelTicks = 0;
+    shellTicks = 0;
+    maxKernelTicks = 0;
+    transitions = 0;
+    waits = 0;
+    waitTicks = 0;
+    values = 0;
+    bindings = 0;
+    stacks = 0;
+}
+
+/**
+ * Only one thread runs a given session at a time, but two sessions from
+ * the same script may be running in both the kernel and the shell so the
+ * maximum has to be raised carefully.
+ */
+void MslProfiler::Entry::addRun(bool kernel, juce::int64 ticks)
+{
+    if (kernel) {
+        kernelRuns.fetch_add(1, std::memory_order_relaxed);
+        kernelTicks.fetch_add(ticks, std::memory_order_relaxed);
+        juce::int64 max = maxKernelTicks.load(std::memory_order_relaxed);
+        while (ticks > max &&
+               !maxKernelTicks.compare_exchange_weak(max, ticks, std::memory_order_relaxed)) {
+        }
+    }
+    else {
+        shellRuns.fetch_add(1, std::memory_order_relaxed);
+        shellTicks.fetch_add(ticks, std::memory_order_relaxed);
+    }
+}
+
+void MslProfiler::setActive(Entry* e)
+{
+    ProfilerActive = e;
+}
+
+MslProfiler::Entry* MslProfiler::getActive()
+{
+    return ProfilerActive;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Slots
+//
+//////////////////////////////////////////////////////////////////////
+
+juce::String MslProfiler::getName(MslCompilation* unit, MslFunction* f, bool body)
+{
+    juce::String unitName = (unit->name.length() > 0) ? unit->name : unit->id;
+    if (body)
+      return unitName;
+    else
+      return unitName + "." + f->name;
+}
+
+int MslProfiler::assign(juce::String name)
+{
+    int slot = -1;
+    if (slots.contains(name)) {
+        slot = slots[name];
+    }
+    else if (names.size() < MaxEntries) {
+        slot = names.size();
+        names.add(name);
+        slots.set(name, slot);
+    }
+    else if (!overflowed) {
+        Trace(1, "MslProfiler: Profile table is full");
+        overflowed = true;
+    }
+    return slot;
+}
+
+void MslProfiler::assign(MslCompilation* unit)
+{
+    MslFunction* body = unit->getBodyFunction();
+    if (body != nullptr)
+      body->profileSlot = assign(getName(unit, body, true));
+
+    for (auto f : unit->functions)
+      f->profileSlot = assign(getName(unit, f, false));
+}
+
+MslProfiler::Entry* MslProfiler::getEntry(MslFunction* f)
+{
+    Entry* e = nullptr;
+    if (f != nullptr && f->profileSlot >= 0 && isEnabled())
+      e = &(entries[f->profileSlot]);
+    return e;
+}
+
+void MslProfiler::reset(juce::Array<MslCompilation*>& units)
+{
+    for (int i = 0 ; i < MaxEntries ; i++)
+      entries[i].reset();
+
+    for (auto unit : units) {
+        MslFunction* body = unit->getBodyFunction();
+        if (body != nullptr)
+          reset(body->getBody());
+        for (auto f : unit->functions)
+          reset(f->getBody());
+    }
+}
+
+void MslProfiler::reset(MslNode* node)
+{
+    if (node != nullptr) {
+        node->visits = 0;
+        for (auto child : node->children)
+          reset(child);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Reports
+//
+//////////////////////////////////////////////////////////////////////
+
+juce::int64 MslProfiler::getSortValue(Entry* e, juce::String sort)
+{
+    juce::int64 value = 0;
+    if (sort == "calls")
+      value = e->calls;
+    else if (sort == "shell")
+      value = e->shellTicks;
+    else if (sort == "max")
+      value = e->maxKernelTicks;
+    else if (sort == "statements")
+      value = e->statements;
+    else if (sort == "transitions")
+      value = e->transitions;
+    else if (sort == "waits")
+      value = e->waitTicks;
+    else if (sort == "allocs")
+      value = e->values + e->bindings + e->stacks;
+    else
+      value = e->kernelTicks;
+    return value;
+}
+
+static juce::String formatMsec(juce::int64 ticks)
+{
+    double msec = juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    return juce::String(msec, 3);
+}
+
+void MslProfiler::report(juce::String sort, juce::StringArray& lines)
+{
+    juce::Array<int> order;
+    for (int i = 0 ; i < names.size() ; i++) {
+        Entry* e = &(entries[i]);
+        if (e->calls > 0 || e->kernelRuns > 0 || e->shellRuns > 0)
+          order.add(i);
+    }
+
+    // a simple insertion sort, there aren't many of these
+    for (int i = 1 ; i < order.size() ; i++) {
+        int slot = order[i];
+        juce::int64 value = getSortValue(&(entries[slot]), sort);
+        int j = i - 1;
+        while (j >= 0 && getSortValue(&(entries[order[j]]), sort) < value) {
+            order.set(j + 1, order[j]);
+            j--;
+        }
+        order.set(j + 1, slot);
+    }
+
+    if (order.size() == 0) {
+        lines.add("No profile data");
+    }
+    else {
+        lines.add("Function calls statements kernel(ms) max(ms) shell(ms) transitions waits wait(ms) values bindings stacks");
+        for (auto slot : order) {
+            Entry* e = &(entries[slot]);
+            juce::String line = names[slot] + " " +
+                juce::String(e->calls) + " " +
+                juce::String(e->statements) + " " +
+                formatMsec(e->kernelTicks) + " " +
+                formatMsec(e->maxKernelTicks) + " " +
+                formatMsec(e->shellTicks) + " " +
+                juce::String(e->transitions) + " " +
+                juce::String(e->waits) + " " +
+                formatMsec(e->waitTicks) + " " +
+                juce::String(e->values) + " " +
+                juce::String(e->bindings) + " " +
+                juce::String(e->stacks);
+            lines.add(line);
+        }
+    }
+}
+
+void MslProfiler::gatherStatements(juce::String unit, MslNode* node, juce::Array<Statement>& result)
+{
+    if (node != nullptr) {
+        int count = node->visits;
+        if (count > 0) {
+            Statement s;
+            s.unit = unit;
+            s.line = node->token.line;
+            s.column = node->token.column;
+            s.text = juce::String(node->getLogName()) + " " + node->token.value;
+            s.count = count;
+            result.add(s);
+        }
+        for (auto child : node->children)
+          gatherStatements(unit, child, result);
+    }
+}
+
+void MslProfiler::gatherStatements(juce::Array<MslCompilation*>& units, juce::Array<Statement>& result)
+{
+    for (auto unit : units) {
+        juce::String unitName = (unit->name.length() > 0) ? unit->name : unit->id;
+        MslFunction* body = unit->getBodyFunction();
+        if (body != nullptr)
+          gatherStatements(unitName, body->getBody(), result);
+        for (auto f : unit->functions)
+          gatherStatements(unitName, f->getBody(), result);
+    }
+}
+
+class StatementSorter
+{
+  public:
+    template <class T>
+    static int compareElements(const T& a, const T& b) {
+        return (a.count > b.count) ? -1 : ((a.count < b.count) ? 1 : 0);
+    }
+};
+
+void MslProfiler::reportStatements(juce::Array<MslCompilation*>& units, int max,
+                                   juce::StringArray& lines)
+{
+    juce::Array<Statement> statements;
+    gatherStatements(units, statements);
+    StatementSorter sorter;
+    statements.sort(sorter, true);
+
+    for (int i = 0 ; i < statements.size() && i < max ; i++) {
+        Statement& s = statements.getReference(i);
+        lines.add(juce::String(s.count) + " " + s.unit + ":" + juce::String(s.line) +
+                  ":" + juce::String(s.column) + " " + s.text);
+    }
+}
+
+/**
+ * The times are in microseconds so the numbers don't depend on
+ * the resolution of the platform's tick counter.
+ */
+juce::String MslProfiler::dump(juce::Array<MslCompilation*>& units)
+{
+    juce::Array<juce::var> functions;
+    for (int i = 0 ; i < names.size() ; i++) {
+        Entry* e = &(entries[i]);
+        juce::DynamicObject::Ptr obj = new juce::DynamicObject();
+        obj->setProperty("name", names[i]);
+        obj->setProperty("calls", e->calls.load());
+        obj->setProperty("statements", e->statements.load());
+        obj->setProperty("kernelRuns", e->kernelRuns.load());
+        obj->setProperty("kernelMicros", (juce::int64)(juce::Time::highResolutionTicksToSeconds(e->kernelTicks) * 1000000.0));
+        obj->setProperty("maxKernelMicros", (juce::int64)(juce::Time::highResolutionTicksToSeconds(e->maxKernelTicks) * 1000000.0));
+        obj->setProperty("shellRuns", e->shellRuns.load());
+        obj->setProperty("shellMicros", (juce::int64)(juce::Time::highResolutionTicksToSeconds(e->shellTicks) * 1000000.0));
+        obj->setProperty("transitions", e->transitions.load());
+        obj->setProperty("waits", e->waits.load());
+        obj->setProperty("waitMicros", (juce::int64)(juce::Time::highResolutionTicksToSeconds(e->waitTicks) * 1000000.0));
+        obj->setProperty("values", e->values.load());
+        obj->setProperty("bindings", e->bindings.load());
+        obj->setProperty("stacks", e->stacks.load());
+        functions.add(juce::var(obj.get()));
+    }
+
+    juce::Array<Statement> statements;
+    gatherStatements(units, statements);
+    juce::Array<juce::var> lines;
+    for (auto& s : statements) {
+        juce::DynamicObject::Ptr obj = new juce::DynamicObject();
+        obj->setProperty("unit", s.unit);
+        obj->setProperty("line", s.line);
+        obj->setProperty("column", s.column);
+        obj->setProperty("node", s.text);
+        obj->setProperty("count", s.count);
+        lines.add(juce::var(obj.get()));
+    }
+
+    juce::DynamicObject::Ptr root = new juce::DynamicObject();
+    root->setProperty("functions", functions);
+    root->setProperty("statements", lines);
+    return juce::JSON::toString(juce::var(root.get()));
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,162 @@
+/**
+ * Optional execution statistics for MSL scripts.
+ *
+ * When enabled, sessions record what they do against the script they
+ * started from: how many times it ran, how long it spent running in
+ * the kernel and the shell, the longest single run in the kernel,
+ * statements evaluated, transitions, time spent waiting, and objects taken
+ * from the pools.  Calls to functions in other scripts or within the same
+ * script are counted against those functions.  Each node in the parse
+ * tree also counts how many times it was evaluated so the busiest
+ * statements can be found.
+ *
+ * Every function is given a slot in a fixed table when its unit is
+ * installed, which happens in the shell.  After that the counters are
+ * atomics updated with relaxed ordering so the kernel can record without
+ * locking or allocating.  Reading the table in the middle of a run may
+ * see one counter updated and not another, that's fine for a profile.
+ *
+ * Pool allocations are attributed through a thread local pointer set
+ * while a session is running so MslPools doesn't need to know about
+ * sessions.
+ *
+ * The report is built in the shell for MobiusConsole.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class MslProfiler
+{
+  public:
+
+    /**
+     * The number of functions that can be profiled.  Anything
+     * installed after this fills up is not counted.
+     */
+    static const int MaxEntries = 512;
+
+    class Entry
+    {
+      public:
+        std::atomic<int> calls {0};
+        std::atomic<int> statements {0};
+        std::atomic<int> kernelRuns {0};
+        std::atomic<int> shellRuns {0};
+        std::atomic<juce::int64> kernelTicks {0};
+        std::atomic<juce::int64> shellTicks {0};
+        std::atomic<juce::int64> maxKernelTicks {0};
+        std::atomic<int> transitions {0};
+        std::atomic<int> waits {0};
+        std::atomic<juce::int64> waitTicks {0};
+        std::atomic<int> values {0};
+        std::atomic<int> bindings {0};
+        std::atomic<int> stacks {0};
+
+        void reset();
+        void addRun(bool kernel, juce::int64 ticks);
+    };
+
+    MslProfiler();
+    ~MslProfiler();
+
+    void setEnabled(bool b) {
+        enabled.store(b);
+    }
+
+    bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Give the functions in a unit their slots.  Shell only.
+     */
+    void assign(class MslCompilation* unit);
+
+    /**
+     * The entry for a function, or nullptr if it doesn't have one or
+     * profiling is off.
+     */
+    Entry* getEntry(class MslFunction* f);
+
+    /**
+     * Clear all the counters, including the ones on the nodes of
+     * the units passed.
+     */
+    void reset(juce::Array<class MslCompilation*>& units);
+
+    //
+    // Attribution of pool allocations
+    //
+
+    static void setActive(Entry* e);
+    static Entry* getActive();
+
+    static void countValue() {
+        Entry* e = getActive();
+        if (e != nullptr) e->values.fetch_add(1, std::memory_order_relaxed);
+    }
+    static void countBinding() {
+        Entry* e = getActive();
+        if (e != nullptr) e->bindings.fetch_add(1, std::memory_order_relaxed);
+    }
+    static void countStack() {
+        Entry* e = getActive();
+        if (e != nullptr) e->stacks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //
+    // Reports
+    //
+
+    /**
+     * Add lines for the function table, sorted by one of the column names:
+     * calls, kernel, shell, max, statements, transitions, waits, allocs.
+     * Default is kernel time.
+     */
+    void report(juce::String sort, juce::StringArray& lines);
+
+    /**
+     * Add lines for the most evaluated statements in the units.
+     */
+    void reportStatements(juce::Array<class MslCompilation*>& units, int max,
+                          juce::StringArray& lines);
+
+    /**
+     * Everything as JSON.
+     */
+    juce::String dump(juce::Array<class MslCompilation*>& units);
+
+  private:
+
+    std::atomic<bool> enabled {false};
+
+    Entry entries[MaxEntries];
+
+    // shell only
+    juce::StringArray names;
+    juce::HashMap<juce::String,int> slots;
+    bool overflowed = false;
+
+    int assign(juce::String name);
+    juce::String getName(class MslCompilation* unit, class MslFunction* f, bool body);
+    juce::int64 getSortValue(Entry* e, juce::String sort);
+
+    class Statement
+    {
+      public:
+        juce::String unit;
+        int line = 0;
+        int column = 0;
+        juce::String text;
+        int count = 0;
+    };
+    void gatherStatements(juce::String unit, class MslNode* node, juce::Array<Statement>& result);
+    void gatherStatements(juce::Array<class MslCompilation*>& units, juce::Array<Statement>& result);
+    void reset(class MslNode* node);
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
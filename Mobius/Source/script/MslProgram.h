@@ -0,0 +1,92 @@
+/**
+ * Compiled form of a section of the MSL parse tree.
+ *
+ * MslSession evaluates scripts by walking the node tree, pushing a stack
+ * frame for every node and passing pooled MslValues up through them.  That
+ * is necessary for anything that can wait, transition between the shell and
+ * the kernel, or call out to the application, but most of what a script does
+ * between those points is arithmetic, comparisons and local variables.
+ *
+ * After linking, MslCompiler looks for subtrees that contain only those
+ * things and lowers them into a flat list of instructions for MslMachine.
+ * The program is left on the root node of the subtree and when the session
+ * reaches that node it runs the program in one step rather than walking it.
+ * Everything else is still walked, so the places where a session can
+ * suspend are exactly where they were.
+ *
+ * Variable references are collected into slots.  These are resolved once
+ * each time the program starts, and instructions then refer to them by index.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+typedef enum {
+
+    // push a constant
+    MslOpPushInt,
+    MslOpPushBool,
+    MslOpPushString,
+    MslOpPushNull,
+    // push nothing at all, the result of an assignment or empty block
+    MslOpPushVoid,
+
+    // push the value of a slot
+    MslOpLoad,
+    // pop a value into a slot and push void
+    MslOpStore,
+
+    // pop one or two operands, apply an MslOperators code, push the result
+    MslOpOperator,
+
+    // discard the top of the stack
+    MslOpPop,
+
+    // unconditional and pop-and-test branches to an instruction index
+    MslOpJump,
+    MslOpJumpFalse
+    
+} MslOpcode;
+
+class MslInstruction
+{
+  public:
+    MslOpcode op = MslOpPushNull;
+    int operand = 0;
+};
+
+class MslProgram
+{
+  public:
+
+    MslProgram() {}
+    ~MslProgram() {}
+
+    /**
+     * A variable referenced by the program.  The name is looked up
+     * in the stack bindings first like MslSymbolNode does.  If there is no
+     * binding the static variable the linker found is used.
+     */
+    class Slot
+    {
+      public:
+        juce::String name;
+        int nameId = 0;
+        class MslVariable* staticVariable = nullptr;
+    };
+    
+    juce::Array<MslInstruction> code;
+    juce::StringArray constants;
+    juce::Array<Slot> slots;
+
+    // the most values on the operand stack at any point
+    int maxDepth = 0;
+
+    // number of nodes this replaced, for the console
+    int nodes = 0;
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -23,6 +23,7 @@
 #include "MslExternal.h"
 #include "MslCompilation.h"
 #include "MslEnvironment.h"
+#include "MslProgram.h"
 
 #include "MslSession.h"
 
@@ -231,11 +232,14 @@ int MslSession::getTriggerId()
  */
 void MslSession::reset()
 {
+    generation++;
     context = nullptr;
     linkage = nullptr;
     unit = nullptr;
     process = nullptr;
     triggerId = 0;
+    profile = nullptr;
+    profileWaitStart = 0;
 
     pool->freeList(stack);
     stack = nullptr;
@@ -279,7 +283,9 @@ void MslSession::run(MslContext* argContext, MslCompilation* argUnit, MslBinding
 
     context = argContext;
     unit = argUnit;
+    epoch = environment->getKernelEpoch();
     defaultScope = argContext->mslGetFocusedScope();
+    profile = environment->getProfiler()->getEntry(argUnit->getBodyFunction());
     
     stack = pool->allocStack();
     stack->node = node;
@@ -297,7 +303,9 @@ void MslSession::start(MslContext* argContext, MslLinkage* argLink, MslRequest*
 
     context = argContext;
     linkage = argLink;
-    unit = argLink->unit;
+    // the kernel may not have adopted the latest linkages yet
+    unit = environment->getUnit(argContext, argLink);
+    epoch = environment->getKernelEpoch();
     defaultScope = request->scope;
     if (defaultScope == 0)
       defaultScope = argContext->mslGetFocusedScope();
@@ -305,8 +313,16 @@ void MslSession::start(MslContext* argContext, MslLinkage* argLink, MslRequest*
     // remember this for later when making the MslProcess
     triggerId = request->triggerId;
     
+    MslFunction* function = environment->getFunction(argContext, argLink);
+    profile = environment->getProfiler()->getEntry(function);
+    if (profile != nullptr)
+      profile->calls.fetch_add(1, std::memory_order_relaxed);
+
     stack = pool->allocStack();
-    stack->node = argLink->function->getBody();
+    if (function != nullptr)
+      stack->node = function->getBody();
+    else
+      addError("Function not yet available to this context");
     stack->bindings = gatherStartBindings(request);
     
     run();
@@ -919,10 +935,22 @@ void MslSession::run()
 {
     //if (stack != nullptr)
     //aTrace(2, "Run: %s", debugNode(stack->node).toUTF8());
+
+    juce::int64 startTicks = 0;
+    if (profile != nullptr) {
+        startTicks = juce::Time::getHighResolutionTicks();
+        MslProfiler::setActive(profile);
+    }
     
     while (stack != nullptr && errors == nullptr && !transitioning && !isWaitActive()) {
         advanceStack();
     }
+
+    if (profile != nullptr) {
+        MslProfiler::setActive(nullptr);
+        profile->addRun(context->mslGetContextId() == MslContextKernel,
+                        juce::Time::getHighResolutionTicks() - startTicks);
+    }
 }
 
 /**
@@ -962,8 +990,18 @@ bool MslSession::isWaitActive()
 void MslSession::advanceStack()
 {
     if (stack->node != nullptr) {
-        // warp to a node-specific handler
-        stack->node->visit(this);
+        // a compiled subtree runs in one step if we haven't started walking it,
+        // if the machine declines the node is walked as usual
+        MslProgram* program = stack->node->program;
+        if (program != nullptr && stack->phase == 0 && stack->childIndex < 0 &&
+            !stack->accumulator && environment->isBytecode() &&
+            machine.run(this, program)) {
+            // the frame has been popped with the result
+        }
+        else {
+            // warp to a node-specific handler
+            stack->node->visit(this);
+        }
     }
     else {
         // here is where we might add special stack frames that are not
@@ -981,6 +1019,12 @@ MslStack* MslSession::pushStack(MslNode* node)
     logNode("pushStack", node);
     MslStack* neu = pool->allocStack();
 
+    if (profile != nullptr) {
+        profile->statements.fetch_add(1, std::memory_order_relaxed);
+        if (node != nullptr)
+          node->visits.fetch_add(1, std::memory_order_relaxed);
+    }
+
     neu->node = node;
     neu->parent = stack;
     
@@ -1135,6 +1179,27 @@ MslBinding* MslSession::findBinding(const char* name)
     return found;
 }
 
+/**
+ * Walk up the stack looking for the binding of a linked reference.
+ * Bindings created for linked variables and arguments are matched on
+ * the name id alone.
+ */
+MslBinding* MslSession::findBinding(int nameId, const char* name)
+{
+    MslBinding* found = nullptr;
+
+    MslStack* level = stack;
+    while (found == nullptr && level != nullptr) {
+        if (level->bindings != nullptr)
+          found = level->bindings->find(nameId, name);
+
+        if (found == nullptr)
+          level = level->parent;
+    }
+    
+    return found;
+}
+
 MslBinding* MslSession::findBinding(int position)
 {
     MslBinding* found = nullptr;
@@ -1171,34 +1236,40 @@ void MslSession::getVariable(const char* name, MslValue* dest)
         dest->copy(binding->value);
     }
     else {
-        juce::String jname(name);
-
         // look for static non-public variables in this unit
+        // comparing juce::String with a char* doesn't allocate
         MslVariable* found = nullptr;
         for (auto var : unit->variables) {
-            if (var->name == jname) {
+            if (var->name == name) {
                 found = var;
                 break;
             }
         }
+        if (found == nullptr) {
+            // exported variables from other scripts that this one references
+            // were left by the linker
+            for (auto& ref : unit->linkedReferences) {
+                if (ref.name == name) {
+                    found = environment->getVariable(context, ref.linkage);
+                    break;
+                }
+            }
+        }
+        if (found == nullptr) {
+            // something the script never mentions, the environment can still
+            // find it but this builds strings and hashes, it is rare enough
+            // not to be worth an index
+            juce::String jname(name);
+            MslLinkage* link = environment->find(unit, jname);
+            if (link != nullptr)
+              found = environment->getVariable(context, link);
+        }
+        
         if (found != nullptr) {
             // !! supposed to have a csect around this which means
             // we really should be copying
             found->getValue(getEffectiveScope(), dest);
         }
-        else {
-            // MslSymbolNode evaluation will at this point look for an
-            // MslResolution that may have an MslLinksge to an exported
-            // variable from another script.  We can't do pre-resolution
-            // but it's a small amount of overhead.
-
-            MslLinkage* link = environment->find(unit, jname);
-            if (link != nullptr && link->variable != nullptr) {
-
-                // !! also supposed to be csect protected
-                link->variable->getValue(getEffectiveScope(), dest);
-            }
-        }
     }
 }
 
@@ -1225,8 +1296,8 @@ void MslSession::mslVisit(MslLiteralNode* lit)
         // could be a bit more relaxed here but this is what the tokanizer left
         v->setBool(lit->token.value == "true");
     }
-    else {
-        v->setJString(lit->token.value);
+    else if (!v->setJString(lit->token.value)) {
+        addError(lit, "Out of string storage");
     }
 
     popStack(v);
@@ -1338,6 +1409,7 @@ void MslSession::mslVisit(MslVariableNode* var)
                 else {
                     MslBinding* b = pool->allocBinding();
                     b->setName(var->name.toUTF8());
+                    b->nameId = var->nameId;
                     // value ownership transfers
                     b->value = stack->childResults;
                     stack->childResults = nullptr;
@@ -1504,7 +1576,8 @@ void MslSession::returnBinding(MslBinding* binding)
     else {
         // bindings can be referenced multiple times, so need to copy
         copy = pool->allocValue();
-        copy->copy(value);
+        if (!copy->copy(value))
+          addError("Out of string storage");
     }
     popStack(copy);
 }
@@ -1616,84 +1689,91 @@ void MslSession::doOperator(MslOperatorNode* opnode)
               addError(opnode, "Missing operand");
         }
             
-        if (errors == nullptr) {
+        if (errors == nullptr)
+          applyOperator(op, value1, value2, v);
+    }
     
-            switch (op) {
-                case MslUnknown:
-                    // already added an error
-                    break;
-                case MslPlus:
-                    addTwoThings(value1, value2, v);
-                    break;
-                case MslMinus:
-                    v->setInt(value1->getInt() - value2->getInt());
-                    break;
-                case MslMult:
-                    v->setInt(value1->getInt() * value2->getInt());
-                    break;
-                case MslDiv: {
-                    int divisor = value2->getInt();
-                    if (divisor == 0) {
-                        // we're obviously not going to throw if they made an error
-                        v->setInt(0);
-                        // should be a warning
-                        Trace(1, "MslSession: divide by zero");
-                        //addError(opnode, "Divide by zero");
-                    }
-                    else {
-                        v->setInt(value1->getInt() / divisor);
-                    }
-                }
-                    break;
+    popStack(v);
+}
 
-                    // for direct comparison, be smarter about coercion
-                    // = and == are the same right now, but that probably won't work
-                case MslEq:
-                    v->setBool(compare(value1, value2, true));
-                    break;
-                case MslDeq:
-                    v->setBool(compare(value1, value2, true));
-                    break;
-            
-                case MslNeq:
-                    v->setBool(compare(value2, value2, false));
-                    break;
-            
-                case MslGt:
-                    v->setInt(value1->getInt() > value2->getInt());
-                    break;
-                case MslGte:
-                    v->setBool(value1->getInt() >= value2->getInt());
-                    break;
-                case MslLt:
-                    v->setBool(value1->getInt() < value2->getInt());
-                    break;
-                case MslLte:
-                    v->setBool(value1->getInt() <= value2->getInt());
-                    break;
-                case MslNot:
-                    // here we check to make sure the node only has one child
-                    v->setBool(!(value1->getBool()));
-                    break;
-                case MslAnd:
-                    // c++ won't evaluate the second arg if the first one is false
-                    // msl doesn't do deferred evaluation so no, we don't
-                    v->setBool(value1->getBool() && value2->getBool());
-                    break;
-                case MslOr:
-                    // c++ won't evaluate the second arg if the first one is true
-                    v->setBool(value1->getBool() || value2->getBool());
-                    break;
-            
-                    // unclear about this, treat it as and
-                    //case MslAmp:
-                    //v->setInt(value1->getBool() && value2->getBool());
-                    //break;
+/**
+ * Apply an operator to one or two values.  Shared with MslMachine so
+ * compiled expressions coerce exactly the same way.
+ */
+void MslSession::applyOperator(MslOperators op, MslValue* value1, MslValue* value2, MslValue* v)
+{
+    switch (op) {
+        case MslUnknown:
+            // already added an error
+            break;
+        case MslPlus:
+            addTwoThings(value1, value2, v);
+            break;
+        case MslMinus:
+            v->setInt(value1->getInt() - value2->getInt());
+            break;
+        case MslMult:
+            v->setInt(value1->getInt() * value2->getInt());
+            break;
+        case MslDiv: {
+            int divisor = value2->getInt();
+            if (divisor == 0) {
+                // we're obviously not going to throw if they made an error
+                v->setInt(0);
+                // should be a warning
+                Trace(1, "MslSession: divide by zero");
+                //addError(opnode, "Divide by zero");
+            }
+            else {
+                v->setInt(value1->getInt() / divisor);
             }
         }
-    }
+            break;
+
+            // for direct comparison, be smarter about coercion
+            // = and == are the same right now, but that probably won't work
+        case MslEq:
+            v->setBool(compare(value1, value2, true));
+            break;
+        case MslDeq:
+            v->setBool(compare(value1, value2, true));
+            break;
     
-    popStack(v);
+        case MslNeq:
+            v->setBool(compare(value2, value2, false));
+            break;
+    
+        case MslGt:
+            v->setInt(value1->getInt() > value2->getInt());
+            break;
+        case MslGte:
+            v->setBool(value1->getInt() >= value2->getInt());
+            break;
+        case MslLt:
+            v->setBool(value1->getInt() < value2->getInt());
+            break;
+        case MslLte:
+            v->setBool(value1->getInt() <= value2->getInt());
+            break;
+        case MslNot:
+            // here we check to make sure the node only has one child
+            v->setBool(!(value1->getBool()));
+            break;
+        case MslAnd:
+            // c++ won't evaluate the second arg if the first one is false
+            // msl doesn't do deferred evaluation so no, we don't
+            v->setBool(value1->getBool() && value2->getBool());
+            break;
+        case MslOr:
+            // c++ won't evaluate the second arg if the first one is true
+            v->setBool(value1->getBool() || value2->getBool());
+            break;
+    
+            // unclear about this, treat it as and
+            //case MslAmp:
+            //v->setInt(value1->getBool() && value2->getBool());
+            //break;
+    }
 }
 
 /**
@@ -1713,7 +1793,8 @@ void MslSession::addTwoThings(MslValue* v1, MslValue* v2, MslValue* res)
         char merged[128];
         // hello darkness my old friend
         snprintf(merged, sizeof(merged), "%s%s", v1->getString(), v2->getString());
-        res->setString(merged);
+        if (!res->setString(merged))
+          addError("Out of string storage");
     }
     else {
         res->setInt(v1->getInt() + v2->getInt());
@@ -2035,6 +2116,12 @@ void MslSession::mslVisit(MslWaitNode* wait)
                 // reached normally, might want options on how to handle this
                 Trace(2, "MslSession: Wait event was canceled");
             }
+
+            if (profile != nullptr && profileWaitStart > 0) {
+                profile->waitTicks.fetch_add(juce::Time::getHighResolutionTicks() - profileWaitStart,
+                                             std::memory_order_relaxed);
+                profileWaitStart = 0;
+            }
             
             stack->wait.init();
             popStack();
@@ -2161,6 +2248,10 @@ void MslSession::setupWait(MslWaitNode* node)
             else {
                 // make it go, or rather stop
                 wait->active = true;
+                if (profile != nullptr) {
+                    profile->waits.fetch_add(1, std::memory_order_relaxed);
+                    profileWaitStart = juce::Time::getHighResolutionTicks();
+                }
             }
         }
     }
@@ -2455,7 +2546,10 @@ void MslSession::mslVisit(MslKeywordNode* key)
     logVisit(key);
 
     MslValue* v = pool->allocValue();
-    v->setKeyword(key->name.toUTF8());
+    if (key->nameId > 0)
+      v->setKeywordId(key->nameId);
+    else if (!v->setKeyword(key->name.toUTF8()))
+      addError(key, "Out of string storage");
     
     popStack(v);
 }
@@ -25,6 +25,8 @@
 #include "MslWait.h"
 #include "MslContext.h"
 #include "MslConstants.h"
+#include "MslMachine.h"
+#include "MslProfiler.h"
 
 /**
  * Enumeration of the various notifications suspended scripts may
@@ -122,6 +124,7 @@ class MslSession : public MslVisitor, public MslSessionInterface
     friend class MslEnvironment;
     friend class MslConductor;
     friend class MslPools;
+    friend class MslMachine;
     
   public:
     
@@ -223,6 +226,16 @@ class MslSession : public MslVisitor, public MslSessionInterface
     int getSessionId();
     int getTriggerId();
 
+    // the kernel linkage table epoch when this started
+    int getEpoch() {return epoch;}
+
+    // changes every time the session is reset, for things that hold
+    // onto a pooled session and need to know if it was reused
+    int getGeneration() {return generation;}
+
+    // where this session records statistics, nullptr unless profiling
+    MslProfiler::Entry* getProfile() {return profile;}
+
     // StandardLibrary support
     MslContext* getContext() {return context;}
     MslEnvironment* getEnvironment() {return environment;}
@@ -250,6 +263,16 @@ class MslSession : public MslVisitor, public MslSessionInterface
     // move it to the MslProcess if this suspends
     int triggerId = 0;
 
+    // see MslEnvironment::reclaim
+    int epoch = 0;
+
+    // see getGeneration
+    int generation = 0;
+
+    // set when the session started while MslProfiler was enabled
+    MslProfiler::Entry* profile = nullptr;
+    juce::int64 profileWaitStart = 0;
+
     // the default scope identifier
     // this is the scope we are "in" until the scope is explicitly
     // overridden
@@ -257,6 +280,9 @@ class MslSession : public MslVisitor, public MslSessionInterface
     
     class MslStack* stack = nullptr;
 
+    // runs compiled expressions
+    MslMachine machine;
+
     // set true during evaluation to transition to the other side
     bool transitioning = false;
 
@@ -314,6 +340,7 @@ class MslSession : public MslVisitor, public MslSessionInterface
 
     // bindings
     MslBinding* findBinding(const char* name);
+    MslBinding* findBinding(int nameId, const char* name);
     MslBinding* findBinding(int position);
     void returnBinding(MslBinding* binding);
 
@@ -321,6 +348,8 @@ class MslSession : public MslVisitor, public MslSessionInterface
     // implementation broken out to MslSymbol.cpp
     void returnUnresolved(MslSymbolNode* snode);
     void returnLinkedVariable(MslSymbolNode* snode);
+    bool isFunction(MslSymbolNode* snode);
+    class MslBlockNode* getBody(MslSymbolNode* snode);
     void returnStaticVariable(MslSymbolNode* snode);
     void returnKeyword(MslSymbolNode* snode);
     void pushArguments(MslSymbolNode* snode);
@@ -341,6 +370,7 @@ class MslSession : public MslVisitor, public MslSessionInterface
     // expressions
     MslValue* getArgument(int index);
     void doOperator(MslOperatorNode* opnode);
+    void applyOperator(MslOperators op, MslValue* value1, MslValue* value2, MslValue* result);
     bool compare(MslValue* value1, MslValue* value2, bool equal);
     void addTwoThings(MslValue* v1, MslValue* v2, MslValue* result);
 
@@ -0,0 +1,266 @@
+/**
+ * Implementation of the MslValue string arena.
+ *
+ * The initial block counts are enough for the strings the standard scripts
+ * hold at one time with plenty to spare.  If they're wrong the statistics at
+ * shutdown will say so.
+ */
+
+#include <JuceHeader.h>
+
+#include "../util/Trace.h"
+
+#include "MslStringArena.h"
+
+/**
+ * Blocks in each slab, the arena starts with one slab of each size.
+ */
+const int ArenaSlabSmall = 512;
+const int ArenaSlabMedium = 128;
+const int ArenaSlabLarge = 16;
+
+/**
+ * Fluff adds slabs while fewer than this fraction of a slab are free.
+ * Half a slab is more than the standard scripts take between two
+ * shell advances.
+ */
+const int ArenaLowWater = 2;
+
+/**
+ * Created the first time a value needs a long string or something
+ * is interned, which will be in the shell during startup.
+ */
+MslStringArena* MslStringArena::getArena()
+{
+    static MslStringArena* arena = new MslStringArena();
+    return arena;
+}
+
+MslStringArena::MslStringArena()
+{
+    classes[0].size = SmallBlock;
+    classes[0].slabBlocks = ArenaSlabSmall;
+    classes[1].size = MediumBlock;
+    classes[1].slabBlocks = ArenaSlabMedium;
+    classes[2].size = LargeBlock;
+    classes[2].slabBlocks = ArenaSlabLarge;
+
+    for (int i = 0 ; i < MaxInterned ; i++)
+      interned[i] = nullptr;
+
+    for (int i = 0 ; i < SizeClasses ; i++) {
+        for (int j = 0 ; j < MaxSlabs ; j++)
+          classes[i].slabs[j] = nullptr;
+        addSlab(i);
+    }
+}
+
+/**
+ * Not expected to be called, values can outlive static destruction.
+ */
+MslStringArena::~MslStringArena()
+{
+}
+
+MslStringArena::Block* MslStringArena::getBlock(SizeClass& sc, int index)
+{
+    int stride = (int)sizeof(Block) + sc.size;
+    char* slab = sc.slabs[index / sc.slabBlocks];
+    return reinterpret_cast<Block*>(slab + ((index % sc.slabBlocks) * stride));
+}
+
+/**
+ * The slab pointer is set before the count is raised and before
+ * any of its blocks are pushed, so anyone who pops one can find it.
+ */
+void MslStringArena::addSlab(int sizeClass)
+{
+    SizeClass& sc = classes[sizeClass];
+    int slab = sc.slabCount.load();
+    if (slab >= MaxSlabs) {
+        Trace(1, "MslStringArena: No more slabs for size class %d", sc.size);
+    }
+    else {
+        int stride = (int)sizeof(Block) + sc.size;
+        sc.slabs[slab] = new char[(size_t)(stride * sc.slabBlocks)];
+        sc.slabCount.store(slab + 1);
+        for (int i = 0 ; i < sc.slabBlocks ; i++) {
+            Block* b = new (sc.slabs[slab] + (i * stride)) Block();
+            b->sizeClass = sizeClass;
+            b->index = (slab * sc.slabBlocks) + i;
+            push(sc, b);
+        }
+    }
+}
+
+MslStringArena::Block* MslStringArena::pop(SizeClass& sc)
+{
+    Block* b = nullptr;
+    juce::uint64 old = sc.head.load(std::memory_order_acquire);
+    while (true) {
+        int top = (int)(old & 0xFFFFFFFF);
+        if (top == 0)
+          break;
+        Block* candidate = getBlock(sc, top - 1);
+        juce::uint64 next = (juce::uint64)(juce::uint32)candidate->next.load(std::memory_order_relaxed);
+        juce::uint64 neu = (((old >> 32) + 1) << 32) | next;
+        if (sc.head.compare_exchange_weak(old, neu, std::memory_order_acq_rel,
+                                          std::memory_order_acquire)) {
+            b = candidate;
+            sc.available--;
+            break;
+        }
+    }
+    return b;
+}
+
+void MslStringArena::push(SizeClass& sc, Block* b)
+{
+    juce::uint64 old = sc.head.load(std::memory_order_relaxed);
+    juce::uint64 neu;
+    do {
+        b->next.store((int)(old & 0xFFFFFFFF), std::memory_order_relaxed);
+        neu = (((old >> 32) + 1) << 32) | (juce::uint64)(b->index + 1);
+    }
+    while (!sc.head.compare_exchange_weak(old, neu, std::memory_order_release,
+                                          std::memory_order_relaxed));
+    sc.available++;
+}
+
+/**
+ * A string that doesn't fit the class it wants can use a larger one,
+ * but once all of them are empty the caller has to make do.
+ */
+char* MslStringArena::alloc(int size)
+{
+    char* result = nullptr;
+    for (int i = 0 ; i < SizeClasses && result == nullptr ; i++) {
+        SizeClass& sc = classes[i];
+        if (size <= sc.size) {
+            Block* b = pop(sc);
+            if (b != nullptr) {
+                int used = ++sc.inUse;
+                if (used > sc.maxInUse.load())
+                  sc.maxInUse.store(used);
+                result = reinterpret_cast<char*>(b) + sizeof(Block);
+            }
+            else {
+                sc.panics++;
+            }
+        }
+    }
+    if (result == nullptr)
+      failures++;
+    return result;
+}
+
+void MslStringArena::free(char* s)
+{
+    if (s != nullptr) {
+        Block* b = reinterpret_cast<Block*>(s - sizeof(Block));
+        SizeClass& sc = classes[b->sizeClass];
+        sc.inUse--;
+        push(sc, b);
+    }
+}
+
+/**
+ * Called periodically by MslEnvironment in the shell.
+ */
+void MslStringArena::fluff()
+{
+    for (int i = 0 ; i < SizeClasses ; i++) {
+        SizeClass& sc = classes[i];
+        while (sc.available.load() < (sc.slabBlocks / ArenaLowWater) &&
+               sc.slabCount.load() < MaxSlabs) {
+            Trace(2, "MslStringArena: Extending size class %d", sc.size);
+            addSlab(i);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Interned Strings
+//
+//////////////////////////////////////////////////////////////////////
+
+int MslStringArena::intern(const char* s)
+{
+    int id = 0;
+    if (s != nullptr && strlen(s) > 0) {
+        const juce::ScopedLock lock(criticalSection);
+        juce::String key(s);
+        id = internMap[key];
+        if (id == 0) {
+            int count = internedCount.load();
+            if (count >= MaxInterned) {
+                Trace(1, "MslStringArena: Interned string table is full");
+            }
+            else {
+                size_t length = strlen(s) + 1;
+                char* copy = new char[length];
+                strcpy(copy, s);
+                interned[count] = copy;
+                internedBytes += (int)length;
+                // ids start from 1 so zero can mean not interned
+                id = count + 1;
+                internMap.set(key, id);
+                internedCount.store(count + 1);
+            }
+        }
+    }
+    return id;
+}
+
+const char* MslStringArena::getInterned(int id)
+{
+    const char* s = nullptr;
+    if (id > 0 && id <= internedCount.load())
+      s = interned[id - 1];
+    return s;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Statistics
+//
+//////////////////////////////////////////////////////////////////////
+
+int MslStringArena::getMemory()
+{
+    const juce::ScopedLock lock(criticalSection);
+    int total = internedBytes;
+    for (int i = 0 ; i < SizeClasses ; i++) {
+        SizeClass& sc = classes[i];
+        total += sc.slabCount.load() * sc.slabBlocks * (sc.size + (int)sizeof(Block));
+    }
+    return total;
+}
+
+void MslStringArena::getStatistics(juce::StringArray& lines)
+{
+    lines.add("String arena: " + juce::String(getMemory()) + " bytes, " +
+              juce::String(internedCount.load()) + " interned strings, " +
+              juce::String(failures.load()) + " strings not stored");
+    for (int i = 0 ; i < SizeClasses ; i++) {
+        SizeClass& sc = classes[i];
+        lines.add("  " + juce::String(sc.size) + " byte blocks: " +
+                  juce::String(sc.slabCount.load() * sc.slabBlocks) + " allocated " +
+                  juce::String(sc.inUse.load()) + " in use " +
+                  juce::String(sc.maxInUse.load()) + " maximum " +
+                  juce::String(sc.panics.load()) + " exhausted");
+    }
+}
+
+void MslStringArena::traceStatistics()
+{
+    juce::StringArray lines;
+    getStatistics(lines);
+    for (auto line : lines)
+      Trace(2, "MslStringArena: %s", line.toUTF8());
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,145 @@
+/**
+ * String storage for MslValue.
+ *
+ * MslValue used to carry a 1K character buffer so any value could hold
+ * any string without allocating.  Almost all values are numbers, booleans,
+ * enums and keywords though, so the pools were mostly empty buffers.  Values
+ * now keep short strings inline, and take longer ones from here.
+ *
+ * The arena has a few size classes of preallocated blocks kept on free lists.
+ * Blocks go back to the list they came from when the value is cleared.
+ * Values are used by the shell and the kernel at the same time, so the lists
+ * are lock free stacks.  Blocks are carved out of fixed size slabs and the
+ * lists link them by index, with a counter packed next to the top index so
+ * a block that is popped and pushed again between another thread's read and
+ * compare can't be mistaken for the one it saw.
+ *
+ * Neither alloc nor free ever allocate.  If a list runs dry, alloc tries
+ * the next larger size and then gives up, and the value is left without
+ * a string.  The shell adds slabs in fluff() when a list gets low, well
+ * before it runs dry.
+ *
+ * There is also a table of interned strings for names that are known
+ * before anything runs: keywords found by the linker and parameter enumeration
+ * names.  These are added by the shell and never removed, so values can
+ * refer to them by id without copying anything.
+ *
+ * There is one arena for the application since values are used well
+ * outside the MSL environment.  It is never deleted.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class MslStringArena
+{
+  public:
+
+    /**
+     * Block sizes including the terminator.  The largest must match
+     * MslValue::MaxString.
+     */
+    static const int SmallBlock = 32;
+    static const int MediumBlock = 128;
+    static const int LargeBlock = 1024;
+
+    static const int MaxInterned = 4096;
+
+    static MslStringArena* getArena();
+
+    /**
+     * Return a block that can hold at least this many characters
+     * including the terminator, nullptr if it is too large.
+     */
+    char* alloc(int size);
+
+    void free(char* s);
+
+    /**
+     * Shell only.  Add blocks to any size class that is running low.
+     */
+    void fluff();
+
+    /**
+     * Shell only.  Return the id of a permanent copy of a string,
+     * zero if the table is full.
+     */
+    int intern(const char* s);
+
+    const char* getInterned(int id);
+
+    /**
+     * Total bytes held by the arena, including blocks in use.
+     */
+    int getMemory();
+
+    /**
+     * Describe the arena one line per size class, for the
+     * console and the shutdown trace.
+     */
+    void getStatistics(juce::StringArray& lines);
+    
+    void traceStatistics();
+
+  private:
+
+    MslStringArena();
+    ~MslStringArena();
+
+    /**
+     * Header in front of each block.  The link is the index of the next
+     * free block plus one so zero can be the end of the list.
+     */
+    class Block
+    {
+      public:
+        std::atomic<int> next {0};
+        int sizeClass = 0;
+        int index = 0;
+        int pad = 0;
+    };
+
+    static const int MaxSlabs = 32;
+
+    class SizeClass
+    {
+      public:
+        int size = 0;
+        int slabBlocks = 0;
+        char* slabs[MaxSlabs];
+        std::atomic<int> slabCount {0};
+        // top of the free list, the low half is the top index plus one
+        // and the high half counts changes
+        std::atomic<juce::uint64> head {0};
+        std::atomic<int> available {0};
+        std::atomic<int> inUse {0};
+        std::atomic<int> maxInUse {0};
+        std::atomic<int> panics {0};
+    };
+
+    static const int SizeClasses = 3;
+    SizeClass classes[SizeClasses];
+
+    // allocations no size class could satisfy
+    std::atomic<int> failures {0};
+
+    // interning happens in the shell, the kernel only reads the table
+    juce::CriticalSection criticalSection;
+
+    // interned strings, readers index this without locking
+    // so it is fixed size and only ever appended
+    const char* interned[MaxInterned];
+    std::atomic<int> internedCount {0};
+    juce::HashMap<juce::String,int> internMap;
+    int internedBytes = 0;
+
+    void addSlab(int sizeClass);
+    Block* getBlock(SizeClass& sc, int index);
+    Block* pop(SizeClass& sc);
+    void push(SizeClass& sc, Block* b);
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
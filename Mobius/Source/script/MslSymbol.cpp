@@ -119,7 +119,7 @@ void MslSession::mslVisit(MslSymbolNode* snode)
     else if (snode->arguments.size() > 0) {
         // set up a function call
         // linker should already have verified this resolved to a function
-        if (!snode->resolution.isFunction())
+        if (!isFunction(snode))
           addError(snode, "Call syntax for a symbol that was not resolved to a function");
         else
           pushArguments(snode);
@@ -131,10 +131,10 @@ void MslSession::mslVisit(MslSymbolNode* snode)
         // have errored at this point
         // also this will override the use of "in all" if you bind "all" to a variable
         // which is not intended
-        MslBinding* binding = findBinding(snode->token.value.toUTF8());
+        MslBinding* binding = findBinding(snode->nameId, snode->token.value.toUTF8());
         if (binding != nullptr) {
 
-            if (snode->resolution.isResolved() && snode->resolution.isFunction())
+            if (snode->resolution.isResolved() && isFunction(snode))
               addError(snode, "Conflict between variable binding and resolved function");
             
             returnBinding(binding);    
@@ -143,7 +143,7 @@ void MslSession::mslVisit(MslSymbolNode* snode)
             
             returnUnresolved(snode);
         }
-        else if (!snode->resolution.isFunction()) {
+        else if (!isFunction(snode)) {
             // must be a variable
             if (snode->resolution.keyword)
               returnKeyword(snode);
@@ -257,7 +257,7 @@ void MslSession::returnStaticVariable(MslSymbolNode* snode)
 void MslSession::returnLinkedVariable(MslSymbolNode* snode)
 {
     MslLinkage* link = snode->resolution.linkage;
-    MslVariable* var = link->variable;
+    MslVariable* var = environment->getVariable(context, link);
     MslValue* value = pool->allocValue();
     
     if (var == nullptr) {
@@ -294,6 +294,34 @@ void MslSession::pushArguments(MslSymbolNode* snode)
     }
 }
 
+/**
+ * Symbols that resolved to another unit are looked up through the
+ * environment since the kernel may see a different version than the shell.
+ */
+bool MslSession::isFunction(MslSymbolNode* snode)
+{
+    bool result = false;
+    if (snode->resolution.linkage != nullptr)
+      result = (environment->getFunction(context, snode->resolution.linkage) != nullptr);
+    else
+      result = snode->resolution.isFunction();
+    return result;
+}
+
+MslBlockNode* MslSession::getBody(MslSymbolNode* snode)
+{
+    MslBlockNode* body = nullptr;
+    if (snode->resolution.linkage != nullptr) {
+        MslFunction* f = environment->getFunction(context, snode->resolution.linkage);
+        if (f != nullptr)
+          body = f->getBody();
+    }
+    else {
+        body = snode->resolution.getBody();
+    }
+    return body;
+}
+
 /**
  * Here we're back from evaluation the function call arguments and are
  * ready to call the function.
@@ -312,7 +340,17 @@ void MslSession::pushCall(MslSymbolNode* snode)
         callExternal(snode);
     }
     else {
-        MslBlockNode* body = snode->resolution.getBody();
+        if (profile != nullptr) {
+            // calls are counted against the function called, everything
+            // else against the script the session started from
+            MslFunction* f = snode->resolution.rootFunction;
+            if (snode->resolution.linkage != nullptr)
+              f = environment->getFunction(context, snode->resolution.linkage);
+            MslProfiler::Entry* e = environment->getProfiler()->getEntry(f);
+            if (e != nullptr)
+              e->calls.fetch_add(1, std::memory_order_relaxed);
+        }
+        MslBlockNode* body = getBody(snode);
         if (body != nullptr)
           pushBody(snode, body);
         else
@@ -360,6 +398,7 @@ void MslSession::bindArguments(MslSymbolNode* snode)
 
         MslBinding* b = pool->allocBinding();
         b->setName(arg->name.toUTF8());
+        b->nameId = arg->nameId;
         // ownership of the value transfers
         if (stack->childResults == nullptr) {
             // this should only happen for :optional arguments
@@ -685,7 +724,7 @@ void MslSession::doAssignment(MslAssignmentNode* ass)
     if (namesym != nullptr) {
     
         // if there is a dyanmic binding on the stack, it always gets it first
-        MslBinding* binding = findBinding(namesym->token.value.toUTF8());
+        MslBinding* binding = findBinding(namesym->nameId, namesym->token.value.toUTF8());
         if (binding != nullptr) {
             // transfer the value
             pool->free(binding->value);
@@ -703,7 +742,7 @@ void MslSession::doAssignment(MslAssignmentNode* ass)
         }
         else if (namesym->resolution.linkage != nullptr) {
             // assignment of public variable in another script
-            MslVariable* var = namesym->resolution.linkage->variable;
+            MslVariable* var = environment->getVariable(context, namesym->resolution.linkage);
             if (var == nullptr)
               addError(ass, "Missing variable in linkage");
             else {
@@ -171,6 +171,9 @@ class MslArgumentNode : public MslNode
     // the position of this argument, necessary?
     int position = 0;
 
+    // binding name id from MslEnvironment
+    int nameId = 0;
+
     // true if this is an extra call argument that didn't match
     // an argument in the function declaration
     bool extra = false;
@@ -221,6 +224,9 @@ class MslSymbolNode : public MslNode
     // link state
     MslResolution resolution;
     bool isResolved() {return resolution.isResolved();}
+
+    // binding name id from MslEnvironment
+    int nameId = 0;
     
     // compiled argument list for the resolved function
     MslBlockNode arguments;
@@ -17,15 +17,37 @@ void MslTokenizer::setContent(juce::String s)
     iterator = juce::CodeDocument::Iterator(document);
     // any difference here?
     //iterator = juce::CodeDocument::Iterator(document, 0, 0);
+    replay = nullptr;
 }    
 
+void MslTokenizer::setTokens(juce::Array<MslToken>* tokens)
+{
+    replay = tokens;
+    replayIndex = 0;
+}
+
+void MslTokenizer::setCapture(juce::Array<MslToken>* tokens)
+{
+    capture = tokens;
+}
+
 bool MslTokenizer::hasNext()
 {
-    return !iterator.isEOF();
+    if (replay != nullptr)
+      return (replayIndex < replay->size());
+    else
+      return !iterator.isEOF();
 }
 
 MslToken MslTokenizer::next()
 {
+    if (replay != nullptr) {
+        if (replayIndex < replay->size())
+          return replay->getReference(replayIndex++);
+        else
+          return MslToken(MslToken::Type::End);
+    }
+    
     MslToken t = MslToken(MslToken::Type::End);
     t.line = getLine();
     t.column = getColumn();
@@ -63,6 +85,8 @@ MslToken MslTokenizer::next()
         //t.line = getLine();
         //t.column = getColumn();
     }
+    if (capture != nullptr)
+      capture->add(t);
     return t;
 }
 
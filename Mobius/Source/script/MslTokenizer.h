@@ -70,6 +70,18 @@ class MslTokenizer
     bool hasNext();
     MslToken next();
 
+    /**
+     * Return tokens from a list captured from an earlier tokenization
+     * of the same content rather than tokenizing again.  MslCompileCache
+     * keeps these.
+     */
+    void setTokens(juce::Array<MslToken>* tokens);
+
+    /**
+     * Add every token returned by next() to this list.
+     */
+    void setCapture(juce::Array<MslToken>* tokens);
+
     int getLines();
     int getLine();
     int getColumn();
@@ -80,6 +92,10 @@ class MslTokenizer
 
     juce::String content;
     juce::CPlusPlusCodeTokeniser tokeniser;
+
+    juce::Array<MslToken>* replay = nullptr;
+    int replayIndex = 0;
+    juce::Array<MslToken>* capture = nullptr;
     
     MslToken::Type convertType(int cpptype);
     juce::String toString(int cpptype);
@@ -3,6 +3,7 @@
 #include "../util/Util.h"
 
 #include "MslBinding.h"
+#include "MslStringArena.h"
 #include "MslValue.h"
 
 MslValue::MslValue()
@@ -10,6 +11,23 @@ MslValue::MslValue()
     setNull();
 }
 
+/**
+ * Copying a value by value copies the atom.  Neither list comes
+ * along since the copy would not own them.
+ */
+MslValue::MslValue(const MslValue& src)
+{
+    setNull();
+    copy(const_cast<MslValue*>(&src));
+}
+
+MslValue& MslValue::operator=(const MslValue& src)
+{
+    if (this != &src)
+      copy(const_cast<MslValue*>(&src));
+    return *this;
+}
+
 /**
  * Ownership of the chain pointer and the sublist pointer is touchy.
  * We could do it here, or expect the object pool to deal with it.
@@ -24,21 +42,38 @@ MslValue::~MslValue()
     delete next;
     // and the values I contain
     delete list;
+    clearString();
 }
 
 /**
  * Copy one value to another.
  * Mostly to copy binding values which are expected to be atomic.
  */
-void MslValue::copy(MslValue* src)
+bool MslValue::copy(MslValue* src)
 {
+    bool stored = true;
     if (src == nullptr)
       setNull();
-    else {
+    else if (src != this) {
+        clearString();
         type = src->type;
         ival = src->ival;
-        fval = src->fval;
-        strcpy(string, src->string);
+        if (src->storage == Interned) {
+            storage = Interned;
+            text.name = src->text.name;
+        }
+        else {
+            // numbers may have a formatted string lingering but
+            // there is no need to copy that
+            const char* s = src->getChars();
+            if (s != nullptr && s[0] != 0 &&
+                (type == String || type == Enum || type == Keyword || type == Symbol)) {
+                stored = storeString(s);
+                // an enum still has its ordinal
+                if (!stored && type != Enum)
+                  type = Null;
+            }
+        }
 
         // I suppose we could support these, but needs more thought if you do
         // bindings will always be atomic, right?
@@ -50,6 +85,102 @@ void MslValue::copy(MslValue* src)
         if (src->list != nullptr)
           Trace(1, "MslValue: Unable to copy list value");
     }
+    return stored;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Strings
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Return any arena block and go back to an empty inline string.
+ */
+void MslValue::clearString()
+{
+    if (storage == Arena)
+      MslStringArena::getArena()->free(text.block);
+    storage = Inline;
+    text.chars[0] = 0;
+}
+
+/**
+ * Copy characters into whatever storage fits.  The caller
+ * has already cleared the old string.
+ *
+ * If the arena is out of blocks nothing is stored and this returns
+ * false.  Part of a name or path is worse than none, the caller makes
+ * the value Null and reports it if it can.  The arena counts these
+ * and the shell grows it before it should get that far.
+ */
+bool MslValue::storeString(const char* s)
+{
+    bool stored = true;
+    size_t length = strlen(s);
+    if (length < (size_t)InlineString) {
+        memcpy(text.chars, s, length + 1);
+    }
+    else {
+        if (length >= (size_t)MaxString)
+          length = MaxString - 1;
+        char* b = MslStringArena::getArena()->alloc((int)length + 1);
+        if (b == nullptr) {
+            text.chars[0] = 0;
+            stored = false;
+        }
+        else {
+            memcpy(b, s, length);
+            b[length] = 0;
+            storage = Arena;
+            text.block = b;
+        }
+    }
+    return stored;
+}
+
+void MslValue::storeInterned(int id)
+{
+    const char* s = MslStringArena::getArena()->getInterned(id);
+    if (s == nullptr) {
+        Trace(1, "MslValue: Invalid interned string %d", id);
+    }
+    else {
+        storage = Interned;
+        text.name = s;
+    }
+}
+
+/**
+ * Replace the string storage with a formatted number without
+ * changing the type.  If the arena is out of blocks the number is
+ * still there but it formats as an empty string.
+ */
+void MslValue::formatString(const char* s)
+{
+    clearString();
+    storeString(s);
+}
+
+const char* MslValue::getString()
+{
+    const char* result = nullptr;
+    if (type != Null) {
+        char buffer[64];
+        if (type == Int) {
+            snprintf(buffer, sizeof(buffer), "%d", ival);
+            formatString(buffer);
+        }
+        else if (type == Float) {
+            snprintf(buffer, sizeof(buffer), "%f", fval);
+            formatString(buffer);
+        }
+        else if (type == Bool) {
+            formatString((ival > 0) ? "true" : "false");
+        }
+        result = getChars();
+    }
+    return result;
 }
 
 /**
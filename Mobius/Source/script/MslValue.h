@@ -52,6 +52,10 @@
  *
  * For convenience, string values do have a maximum size, but use of string literals
  * is rare in MSL and symbolic references are normally handled with interned Symbols.
+ * Short strings are kept inline in the value, longer ones come from MslStringArena,
+ * and names known ahead of time like keywords and enumeration names can refer to the
+ * arena's interned string table by id.  This keeps the value small enough that pools
+ * of them don't waste memory on string buffers that are almost never used.
  *
  * Enums are a little weird in that they have two values, an integer "ordinal" and
  * a string "name".  This because while most code deals with ordinal numbers, users
@@ -62,12 +66,22 @@ class MslValue
 {
   public:
     MslValue();
+    MslValue(const MslValue& src);
+    MslValue& operator=(const MslValue& src);
     ~MslValue();
-    void copy(MslValue* src);
+
+    /**
+     * Returns false if a string couldn't be stored, the value is
+     * then Null rather than holding part of the string.
+     */
+    bool copy(MslValue* src);
     
     static const int MaxString = 1024;
 
-    enum Type {
+    // strings shorter than this are stored in the value
+    static const int InlineString = 8;
+
+    enum Type : juce::uint8 {
         Null,
         Int,
         Float,
@@ -98,8 +112,7 @@ class MslValue
         type = Null;
         // not necessary to clear these but looks better in the debugger
         ival = 0;
-        fval = 0.0f;
-        string[0] = 0;
+        clearString();
         // these are more complicated,code that uses pooled values shold be reclaiming
         // these before setting to null
         delete next;
@@ -133,31 +146,45 @@ class MslValue
     // sigh, if we have two setString() methods with different signatures
     // it's ambiguous becasue Juce::String has a coersion operator
     // and we don't want to use that at runtime in the engine
-    void setJString(juce::String s) {
-        setString(s.toUTF8());
+    bool setJString(juce::String s) {
+        return setString(s.toUTF8());
     }
 
-    void setString(const char* s) {
-        if (s == string) {
+    /**
+     * Returns false if the string arena was out of blocks, the value
+     * is left Null.  Callers that can report errors should.
+     */
+    bool setString(const char* s) {
+        bool stored = true;
+        if (s != nullptr && s == getChars()) {
             // someone did this v->setString(v->getString())
             // or more likely v->setEnum(v->getString(), ordinal)
             // leave it alone
         }
         else {
             setNull();
-            if (s == nullptr) {
-                strcpy(string, "");
-            }
-            else {
-                strncpy(string, s, sizeof(string));
-                if (strlen(string) > 0)
+            if (s != nullptr && s[0] != 0) {
+                stored = storeString(s);
+                if (stored)
                   type = String;
             }
         }
+        return stored;
     }
     
-    void setKeyword(const char* s) {
-        setString(s);
+    bool setKeyword(const char* s) {
+        bool stored = setString(s);
+        if (stored)
+          type = Keyword;
+        return stored;
+    }
+
+    /**
+     * Keyword with a name from the interned string table.
+     */
+    void setKeywordId(int id) {
+        setNull();
+        storeInterned(id);
         type = Keyword;
     }
 
@@ -167,8 +194,20 @@ class MslValue
         return (type == String || type == Keyword);
     }
 
-    void setEnum(const char* s, int i) {
-        setString(s);
+    // the ordinal is kept even if the name couldn't be stored
+    bool setEnum(const char* s, int i) {
+        bool stored = setString(s);
+        ival = i;
+        type = Enum;
+        return stored;
+    }
+
+    /**
+     * Enum with a name from the interned string table.
+     */
+    void setEnumId(int id, int i) {
+        setNull();
+        storeInterned(id);
         ival = i;
         type = Enum;
     }
@@ -180,23 +219,12 @@ class MslValue
           ival = i;
     }
 
-    const char* getString() {
-        const char* result = nullptr;
-        if (type != Null) {
-            if (type == Int) {
-                snprintf(string, sizeof(string), "%d", ival);
-            }
-            else if (type == Float) {
-                snprintf(string, sizeof(string), "%f", fval);
-            }
-            else if (type == Bool) {
-                snprintf(string, sizeof(string),
-                         (ival > 0) ? "true" : "false");
-            }
-            result = string;
-        }
-        return result;
-    }
+    /**
+     * Numbers and booleans are formatted on demand which may
+     * replace the string storage.  The result remains valid until
+     * the value is changed.
+     */
+    const char* getString();
 
     int getInt() {
         int result = 0;
@@ -207,7 +235,9 @@ class MslValue
             result = (int)fval;
         }
         else if (type != Null) {
-            result = atoi(string);
+            const char* s = getChars();
+            if (s != nullptr)
+              result = atoi(s);
         }
         return result;
     }
@@ -238,15 +268,39 @@ class MslValue
 
   private:
 
+    // where the characters of a string are
+    enum Storage : juce::uint8 {
+        Inline,
+        Arena,
+        Interned
+    };
+
     // keep these private to enforce use of the methods to keep
     // type Type in sync with the value
     // by convention once "list" becomes non-null Type is implicitly List
     // though those should be kept in sync
     // "bool" is just 0 or 1
+    // no type needs both numbers, Enum uses ival
     
-    int ival = 0;
-    float fval = 0.0f;
-    char string[MaxString];
+    Storage storage = Inline;
+    union {
+        int ival;
+        float fval;
+    };
+    union {
+        char chars[InlineString];
+        char* block;
+        const char* name;
+    } text;
+
+    const char* getChars() {
+        return (storage == Inline) ? text.chars : ((storage == Arena) ? text.block : text.name);
+    }
+
+    void clearString();
+    bool storeString(const char* s);
+    void storeInterned(int id);
+    void formatString(const char* s);
 };
 
 /****************************************************************************/
@@ -23,6 +23,12 @@
 
 #include "MslEnvironment.h"
 #include "MslDetails.h"
+#include "MslParser.h"
+#include "MslModel.h"
+#include "MslFunction.h"
+#include "MslVariable.h"
+#include "MslCompilation.h"
+#include "MslCompileCache.h"
 #include "ScriptRegistry.h"
 
 #include "ScriptClerk.h"
@@ -115,21 +121,41 @@ bool ScriptClerk::isInLibraryFolder(juce::String path)
  * The referenced script files are not installed, this only
  * maintins the ScriptRegistry memory model.  When they are ready
  * to be installed, Supervisor calls installMsl.
+ *
+ * Supervisor startup runs these phases itself so reading and scanning
+ * can happen in the background.  Only convertRegistry and adoptRegistry
+ * touch anything outside the new registry and must be on the
+ * message thread.
  */
 void ScriptClerk::initialize()
+{
+    ScriptRegistry* reg = readRegistry();
+    convertRegistry(reg);
+    scanRegistry(reg);
+    adoptRegistry(reg);
+}
+
+/**
+ * Load last known registry state into a new registry.
+ */
+ScriptRegistry* ScriptClerk::readRegistry()
 {
     ScriptRegistry* reg = new ScriptRegistry();
-    registry.reset(reg);
 
-    // load last known registry state
     juce::File root = supervisor->getRoot();
     juce::File regfile = root.getChildFile("scripts.xml");
     if (regfile.existsAsFile()) {
         juce::String xml = regfile.loadFileAsString();
         reg->parseXml(xml);
     }
+    return reg;
+}
 
-    // upgrade ScriptConfig to registry entries
+/**
+ * Upgrade ScriptConfig to registry entries.
+ */
+void ScriptClerk::convertRegistry(ScriptRegistry* reg)
+{
     MobiusConfig* mconfig = supervisor->getOldMobiusConfig();
     ScriptConfig* sconfig = mconfig->getScriptConfigObsolete();
     if (sconfig != nullptr && sconfig->getScripts() != nullptr) {
@@ -141,17 +167,23 @@ void ScriptClerk::initialize()
         // this is a shitty backdoor until the old mobius.xml can be broken apart
         supervisor->writeOldMobiusConfig();
     }
+}
 
+/**
+ * Reconcile a registry that nothing else can see yet with the files.
+ */
+void ScriptClerk::scanRegistry(ScriptRegistry* reg)
+{
     // hack: If they have paths into the standard library folder
     // configured as externals, remove them since we will have
     // already found those.  This is common when ScriptConfig
     // is converted
     juce::File libdir = getLibraryFolder();
-    ScriptRegistry::Machine* machine = registry->getMachine();
+    ScriptRegistry::Machine* machine = reg->getMachine();
     machine->filterExternals(libdir.getFullPathName());
 
     // reconcile file references
-    reconcile();
+    reconcile(machine);
 
     // remove any previous file entries for files we didn't encounter
     // on this scan
@@ -163,6 +195,14 @@ void ScriptClerk::initialize()
         else
           index++;
     }
+}
+
+/**
+ * Make a registry built by the other phases the current one.
+ */
+void ScriptClerk::adoptRegistry(ScriptRegistry* reg)
+{
+    registry.reset(reg);
 
     // don't bother with dirty checking on this? it isn't big
     saveRegistry();
@@ -198,8 +238,11 @@ void ScriptClerk::saveRegistry()
  */
 void ScriptClerk::reconcile()
 {
-    ScriptRegistry::Machine* machine = getMachine();
+    reconcile(getMachine());
+}
 
+void ScriptClerk::reconcile(ScriptRegistry::Machine* machine)
+{
     // initialize flags containing scan result
     machine->externalOverlapDetected = false;
     for (auto file : machine->files) {
@@ -376,17 +419,95 @@ void ScriptClerk::scanOldFile(ScriptRegistry::File* sfile, juce::File jfile)
 //
 //////////////////////////////////////////////////////////////////////
 
+/**
+ * The most threads used to parse files.
+ */
+const int ClerkMaxParseThreads = 8;
+
+/**
+ * Parses one file on the installation thread pool.
+ */
+class ScriptClerk::ParseJob : public juce::ThreadPoolJob
+{
+  public:
+
+    ParseJob(ScriptRegistry::File* f) : juce::ThreadPoolJob("MslParse") {
+        file = f;
+    }
+    ~ParseJob() {
+        // if it didn't make it to the environment
+        delete unit;
+    }
+
+    ScriptRegistry::File* file = nullptr;
+    juce::String source;
+    juce::int64 hash = 0;
+    juce::Array<MslToken> tokens;
+    bool cached = false;
+    MslCompilation* unit = nullptr;
+    double parseTime = 0.0;
+
+    // names this file defines and names it references, for ordering
+    juce::StringArray defines;
+    juce::StringArray references;
+    bool ordered = false;
+
+    JobStatus runJob() override {
+        double start = juce::Time::getMillisecondCounterHiRes();
+        MslParser parser;
+        unit = parser.parse(source, tokens);
+        parseTime = juce::Time::getMillisecondCounterHiRes() - start;
+        return jobHasFinished;
+    }
+};
+
+juce::File ScriptClerk::getCacheFile()
+{
+    return supervisor->getRoot().getChildFile("msl.cache");
+}
+
+/**
+ * True if a file has been installed and nothing about it needs to change.
+ * Files with errors or collisions are always installed again since
+ * other files may have changed in a way that fixes them.
+ */
+bool ScriptClerk::isCurrent(ScriptRegistry::File* file, juce::int64 hash)
+{
+    MslDetails* details = file->getDetails();
+    return (file->hash == hash && details != nullptr && details->published &&
+            !file->hasErrors());
+}
+
 /**
  * After reading and reconciling the ScriptRegistry, install all the MSL
  * files into the script environment.  This is a bulk operation where
  * linking is deferred until all files have been installed.
+ *
+ * Files are parsed in parallel on a thread pool, and the tokenizing is
+ * skipped for any file MslCompileCache has seen before.  Files that were
+ * installed before and haven't changed since are left alone.  Installation
+ * itself has to be done one file at a time since it changes the environment,
+ * and is done in an order where files are installed after the ones
+ * they reference.
+ *
+ * Old .mos files don't go through here.  ScriptCompiler keeps the file
+ * being parsed and the current block in its own members and resolves
+ * Functions and Parameters through Mobius as it goes, and the statements
+ * have no form that could be cached, so those are still compiled one
+ * at a time by MobiusShell.  There are rarely more than a few of them
+ * and saveErrors picks up how long each one took.
  */
 int ScriptClerk::installMsl()
 {
     int numInstalled = 0;
+    int numUnchanged = 0;
     ScriptRegistry::Machine* machine = registry->getMachine();
     MslEnvironment* env = supervisor->getMslEnvironment();
+    double start = juce::Time::getMillisecondCounterHiRes();
+
+    compileCache.load(getCacheFile());
     
+    juce::OwnedArray<ParseJob> jobs;
     for (auto fileref : machine->files) {
 
         if (isInstallable(fileref)) {
@@ -401,19 +522,66 @@ int ScriptClerk::installMsl()
             else {
                 juce::String source = file.loadFileAsString();
                 fileref->source = source;
-
-                // note that we defer linking
-                MslDetails* unit = env->install(supervisor, fileref->path, source, false);
-                updateDetails(fileref, unit);
-                numInstalled++;
+                
+                juce::int64 hash = source.hashCode64();
+                if (isCurrent(fileref, hash)) {
+                    fileref->unchanged = true;
+                    fileref->cached = false;
+                    fileref->parseTime = 0.0;
+                    fileref->installTime = 0.0;
+                    compileCache.keep(hash);
+                    numUnchanged++;
+                    numInstalled++;
+                }
+                else {
+                    ParseJob* job = new ParseJob(fileref);
+                    job->source = source;
+                    job->hash = hash;
+                    job->cached = compileCache.get(hash, job->tokens);
+                    jobs.add(job);
+                }
             }
         }
     }
 
+    parse(jobs);
+
+    juce::Array<ParseJob*> ordered;
+    order(jobs, ordered);
+
+    for (auto job : ordered) {
+        ScriptRegistry::File* fileref = job->file;
+        
+        // don't keep tokens for files that didn't parse, the parser
+        // stops at the first error so the list is incomplete
+        if (!job->cached && !job->unit->hasErrors())
+          compileCache.put(job->hash, job->tokens);
+
+        double installStart = juce::Time::getMillisecondCounterHiRes();
+        // note that we defer linking
+        MslCompilation* unit = job->unit;
+        job->unit = nullptr;
+        MslDetails* details = env->install(supervisor, fileref->path, unit, false);
+        
+        fileref->cached = job->cached;
+        fileref->unchanged = false;
+        fileref->parseTime = job->parseTime;
+        fileref->installTime = juce::Time::getMillisecondCounterHiRes() - installStart;
+        
+        updateDetails(fileref, details);
+        numInstalled++;
+    }
+
     // do the full relink of the environment, this can result in resolution
     // changes in units that won't be reflected in the details we just capatured
     env->link(supervisor);
 
+    compileCache.save(getCacheFile());
+
+    Trace(2, "ScriptClerk: Installed %d files in %d ms, %d unchanged %d tokens cached",
+          numInstalled, (int)(juce::Time::getMillisecondCounterHiRes() - start),
+          numUnchanged, compileCache.getHits());
+
     // refresh all the details after everything has been loaded and all the
     // cross-script references have been resolved
     // to avoid memory churn, we could defer install() returning a details object
@@ -425,6 +593,112 @@ int ScriptClerk::installMsl()
     return numInstalled;
 }
 
+/**
+ * Parse files on a thread pool.  The parser doesn't touch the environment
+ * so this is safe, the threads are gone before anything is installed.
+ */
+void ScriptClerk::parse(juce::OwnedArray<ParseJob>& jobs)
+{
+    if (jobs.size() == 1) {
+        // not worth a thread
+        jobs[0]->runJob();
+    }
+    else if (jobs.size() > 1) {
+        int threads = juce::jmin(jobs.size(), juce::SystemStats::getNumCpus(),
+                                 ClerkMaxParseThreads);
+        juce::ThreadPool pool(threads);
+        for (auto job : jobs)
+          pool.addJob(job, false);
+        for (auto job : jobs)
+          pool.waitForJobToFinish(job, -1);
+    }
+}
+
+/**
+ * Put the parsed files in the order they should be installed.
+ *
+ * Initialization blocks run when each file is installed, and they can call
+ * functions in other files, so a file should be installed after the files
+ * defining the names it uses.  The names are just gathered from the parse
+ * trees, the linker hasn't seen them yet, so this can be fooled by local
+ * names that happen to match something in another file.  That only changes
+ * the order.  Files caught in a cycle are installed in registry order.
+ */
+void ScriptClerk::order(juce::OwnedArray<ParseJob>& jobs, juce::Array<ParseJob*>& ordered)
+{
+    for (auto job : jobs) {
+        MslCompilation* unit = job->unit;
+        if (!unit->hasErrors()) {
+            MslFunction* body = unit->getBodyFunction();
+            if (body != nullptr) {
+                if (body->name.length() > 0)
+                  job->defines.add(body->name);
+                else
+                  job->defines.add(juce::File(job->file->path).getFileNameWithoutExtension());
+                gatherReferences(body->getBody(), job->references);
+            }
+            for (auto func : unit->functions) {
+                job->defines.add(func->name);
+                gatherReferences(func->getBody(), job->references);
+            }
+            for (auto var : unit->variables)
+              job->defines.add(var->name);
+        }
+    }
+    
+    while (ordered.size() < jobs.size()) {
+        ParseJob* next = nullptr;
+        for (auto job : jobs) {
+            if (!job->ordered && isReady(job, jobs)) {
+                next = job;
+                break;
+            }
+        }
+        if (next == nullptr) {
+            // a cycle, take the first one left
+            for (auto job : jobs) {
+                if (!job->ordered) {
+                    next = job;
+                    break;
+                }
+            }
+        }
+        next->ordered = true;
+        ordered.add(next);
+    }
+}
+
+/**
+ * True if none of the files not yet ordered define a name this one references.
+ */
+bool ScriptClerk::isReady(ParseJob* job, juce::OwnedArray<ParseJob>& jobs)
+{
+    bool ready = true;
+    for (auto other : jobs) {
+        if (other != job && !other->ordered) {
+            for (auto name : job->references) {
+                if (other->defines.contains(name)) {
+                    ready = false;
+                    break;
+                }
+            }
+        }
+        if (!ready) break;
+    }
+    return ready;
+}
+
+void ScriptClerk::gatherReferences(MslNode* node, juce::StringArray& names)
+{
+    if (node != nullptr) {
+        MslSymbolNode* sym = node->getSymbol();
+        if (sym != nullptr)
+          names.addIfNotAlreadyThere(sym->token.value);
+        for (auto child : node->children)
+          gatherReferences(child, names);
+    }
+}
+
 bool ScriptClerk::isInstallable(ScriptRegistry::File* file)
 {
     return (!file->old && !file->missing && !file->deleted && !file->disabled);
@@ -476,6 +750,9 @@ void ScriptClerk::updateDetails(ScriptRegistry::File* regfile, MslDetails* detai
         regfile->name = details->name;
         regfile->library = details->library;
         regfile->package = details->package;
+        // remember what was installed so installMsl can tell if it changed,
+        // this may also be a single file installed from the editor
+        regfile->hash = regfile->source.hashCode64();
     }
 }
 
@@ -588,6 +865,12 @@ void ScriptClerk::saveErrors(ScriptConfig* config)
                 // note we don't use updateDetails here because the details
                 // wasn't created by the compiler and won't have the reference name
                 file->setDetails(details);
+
+                // for the console compile times, there is nothing to install
+                file->parseTime = ref->parseTime;
+                file->installTime = 0.0;
+                file->cached = false;
+                file->unchanged = false;
             }
         }
     }
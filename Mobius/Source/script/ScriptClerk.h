@@ -21,6 +21,7 @@
 #include <JuceHeader.h>
 
 #include "ScriptRegistry.h"
+#include "MslCompileCache.h"
 
 // have to include this so the unique_ptr can compile
 #include "../model/ScriptConfig.h"
@@ -62,6 +63,13 @@ class ScriptClerk {
     
     void initialize();
     void refresh();
+
+    // initialize() in phases for Supervisor startup
+    class ScriptRegistry* readRegistry();
+    void convertRegistry(class ScriptRegistry* reg);
+    void scanRegistry(class ScriptRegistry* reg);
+    void adoptRegistry(class ScriptRegistry* reg);
+
     void saveRegistry();
     int installMsl();
     void restoreState();
@@ -107,14 +115,26 @@ class ScriptClerk {
     std::unique_ptr<class ScriptRegistry> registry;
     juce::Array<Listener*> listeners;
 
+    // tokens from earlier installations
+    MslCompileCache compileCache;
+
+    class ParseJob;
+
     // Registry housekeeping
     void reconcile();
+    void reconcile(class ScriptRegistry::Machine* machine);
     void scanFolder(class ScriptRegistry::Machine* machine, juce::File jfolder, class ScriptRegistry::External* ext);
     ScriptRegistry::File* scanFile(class ScriptRegistry::Machine* machine, juce::File jfile, class ScriptRegistry::External* ext);
     void scanOldFile(class ScriptRegistry::File* sfile, juce::File jfile);
 
     // installation support
     bool isInstallable(class ScriptRegistry::File* file);
+    juce::File getCacheFile();
+    bool isCurrent(class ScriptRegistry::File* file, juce::int64 hash);
+    void parse(juce::OwnedArray<ParseJob>& jobs);
+    void order(juce::OwnedArray<ParseJob>& jobs, juce::Array<ParseJob*>& ordered);
+    bool isReady(ParseJob* job, juce::OwnedArray<ParseJob>& jobs);
+    void gatherReferences(class MslNode* node, juce::StringArray& names);
     void refreshDetails();
     void updateDetails(class ScriptRegistry::File* regfile, class MslDetails* details);
     void notifyFileDeleted(Listener* listener, class ScriptRegistry::File* file);
@@ -97,6 +97,23 @@ class ScriptRegistry
         // true if this was tagged for removal during external reconciliation
         bool externalRemove = false;
 
+        //
+        // transient fields set during installMsl
+        //
+
+        // hash of the source that was last installed
+        juce::int64 hash = 0;
+
+        // milliseconds spent parsing and installing the last time
+        double parseTime = 0.0;
+        double installTime = 0.0;
+
+        // true if the tokens came from MslCompileCache
+        bool cached = false;
+
+        // true if the file was not installed again because it hadn't changed
+        bool unchanged = false;
+
         //
         // Complex compilation information
         //
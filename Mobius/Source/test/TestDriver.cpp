@@ -72,9 +72,15 @@
 #include "../model/UIAction.h"
 #include "../model/UIConfig.h"
 #include "../model/SessionHelper.h"
+#include "../model/Binding.h"
+#include "../model/BindingSet.h"
+#include "../model/Session.h"
+#include "../model/SessionConstants.h"
+#include "../model/SymbolId.h"
 
 #include "../mobius/MobiusInterface.h"
 #include "../mobius/MobiusShell.h"
+#include "../mobius/KernelPublisher.h"
 #include "../mobius/Audio.h"
 #include "../mobius/AudioFile.h"
 #include "../mobius/AudioPool.h"
@@ -82,8 +88,22 @@
 #include "../mobius/SampleManager.h"
 #include "../mobius/WaveFile.h"
 #include "../mobius/core/Mobius.h"
+#include "../mobius/track/TrackManager.h"
+#include "../mobius/track/LogicalTrack.h"
+#include "../mobius/sync/SyncMaster.h"
+#include "../mobius/sync/MidiRealizer.h"
+#include "../mobius/sync/MidiAnalyzer.h"
+#include "../midi/MidiEvent.h"
+#include "../midi/MidiSequence.h"
+#include "../midi/MidiPackedSequence.h"
+#include "../mobius/midi/MidiPools.h"
+#include "../mobius/midi/MidiLayer.h"
+#include "../mobius/midi/MidiPlayer.h"
 
 #include "../Supervisor.h"
+#include "../Binderator.h"
+#include "../PortAuthority.h"
+#include "../MidiManager.h"
 
 #include "AudioDifferencer.h"
 #include "TestDriver.h"
@@ -289,6 +309,882 @@ void TestDriver::runTest(Symbol* s, juce::String testName)
     }
 }
 
+//////////////////////////////////////////////////////////////////////
+//
+// MIDI Timing Test
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Note bound to Record during the MIDI timing test.
+ */
+const int MidiTimingNote = 60;
+
+/**
+ * Frames after reset where the recording starts and the length of
+ * the recording.  Neither is a multiple of any of the block sizes.
+ */
+const int MidiTimingStart = 10007;
+const int MidiTimingLength = 44111;
+
+/**
+ * Verify that MIDI triggered actions happen at the offset within the block
+ * where the message was received.  A note bound to Record is sent from a
+ * simulated host at the same stream frames with several block sizes and the
+ * resulting loops must all be exactly MidiTimingLength.  If actions were done
+ * at the start of the block they would be off by up to a block.
+ *
+ * This runs synchronously and must be in bypass mode so we are the only
+ * one sending blocks to the kernel, which also makes it safe to look at
+ * the track directly.
+ */
+void TestDriver::runMidiTimingTest()
+{
+    if (!bypass) {
+        Trace(1, "TestDriver: MIDI timing test requires bypass mode\n");
+        return;
+    }
+    if (waitingId > 0) {
+        Trace(1, "TestDriver: Ignoring MIDI timing test, still waiting on %d\n", waitingId);
+        return;
+    }
+
+    // bind the note the way the plugin does, in the kernel
+    BindingSet set;
+    Binding* b = new Binding();
+    b->trigger = Binding::TriggerNote;
+    b->triggerValue = MidiTimingNote;
+    b->symbol = "Record";
+    set.add(b);
+    Binderator* binderator = new Binderator();
+    binderator->configureMidi(supervisor->getSymbols(), &set);
+    installMidiBindings(binderator);
+
+    midiTest = true;
+    const int sizes[] = {64, 256, 1000};
+    juce::String detail;
+    for (auto size : sizes) {
+        int length = recordMidiLoop(size);
+        if (length != MidiTimingLength) {
+            if (detail.length() > 0) detail += ", ";
+            detail += "block size " + juce::String(size) + " recorded " + juce::String(length);
+        }
+    }
+    midiTest = false;
+    blockSize = 256;
+
+    // put back what Supervisor would have given the kernel
+    Binderator* restored = new Binderator();
+    restored->configureMidi(supervisor->getSystemConfig(), supervisor->getUIConfig(),
+                            supervisor->getSymbols());
+    installMidiBindings(restored);
+
+    if (detail.length() > 0)
+      detail += ", expected " + juce::String(MidiTimingLength);
+    reportTest("MIDI timing", detail.length() == 0, detail);
+}
+
+/**
+ * Put the result in the panel log with the script test output and
+ * in the trace log.  Failures trace as errors so they are hard to miss.
+ */
+void TestDriver::reportTest(const char* name, bool passed, juce::String detail)
+{
+    juce::String msg = juce::String(name) + (passed ? " passed" : " FAILED");
+    if (detail.length() > 0)
+      msg += ": " + detail;
+    controlPanel.log(msg);
+    if (passed)
+      Trace(2, "TestDriver: %s\n", msg.toUTF8());
+    else
+      Trace(1, "TestDriver: %s\n", msg.toUTF8());
+}
+
+/**
+ * Send the kernel a Binderator and pump a block so it gets installed.
+ */
+void TestDriver::installMidiBindings(Binderator* b)
+{
+    supervisor->getMobius()->installBindings(b);
+    pumpBlock();
+}
+
+/**
+ * Reset, then record a loop with two notes at fixed stream frames
+ * using a given block size and return the length of the loop.
+ */
+int TestDriver::recordMidiLoop(int size)
+{
+    blockSize = size;
+    
+    UIAction action;
+    action.symbol = supervisor->getSymbols()->intern("GlobalReset");
+    supervisor->getMobius()->doAction(&action);
+
+    // let the reset happen without any MIDI
+    juce::Array<int> none;
+    pumpMidiFrames(size * 4, none);
+
+    juce::Array<int> notes;
+    notes.add(MidiTimingStart);
+    notes.add(MidiTimingStart + MidiTimingLength);
+    // leave some time for the loop to finish recording
+    pumpMidiFrames(MidiTimingStart + MidiTimingLength + (size * 4), notes);
+
+    int length = 0;
+    MobiusKernel* kernel = getMobiusShell()->getKernel();
+    TrackManager* tm = kernel->getTrackManager();
+    LogicalTrack* track = tm->getLogicalTrack(tm->getFocusedTrackIndex() + 1);
+    if (track != nullptr)
+      length = track->getSyncLength();
+    return length;
+}
+
+/**
+ * Pump blocks covering at least the given number of frames, adding note
+ * messages at their offsets within the blocks that contain them.
+ * Frames are relative to the first block pumped.
+ */
+void TestDriver::pumpMidiFrames(int frames, juce::Array<int>& noteFrames)
+{
+    juce::MidiMessage note = juce::MidiMessage::noteOn(1, MidiTimingNote, (juce::uint8)127);
+    for (int start = 0 ; start < frames ; start += blockSize) {
+        // the kernel may leave output here, clear it every time
+        testMidi.clear();
+        for (auto frame : noteFrames) {
+            if (frame >= start && frame < start + blockSize)
+              testMidi.addEvent(note, frame - start);
+        }
+        pumpBlock();
+    }
+    testMidi.clear();
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Binding Benchmark
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Size of the configuration and number of messages dispatched.
+ */
+const int BenchmarkBindings = 2000;
+const int BenchmarkMessages = 1000000;
+
+/**
+ * Measure the cost of compiling a large MIDI binding configuration and
+ * of dispatching messages through it the way the kernel does.
+ *
+ * Bindings are spread over notes, controllers, and program changes on
+ * every channel including "any", with some landing on the same message.
+ * The messages cycle through every note, controller, and program
+ * on every channel so most of them miss, which is typical.
+ *
+ * The number of actions dispatched must match what a simple table built
+ * from the bindings says, which catches lost or extra entries in the
+ * compiled tables.
+ *
+ * This doesn't touch the engine so it doesn't need bypass mode.
+ */
+void TestDriver::runBindingBenchmark()
+{
+    const char* functions[] = {"Record", "Overdub", "Multiply", "Insert",
+                               "Mute", "Replace", "Undo", "Redo"};
+    const Binding::Trigger triggers[] = {Binding::TriggerNote,
+                                         Binding::TriggerControl,
+                                         Binding::TriggerProgram};
+    // trigger, channel with zero for any, value
+    bool bound[3][17][128] = {};
+    BindingSet set;
+    for (int i = 0 ; i < BenchmarkBindings ; i++) {
+        Binding* b = new Binding();
+        b->trigger = triggers[i % 3];
+        b->midiChannel = (i / 3) % 17;
+        b->triggerValue = (i * 7) % 128;
+        b->symbol = functions[i % 8];
+        set.add(b);
+        bound[i % 3][b->midiChannel][b->triggerValue] = true;
+    }
+
+    // messages are in the same trigger order as the bindings
+    juce::Array<juce::MidiMessage> messages;
+    juce::Array<bool> hits;
+    for (int channel = 1 ; channel <= 16 ; channel++) {
+        for (int value = 0 ; value < 128 ; value++) {
+            messages.add(juce::MidiMessage::noteOn(channel, value, (juce::uint8)127));
+            messages.add(juce::MidiMessage::controllerEvent(channel, value, 127));
+            messages.add(juce::MidiMessage::programChange(channel, value));
+            for (int t = 0 ; t < 3 ; t++)
+              hits.add(bound[t][0][value] || bound[t][channel][value]);
+        }
+    }
+
+    double ticksPerMicro = (double)juce::Time::getHighResolutionTicksPerSecond() / 1000000.0;
+
+    juce::int64 start = juce::Time::getHighResolutionTicks();
+    Binderator binderator;
+    binderator.configureMidi(supervisor->getSymbols(), &set);
+    juce::int64 compiled = juce::Time::getHighResolutionTicks();
+
+    int found = 0;
+    int count = messages.size();
+    for (int i = 0 ; i < BenchmarkMessages ; i++) {
+        if (binderator.handleMidiEvent(messages.getReference(i % count)) != nullptr)
+          found++;
+    }
+    juce::int64 end = juce::Time::getHighResolutionTicks();
+
+    int expected = 0;
+    for (int i = 0 ; i < BenchmarkMessages ; i++) {
+        if (hits[i % count])
+          expected++;
+    }
+
+    int compileMicros = (int)((double)(compiled - start) / ticksPerMicro);
+    double nanos = ((double)(end - compiled) / ticksPerMicro * 1000.0) / BenchmarkMessages;
+
+    Trace(2, "TestDriver: Binding benchmark %d bindings compiled in %d us\n",
+          binderator.getMidiBindingCount(), compileMicros);
+    Trace(2, "TestDriver: Binding benchmark %d messages %d actions %d ns per dispatch\n",
+          BenchmarkMessages, found, (int)nanos);
+
+    juce::String detail;
+    if (found != expected)
+      detail = juce::String(found) + " actions dispatched, expected " + juce::String(expected);
+    reportTest("Binding benchmark", found == expected, detail);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Clock Jitter Test
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Milliseconds to let the tempo monitor fill its window after a
+ * change, and to measure.
+ */
+const int JitterWarmup = 3000;
+const int JitterMeasure = 10000;
+
+/**
+ * Clocks that must be received in each measurement, a little under
+ * what 60 BPM would send in JitterMeasure, and how much worse in
+ * microseconds sample clocks may be than thread clocks before it
+ * is a failure.
+ */
+const int JitterMinClocks = 200;
+const int JitterToleranceMicros = 100;
+
+/**
+ * Compare the jitter of MIDI clocks generated by the clock thread with
+ * those generated from the audio stream.
+ *
+ * This needs the sync output device looped back to the sync input, usually
+ * with a virtual MIDI port.  The MidiAnalyzer tempo monitor measures how far
+ * each received clock is from the fit.  Jitter in the receiving path is the
+ * same for both so the sample clocks must be no worse than the thread clocks.
+ * Both are measured with the Transport stopped, which only sends clocks,
+ * and again with it running, where the clocks follow the Transport
+ * timeline along with Start and Song Position.
+ *
+ * It runs in real time with live audio blocks, advance() moves through
+ * the phases and reports the result at the end.
+ */
+void TestDriver::runClockJitterTest()
+{
+    if (jitterPhase > 0) {
+        Trace(1, "TestDriver: Clock jitter test already running\n");
+    }
+    else if (!supervisor->getMidiManager()->hasOutputDevice(MidiManager::OutputSync)) {
+        reportTest("Clock jitter", false, "requires a MIDI sync output device");
+    }
+    else {
+        sendFunction(FuncTransportStop);
+        getMidiRealizer()->setSampleClocks(false);
+        sendParameter(ParamTransportMidi, 1);
+        sendParameter(ParamTransportClocks, 1);
+        jitterPhase = 1;
+        jitterStart = juce::Time::getMillisecondCounter();
+    }
+}
+
+/**
+ * Odd phases let the monitor settle after a change and even phases
+ * measure.  Stopped thread clocks 1-2, stopped sample clocks 3-4,
+ * running sample clocks 5-6, and running thread clocks 7-8.
+ */
+void TestDriver::advanceJitterTest()
+{
+    if (jitterPhase > 0) {
+        juce::uint32 now = juce::Time::getMillisecondCounter();
+        juce::uint32 limit = (jitterPhase % 2 == 1) ? JitterWarmup : JitterMeasure;
+        if (now - jitterStart >= limit) {
+            MidiTempoMonitor* monitor = getMobiusShell()->getKernel()->getSyncMaster()->
+                getMidiAnalyzer()->getTempoMonitor();
+            MidiRealizer* realizer = getMidiRealizer();
+            
+            if (jitterPhase % 2 == 1) {
+                monitor->resetJitter();
+            }
+            else {
+                const char* labels[] = {"Stopped thread clocks", "Stopped sample clocks",
+                                        "Running sample clocks", "Running thread clocks"};
+                int measure = (jitterPhase / 2) - 1;
+                monitor->traceJitter(labels[measure]);
+                jitterClocks[measure] = monitor->getJitterCount();
+                jitterRms[measure] = monitor->getJitterRms();
+
+                if (jitterPhase == 2) {
+                    realizer->setSampleClocks(true);
+                }
+                else if (jitterPhase == 4) {
+                    sendFunction(FuncTransportStart);
+                }
+                else if (jitterPhase == 6) {
+                    realizer->setSampleClocks(false);
+                }
+                else {
+                    realizer->traceStatistics();
+                    sendFunction(FuncTransportStop);
+
+                    // put back what the session had
+                    Session* session = supervisor->getSession();
+                    realizer->setSampleClocks(session->getBool(SessionTransportSampleClocks));
+                    sendParameter(ParamTransportClocks, session->getBool(SessionTransportClocks));
+                    sendParameter(ParamTransportMidi, session->getBool(SessionTransportMidi));
+                    finishJitterTest();
+                }
+            }
+            
+            jitterPhase = (jitterPhase < 8) ? jitterPhase + 1 : 0;
+            jitterStart = now;
+        }
+    }
+}
+
+/**
+ * Each measurement must have received clocks, and sample clocks must be
+ * within JitterToleranceMicros of thread clocks with the Transport in the
+ * same state.
+ */
+void TestDriver::finishJitterTest()
+{
+    const char* labels[] = {"stopped thread", "stopped sample",
+                            "running sample", "running thread"};
+    juce::String detail;
+    for (int i = 0 ; i < 4 ; i++) {
+        if (jitterClocks[i] < JitterMinClocks) {
+            if (detail.length() > 0) detail += ", ";
+            detail += juce::String(labels[i]) + " clocks received " + juce::String(jitterClocks[i]);
+        }
+    }
+
+    // stopped pairs thread 0 with sample 1, running pairs sample 2 with thread 3
+    if (jitterRms[1] > jitterRms[0] + JitterToleranceMicros) {
+        if (detail.length() > 0) detail += ", ";
+        detail += "stopped sample clocks rms " + juce::String(jitterRms[1]) +
+            " us thread clocks " + juce::String(jitterRms[0]) + " us";
+    }
+    if (jitterRms[2] > jitterRms[3] + JitterToleranceMicros) {
+        if (detail.length() > 0) detail += ", ";
+        detail += "running sample clocks rms " + juce::String(jitterRms[2]) +
+            " us thread clocks " + juce::String(jitterRms[3]) + " us";
+    }
+    reportTest("Clock jitter", detail.length() == 0, detail);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Clock Lock Test
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Clocks fed at each tempo, the jitter added to them, how close
+ * the tempo must be to call it locked, and how many clocks it may
+ * take to get there, which is two of the monitor's default windows.
+ */
+const int LockTestClocks = 24 * 32;
+const int LockTestJitterMicros = 1000;
+const int LockTestSpikeMicros = 6000;
+const double LockTestTolerance = 0.1;
+const int LockTestMaxClocks = 24 * 8;
+
+/**
+ * Feed a standalone MidiTempoMonitor synthetic clocks and measure how
+ * many it takes to lock and how far off the tempo is after that.
+ *
+ * Every clock is moved randomly within LockTestJitterMicros of where it
+ * should be, and about one in fifty is late by LockTestSpikeMicros like
+ * a busy MIDI thread.  The random seed is fixed so runs are comparable.
+ * It starts at 120 then jumps to 90 to see how fast it relocks.  Locked
+ * means it has stopped filling and the tempo is within LockTestTolerance.
+ * Each tempo must lock within LockTestMaxClocks and stay within
+ * LockTestTolerance on average after that.
+ *
+ * This doesn't need MIDI devices or the audio stream.
+ */
+void TestDriver::runClockLockTest()
+{
+    const int sampleRate = 44100;
+    const float tempos[] = {120.0f, 90.0f};
+    
+    std::unique_ptr<MidiTempoMonitor> monitor (new MidiTempoMonitor());
+    monitor->setSampleRate(sampleRate);
+    juce::Random random (36);
+    double ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+    juce::int64 start = juce::Time::getHighResolutionTicks();
+    double time = 0.0;
+    juce::String detail;
+
+    for (int t = 0 ; t < 2 ; t++) {
+        float tempo = tempos[t];
+        double period = 60.0 / (tempo * 24.0);
+        int lockClock = 0;
+        int errorCount = 0;
+        double errorTotal = 0.0;
+        double errorMax = 0.0;
+        
+        for (int i = 0 ; i < LockTestClocks ; i++) {
+            time += period;
+            double jitter = (random.nextDouble() * 2.0 - 1.0) * LockTestJitterMicros;
+            if (random.nextInt(50) == 0)
+              jitter += LockTestSpikeMicros;
+            double stamp = time + (jitter / 1000000.0);
+            monitor->consumeClock(start + (juce::int64)(stamp * ticksPerSecond));
+
+            double error = fabs(monitor->getAverageTempo() - tempo);
+            if (lockClock == 0) {
+                if (!monitor->isFilling() && error < LockTestTolerance)
+                  lockClock = i + 1;
+            }
+            else {
+                errorCount++;
+                errorTotal += error;
+                if (error > errorMax)
+                  errorMax = error;
+            }
+        }
+
+        int expectedUnit = (int)(period * 24.0 * sampleRate);
+        int unitError = abs(monitor->getAverageUnitLength() - expectedUnit);
+        double errorAverage = (errorCount > 0) ? (errorTotal / errorCount) : 0.0;
+        
+        char buf[256];
+        if (lockClock == 0) {
+            snprintf(buf, sizeof(buf), "%d BPM never locked, tempo %f",
+                     (int)tempo, monitor->getAverageTempo());
+        }
+        else {
+            snprintf(buf, sizeof(buf), "%d BPM locked after %d clocks, tempo error %f average %f maximum, unit error %d frames",
+                     (int)tempo, lockClock, errorAverage, errorMax, unitError);
+        }
+        Trace(2, "TestDriver: Clock lock at %s\n", buf);
+
+        if (lockClock == 0 || lockClock > LockTestMaxClocks || errorAverage >= LockTestTolerance) {
+            if (detail.length() > 0) detail += ", ";
+            detail += buf;
+        }
+    }
+    reportTest("Clock lock", detail.length() == 0, detail);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Sequence Benchmark
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Events in the sequence and the number of lookups timed.
+ */
+const int SequenceEvents = 100000;
+const int SequenceSeeks = 10000;
+const int SequenceInserts = 1000;
+
+/**
+ * Compare walking a large MidiSequence from the front the way the
+ * harvester used to with the indexed seek and held note searches.
+ *
+ * The sequence is mostly dense controller data with a note every
+ * tenth event lasting up to a second, which is the case that made
+ * loop jumps expensive.  Results of both methods are compared so this
+ * also checks the index, and it fails if any of them disagree.
+ */
+void TestDriver::runSequenceBenchmark()
+{
+    juce::Random random (37);
+    double ticksPerMicro = (double)juce::Time::getHighResolutionTicksPerSecond() / 1000000.0;
+    MidiSequence sequence;
+    sequence.reserveIndex();
+
+    juce::int64 start = juce::Time::getHighResolutionTicks();
+    int frame = 0;
+    for (int i = 0 ; i < SequenceEvents ; i++) {
+        MidiEvent* e = new MidiEvent();
+        e->frame = frame;
+        if (i % 10 == 0) {
+            e->juceMessage = juce::MidiMessage::noteOn(1, 60 + (i % 12), (juce::uint8)100);
+            e->duration = 1 + random.nextInt(44100);
+        }
+        else {
+            e->juceMessage = juce::MidiMessage::pitchWheel(1, random.nextInt(16384));
+        }
+        sequence.add(e);
+        frame += random.nextInt(64);
+    }
+    int lastFrame = frame;
+    juce::int64 built = juce::Time::getHighResolutionTicks();
+
+    juce::Array<int> frames;
+    for (int i = 0 ; i < SequenceSeeks ; i++)
+      frames.add(random.nextInt(lastFrame));
+
+    // seek from the front
+    juce::int64 walkStart = juce::Time::getHighResolutionTicks();
+    juce::Array<MidiEvent*> walked;
+    for (int i = 0 ; i < SequenceSeeks ; i++) {
+        MidiEvent* e = sequence.getFirst();
+        while (e != nullptr && e->frame < frames[i])
+          e = e->next;
+        walked.add(e);
+    }
+    juce::int64 walkEnd = juce::Time::getHighResolutionTicks();
+
+    int errors = 0;
+    for (int i = 0 ; i < SequenceSeeks ; i++) {
+        if (sequence.seek(frames[i]) != walked[i])
+          errors++;
+    }
+    juce::int64 seekEnd = juce::Time::getHighResolutionTicks();
+
+    // held notes, count the ones sounding at each frame both ways
+    juce::Array<int> heldWalked;
+    for (int i = 0 ; i < SequenceSeeks ; i++) {
+        int held = 0;
+        for (MidiEvent* e = sequence.getFirst() ; e != nullptr && e->frame <= frames[i] ; e = e->next) {
+            if (e->frame + e->duration - 1 > frames[i])
+              held++;
+        }
+        heldWalked.add(held);
+    }
+    juce::int64 heldWalkEnd = juce::Time::getHighResolutionTicks();
+    
+    for (int i = 0 ; i < SequenceSeeks ; i++) {
+        int held = 0;
+        for (MidiEvent* e = sequence.seekHeld(frames[i]) ; e != nullptr && e->frame <= frames[i] ; e = e->next) {
+            if (e->frame + e->duration - 1 > frames[i])
+              held++;
+        }
+        if (held != heldWalked[i])
+          errors++;
+    }
+    juce::int64 heldSeekEnd = juce::Time::getHighResolutionTicks();
+
+    // random inserts, then make sure seek still agrees with a walk
+    for (int i = 0 ; i < SequenceInserts ; i++) {
+        MidiEvent* e = new MidiEvent();
+        e->frame = random.nextInt(lastFrame);
+        e->juceMessage = juce::MidiMessage::controllerEvent(1, 1, 64);
+        sequence.insert(e);
+    }
+    juce::int64 insertEnd = juce::Time::getHighResolutionTicks();
+    
+    for (int i = 0 ; i < 100 ; i++) {
+        MidiEvent* e = sequence.getFirst();
+        while (e != nullptr && e->frame < frames[i])
+          e = e->next;
+        if (sequence.seek(frames[i]) != e)
+          errors++;
+    }
+    
+    Trace(2, "TestDriver: Sequence benchmark %d events built in %d us\n",
+          sequence.size(), (int)((double)(built - start) / ticksPerMicro));
+    Trace(2, "TestDriver: Sequence benchmark seek %d ns walking, %d ns indexed\n",
+          (int)((double)(walkEnd - walkStart) / ticksPerMicro * 1000.0 / SequenceSeeks),
+          (int)((double)(seekEnd - walkEnd) / ticksPerMicro * 1000.0 / SequenceSeeks));
+    Trace(2, "TestDriver: Sequence benchmark held %d ns walking, %d ns indexed\n",
+          (int)((double)(heldWalkEnd - seekEnd) / ticksPerMicro * 1000.0 / SequenceSeeks),
+          (int)((double)(heldSeekEnd - heldWalkEnd) / ticksPerMicro * 1000.0 / SequenceSeeks));
+    Trace(2, "TestDriver: Sequence benchmark %d inserts %d ns each\n",
+          SequenceInserts,
+          (int)((double)(insertEnd - heldSeekEnd) / ticksPerMicro * 1000.0 / SequenceInserts));
+
+    // the same thing packed
+    MidiPackedChunkPool chunks;
+    MidiPackedSequence packed;
+    if (!packed.pack(&chunks, &sequence))
+      errors++;
+    juce::int64 packedStart = juce::Time::getHighResolutionTicks();
+    for (int i = 0 ; i < SequenceSeeks ; i++) {
+        MidiEvent* e = sequence.seek(frames[i]);
+        int index = packed.seek(frames[i]);
+        int packedFrame = (index < packed.size()) ? packed.get(index).frame : -1;
+        if ((e == nullptr) ? (packedFrame != -1) : (packedFrame != e->frame))
+          errors++;
+    }
+    juce::int64 packedEnd = juce::Time::getHighResolutionTicks();
+    Trace(2, "TestDriver: Sequence benchmark packed %d bytes per event, pooled %d\n",
+          (int)sizeof(MidiPackedSequence::Event), (int)sizeof(MidiEvent));
+    Trace(2, "TestDriver: Sequence benchmark packed and indexed seek %d ns\n",
+          (int)((double)(packedEnd - packedStart) / ticksPerMicro * 1000.0 / SequenceSeeks));
+    
+    juce::String detail;
+    if (errors > 0)
+      detail = juce::String(errors) + " seeks disagreed with a walk";
+    reportTest("Sequence benchmark", errors == 0, detail);
+    
+    // the destructor deletes events when there is no pool
+    packed.clear(&chunks);
+    sequence.clear(nullptr);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Port Benchmark
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Block sizes tried and the number of blocks for each.  The last is
+ * larger than the old fixed port buffers could hold.
+ */
+const int PortBenchmarkSizes[] = {256, 1024, 8192};
+const int PortBenchmarkMaxFrames = 8192;
+const int PortBenchmarkBlocks = 2000;
+
+/**
+ * Count the samples copied per block by PortAuthority for a stereo
+ * pass-through on one port, reading the input interleaved the old way
+ * and then through the host channels, and time both.
+ *
+ * Each block makes a copy of the input the way InputStream does, then
+ * writes that to the output.  Interleaved input costs one copy of the
+ * block on the way in and one on the way out, planar input only the one
+ * on the way out.  It fails if the counts aren't exactly that.
+ *
+ * This uses its own PortAuthority and buffer so it doesn't need
+ * bypass mode.
+ */
+void TestDriver::runPortBenchmark()
+{
+    double ticksPerMicro = (double)juce::Time::getHighResolutionTicksPerSecond() / 1000000.0;
+    PortAuthority ports;
+    ports.configure(supervisor);
+    ports.allocate(PortBenchmarkMaxFrames);
+    juce::HeapBlock<float> scratch (PortBenchmarkMaxFrames * PortMaxChannels);
+    int errors = 0;
+
+    for (auto size : PortBenchmarkSizes) {
+        juce::AudioBuffer<float> buffer (PortMaxChannels, size);
+        for (int channel = 0 ; channel < PortMaxChannels ; channel++) {
+            float* samples = buffer.getWritePointer(channel);
+            for (int i = 0 ; i < size ; i++)
+              samples[i] = (float)((i % 100) - 50) / 100.0f;
+        }
+
+        int samples = size * PortMaxChannels;
+        juce::int64 copied[2] = {};
+        juce::int64 avoided[2] = {};
+        double nanos[2] = {};
+        
+        for (int planar = 0 ; planar < 2 ; planar++) {
+            juce::int64 startCopied = ports.getSamplesCopied();
+            juce::int64 startAvoided = ports.getSamplesAvoided();
+            juce::int64 start = juce::Time::getHighResolutionTicks();
+
+            for (int block = 0 ; block < PortBenchmarkBlocks ; block++) {
+                ports.prepare(buffer);
+                const float* left = nullptr;
+                const float* right = nullptr;
+                if (planar && ports.getPlanarInput(0, &left, &right)) {
+                    int sampleIndex = 0;
+                    for (int i = 0 ; i < size ; i++) {
+                        scratch[sampleIndex] = left[i];
+                        scratch[sampleIndex+1] = right[i];
+                        sampleIndex += 2;
+                    }
+                }
+                else {
+                    memcpy(scratch, ports.getInput(0), sizeof(float) * samples);
+                }
+                memcpy(ports.getOutput(0), scratch, sizeof(float) * samples);
+                ports.commit();
+            }
+            
+            juce::int64 end = juce::Time::getHighResolutionTicks();
+            copied[planar] = (ports.getSamplesCopied() - startCopied) / PortBenchmarkBlocks;
+            avoided[planar] = (ports.getSamplesAvoided() - startAvoided) / PortBenchmarkBlocks;
+            nanos[planar] = (double)(end - start) / ticksPerMicro * 1000.0 / PortBenchmarkBlocks;
+        }
+
+        Trace(2, "TestDriver: Port benchmark %d frames interleaved %d copied %d ns per block\n",
+              size, (int)copied[0], (int)nanos[0]);
+        Trace(2, "TestDriver: Port benchmark %d frames planar %d copied %d saved %d ns per block\n",
+              size, (int)copied[1], (int)avoided[1], (int)nanos[1]);
+
+        if (copied[0] != samples * 2 || avoided[0] != 0 ||
+            copied[1] != samples || avoided[1] != samples)
+          errors++;
+    }
+
+    juce::String detail;
+    if (errors > 0)
+      detail = juce::String(errors) + " block sizes copied more than expected";
+    reportTest("Port benchmark", errors == 0, detail);
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// MIDI Output Timing
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Length of the test layer, the number of notes in it, and the block
+ * sizes it is played with.  The last one is split in two the way
+ * the track scheduler splits a block around an event.
+ */
+const int OutputTimingFrames = 44100 * 4;
+const int OutputTimingNotes = 400;
+const int OutputTimingBlocks[] = {64, 256, 1000, 512};
+const int OutputTimingSplit = 100;
+
+/**
+ * Play the same layer through MidiPlayer with different block sizes
+ * and check that every NoteOn lands on the frame of its event and every
+ * NoteOff on the frame where its duration ends.
+ *
+ * The player captures what it sends, the frame is the block start plus
+ * the sample offset of the message.  Before offsets were passed along
+ * everything went out at the block start.
+ */
+void TestDriver::runMidiOutputTimingTest()
+{
+    juce::Random random (39);
+    MidiPools pools;
+    MidiLayer* layer = pools.newLayer();
+    layer->prepare(&pools);
+
+    juce::Array<int> starts;
+    for (int i = 0 ; i < OutputTimingNotes ; i++)
+      starts.add(random.nextInt(OutputTimingFrames - 44100));
+    starts.sort();
+    
+    // the blocks don't all end at the same place so only compare
+    // what all of them covered
+    int limit = OutputTimingFrames - 1024;
+    juce::StringArray expected;
+    
+    for (int i = 0 ; i < OutputTimingNotes ; i++) {
+        // a note ends before the next one with the same number starts
+        // so the player doesn't have to decide which one a NoteOff is for
+        int duration = 1 + random.nextInt(22050);
+        int next = i + 48;
+        if (next < OutputTimingNotes && starts[i] + duration >= starts[next])
+          duration = juce::jmax(1, starts[next] - starts[i] - 1);
+        
+        MidiEvent* e = pools.newEvent();
+        e->frame = starts[i];
+        e->duration = duration;
+        int note = 36 + (i % 48);
+        e->juceMessage = juce::MidiMessage::noteOn(1, note, (juce::uint8)100);
+        layer->add(e);
+
+        if (e->frame < limit)
+          expected.add(juce::String(e->frame) + " on " + juce::String(note));
+        if (e->frame + duration < limit)
+          expected.add(juce::String(e->frame + duration) + " off " + juce::String(note));
+    }
+    layer->setFrames(OutputTimingFrames);
+    // events at the same frame may be ordered differently, that's fine
+    expected.sort(false);
+
+    juce::String detail;
+    int numBlocks = (int)(sizeof(OutputTimingBlocks) / sizeof(int));
+    for (int b = 0 ; b < numBlocks ; b++) {
+        int blockSize = OutputTimingBlocks[b];
+        bool split = (b == numBlocks - 1);
+        
+        MidiPlayer player(nullptr);
+        player.initialize(&pools);
+        juce::MidiBuffer capture;
+        player.setCapture(&capture);
+        player.change(layer, 0);
+
+        juce::StringArray sent;
+        int blockStart = 0;
+        // stop short of the loop point, restart is MidiTrack's business
+        while (blockStart + blockSize < OutputTimingFrames) {
+            capture.clear();
+            player.setBlockOffset(0);
+            if (split) {
+                player.play(OutputTimingSplit);
+                player.play(blockSize - OutputTimingSplit);
+            }
+            else {
+                player.play(blockSize);
+            }
+            for (const auto metadata : capture) {
+                juce::MidiMessage msg = metadata.getMessage();
+                sent.add(juce::String(blockStart + metadata.samplePosition) + " " +
+                         juce::String(msg.isNoteOn() ? "on " : "off ") +
+                         juce::String(msg.getNoteNumber()));
+            }
+            blockStart += blockSize;
+        }
+        // there is no track to send the final NoteOffs to
+        player.reset();
+        player.setCapture(nullptr);
+
+        juce::StringArray covered;
+        for (auto s : sent) {
+            if (s.getIntValue() < limit)
+              covered.add(s);
+        }
+        covered.sort(false);
+
+        if (covered != expected) {
+            int wrong = 0;
+            for (auto s : covered) {
+                if (!expected.contains(s))
+                  wrong++;
+            }
+            if (detail.length() > 0) detail += ", ";
+            detail += "block size " + juce::String(blockSize) + (split ? " split " : " ") +
+                juce::String(wrong) + " of " + juce::String(covered.size()) +
+                " messages misplaced, expected " + juce::String(expected.size());
+        }
+    }
+
+    reportTest("MIDI output timing", detail.length() == 0, detail);
+
+    layer->clear();
+    pools.checkin(layer);
+}
+
+MidiRealizer* TestDriver::getMidiRealizer()
+{
+    return getMobiusShell()->getKernel()->getSyncMaster()->getMidiRealizer();
+}
+
+void TestDriver::sendParameter(SymbolId id, int value)
+{
+    UIAction action;
+    action.symbol = supervisor->getSymbols()->getSymbol(id);
+    action.value = value;
+    supervisor->getMobius()->doAction(&action);
+}
+
+void TestDriver::sendFunction(SymbolId id)
+{
+    UIAction action;
+    action.symbol = supervisor->getSymbols()->getSymbol(id);
+    supervisor->getMobius()->doAction(&action);
+}
+
 /**
  * MobiusListener callback when a script with a requestId finishes.
  * If this is the script we've been waiting on, cancel the wait state
@@ -344,6 +1240,8 @@ void TestDriver::mobiusScriptFinished(int requestId)
 void TestDriver::advance()
 {
     if (active) {
+        advanceJitterTest();
+        
         if (waitingId > 0) {
             juce::uint32 msec = juce::Time::getMillisecondCounter();
             juce::uint32 delta = msec - waitStart;
@@ -540,7 +1438,7 @@ void TestDriver::avoidMemoryLeak()
  */
 int TestDriver::getInterruptFrames()
 {
-    return 256;
+    return blockSize;
 }
 
 /**
@@ -560,11 +1458,11 @@ void TestDriver::getInterruptBuffers(int inport, float** input,
 }
 
 /**
- * This will be interesting to simulate.
+ * Pretend to be a plugin host only while the MIDI timing test is running.
  */
 juce::MidiBuffer* TestDriver::getMidiMessages()
 {
-    return nullptr;
+    return (midiTest) ? &testMidi : nullptr;
 }
 
 //
@@ -663,11 +1561,6 @@ void TestDriver::mobiusMidiReceived(juce::MidiMessage& msg)
     (void)msg;
 }
 
-void TestDriver::mobiusStateRefreshed(class SystemState* state)
-{
-    (void)state;
-}
-
 void TestDriver::mobiusSetFocusedTrack(int index)
 {
     (void)index;
@@ -784,6 +1677,36 @@ void TestDriver::mobiusDynamicConfigChanged()
 //
 //////////////////////////////////////////////////////////////////////
 
+/**
+ * Milliseconds to wait for the kernel to adopt the test configuration.
+ * If scripts are still running the old Scriptarian is kept and the
+ * epoch doesn't move until they finish.
+ */
+const int KernelWaitTimeout = 2000;
+
+/**
+ * Wait until the kernel has adopted everything the shell published.
+ * With live audio that happens at the start of the next block.  In bypass
+ * mode the live blocks don't get through so we have to pump them.
+ */
+void TestDriver::waitForKernel(MobiusShell* shell)
+{
+    KernelPublisher* publisher = shell->getPublisher();
+    int target = publisher->getPublications();
+    juce::uint32 start = juce::Time::getMillisecondCounter();
+
+    while (publisher->getKernelEpoch() < target) {
+        if (juce::Time::getMillisecondCounter() - start > (juce::uint32)KernelWaitTimeout) {
+            Trace(1, "TestDriver: Timed out waiting for the kernel to adopt the test configuration");
+            break;
+        }
+        if (bypass && defaultAudioListener != nullptr)
+          pumpBlock();
+        else
+          juce::Thread::sleep(1);
+    }
+}
+
 /**
  * Hook for TestPanel to force installation again to pick up
  * script changes.
@@ -834,11 +1757,11 @@ void TestDriver::installTestConfiguration()
                 // from when this code existed under MobiusShell
                 // retaining that to get this working under TestDriver but need to decide
                 // the best way for this to work
-                // we could just go through MobiusInterface::installSamples but that
-                // does an asynchronous thread transition we would need to wait for
+                // these go down with the next block like anything else, we
+                // wait for that below
 
                 SampleManager* manager = shell->compileSamples(overlay->getSampleConfig());
-                shell->sendSamples(manager, true);
+                shell->sendSamples(manager);
 
                 // load and install the scripts
                 // note that since we're bypassing installScripts, we don't get
@@ -849,13 +1772,10 @@ void TestDriver::installTestConfiguration()
                 // be redesigned once the test scripts are ported to .msl
                 Scriptarian* scriptarian = shell->compileScripts(overlay->getScriptConfigObsolete());
                 // todo: we have a way to return errors in the ScriptConfig now, should report them
-                shell->sendScripts(scriptarian, true);
+                shell->sendScripts(scriptarian);
 
-                // if we decide to defer DynamicConfigChanged notification
-                // this is where you would do it
-                // hmm, since all the send() functions do is updateDynamicConfig
-                // and send notifications could just do that here and
-                // avoid the kludgey "saveMode" flag
+                // the test scripts expect these to be installed when they start
+                waitForKernel(shell);
             }
             
             delete overlay;
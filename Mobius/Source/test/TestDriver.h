@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "../model/SymbolId.h"
 #include "../mobius/MobiusInterface.h"
 
 #include "TestPanel.h"
@@ -58,7 +59,6 @@ class TestDriver : public MobiusListener, public MobiusAudioListener, public Mob
     void mobiusDiffText(juce::String, juce::String) override;
     Audio* mobiusLoadAudio(juce::String) override;
     void mobiusScriptFinished(int requestId) override;
-    void mobiusStateRefreshed(class SystemState* state) override;
     void mobiusSetFocusedTrack(int index) override;
     void mobiusGlobalReset() override;
 
@@ -91,7 +91,17 @@ class TestDriver : public MobiusListener, public MobiusAudioListener, public Mob
     void reinstall();
     void setBypass(bool b);
     void runTest(class Symbol* s, juce::String testName);
+    void runMidiTimingTest();
+    void runBindingBenchmark();
+    void runClockJitterTest();
+    void runClockLockTest();
+    void runSequenceBenchmark();
+    void runMidiOutputTimingTest();
+    void runPortBenchmark();
     void cancel();
+
+    // outcome of one of the built-in tests above
+    void reportTest(const char* name, bool passed, juce::String detail);
     
   private:
 
@@ -122,8 +132,27 @@ class TestDriver : public MobiusListener, public MobiusAudioListener, public Mob
     float dummyInputBuffer[TestDriverMaxSamplesPerBuffer];
     float dummyOutputBuffer[TestDriverMaxSamplesPerBuffer];
 
+    // simulated block size, only changed by the MIDI timing test
+    int blockSize = 256;
+
+    // simulated host MIDI, only returned during the MIDI timing test
+    juce::MidiBuffer testMidi;
+    bool midiTest = false;
+
+    // clock jitter test state
+    int jitterPhase = 0;
+    juce::uint32 jitterStart = 0;
+    int jitterClocks[4] = {};
+    int jitterRms[4] = {};
+    void advanceJitterTest();
+    void finishJitterTest();
+    class MidiRealizer* getMidiRealizer();
+    void sendParameter(SymbolId id, int value);
+    void sendFunction(SymbolId id);
+
     class MobiusShell* getMobiusShell();
     void installTestConfiguration();
+    void waitForKernel(class MobiusShell* shell);
     void installPresetAndSetup(class MobiusConfig* config);
     class MobiusConfig* readConfigOverlay();
     juce::File getTestRoot();
@@ -136,6 +165,9 @@ class TestDriver : public MobiusListener, public MobiusAudioListener, public Mob
 
     void pumpBlocks();
     void pumpBlock();
+    void pumpMidiFrames(int frames, juce::Array<int>& noteFrames);
+    int recordMidiLoop(int size);
+    void installMidiBindings(class Binderator* b);
     void doTestAnalysis();
     void avoidMemoryLeak();
     
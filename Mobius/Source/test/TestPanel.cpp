@@ -403,6 +403,13 @@ void TestPanel::initCommandButtons()
     addCommandButton(&clearButton);
     addCommandButton(&installButton);
     addCommandButton(&cancelButton);
+    addCommandButton(&midiTimingButton);
+    addCommandButton(&bindingBenchmarkButton);
+    addCommandButton(&clockJitterButton);
+    addCommandButton(&clockLockButton);
+    addCommandButton(&sequenceBenchmarkButton);
+    addCommandButton(&midiOutputTimingButton);
+    addCommandButton(&portBenchmarkButton);
 }
 
 void TestPanel::addCommandButton(juce::Button* b)
@@ -465,6 +472,27 @@ void TestPanel::buttonClicked(juce::Button* b)
     else if (b == &cancelButton) {
         driver->cancel();
     }
+    else if (b == &midiTimingButton) {
+        driver->runMidiTimingTest();
+    }
+    else if (b == &bindingBenchmarkButton) {
+        driver->runBindingBenchmark();
+    }
+    else if (b == &clockJitterButton) {
+        driver->runClockJitterTest();
+    }
+    else if (b == &clockLockButton) {
+        driver->runClockLockTest();
+    }
+    else if (b == &sequenceBenchmarkButton) {
+        driver->runSequenceBenchmark();
+    }
+    else if (b == &midiOutputTimingButton) {
+        driver->runMidiOutputTimingTest();
+    }
+    else if (b == &portBenchmarkButton) {
+        driver->runPortBenchmark();
+    }
     else {
         // must be a test button
         TestButton* tb = dynamic_cast<TestButton*>(b);
@@ -57,6 +57,13 @@ class TestPanel : public juce::Component, public juce::Button::Listener,
     juce::TextButton installButton {"Reinstall"};
     juce::TextButton clearButton {"Clear"};
     juce::TextButton cancelButton {"Cancel"};
+    juce::TextButton midiTimingButton {"MIDI Timing"};
+    juce::TextButton bindingBenchmarkButton {"Binding Benchmark"};
+    juce::TextButton clockJitterButton {"Clock Jitter"};
+    juce::TextButton clockLockButton {"Clock Lock"};
+    juce::TextButton sequenceBenchmarkButton {"Sequence Benchmark"};
+    juce::TextButton midiOutputTimingButton {"MIDI Output Timing"};
+    juce::TextButton portBenchmarkButton {"Port Benchmark"};
 
     juce::ToggleButton bypassButton {"Bypass"};
     bool bypass = false;
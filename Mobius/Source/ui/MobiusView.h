@@ -356,6 +356,17 @@ class MobiusViewTrack {
     bool refreshEvents = false;
     juce::Array<MobiusViewEvent> events;
     juce::Array<TrackState::Region> regions;
+
+    //
+    // Waveform
+    // The peaks point into kernel memory, see TrackState
+    //
+
+    bool refreshWaveform = false;
+    juce::Array<class WavePeaks*> peaks;
+    int peakOffset = 0;
+    int peakLayer = 0;
+    int peakChanges = 0;
     
   protected:
 
@@ -207,7 +207,15 @@ void MobiusViewer::refresh(SystemState* sysstate, MobiusView* view)
         view->lastFocusedTrack = view->focusedTrack;
     }
 
-    refreshAllTracks(sysstate, view);
+    // tracks that haven't changed since the last state we saw don't need to be
+    // derived again unless something outside the state changed
+    bool all = (view->trackChanged ||
+                lastSequence == 0 ||
+                sysstate->sequence < lastSequence ||
+                view->lastSessionVersion != sysstate->sessionVersion);
+    
+    refreshAllTracks(sysstate, view, all);
+    lastSequence = sysstate->sequence;
 
     // dump the entire sync state over, no need to duplicate
     view->syncState = sysstate->syncState;
@@ -247,6 +255,7 @@ void MobiusViewer::resetRefreshTriggers(MobiusView* view)
         t->refreshEvents = false;
         t->refreshSwitch = false;
         t->refreshLoopContent = false;
+        t->refreshWaveform = false;
     }
 }
 
@@ -269,6 +278,7 @@ void MobiusViewer::forceRefresh(MobiusView* view)
         t->refreshEvents = true;
         t->refreshSwitch = true;
         t->refreshLoopContent = true;
+        t->refreshWaveform = true;
     }
 }
 
@@ -281,8 +291,12 @@ void MobiusViewer::forceRefresh(MobiusView* view)
 /**
  * This is what we should be doing for all tracks as soon as core
  * refreshes the new TrackState model properly.
+ *
+ * Unless the all flag is on, only tracks whose change sequence is
+ * newer than the last state we saw are refreshed.  The focused track
+ * details are always refreshed.
  */
-void MobiusViewer::refreshAllTracks(SystemState* state, MobiusView* view)
+void MobiusViewer::refreshAllTracks(SystemState* state, MobiusView* view, bool all)
 {
     for (int i = 0 ; i < state->totalTracks ; i++) {
 
@@ -294,6 +308,11 @@ void MobiusViewer::refreshAllTracks(SystemState* state, MobiusView* view)
         else if (i >= view->tracks.size()) {
             Trace(1, "MobiusViewer: View track index overflow");
         }
+        else if (!all && state->tracks[i]->changeSequence <= lastSequence) {
+            // the track didn't change but the tempo it displays
+            // comes from the common SyncState which may have
+            refreshSync(state, state->tracks[i], view->tracks[i]);
+        }
         else {
             TrackState* tstate = state->tracks[i];
             MobiusViewTrack* tview = view->tracks[i];
@@ -442,6 +461,29 @@ void MobiusViewer::refreshTrack(SystemState* state, TrackState* tstate,
     refreshSync(state, tstate, tview);
     refreshTrackGroups(tstate, tview);
     refreshTrackName(state, tstate, mview, tview);
+    refreshPeaks(tstate, tview);
+}
+
+/**
+ * The peak references are always copied since they may move around
+ * as the layer grows, the counters tell us when to redraw.
+ * The array will grow to the largest loop and then stay there.
+ */
+void MobiusViewer::refreshPeaks(TrackState* tstate, MobiusViewTrack* tview)
+{
+    if (tview->peaks.size() != tstate->peakCount ||
+        tview->peakOffset != tstate->peakOffset ||
+        tview->peakLayer != tstate->peakLayer ||
+        tview->peakChanges != tstate->peakChanges)
+      tview->refreshWaveform = true;
+
+    tview->peaks.clearQuick();
+    for (int i = 0 ; i < tstate->peakCount && i < tstate->peaks.size() ; i++)
+      tview->peaks.add(tstate->peaks[i]);
+    
+    tview->peakOffset = tstate->peakOffset;
+    tview->peakLayer = tstate->peakLayer;
+    tview->peakChanges = tstate->peakChanges;
 }
 
 /**
@@ -31,10 +31,13 @@ class MobiusViewer
     class Provider* provider = nullptr;
     Query subcyclesQuery;
 
+    // sequence number of the last SystemState we refreshed from
+    int lastSequence = 0;
+
     void grow(MobiusView* view, int required);
     void resetRefreshTriggers(class MobiusView* view);
 
-    void refreshAllTracks(class SystemState* state, class MobiusView* view);
+    void refreshAllTracks(class SystemState* state, class MobiusView* view, bool all);
     void refreshTrack(class SystemState* state, class TrackState* tstate,
                       class MobiusView* mview, class MobiusViewTrack* tview);
     void refreshTrackName(class SystemState* state, class TrackState* tstate,
@@ -47,6 +50,7 @@ class MobiusViewer
     
     void refreshSync(class SystemState* state, class TrackState* tstate, class MobiusViewTrack* tview);
     void refreshTrackGroups(class TrackState* tstate,  class MobiusViewTrack* tview);
+    void refreshPeaks(class TrackState* tstate, class MobiusViewTrack* tview);
 
     //
     // Focused Track
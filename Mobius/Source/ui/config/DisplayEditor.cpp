@@ -76,6 +76,8 @@ DisplayEditor::DisplayEditor(Supervisor* s) : ConfigEditor(s)
     properties.add(&buttonHeight);
     properties.add(&radarDiameter);
     properties.add(&alertDuration);
+    properties.add(&refreshRate);
+    properties.add(&highRefreshRate);
 
     tabs.add("Main Elements", &mainElements);
     tabs.add("Docked Track Strip", &dockedStrip);
@@ -281,6 +283,8 @@ void DisplayEditor::loadLayout(int ordinal)
     buttonHeight.setValue(config->get("buttonHeight"));
     radarDiameter.setValue(config->get("radarDiameter"));
     alertDuration.setValue(config->get("alertDuration"));
+    refreshRate.setValue(config->get("refreshRate"));
+    highRefreshRate.setValue(config->get("highRefreshRate"));
     
     initElementSelector(&mainElements, config, layout->mainElements, false);
 
@@ -441,6 +445,8 @@ void DisplayEditor::saveLayout(int ordinal)
     config->put("buttonHeight", buttonHeight.getValue());
     config->put("radarDiameter", radarDiameter.getValue());
     config->put("alertDuration", alertDuration.getValue());
+    config->put("refreshRate", refreshRate.getValue());
+    config->put("highRefreshRate", highRefreshRate.getValue());
 }
 
 /**
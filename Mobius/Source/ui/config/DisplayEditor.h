@@ -54,6 +54,8 @@ class DisplayEditor : public ConfigEditor
     YanInput buttonHeight {"Button Height", 20};
     YanInput radarDiameter {"Radar Diameter", 20};
     YanInput alertDuration {"Alert Duration", 20};
+    YanInput refreshRate {"Refresh Rate", 20};
+    YanInput highRefreshRate {"High Refresh Rate", 20};
     
     BasicTabs tabs;
     
@@ -62,8 +62,11 @@
 #include "../../util/Trace.h"
 
 #include "Colors.h"
+#include "PaintMeter.h"
 #include "AudioMeter.h"
 
+static PaintMeter AudioMeterPaint {"AudioMeter"};
+
 AudioMeter::AudioMeter()
 {
     // didn't seem to change in old chde
@@ -94,8 +97,12 @@ void AudioMeter::update(int value)
 		int width = getWidth() - (AudioMeterInset * 2);
         int level = (int)(((float)width / (float)range) * value);
 		if (level != savedLevel) {
+            // only the strip between the old and new level changes
+            int left = juce::jmin(level, savedLevel);
+            int right = juce::jmax(level, savedLevel);
 			savedLevel = level;
-            repaint();
+            repaint(AudioMeterInset + left, AudioMeterInset,
+                    right - left, getHeight() - (AudioMeterInset * 2));
 		}
 	}
 }
@@ -106,6 +113,7 @@ void AudioMeter::update(int value)
  */
 void AudioMeter::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(AudioMeterPaint);
     // this started as Red, but it was green in 2.5
     // opportunity to use the colors to mean something?
     g.setColour(juce::Colour(MobiusGreen));
@@ -15,6 +15,7 @@
 #include "../MobiusView.h"
 
 #include "Colors.h"
+#include "PaintMeter.h"
 #include "StatusArea.h"
 #include "LoopMeterElement.h"
 
@@ -38,6 +39,8 @@ const int MaxTextStack = 3;
 // on the left or right, which adds to the overall component width
 const int MarkerOverhang = MarkerArrowWidth / 2;
 
+static PaintMeter LoopMeterPaint {"LoopMeterElement"};
+
 LoopMeterElement::LoopMeterElement(StatusArea* area) :
     StatusElement(area, "LoopMeterElement")
 {
@@ -65,23 +68,34 @@ int LoopMeterElement::getPreferredWidth()
  * things trigger repaints.
  *
  * Since the thermometer and events are two different things
- * they can be repainted independently, but have to trigger repaint for both.
+ * they can be repainted independently.  When only the play frame
+ * advanced the events stay where they are and just the meter bar
+ * needs to be redrawn, and only if the bar moved by a pixel.
  */
 void LoopMeterElement::update(MobiusView* view)
 {
     MobiusViewTrack* track = view->track;
 
     if (view->trackChanged || track->loopChanged || track->refreshEvents ||
-        
         lastFrames != track->frames ||
-        lastFrame != track->frame ||
         lastSubcycles != track->subcycles) {
 
         lastFrame = track->frame;
         lastFrames = track->frames;
         lastSubcycles = track->subcycles;
+        lastOffset = getMeterOffset(track->frame, track->frames);
         repaint();
     }
+    else if (lastFrame != track->frame) {
+        lastFrame = track->frame;
+        int offset = getMeterOffset(track->frame, track->frames);
+        if (offset != lastOffset) {
+            lastOffset = offset;
+            repaint(MarkerOverhang, 0,
+                    MeterBarWidth + (BorderThickness * 2),
+                    MeterBarHeight + (BorderThickness * 2));
+        }
+    }
 }
 
 void LoopMeterElement::resized()
@@ -91,13 +105,14 @@ void LoopMeterElement::resized()
 }
 
 /**
- * Don't need to repaint the whole thing if only the
- * meter bar and event list changes, but it seems fast enough.
+ * When only the meter bar changed, update() limits the repaint
+ * to the bar and Juce clips everything else.
  * Could break this down into subcomponents for the progress bar
  * and events.  Will want a verbose event list too.
  */
 void LoopMeterElement::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(LoopMeterPaint);
     MobiusViewTrack* track = getMobiusView()->track;
     
     // borders, labels, etc.
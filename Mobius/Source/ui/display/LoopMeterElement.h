@@ -29,6 +29,7 @@ class LoopMeterElement : public StatusElement
     int lastFrames = 0;
     int lastFrame = 0;
     int lastSubcycles = 0;
+    int lastOffset = 0;
     
     int getMeterOffset(int frame, int frames);
 
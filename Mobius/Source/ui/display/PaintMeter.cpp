@@ -0,0 +1,55 @@
+/**
+ * Paint cost instrumentation.
+ */
+
+#include <JuceHeader.h>
+
+#include "../../util/Trace.h"
+
+#include "PaintMeter.h"
+
+PaintMeter* PaintMeter::Meters = nullptr;
+
+PaintMeter::PaintMeter(const char* argName)
+{
+    name = argName;
+    next = Meters;
+    Meters = this;
+}
+
+void PaintMeter::add(juce::int64 ticks)
+{
+    paints++;
+    totalTicks += ticks;
+    if (ticks > maxTicks)
+      maxTicks = ticks;
+}
+
+/**
+ * Trace the elements that were painted, the most expensive first.
+ */
+void PaintMeter::traceStatistics()
+{
+    juce::Array<PaintMeter*> sorted;
+    for (PaintMeter* m = Meters ; m != nullptr ; m = m->next) {
+        if (m->paints > 0) {
+            int index = 0;
+            while (index < sorted.size() && sorted[index]->totalTicks >= m->totalTicks)
+              index++;
+            sorted.insert(index, m);
+        }
+    }
+
+    double ticksPerMicro = (double)juce::Time::getHighResolutionTicksPerSecond() / 1000000.0;
+    for (auto m : sorted) {
+        int total = (int)((double)m->totalTicks / ticksPerMicro / 1000.0);
+        int average = (int)((double)m->totalTicks / ticksPerMicro / m->paints);
+        int maximum = (int)((double)m->maxTicks / ticksPerMicro);
+        Trace(2, "PaintMeter: %s %d paints %d ms total %d us average %d us maximum",
+              m->name, m->paints, total, average, maximum);
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
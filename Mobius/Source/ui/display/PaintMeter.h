@@ -0,0 +1,58 @@
+/**
+ * Accumulates the time spent painting one kind of display element.
+ *
+ * Each element class has a static PaintMeter and puts a Timer at the top
+ * of its paint() method.  The meters link themselves into a list when they
+ * are constructed so they can all be traced together at shutdown to see
+ * which elements dominate the message thread.
+ *
+ * Painting only happens on the message thread so there is no locking.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class PaintMeter
+{
+  public:
+
+    PaintMeter(const char* name);
+    ~PaintMeter() {}
+
+    /**
+     * Scoped timer for one call to paint().
+     */
+    class Timer
+    {
+      public:
+        Timer(PaintMeter& m) : meter(m) {
+            start = juce::Time::getHighResolutionTicks();
+        }
+        ~Timer() {
+            meter.add(juce::Time::getHighResolutionTicks() - start);
+        }
+      private:
+        PaintMeter& meter;
+        juce::int64 start;
+    };
+
+    void add(juce::int64 ticks);
+
+    static void traceStatistics();
+    
+  private:
+
+    static PaintMeter* Meters;
+    PaintMeter* next = nullptr;
+    
+    const char* name;
+    int paints = 0;
+    juce::int64 totalTicks = 0;
+    juce::int64 maxTicks = 0;
+
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -49,6 +49,7 @@ StatusArea::StatusArea(MobiusDisplay* parent) : display(parent)
     addElement(&minorModes);
     addElement(&tempo);
     addElement(&loopWindow);
+    addElement(&waveform);
 }
 
 void StatusArea::addElement(StatusElement* el)
@@ -21,6 +21,7 @@
 #include "MinorModesElement.h"
 #include "TempoElement.h"
 #include "LoopWindowElement.h"
+#include "WaveformElement.h"
 
 class StatusArea : public juce::Component
 {
@@ -77,6 +78,7 @@ class StatusArea : public juce::Component
     MinorModesElement minorModes {this};
     TempoElement tempo {this};
     LoopWindowElement loopWindow {this};
+    WaveformElement waveform {this};
     
     void addElement(StatusElement* el);
     void addMissing(StatusElement* el);
@@ -12,10 +12,19 @@
 #include "../MobiusView.h"
 
 #include "Colors.h"
+#include "PaintMeter.h"
 #include "TrackStrip.h"
 #include "StripElement.h"
 #include "StripElements.h"
 
+static PaintMeter TrackNumberPaint {"StripTrackNumber"};
+static PaintMeter MasterPaint {"StripMaster"};
+static PaintMeter GroupNamePaint {"StripGroupName"};
+static PaintMeter FocusLockPaint {"StripFocusLock"};
+static PaintMeter LoopRadarPaint {"StripLoopRadar"};
+static PaintMeter LoopThermometerPaint {"StripLoopThermometer"};
+static PaintMeter LoopStackPaint {"StripLoopStack"};
+
 //////////////////////////////////////////////////////////////////////
 //
 // TrackNumber
@@ -37,6 +46,9 @@
 StripTrackNumber::StripTrackNumber(class TrackStrip* parent) :
     StripElement(parent, StripDefinitionTrackNumber)
 {
+    // text rendering is expensive and rarely changes, let Juce cache it
+    // so repaints of the strip around us just copy the image
+    setBufferedToImage(true);
     action.symbol = strip->getProvider()->getSymbols()->intern("FocusLock");
     action.setScopeTrack(parent->getTrackIndex() + 1);
 }
@@ -101,6 +113,7 @@ void StripTrackNumber::update(MobiusView* view)
  */
 void StripTrackNumber::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(TrackNumberPaint);
     MobiusViewTrack* track = strip->getTrackView();
 
     juce::Colour textColor = juce::Colour(MobiusGreen);
@@ -168,6 +181,7 @@ void StripTrackNumber::mouseDown(const class juce::MouseEvent& event)
 StripMaster::StripMaster(class TrackStrip* parent) :
     StripElement(parent, StripDefinitionMaster)
 {
+    setBufferedToImage(true);
     action.symbol = strip->getProvider()->getSymbols()->intern("SyncMasterTrack");
     action.setScopeTrack(parent->getTrackIndex() + 1);
 }
@@ -203,6 +217,7 @@ void StripMaster::update(MobiusView* view)
 
 void StripMaster::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(MasterPaint);
 
     int textHeight = 12;
     juce::Font font(JuceUtil::getFont(textHeight));
@@ -302,6 +317,7 @@ void StripMaster::mouseDown(const class juce::MouseEvent& event)
 StripGroupName::StripGroupName(class TrackStrip* parent) :
     StripElement(parent, StripDefinitionGroupName)
 {
+    setBufferedToImage(true);
 }
 
 StripGroupName::~StripGroupName()
@@ -334,6 +350,7 @@ void StripGroupName::update(MobiusView* view)
  */
 void StripGroupName::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(GroupNamePaint);
     MobiusViewTrack* track = strip->getTrackView();
     
     juce::Colour textColor = juce::Colour(MobiusGreen);
@@ -368,6 +385,7 @@ void StripGroupName::paint(juce::Graphics& g)
 StripFocusLock::StripFocusLock(class TrackStrip* parent) :
     StripElement(parent, StripDefinitionFocusLock)
 {
+    setBufferedToImage(true);
     action.symbol = strip->getProvider()->getSymbols()->intern("FocusLock");
     // TrackStrip track numbers are zero based, should call
     // this TrackIndex!
@@ -399,6 +417,7 @@ void StripFocusLock::update(MobiusView* view)
 
 void StripFocusLock::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(FocusLockPaint);
     // Ellipse wants float rectangles, getLocalBounds returns ints
     // seems like there should be an easier way to convert this
     juce::Rectangle<float> area (0.0f, 0.0f, (float)getWidth(), (float)getHeight());
@@ -445,6 +464,8 @@ const int LoopRadarPadding = 4;
 StripLoopRadar::StripLoopRadar(class TrackStrip* parent) :
     StripElement(parent, StripDefinitionLoopRadar)
 {
+    // we fill the background so nothing behind us needs to be painted
+    setOpaque(true);
 }
 
 StripLoopRadar::~StripLoopRadar()
@@ -470,17 +491,29 @@ int StripLoopRadar::getPreferredHeight()
     return diameter + (LoopRadarPadding * 2);
 }
 
+/**
+ * The frame changes on every refresh but the pie only looks different
+ * when the edge of the sweep moves by a pixel along the circumference.
+ * With many strips that skips most of the repaints of small radars.
+ */
 void StripLoopRadar::update(MobiusView* view)
 {
     MobiusViewTrack* track = view->getTrack(strip->getTrackIndex());
     
     juce::Colour color = Colors::getLoopColor(track);
 
-    if (track->frame != loopFrame ||
+    int sweep = 0;
+    if (track->frames > 0) {
+        float circumference = 3.14159f * (float)diameter;
+        sweep = (int)(((float)track->frame / (float)track->frames) * circumference);
+    }
+    
+    loopFrame = track->frame;
+    if (sweep != lastSweep ||
         track->frames != loopFrames ||
         color != loopColor) {
         
-        loopFrame = track->frame;
+        lastSweep = sweep;
         loopFrames = track->frames;
         loopColor = color;
         repaint();
@@ -508,6 +541,7 @@ void StripLoopRadar::update(MobiusView* view)
  */
 void StripLoopRadar::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(LoopRadarPaint);
     float twopi = 6.28318f;
 
     // StripElement::paint(g);
@@ -553,6 +587,7 @@ void StripLoopRadar::paint(juce::Graphics& g)
 StripLoopThermometer::StripLoopThermometer(class TrackStrip* parent) :
     StripElement(parent, StripDefinitionLoopThermometer)
 {
+    setOpaque(true);
 }
 
 StripLoopThermometer::~StripLoopThermometer()
@@ -569,21 +604,34 @@ int StripLoopThermometer::getPreferredHeight()
     return 10;
 }
 
+/**
+ * Only repaint the part of the bar between the old and new edges.
+ */
 void StripLoopThermometer::update(MobiusView* view)
 {
     MobiusViewTrack* track = view->getTrack(strip->getTrackIndex());
 
-    if (track->frame != loopFrame ||
-        track->frames != loopFrames) {
+    int edge = 0;
+    if (track->frames > 0)
+      edge = (int)((float)getWidth() * ((float)track->frame / (float)track->frames));
 
-        loopFrame = track->frame;
+    loopFrame = track->frame;
+    if (track->frames != loopFrames) {
         loopFrames = track->frames;
+        lastEdge = edge;
         repaint();
     }
+    else if (edge != lastEdge) {
+        int left = juce::jmin(edge, lastEdge);
+        int right = juce::jmax(edge, lastEdge);
+        lastEdge = edge;
+        repaint(left, 0, right - left + 1, getHeight());
+    }
 }
 
 void StripLoopThermometer::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(LoopThermometerPaint);
     // StripElement::paint(g);
 
     // start by redrawing the pie every time, can get smarter later
@@ -699,6 +747,7 @@ const int LoopStackDefaultLoopRows = 4;
 StripLoopStack::StripLoopStack(class TrackStrip* parent) :
     StripElement(parent, StripDefinitionLoopStack)
 {
+    setBufferedToImage(true);
     maxLoops = LoopStackDefaultLoopRows;
 }
 
@@ -770,6 +819,7 @@ void StripLoopStack::update(MobiusView* view)
  */
 void StripLoopStack::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(LoopStackPaint);
     MobiusViewTrack* track = strip->getTrackView();
 
     // determine the origin of the loops to display
@@ -111,6 +111,8 @@ class StripLoopRadar : public StripElement
     long loopFrames = 0;
     long loopFrame = 0;
     juce::Colour loopColor;
+    // pixels along the circumference the last time we painted
+    int lastSweep = 0;
 };
 
 class StripLoopThermometer : public StripElement
@@ -130,6 +132,8 @@ class StripLoopThermometer : public StripElement
 
     long loopFrames = 0;
     long loopFrame = 0;
+    // right edge of the bar the last time we painted
+    int lastEdge = 0;
 
 };
     
@@ -19,6 +19,7 @@
 #include "../MobiusView.h"
 
 #include "Colors.h"
+#include "PaintMeter.h"
 #include "StripElement.h"
 #include "StripElements.h"
 #include "TrackStrips.h"
@@ -201,6 +202,8 @@ void TrackStrip::resized()
     }
 }
 
+static PaintMeter TrackStripPaint {"TrackStrip"};
+
 void TrackStrip::update(MobiusView* view)
 {
     // sub elements track changes themselves
@@ -211,10 +214,8 @@ void TrackStrip::update(MobiusView* view)
 
     // outer strip container may need to repaint
     // if it needs border changes
-    // this will also request repaints of all the children
-    // which may have already requested a repaint
-    // todo: verify that this doesn't cause children
-    // to be repainted twice
+    // only invalidate the border edges, a full repaint would
+    // drag every child along with it even if nothing in them changed
     MobiusViewTrack* track = getTrackView();
     
     if (focusedTrack != view->focusedTrack ||
@@ -224,12 +225,23 @@ void TrackStrip::update(MobiusView* view)
         focusedTrack = view->focusedTrack;
         lastActive = track->active;
         lastDropTarget = outerDropTarget;
-        repaint();
+        repaintBorder();
     }
 }
 
+void TrackStrip::repaintBorder()
+{
+    int width = getWidth();
+    int height = getHeight();
+    repaint(0, 0, width, 2);
+    repaint(0, height - 2, width, 2);
+    repaint(0, 0, 2, height);
+    repaint(width - 2, 0, 2, height);
+}
+
 void TrackStrip::paint(juce::Graphics& g)
 {
+    PaintMeter::Timer timer(TrackStripPaint);
     if (strips != nullptr) {
         // we're in the dock, border shows active
         if (outerDropTarget) {
@@ -94,6 +94,7 @@ class TrackStrip : public juce::Component,
     
     class StripElement* createStripElement(class StripElementDefinition* def);
     class StripElement* createNewStripElement(class UIElementDefinition* def);
+    void repaintBorder();
 
 };
 
@@ -0,0 +1,176 @@
+/**
+ * Draws the loop waveform from the peak pyramid maintained by the kernel.
+ *
+ * Each column of pixels asks WavePeaks for the range of the frames it covers,
+ * which uses the coarsest peak level that fits so painting cost depends on
+ * the width of the element and not the length of the loop.  The raw audio
+ * is never touched.
+ *
+ * The mouse wheel zooms in around the playback position.
+ */
+
+#include <JuceHeader.h>
+
+#include "../../model/WavePeaks.h"
+#include "../MobiusView.h"
+
+#include "Colors.h"
+#include "PaintMeter.h"
+#include "StatusArea.h"
+#include "WaveformElement.h"
+
+const int WaveformDefaultWidth = 300;
+const int WaveformDefaultHeight = 60;
+const int WaveformInset = 2;
+const int WaveformMaxZoom = 64;
+
+static PaintMeter WaveformPaint {"WaveformElement"};
+
+WaveformElement::WaveformElement(StatusArea* area) :
+    StatusElement(area, "WaveformElement")
+{
+    resizes = true;
+}
+
+WaveformElement::~WaveformElement()
+{
+}
+
+int WaveformElement::getPreferredHeight()
+{
+    return WaveformDefaultHeight;
+}
+
+int WaveformElement::getPreferredWidth()
+{
+    return WaveformDefaultWidth;
+}
+
+void WaveformElement::resized()
+{
+    // necessary to get the resizer
+    StatusElement::resized();
+}
+
+/**
+ * The waveform only changes when the viewer says the peaks changed,
+ * but the playback cursor moves all the time.
+ *
+ * When the entire loop is visible the waveform stays still and only
+ * the cursor columns need to be redrawn.  When zoomed the view scrolls
+ * with the cursor so everything is redrawn.
+ */
+void WaveformElement::update(MobiusView* view)
+{
+    MobiusViewTrack* track = view->track;
+
+    int cursor = -1;
+    int width = getWidth() - (WaveformInset * 2);
+    if (track->frames > 0 && width > 0)
+      cursor = (int)(((juce::int64)track->frame * width) / track->frames);
+    
+    if (view->trackChanged || track->loopChanged || track->refreshWaveform ||
+        lastFrames != track->frames ||
+        (zoom > 1 && lastFrame != track->frame)) {
+
+        lastFrames = track->frames;
+        lastFrame = track->frame;
+        lastCursor = cursor;
+        repaint();
+    }
+    else if (cursor != lastCursor) {
+        if (lastCursor >= 0)
+          repaint(WaveformInset + lastCursor, 0, 1, getHeight());
+        if (cursor >= 0)
+          repaint(WaveformInset + cursor, 0, 1, getHeight());
+        lastFrame = track->frame;
+        lastCursor = cursor;
+    }
+}
+
+void WaveformElement::mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel)
+{
+    (void)e;
+    if (wheel.deltaY > 0 && zoom < WaveformMaxZoom)
+      zoom *= 2;
+    else if (wheel.deltaY < 0 && zoom > 1)
+      zoom /= 2;
+    lastCursor = -1;
+    repaint();
+}
+
+/**
+ * When zoomed, keep the playback position in the center until
+ * we run into the edges of the loop.
+ */
+int WaveformElement::getViewStart(MobiusViewTrack* track, int viewFrames)
+{
+    int start = 0;
+    if (viewFrames < track->frames) {
+        start = track->frame - (viewFrames / 2);
+        if (start < 0)
+          start = 0;
+        else if (start + viewFrames > track->frames)
+          start = track->frames - viewFrames;
+    }
+    return start;
+}
+
+void WaveformElement::paint(juce::Graphics& g)
+{
+    PaintMeter::Timer timer(WaveformPaint);
+    MobiusViewTrack* track = getMobiusView()->track;
+    
+    // borders, labels, etc.
+    StatusElement::paint(g);
+    if (isIdentify()) return;
+
+    int width = getWidth() - (WaveformInset * 2);
+    int height = getHeight() - (WaveformInset * 2);
+    if (width <= 0 || height <= 0) return;
+
+    g.setColour(juce::Colour(MobiusBlue));
+    g.drawRect(0, 0, getWidth(), getHeight());
+    
+    int frames = track->frames;
+    if (frames <= 0 || track->peaks.size() == 0) return;
+
+    int viewFrames = frames / zoom;
+    if (viewFrames < width)
+      viewFrames = (frames < width) ? frames : width;
+    int viewStart = getViewStart(track, viewFrames);
+
+    float center = (float)WaveformInset + ((float)height / 2.0f);
+    float scale = (float)height / 2.0f;
+    double framesPerPixel = (double)viewFrames / (double)width;
+    WavePeaks* const* blocks = track->peaks.getRawDataPointer();
+    int blockCount = track->peaks.size();
+    
+    g.setColour(Colors::getLoopColor(track));
+    for (int x = 0 ; x < width ; x++) {
+        int start = viewStart + (int)(x * framesPerPixel);
+        int end = viewStart + (int)((x + 1) * framesPerPixel);
+        if (end <= start) end = start + 1;
+
+        float low, high;
+        WavePeaks::scan(blocks, blockCount, start + track->peakOffset,
+                        end + track->peakOffset, low, high);
+
+        float top = center - (high * scale);
+        float bottom = center - (low * scale);
+        if (bottom - top < 1.0f) bottom = top + 1.0f;
+        g.drawVerticalLine(WaveformInset + x, top, bottom);
+    }
+
+    // playback position
+    int cursor = (int)((track->frame - viewStart) / framesPerPixel);
+    if (cursor >= 0 && cursor < width) {
+        g.setColour(juce::Colours::white);
+        g.drawVerticalLine(WaveformInset + cursor, (float)WaveformInset,
+                           (float)(WaveformInset + height));
+    }
+}
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
@@ -0,0 +1,44 @@
+/**
+ * Status element that draws the waveform of the active loop
+ * in the focused track.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "StatusElement.h"
+
+class WaveformElement : public StatusElement
+{
+  public:
+    
+    WaveformElement(class StatusArea* area);
+    ~WaveformElement();
+
+    void update(class MobiusView* view) override;
+    int getPreferredWidth() override;
+    int getPreferredHeight() override;
+
+    void resized() override;
+    void paint(juce::Graphics& g) override;
+
+    void mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
+
+  private:
+
+    // repaint change detection state
+    int lastFrames = 0;
+    int lastFrame = 0;
+    int lastCursor = -1;
+
+    // 1 shows the entire loop, each doubling halves the visible region
+    int zoom = 1;
+
+    int getViewStart(class MobiusViewTrack* track, int viewFrames);
+
+};
+
+/****************************************************************************/
+/****************************************************************************/
+/****************************************************************************/
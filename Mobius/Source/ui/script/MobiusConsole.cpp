@@ -17,8 +17,15 @@
 #include "../../script/MslBinding.h"
 #include "../../script/MslPreprocessor.h"
 
+#include "../../model/Session.h"
+#include "../../model/ValueSet.h"
+#include "../../model/Symbol.h"
+#include "../../mobius/MobiusShell.h"
+#include "../../mobius/MobiusKernel.h"
+
 #include "../JuceUtil.h"
 #include "../../Supervisor.h"
+#include "../../Freewheeler.h"
 
 #include "ConsolePanel.h"
 
@@ -152,6 +159,18 @@ void MobiusConsole::doLine(juce::String line)
     else if (line.startsWith("resume")) {
         doResume();
     }
+    else if (line.startsWith("bench")) {
+        doBenchmark(withoutCommand(line));
+    }
+    else if (line.startsWith("prof")) {
+        doProfile(withoutCommand(line));
+    }
+    else if (line.startsWith("startup")) {
+        doStartup();
+    }
+    else if (line.startsWith("memory")) {
+        doMemory();
+    }
     
     else if (line.startsWith("parse")) {
         doParse(withoutCommand(line));
@@ -165,6 +184,9 @@ void MobiusConsole::doLine(juce::String line)
     else if (line.startsWith("namespace")) {
         doNamespace(withoutCommand(line));
     }
+    else if (line.startsWith("render")) {
+        doRender(withoutCommand(line));
+    }
     else {
         doEval(line);
     }
@@ -185,6 +207,7 @@ void MobiusConsole::doHelp()
     console.add("list         list exported links");
     console.add("list units   list compilation units");
     console.add("list files   list script registry files");
+    console.add("list times   list file compile times from the last load");
     console.add("show <id>    show details of a compilation unit");
     console.add("load <path>  load a script file");
     console.add("unload <id>  unload a compilation unit");
@@ -196,6 +219,12 @@ void MobiusConsole::doHelp()
     console.add("results      show prior evaluation results");
     console.add("processes    show current processes");
     console.add("diagnostics  enable/disable extended diagnostics");
+    console.add("bench [n]    compare walked and compiled evaluation");
+    console.add("bench session [n|reset]  time session edits in the kernel");
+    console.add("profile      script profiling, profile ? for options");
+    console.add("startup      show the timeline of application startup");
+    console.add("memory       show script value and string memory");
+    console.add("render       render offline to files, render ? for options");
     console.add("");
     console.add("parse        parse a line of MSL text");
     console.add("preproc      test the preprocessor");
@@ -355,7 +384,7 @@ void MobiusConsole::doList(juce::String line)
     juce::String ltype = line.trim();
 
     if (ltype == "") {
-        console.add("list links | units | files");
+        console.add("list links | units | files | times");
         ltype = "link";
     }
         
@@ -418,6 +447,38 @@ void MobiusConsole::doList(juce::String line)
             }
         }
     }
+    else if (ltype.startsWith("time")) {
+        // slowest first
+        ScriptClerk* clerk = supervisor->getScriptClerk();
+        ScriptRegistry::Machine* machine = clerk->getRegistry()->getMachine();
+        juce::Array<ScriptRegistry::File*> files;
+        for (auto file : machine->files) {
+            // old files don't have a hash but were compiled if they have details
+            if (file->hash != 0 || (file->old && file->getDetails() != nullptr)) {
+                double total = file->parseTime + file->installTime;
+                int location = 0;
+                while (location < files.size() &&
+                       (files[location]->parseTime + files[location]->installTime) >= total)
+                  location++;
+                files.insert(location, file);
+            }
+        }
+        console.add("Compile Times (ms)");
+        double parseTotal = 0.0;
+        double installTotal = 0.0;
+        for (auto file : files) {
+            juce::String flags;
+            if (file->unchanged) flags += " unchanged";
+            if (file->cached) flags += " cached";
+            console.add(juce::String(file->parseTime, 2) + " parse " +
+                        juce::String(file->installTime, 2) + " install  " +
+                        file->path + flags);
+            parseTotal += file->parseTime;
+            installTotal += file->installTime;
+        }
+        console.add(juce::String(parseTotal, 2) + " parse " +
+                    juce::String(installTotal, 2) + " install  total");
+    }
 }
 
 void MobiusConsole::doDetails(juce::String line)
@@ -731,6 +792,336 @@ void MobiusConsole::doDiagnostics(juce::String arg)
     scriptenv->setDiagnosticMode(!current);
 }
 
+//////////////////////////////////////////////////////////////////////
+//
+// Benchmark
+//
+//////////////////////////////////////////////////////////////////////
+
+const int BenchDefaultRuns = 1000;
+const int BenchStatements = 40;
+
+/**
+ * Evaluate a script full of arithmetic, comparisons and assignments
+ * with compiled expressions disabled and then enabled.  The values
+ * must be the same, the times hopefully aren't.  If any evaluation fails
+ * or the values differ the times mean nothing and aren't shown.
+ */
+void MobiusConsole::doBenchmark(juce::String arg)
+{
+    if (arg.startsWith("session")) {
+        doSessionBenchmark(withoutCommand(arg).trim());
+        return;
+    }
+    
+    int count = (arg.length() > 0) ? arg.getIntValue() : BenchDefaultRuns;
+    if (count <= 0)
+      count = BenchDefaultRuns;
+
+    juce::String source = "var a = 1\nvar b = 2\nvar t = 0\na = 1\nb = 2\nt = 0\n";
+    for (int i = 0 ; i < BenchStatements ; i++) {
+        source += "t = t + a * " + juce::String(i + 1) + " - b\n";
+        source += "if t > 100 {t = t - 100 b = b + 1} else {t = t + 1}\n";
+        source += "a = (a * 3 + b) / 2\n";
+    }
+    source += "t\n";
+
+    if (benchScriptlet.length() == 0)
+      benchScriptlet = scriptenv->registerScriptlet(supervisor, false);
+
+    MslDetails* details = scriptenv->extend(supervisor, benchScriptlet, source);
+    bool success = (details->errors.size() == 0);
+    if (!success)
+      showDetails(details);
+    delete details;
+
+    if (success) {
+        bool current = scriptenv->isBytecode();
+        juce::String walkedValue;
+        juce::String compiledValue;
+        
+        int failures = 0;
+        
+        scriptenv->setBytecode(false);
+        double walked = runBenchmark(count, walkedValue, failures);
+        scriptenv->setBytecode(true);
+        double compiled = runBenchmark(count, compiledValue, failures);
+        scriptenv->setBytecode(current);
+
+        if (failures > 0 || walkedValue != compiledValue) {
+            console.add("Benchmark failed: " + juce::String(failures) + " bad evaluations");
+            console.add("Walked result " + walkedValue + " compiled result " + compiledValue);
+            Trace(1, "MobiusConsole: Bytecode benchmark failed, walked %s compiled %s",
+                  walkedValue.toUTF8(), compiledValue.toUTF8());
+        }
+        else {
+            console.add(juce::String(count) + " evaluations");
+            console.add("Walked:   " + juce::String(walked, 2) + " ms result " + walkedValue);
+            console.add("Compiled: " + juce::String(compiled, 2) + " ms result " + compiledValue);
+            if (compiled > 0.0)
+              console.add("Speedup:  " + juce::String(walked / compiled, 2));
+        }
+    }
+}
+
+/**
+ * An evaluation fails if it has errors, has no value, or gets a
+ * different value than the first one.
+ */
+double MobiusConsole::runBenchmark(int count, juce::String& value, int& failures)
+{
+    double start = juce::Time::getMillisecondCounterHiRes();
+    for (int i = 0 ; i < count ; i++) {
+        MslResult* result = scriptenv->eval(supervisor, benchScriptlet);
+        if (result == nullptr || result->errors != nullptr || result->value == nullptr) {
+            failures++;
+        }
+        else {
+            juce::String s (result->value->getString());
+            if (i == 0)
+              value = s;
+            else if (s != value)
+              failures++;
+        }
+        delete result;
+    }
+    return juce::Time::getMillisecondCounterHiRes() - start;
+}
+
+const int BenchSessionEdits = 20;
+
+/**
+ * Make a number of single parameter edits to the first track of the
+ * Session and send each one down the way the session editor would.
+ * The value goes back and forth and is restored at the end so this
+ * doesn't change anything.  The kernel handles these later in the audio
+ * thread so run it again with no count to see the times.
+ *
+ *    bench session 100
+ *    bench session
+ *    bench session reset
+ */
+void MobiusConsole::doSessionBenchmark(juce::String arg)
+{
+    MobiusShell* shell = dynamic_cast<MobiusShell*>(supervisor->getMobius());
+    if (shell == nullptr) {
+        console.add("Mobius engine is not available");
+        return;
+    }
+    MobiusKernel::ReconfigureStatistics* stats = shell->getKernel()->getReconfigureStatistics();
+
+    if (arg == "reset") {
+        stats->reset();
+        console.add("Session statistics reset");
+    }
+    else if (arg.length() > 0) {
+        int count = arg.getIntValue();
+        if (count <= 0)
+          count = BenchSessionEdits;
+        
+        Session* session = supervisor->getSession();
+        Session::Track* track = session->getTrackByIndex(0);
+        Symbol* s = supervisor->getSymbols()->getSymbol(ParamFeedback);
+        if (track == nullptr || s == nullptr) {
+            console.add("Session has no tracks");
+        }
+        else {
+            ValueSet* values = track->ensureParameters();
+            bool hadValue = (values->get(s->name) != nullptr);
+            int original = hadValue ? values->getInt(s->name) :
+                session->ensureGlobals()->getInt(s->name);
+            int alternate = (original > 0) ? original - 1 : original + 1;
+            
+            for (int i = 0 ; i < count ; i++) {
+                values->setInt(s->name, ((i % 2) == 0) ? alternate : original);
+                supervisor->sendModifiedSession(false);
+            }
+
+            if (hadValue)
+              values->setInt(s->name, original);
+            else
+              values->remove(s->name);
+            supervisor->sendModifiedSession(false);
+
+            console.add("Sent " + juce::String(count + 1) + " session edits, bench session for times");
+        }
+    }
+    else {
+        int partial = stats->partial;
+        int full = stats->full;
+        console.add("Partial: " + juce::String(partial) + " edits" +
+                    formatReconfigure(stats->partialTicks, partial, stats->maxPartialTicks));
+        console.add("Full:    " + juce::String(full) + " loads" +
+                    formatReconfigure(stats->fullTicks, full, stats->maxFullTicks));
+    }
+}
+
+juce::String MobiusConsole::formatReconfigure(juce::int64 ticks, int count, juce::int64 max)
+{
+    juce::String s;
+    if (count > 0) {
+        double avg = juce::Time::highResolutionTicksToSeconds(ticks / count) * 1000.0;
+        double longest = juce::Time::highResolutionTicksToSeconds(max) * 1000.0;
+        s = " average " + juce::String(avg, 3) + " ms max " + juce::String(longest, 3) + " ms";
+    }
+    return s;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+// Profiling
+//
+//////////////////////////////////////////////////////////////////////
+
+const int ProfileStatements = 20;
+
+/**
+ * Control the MslProfiler and show what it found.
+ *
+ *    profile on
+ *    profile report kernel
+ *    profile dump
+ */
+void MobiusConsole::doProfile(juce::String line)
+{
+    MslProfiler* profiler = scriptenv->getProfiler();
+    juce::String command = line.upToFirstOccurrenceOf(" ", false, false).trim();
+    juce::String arg = line.fromFirstOccurrenceOf(" ", false, false).trim();
+
+    if (command == "?") {
+        console.add("profile on|off     start or stop recording for new sessions");
+        console.add("profile reset      clear everything recorded");
+        console.add("profile [sort]     show the report sorted by one of");
+        console.add("                   calls kernel max shell statements transitions waits allocs");
+        console.add("profile dump       write the profile as JSON to mslprofile.json");
+    }
+    else if (command == "on") {
+        profiler->setEnabled(true);
+        console.add("Profiling is on");
+    }
+    else if (command == "off") {
+        profiler->setEnabled(false);
+        console.add("Profiling is off");
+    }
+    else if (command == "reset") {
+        scriptenv->resetProfile();
+        console.add("Profile reset");
+    }
+    else if (command == "dump") {
+        juce::File file = supervisor->getRoot().getChildFile("mslprofile.json");
+        if (file.replaceWithText(scriptenv->dumpProfile()))
+          console.add("Profile written to " + file.getFullPathName());
+        else
+          console.add("Unable to write " + file.getFullPathName());
+    }
+    else {
+        if (command == "report")
+          command = arg;
+        if (!profiler->isEnabled())
+          console.add("Profiling is off");
+        juce::StringArray lines;
+        scriptenv->reportProfile(command, ProfileStatements, lines);
+        for (auto s : lines)
+          console.add(s);
+    }
+}
+
+/**
+ * Show when each of the startup tasks ran, in milliseconds.
+ */
+void MobiusConsole::doStartup()
+{
+    juce::StringArray& timeline = supervisor->getStartupTimeline();
+    if (timeline.size() == 0) {
+        console.add("No startup timeline");
+    }
+    else {
+        console.add(" start   msec thread task");
+        for (auto s : timeline)
+          console.add(s);
+    }
+}
+
+/**
+ * Show what script values and their strings are costing.
+ */
+void MobiusConsole::doMemory()
+{
+    juce::StringArray lines;
+    scriptenv->getPool()->getMemoryStatistics(lines);
+    for (auto s : lines)
+      console.add(s);
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//
+// Offline Rendering
+//
+//////////////////////////////////////////////////////////////////////
+
+/**
+ * Start or cancel an offline render.
+ * Options are keyword=value pairs.
+ *
+ *    render frames=441000 script=MyPerformance block=4096 tracks
+ *    render cancel
+ */
+void MobiusConsole::doRender(juce::String line)
+{
+    Freewheeler* fw = supervisor->getFreewheeler();
+    line = line.trim();
+
+    if (line == "?") {
+        console.add("render [options]");
+        console.add("  frames=<n>      stop after this many frames");
+        console.add("  script=<name>   run a MOS script, stop when it finishes");
+        console.add("  block=<n>       block size, default 1024");
+        console.add("  ports=<n>       number of output ports to write, default 1");
+        console.add("  input=<files>   comma separated input files, one per port");
+        console.add("  folder=<path>   output folder, default render under the installation");
+        console.add("  name=<prefix>   output file prefix, default render");
+        console.add("  tracks          also write a file for each audio track");
+        console.add("render cancel     stop the render in progress");
+    }
+    else if (line == "cancel") {
+        fw->cancel();
+    }
+    else {
+        Freewheeler::Request request;
+        request.folder = supervisor->getRoot().getChildFile("render");
+
+        juce::StringArray tokens = juce::StringArray::fromTokens(line, " ", "\"");
+        for (auto token : tokens) {
+            juce::String key = token.upToFirstOccurrenceOf("=", false, false);
+            juce::String value = token.fromFirstOccurrenceOf("=", false, false).unquoted();
+            if (key == "frames")
+              request.maxFrames = value.getIntValue();
+            else if (key == "script")
+              request.script = value;
+            else if (key == "block")
+              request.blockSize = value.getIntValue();
+            else if (key == "ports")
+              request.ports = value.getIntValue();
+            else if (key == "input")
+              request.inputs = juce::StringArray::fromTokens(value, ",", "");
+            else if (key == "folder")
+              request.folder = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (key == "name")
+              request.name = value;
+            else if (key == "tracks")
+              request.tracks = true;
+            else if (key.length() > 0)
+              console.add("Unknown render option " + key);
+        }
+
+        juce::String error = fw->start(request);
+        if (error.length() > 0)
+          console.add(error);
+        else
+          console.add("Rendering to " + request.folder.getFullPathName());
+    }
+}
 
 /**
  * Test hack for directive parsing
@@ -46,6 +46,9 @@ class MobiusConsole : public juce::Component,
     // scriptlet session we maintain
     juce::String scriptlet;
     int asyncSession = 0;
+
+    // scriptlet used by the benchmark
+    juce::String benchScriptlet;
     
     class ConsolePanel* panel = nullptr;
     BasicButtonRow commandButtons;
@@ -72,6 +75,13 @@ class MobiusConsole : public juce::Component,
     void doResults(juce::String arg);
     void doProcesses(juce::String arg);
     void doDiagnostics(juce::String arg);
+    void doBenchmark(juce::String arg);
+    double runBenchmark(int count, juce::String& value, int& failures);
+    void doSessionBenchmark(juce::String arg);
+    juce::String formatReconfigure(juce::int64 ticks, int count, juce::int64 max);
+    void doProfile(juce::String arg);
+    void doStartup();
+    void doMemory();
     
     void doEval(juce::String line);
     void showResult(class MslResult* result);
@@ -80,6 +90,7 @@ class MobiusConsole : public juce::Component,
 
     void doSignature();
     void doNamespace(juce::String line);
+    void doRender(juce::String line);
     
     void showErrors(juce::OwnedArray<class MslError>* errors);
     void showErrors(class MslError* errors);